@@ -0,0 +1,220 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Hierarchical timer wheel, a scheduling queue with O(1) insertion.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Hierarchical timer wheel, a scheduling queue with O(1) insertion.
+    //! @ingroup cpp
+    //!
+    //! A timer wheel contains elements which are due at some given "tick". The
+    //! unit of the ticks is defined by the application (milliseconds, TS packets, etc).
+    //! Elements are extracted in increasing order of due tick. Elements with the same
+    //! due tick are extracted in order of insertion.
+    //!
+    //! The timer wheel is a list of levels of slots. The first level contains one slot
+    //! per tick. Each slot in upper levels covers the complete range of the level below.
+    //! When the current tick enters a slot of an upper level, the content of that slot
+    //! is cascaded into lower levels. Elements which are due beyond the top level are
+    //! stored in an overflow list.
+    //!
+    //! Insertion is always O(1). Extraction is O(1) amortized. There is no memory
+    //! allocation once the internal node pool has reached the maximum number of elements.
+    //!
+    //! @tparam T The type of the elements in the wheel. Must be copyable. This is typically a SafePtr.
+    //!
+    template <typename T>
+    class TimerWheel
+    {
+        TS_NOCOPY(TimerWheel);
+    public:
+        //!
+        //! Type of the ticks, in application-defined units.
+        //!
+        typedef uint64_t Tick;
+
+        //!
+        //! Constructor.
+        //! @param [in] start Initial current tick.
+        //!
+        explicit TimerWheel(Tick start = 0);
+
+        //!
+        //! Clear the content of the timer wheel.
+        //! @param [in] start New current tick.
+        //!
+        void clear(Tick start = 0);
+
+        //!
+        //! Check if the timer wheel is empty.
+        //! @return True if the timer wheel is empty.
+        //!
+        bool empty() const { return _count == 0; }
+
+        //!
+        //! Get the number of elements in the timer wheel.
+        //! @return The number of elements in the timer wheel.
+        //!
+        size_t size() const { return _count; }
+
+        //!
+        //! Get the current tick of the timer wheel.
+        //! This is the due tick of the last extracted element (or the initial tick).
+        //! @return The current tick.
+        //!
+        Tick currentTick() const { return _current; }
+
+        //!
+        //! Insert an element in the timer wheel.
+        //! @param [in] elem The element to insert.
+        //! @param [in] due The due tick of the element. If earlier than the current tick,
+        //! the element is due at the current tick, after all elements which are already due.
+        //!
+        void insert(const T& elem, Tick due);
+
+        //!
+        //! Extract the next element if it is due.
+        //! @param [out] elem The extracted element.
+        //! @param [in] now The current time, in ticks.
+        //! @param [out] due Optional address of the due tick of the extracted element.
+        //! @return True if an element was extracted, false if the timer wheel is empty
+        //! or the next element is due after @a now.
+        //!
+        bool popReady(T& elem, Tick now, Tick* due = nullptr);
+
+        //!
+        //! Extract the next element, whatever its due tick.
+        //! @param [out] elem The extracted element.
+        //! @param [out] due Optional address of the due tick of the extracted element.
+        //! @return True if an element was extracted, false if the timer wheel is empty.
+        //!
+        bool pop(T& elem, Tick* due = nullptr) { return popReady(elem, ~Tick(0), due); }
+
+        //!
+        //! Remove all elements for which a predicate is true.
+        //! This is an O(n) operation.
+        //! @tparam PRED A predicate type, callable as @c bool(const T&). The predicate
+        //! is called exactly once per element. It can have side effects.
+        //! @param [in] pred The predicate.
+        //! @return The number of removed elements.
+        //!
+        template <class PRED>
+        size_t removeIf(PRED pred);
+
+        //!
+        //! Call a function on all elements, in order of due tick.
+        //! This is an O(n log n) operation, typically for debug purpose.
+        //! @tparam FUNC A function type, callable as @c void(const T&, Tick).
+        //! @param [in] func The function to call.
+        //!
+        template <class FUNC>
+        void forEach(FUNC func) const;
+
+    private:
+        // Geometry of the wheel: level 0 has 256 slots of one tick, upper levels have 64 slots.
+        // The total range of the levels is 2^26 ticks. Beyond, the elements go into the overflow list.
+        static constexpr size_t LEVELS = 4;
+        static constexpr size_t MAX_SLOTS = 256;
+        static constexpr size_t NONE = ~size_t(0);
+        static constexpr size_t WORDS = MAX_SLOTS / 64;
+
+        // Elements are stored in a pool of nodes, in singly linked lists.
+        class Node
+        {
+        public:
+            T      value;
+            Tick   due;
+            size_t next;
+            Node(const T& v, Tick d) : value(v), due(d), next(NONE) {}
+        };
+
+        // A slot is a FIFO list of nodes.
+        class Slot
+        {
+        public:
+            size_t head;
+            size_t tail;
+            Slot() : head(NONE), tail(NONE) {}
+        };
+
+        // A level is an array of slots with a bitmap of non-empty slots.
+        class Level
+        {
+        public:
+            std::vector<Slot> slots;
+            uint64_t          bitmap[WORDS];
+            Level() : slots(), bitmap() {}
+        };
+
+        Tick              _current;   // Current tick.
+        size_t            _count;     // Number of elements.
+        size_t            _free;      // Head of the list of free nodes.
+        std::vector<Node> _nodes;     // Pool of nodes.
+        Level             _levels[LEVELS];
+        Slot              _overflow;  // Elements beyond the range of the levels.
+
+        // Number of bits of a tick before the slot index in a level (level 0 to LEVELS).
+        static size_t Shift(size_t level) { return level == 0 ? 0 : 2 + 6 * level; }
+
+        // Index of the slot of a tick in a level.
+        static size_t SlotIndex(size_t level, Tick tick) { return size_t(tick >> Shift(level)) & ((size_t(1) << (Shift(level + 1) - Shift(level))) - 1); }
+
+        // Check if two ticks are in the same slot of a level (level 0 to LEVELS).
+        static bool SameSlot(size_t level, Tick t1, Tick t2) { return (t1 >> Shift(level)) == (t2 >> Shift(level)); }
+
+        // Allocate and release a node.
+        size_t allocateNode(const T& elem, Tick due);
+        void releaseNode(size_t index);
+
+        // Append a node at the end of a slot and remove the first node of a slot.
+        void append(Slot& slot, size_t index);
+        size_t removeFirst(Slot& slot);
+
+        // Place a node in the right slot, based on the current tick.
+        void place(size_t index);
+
+        // Find the index of the first non-empty slot at or after a given index in a level, NONE if there is none.
+        size_t nextSlot(size_t level, size_t start) const;
+
+        // Compute the next tick where an element may be due. Return false if the wheel is empty.
+        bool nextCandidate(Tick& tick) const;
+
+        // Advance the current tick and cascade the upper slots.
+        void advance(Tick tick);
+    };
+}
+
+#include "tsTimerWheelTemplate.h"
@@ -0,0 +1,350 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemory.h"
+
+
+//----------------------------------------------------------------------------
+// Constructor and clear.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::TimerWheel<T>::TimerWheel(Tick start) :
+    _current(start),
+    _count(0),
+    _free(NONE),
+    _nodes(),
+    _levels(),
+    _overflow()
+{
+    for (size_t level = 0; level < LEVELS; ++level) {
+        _levels[level].slots.resize(size_t(1) << (Shift(level + 1) - Shift(level)));
+    }
+}
+
+template <typename T>
+void ts::TimerWheel<T>::clear(Tick start)
+{
+    _current = start;
+    _count = 0;
+    _free = NONE;
+    _nodes.clear();
+    for (size_t level = 0; level < LEVELS; ++level) {
+        std::fill(_levels[level].slots.begin(), _levels[level].slots.end(), Slot());
+        TS_ZERO(_levels[level].bitmap);
+    }
+    _overflow = Slot();
+}
+
+
+//----------------------------------------------------------------------------
+// Allocate and release a node.
+//----------------------------------------------------------------------------
+
+template <typename T>
+size_t ts::TimerWheel<T>::allocateNode(const T& elem, Tick due)
+{
+    size_t index = _free;
+    if (index == NONE) {
+        index = _nodes.size();
+        _nodes.push_back(Node(elem, due));
+    }
+    else {
+        _free = _nodes[index].next;
+        _nodes[index].value = elem;
+        _nodes[index].due = due;
+        _nodes[index].next = NONE;
+    }
+    return index;
+}
+
+template <typename T>
+void ts::TimerWheel<T>::releaseNode(size_t index)
+{
+    // Release the element, in case it is a smart pointer.
+    _nodes[index].value = T();
+    _nodes[index].next = _free;
+    _free = index;
+}
+
+
+//----------------------------------------------------------------------------
+// Append a node at the end of a slot and remove the first node of a slot.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::TimerWheel<T>::append(Slot& slot, size_t index)
+{
+    _nodes[index].next = NONE;
+    if (slot.tail == NONE) {
+        slot.head = slot.tail = index;
+    }
+    else {
+        _nodes[slot.tail].next = index;
+        slot.tail = index;
+    }
+}
+
+template <typename T>
+size_t ts::TimerWheel<T>::removeFirst(Slot& slot)
+{
+    const size_t index = slot.head;
+    if (index != NONE) {
+        slot.head = _nodes[index].next;
+        if (slot.head == NONE) {
+            slot.tail = NONE;
+        }
+    }
+    return index;
+}
+
+
+//----------------------------------------------------------------------------
+// Place a node in the right slot, based on the current tick.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::TimerWheel<T>::place(size_t index)
+{
+    const Tick due = _nodes[index].due;
+    for (size_t level = 0; level < LEVELS; ++level) {
+        // The node is in this level if it is due in the current slot of the upper level.
+        if (SameSlot(level + 1, due, _current)) {
+            const size_t slot = SlotIndex(level, due);
+            append(_levels[level].slots[slot], index);
+            _levels[level].bitmap[slot / 64] |= uint64_t(1) << (slot % 64);
+            return;
+        }
+    }
+    append(_overflow, index);
+}
+
+
+//----------------------------------------------------------------------------
+// Insert an element in the timer wheel.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::TimerWheel<T>::insert(const T& elem, Tick due)
+{
+    place(allocateNode(elem, std::max(due, _current)));
+    _count++;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the first non-empty slot at or after a given index in a level.
+//----------------------------------------------------------------------------
+
+template <typename T>
+size_t ts::TimerWheel<T>::nextSlot(size_t level, size_t start) const
+{
+    const size_t count = _levels[level].slots.size();
+    while (start < count) {
+        const uint64_t word = _levels[level].bitmap[start / 64] >> (start % 64);
+        if (word != 0) {
+            // Locate the lowest bit in the word.
+            size_t index = start;
+            for (uint64_t w = word; (w & 1) == 0; w >>= 1) {
+                index++;
+            }
+            return index;
+        }
+        // Next word.
+        start = (start / 64 + 1) * 64;
+    }
+    return NONE;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the next tick where an element may be due.
+//----------------------------------------------------------------------------
+
+template <typename T>
+bool ts::TimerWheel<T>::nextCandidate(Tick& tick) const
+{
+    if (_count == 0) {
+        return false;
+    }
+
+    // Look for the first non-empty slot in the lowest level. In upper levels,
+    // the slot of the current tick has already been cascaded and is empty.
+    for (size_t level = 0; level < LEVELS; ++level) {
+        const size_t current = SlotIndex(level, _current);
+        const size_t slot = nextSlot(level, level == 0 ? current : current + 1);
+        if (slot != NONE) {
+            tick = ((_current >> Shift(level + 1)) << Shift(level + 1)) | (Tick(slot) << Shift(level));
+            return true;
+        }
+    }
+
+    // All levels are empty, use the earliest element in the overflow list.
+    tick = ~Tick(0);
+    for (size_t index = _overflow.head; index != NONE; index = _nodes[index].next) {
+        tick = std::min(tick, _nodes[index].due);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Advance the current tick and cascade the upper slots.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::TimerWheel<T>::advance(Tick tick)
+{
+    const Tick previous = _current;
+    _current = tick;
+
+    // If the top level range has changed, redistribute the overflow list.
+    if (!SameSlot(LEVELS, tick, previous)) {
+        Slot list(_overflow);
+        _overflow = Slot();
+        for (size_t index = removeFirst(list); index != NONE; index = removeFirst(list)) {
+            place(index);
+        }
+    }
+
+    // Cascade the slots which contain the new current tick, from top to bottom.
+    for (size_t level = LEVELS; --level > 0; ) {
+        if (!SameSlot(level, tick, previous)) {
+            const size_t slot = SlotIndex(level, tick);
+            Slot list(_levels[level].slots[slot]);
+            _levels[level].slots[slot] = Slot();
+            _levels[level].bitmap[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+            for (size_t index = removeFirst(list); index != NONE; index = removeFirst(list)) {
+                place(index);
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Extract the next element if it is due.
+//----------------------------------------------------------------------------
+
+template <typename T>
+bool ts::TimerWheel<T>::popReady(T& elem, Tick now, Tick* due)
+{
+    Tick tick = 0;
+    while (nextCandidate(tick) && tick <= now) {
+        if (tick == _current) {
+            const size_t slot = SlotIndex(0, _current);
+            Slot& list(_levels[0].slots[slot]);
+            const size_t index = removeFirst(list);
+            if (index != NONE) {
+                if (list.head == NONE) {
+                    _levels[0].bitmap[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+                }
+                elem = _nodes[index].value;
+                if (due != nullptr) {
+                    *due = _nodes[index].due;
+                }
+                releaseNode(index);
+                _count--;
+                return true;
+            }
+        }
+        // Move to the next candidate slot, cascading elements into lower levels.
+        advance(tick);
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Remove all elements for which a predicate is true.
+//----------------------------------------------------------------------------
+
+template <typename T>
+template <class PRED>
+size_t ts::TimerWheel<T>::removeIf(PRED pred)
+{
+    const size_t previous_count = _count;
+
+    // Filter one slot, return true if it is not empty after filtering.
+    auto filter = [this, &pred](Slot& slot) {
+        Slot list(slot);
+        slot = Slot();
+        for (size_t index = removeFirst(list); index != NONE; index = removeFirst(list)) {
+            if (pred(_nodes[index].value)) {
+                releaseNode(index);
+                _count--;
+            }
+            else {
+                append(slot, index);
+            }
+        }
+        return slot.head != NONE;
+    };
+
+    for (size_t level = 0; level < LEVELS && _count > 0; ++level) {
+        Level& lev(_levels[level]);
+        for (size_t slot = nextSlot(level, 0); slot != NONE; slot = nextSlot(level, slot + 1)) {
+            if (!filter(lev.slots[slot])) {
+                lev.bitmap[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+            }
+        }
+    }
+    filter(_overflow);
+
+    return previous_count - _count;
+}
+
+
+//----------------------------------------------------------------------------
+// Call a function on all elements, in order of due tick.
+//----------------------------------------------------------------------------
+
+template <typename T>
+template <class FUNC>
+void ts::TimerWheel<T>::forEach(FUNC func) const
+{
+    // Collect all nodes indexes, sorted by due tick, then insertion order in slot.
+    std::vector<std::pair<Tick, size_t>> all;
+    all.reserve(_count);
+    auto collect = [this, &all](const Slot& slot) {
+        for (size_t index = slot.head; index != NONE; index = _nodes[index].next) {
+            all.push_back(std::make_pair(_nodes[index].due, index));
+        }
+    };
+    for (size_t level = 0; level < LEVELS; ++level) {
+        for (size_t slot = nextSlot(level, 0); slot != NONE; slot = nextSlot(level, slot + 1)) {
+            collect(_levels[level].slots[slot]);
+        }
+    }
+    collect(_overflow);
+    std::stable_sort(all.begin(), all.end(), [](const std::pair<Tick, size_t>& a, const std::pair<Tick, size_t>& b) { return a.first < b.first; });
+    for (const auto& it : all) {
+        func(_nodes[it.second].value, it.first);
+    }
+}
@@ -146,4 +146,15 @@ namespace ts {
     constexpr size_t   RTP_HEADER_SIZE =    12;  //!< Size in bytes of the fixed part of the RTP header.
     constexpr uint8_t  RTP_PT_MP2T     =    33;  //!< RTP payload type for MPEG2-TS.
     constexpr uint64_t RTP_RATE_MP2T   = 90000;  //!< RTP clock rate for MPEG2-TS.
+
+    //------------------------------------------------------------------------
+    // SMPTE 2022-1 Forward Error Correction (FEC) over RTP
+    //------------------------------------------------------------------------
+
+    constexpr size_t   FEC_HEADER_SIZE        = 16;  //!< Size in bytes of the SMPTE 2022-1 FEC header, after the RTP header.
+    constexpr uint8_t  RTP_PT_FEC             = 96;  //!< RTP payload type for SMPTE 2022-1 FEC packets.
+    constexpr uint16_t FEC_COLUMN_PORT_OFFSET =  2;  //!< UDP port offset of the column FEC stream, relative to the media stream.
+    constexpr uint16_t FEC_ROW_PORT_OFFSET    =  4;  //!< UDP port offset of the row FEC stream, relative to the media stream.
+    constexpr size_t   FEC_MAX_COLUMNS        = 20;  //!< Maximum number of columns (L parameter) in a FEC matrix.
+    constexpr size_t   FEC_MAX_ROWS           = 20;  //!< Maximum number of rows (D parameter) in a FEC matrix.
 }
@@ -0,0 +1,327 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSMPTE2022FECDecoder.h"
+#include "tsMemory.h"
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::SMPTE2022FECDecoder::DEFAULT_MEDIA_WINDOW;
+constexpr size_t ts::SMPTE2022FECDecoder::RECOVERY_DEPTH;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::SMPTE2022FECDecoder::SMPTE2022FECDecoder() :
+    _media(DEFAULT_MEDIA_WINDOW),
+    _fec(),
+    _ssrc_valid(false),
+    _ssrc(0),
+    _recovered(0),
+    _max_valid(false),
+    _max_sequence(0),
+    _fec_valid(false),
+    _fec_sequence(0),
+    _changes(0),
+    _failed(false),
+    _failed_sequence(0),
+    _failed_changes(0)
+{
+}
+
+ts::SMPTE2022FECDecoder::MediaPacket::MediaPacket() :
+    valid(false),
+    sequence(0),
+    pt(0),
+    timestamp(0),
+    payload()
+{
+}
+
+ts::SMPTE2022FECDecoder::FECPacket::FECPacket() :
+    sn_base(0),
+    offset(0),
+    na(0),
+    length(0),
+    pt(0),
+    timestamp(0),
+    payload()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Set the number of most recent media packets which are kept for recovery.
+//----------------------------------------------------------------------------
+
+void ts::SMPTE2022FECDecoder::setMediaWindow(size_t count)
+{
+    // A power of 2 keeps consistent slots when the 16-bit sequence numbers wrap.
+    size_t size = DEFAULT_MEDIA_WINDOW;
+    while (size < count && size < 0x4000) {
+        size *= 2;
+    }
+    _media.resize(size);
+    reset();
+}
+
+
+//----------------------------------------------------------------------------
+// Clear all media and FEC packets.
+//----------------------------------------------------------------------------
+
+void ts::SMPTE2022FECDecoder::reset()
+{
+    for (auto& mp : _media) {
+        mp.valid = false;
+    }
+    _fec.clear();
+    _ssrc_valid = false;
+    _ssrc = 0;
+    _recovered = 0;
+    _max_valid = _fec_valid = _failed = false;
+    _max_sequence = _fec_sequence = _failed_sequence = 0;
+    _changes = _failed_changes = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a received media RTP packet.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECDecoder::addMediaPacket(const void* rtp, size_t size)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(rtp);
+    if (data == nullptr || size < RTP_HEADER_SIZE || (data[0] & 0xC0) != 0x80) {
+        return false;
+    }
+
+    const uint16_t seq = GetUInt16(data + 2);
+    MediaPacket& mp(_media[seq % _media.size()]);
+    mp.valid = true;
+    mp.sequence = seq;
+    mp.pt = data[1] & 0x7F;
+    mp.timestamp = GetUInt32(data + 4);
+    mp.payload.copy(data + RTP_HEADER_SIZE, size - RTP_HEADER_SIZE);
+
+    _ssrc_valid = true;
+    _ssrc = GetUInt32(data + 8);
+
+    // A media packet which arrives out of order or after a FEC packet which protects it
+    // (the FEC streams use other sockets) may complete that FEC packet.
+    if (_max_valid && int16_t(uint16_t(seq - _max_sequence)) <= 0) {
+        _changes++;
+    }
+    else {
+        _max_valid = true;
+        _max_sequence = seq;
+        if (_fec_valid && int16_t(uint16_t(seq - _fec_sequence)) <= 0) {
+            _changes++;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a received column or row FEC packet.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECDecoder::addFECPacket(const void* fec, size_t size)
+{
+    // Check RTP header and FEC header. Only the XOR FEC type (0) is supported.
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(fec);
+    if (data == nullptr || size < RTP_HEADER_SIZE + FEC_HEADER_SIZE || (data[0] & 0xC0) != 0x80) {
+        return false;
+    }
+    const size_t header_size = RTP_HEADER_SIZE + 4 * size_t(data[0] & 0x0F);
+    if (size < header_size + FEC_HEADER_SIZE) {
+        return false;
+    }
+    data += header_size;
+    size -= header_size + FEC_HEADER_SIZE;
+    const uint8_t offset = data[13];
+    const uint8_t na = data[14];
+    if ((data[12] & 0x38) != 0 || offset == 0 || na == 0) {
+        return false;
+    }
+
+    // Drop the oldest FEC packets, when they protect media packets which are out of the window.
+    // There is no more FEC packets than media packets in any valid FEC matrix.
+    while (!_fec.empty() && (_fec.size() >= _media.size() || (_max_valid && int(int16_t(uint16_t(_max_sequence - _fec.front().sn_base))) >= int(_media.size())))) {
+        _fec.pop_front();
+    }
+    _fec.emplace_back();
+    FECPacket& fp(_fec.back());
+    fp.sn_base = GetUInt16(data);
+    fp.offset = offset;
+    fp.na = na;
+    fp.length = GetUInt16(data + 2);
+    fp.pt = data[4] & 0x7F;
+    fp.timestamp = GetUInt32(data + 8);
+    fp.payload.copy(data + FEC_HEADER_SIZE, size);
+    _changes++;
+
+    // Keep track of the last media packet which is protected by a FEC packet.
+    const uint16_t last = uint16_t(fp.sn_base + (fp.na - 1) * fp.offset);
+    if (!_fec_valid || int16_t(uint16_t(last - _fec_sequence)) > 0) {
+        _fec_valid = true;
+        _fec_sequence = last;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a media packet is present.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECDecoder::hasMedia(uint16_t sequence) const
+{
+    const MediaPacket& mp(_media[sequence % _media.size()]);
+    return mp.valid && mp.sequence == sequence;
+}
+
+
+//----------------------------------------------------------------------------
+// Try to recover a missing media RTP packet.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECDecoder::recoverPacket(uint16_t sequence, void* buffer, size_t buffer_size, size_t& ret_size)
+{
+    ret_size = 0;
+
+    // Without new FEC packet or late media packet, a previous failure is not retried.
+    if (!hasMedia(sequence) && _failed && _failed_sequence == sequence && _failed_changes == _changes) {
+        return false;
+    }
+    if (!recover(sequence, RECOVERY_DEPTH)) {
+        _failed = true;
+        _failed_sequence = sequence;
+        _failed_changes = _changes;
+        return false;
+    }
+
+    // Rebuild the complete RTP packet.
+    if (!_ssrc_valid) {
+        return false;
+    }
+    const MediaPacket& mp(_media[sequence % _media.size()]);
+    const size_t size = RTP_HEADER_SIZE + mp.payload.size();
+    if (buffer == nullptr || buffer_size < size) {
+        return false;
+    }
+    uint8_t* data = reinterpret_cast<uint8_t*>(buffer);
+    data[0] = 0x80;
+    data[1] = mp.pt;
+    PutUInt16(data + 2, mp.sequence);
+    PutUInt32(data + 4, mp.timestamp);
+    PutUInt32(data + 8, _ssrc);
+    ::memcpy(data + RTP_HEADER_SIZE, mp.payload.data(), mp.payload.size());
+    ret_size = size;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Recover a missing media packet from the FEC packets which protect it.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECDecoder::recover(uint16_t sequence, size_t depth)
+{
+    if (hasMedia(sequence)) {
+        return true;
+    }
+
+    // Look for FEC packets (column or row) which protect this media packet.
+    // The other media packets they protect must be present or, recursively, recovered.
+    // This is how a burst in a row is recovered using the other direction.
+    for (const auto& fp : _fec) {
+        const uint16_t diff = uint16_t(sequence - fp.sn_base);
+        if (diff % fp.offset == 0 && diff / fp.offset < fp.na) {
+            bool complete = true;
+            for (size_t i = 0; complete && i < fp.na; ++i) {
+                const uint16_t seq = uint16_t(fp.sn_base + i * fp.offset);
+                complete = seq == sequence || hasMedia(seq) || (depth > 0 && recover(seq, depth - 1));
+            }
+            // The recursive recovery of other packets may have rebuilt this one.
+            if (hasMedia(sequence) || (complete && rebuild(fp, sequence))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Rebuild the only missing media packet of a FEC packet.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECDecoder::rebuild(const FECPacket& fp, uint16_t missing)
+{
+    // Do not overwrite a more recent packet in the ring (too old FEC packet).
+    MediaPacket& mp(_media[missing % _media.size()]);
+    if (mp.valid && int16_t(uint16_t(mp.sequence - missing)) > 0) {
+        return false;
+    }
+
+    // Exclusive or of the FEC packet with all other media packets.
+    uint16_t length = fp.length;
+    uint8_t pt = fp.pt;
+    uint32_t timestamp = fp.timestamp;
+    mp.valid = false;
+    mp.payload = fp.payload;
+    for (size_t i = 0; i < fp.na; ++i) {
+        const uint16_t seq = uint16_t(fp.sn_base + i * fp.offset);
+        if (seq != missing) {
+            const MediaPacket& other(_media[seq % _media.size()]);
+            if (other.payload.size() > mp.payload.size()) {
+                return false; // inconsistent FEC packet
+            }
+            length ^= uint16_t(other.payload.size());
+            pt ^= other.pt;
+            timestamp ^= other.timestamp;
+            MemXor(mp.payload.data(), mp.payload.data(), other.payload.data(), other.payload.size());
+        }
+    }
+    if (length > mp.payload.size()) {
+        return false;
+    }
+
+    mp.valid = true;
+    mp.sequence = missing;
+    mp.pt = pt & 0x7F;
+    mp.timestamp = timestamp;
+    mp.payload.resize(length);
+    _recovered++;
+    return true;
+}
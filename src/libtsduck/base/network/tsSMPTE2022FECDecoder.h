@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  SMPTE 2022-1 FEC decoder for RTP streams.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsIPProtocols.h"
+#include "tsByteBlock.h"
+
+namespace ts {
+    //!
+    //! SMPTE 2022-1 FEC (Forward Error Correction) decoder for RTP streams.
+    //!
+    //! The decoder keeps a copy of the most recent media RTP packets and the received
+    //! column and row FEC packets. The FEC matrix size is learned from the FEC headers.
+    //! A missing media packet is rebuilt when a FEC packet protects it and all other
+    //! media packets in the same column or row are available, possibly after being
+    //! recursively rebuilt using the other direction. This is how a burst loss in one
+    //! row and an isolated loss in the same column are both recovered with row FEC.
+    //!
+    //! A recovery which failed is not retried until a new FEC packet or a media packet
+    //! which is protected by an already received FEC packet is received. It is consequently
+    //! cheap to retry the recovery of a missing packet each time a new packet is received.
+    //!
+    //! Only the RTP payload (everything after the fixed 12-byte RTP header), the payload
+    //! type and the timestamp are protected by SMPTE 2022-1. A recovered packet has no
+    //! CSRC, no extension and no marker. Its SSRC is the one of the other media packets.
+    //!
+    //! @ingroup net
+    //! @see SMPTE 2022-1, Forward Error Correction for Real-Time Video/Audio Transport Over IP Networks.
+    //!
+    class TSDUCKDLL SMPTE2022FECDecoder
+    {
+        TS_NOCOPY(SMPTE2022FECDecoder);
+    public:
+        //!
+        //! Default number of media packets which are kept for recovery.
+        //! This is more than twice the largest FEC matrix.
+        //!
+        static constexpr size_t DEFAULT_MEDIA_WINDOW = 1024;
+
+        //!
+        //! Maximum depth of recursive recovery of other missing packets in the same row or column.
+        //!
+        static constexpr size_t RECOVERY_DEPTH = 2;
+
+        //!
+        //! Constructor.
+        //!
+        SMPTE2022FECDecoder();
+
+        //!
+        //! Set the number of most recent media packets which are kept for recovery.
+        //! FEC packets which protect older media packets are discarded. When the missing
+        //! packets are recovered after some reordering delay, the window shall be larger
+        //! than the maximum number of packets in that delay plus the FEC matrix.
+        //! All media and FEC packets are cleared.
+        //! @param [in] count Minimum number of media packets to keep. The actual size is
+        //! rounded up to a power of 2, at least DEFAULT_MEDIA_WINDOW and at most 16384.
+        //!
+        void setMediaWindow(size_t count);
+
+        //!
+        //! Clear all media and FEC packets.
+        //!
+        void reset();
+
+        //!
+        //! Add a received media RTP packet.
+        //! @param [in] rtp Address of the complete RTP packet, starting with the RTP header.
+        //! @param [in] size Size in bytes of the RTP packet.
+        //! @return True on success, false if @a rtp is not a valid RTP packet.
+        //!
+        bool addMediaPacket(const void* rtp, size_t size);
+
+        //!
+        //! Add a received column or row FEC packet.
+        //! @param [in] fec Address of the complete FEC packet, starting with the RTP header.
+        //! @param [in] size Size in bytes of the FEC packet.
+        //! @return True on success, false if @a fec is not a valid SMPTE 2022-1 FEC packet.
+        //!
+        bool addFECPacket(const void* fec, size_t size);
+
+        //!
+        //! Try to recover a missing media RTP packet.
+        //! @param [in] sequence RTP sequence number of the missing packet.
+        //! @param [out] buffer Address of the buffer for the recovered RTP packet.
+        //! @param [in] buffer_size Size in bytes of the buffer.
+        //! @param [out] ret_size Size in bytes of the recovered RTP packet.
+        //! @return True if the packet was received or recovered, false otherwise.
+        //!
+        bool recoverPacket(uint16_t sequence, void* buffer, size_t buffer_size, size_t& ret_size);
+
+        //!
+        //! Get the number of media packets which were rebuilt from FEC packets since the last reset.
+        //! @return The number of recovered media packets.
+        //!
+        size_t recoveredCount() const { return _recovered; }
+
+    private:
+        // A media packet, as received or rebuilt.
+        class MediaPacket
+        {
+        public:
+            MediaPacket();
+            bool      valid;        // Slot is used.
+            uint16_t  sequence;     // RTP sequence number.
+            uint8_t   pt;           // RTP payload type.
+            uint32_t  timestamp;    // RTP timestamp.
+            ByteBlock payload;      // Everything after the fixed RTP header.
+        };
+
+        // A received FEC packet.
+        class FECPacket
+        {
+        public:
+            FECPacket();
+            uint16_t  sn_base;      // Sequence number of first protected media packet.
+            uint8_t   offset;       // Distance between protected media packets.
+            uint8_t   na;           // Number of protected media packets.
+            uint16_t  length;       // Length recovery.
+            uint8_t   pt;           // Payload type recovery.
+            uint32_t  timestamp;    // Timestamp recovery.
+            ByteBlock payload;      // FEC payload.
+        };
+
+        std::vector<MediaPacket> _media;           // Ring of media packets, indexed by sequence number modulo window size.
+        std::deque<FECPacket>    _fec;             // Received FEC packets, oldest first.
+        bool                     _ssrc_valid;      // SSRC of media stream is known.
+        uint32_t                 _ssrc;            // SSRC of media stream.
+        size_t                   _recovered;       // Number of recovered packets.
+        bool                     _max_valid;       // _max_sequence is valid.
+        uint16_t                 _max_sequence;    // Highest received media sequence number.
+        bool                     _fec_valid;       // _fec_sequence is valid.
+        uint16_t                 _fec_sequence;    // Highest media sequence number which is protected by a received FEC packet.
+        size_t                   _changes;         // Number of received packets which may allow a failed recovery.
+        bool                     _failed;          // Last recovery failed.
+        uint16_t                 _failed_sequence; // Sequence number of last failed recovery.
+        size_t                   _failed_changes;  // Value of _changes at last failed recovery.
+
+        // Check if a media packet is present.
+        bool hasMedia(uint16_t sequence) const;
+
+        // Recover a missing media packet, recursively recovering other missing packets up to some depth.
+        bool recover(uint16_t sequence, size_t depth);
+
+        // Rebuild the only missing media packet of a FEC packet.
+        bool rebuild(const FECPacket& fec, uint16_t missing);
+    };
+}
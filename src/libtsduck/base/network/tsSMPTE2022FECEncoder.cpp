@@ -0,0 +1,202 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSMPTE2022FECEncoder.h"
+#include "tsMemory.h"
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::SMPTE2022FECEncoder::SMPTE2022FECEncoder(size_t columns, size_t rows, bool row_fec) :
+    _columns(0),
+    _rows(0),
+    _row_fec(false),
+    _valid(false),
+    _next_seq(0),
+    _index(0),
+    _column_seq(0),
+    _row_seq(0),
+    _column_acc(),
+    _row_acc()
+{
+    setMatrix(columns, rows, row_fec);
+}
+
+ts::SMPTE2022FECEncoder::Accumulator::Accumulator() :
+    sn_base(0),
+    length(0),
+    pt(0),
+    timestamp(0),
+    count(0),
+    payload()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Change the size of the FEC matrix and restart the encoding.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECEncoder::setMatrix(size_t columns, size_t rows, bool row_fec)
+{
+    if (columns < 1 || columns > FEC_MAX_COLUMNS || rows < 1 || rows > FEC_MAX_ROWS) {
+        return false;
+    }
+    _columns = columns;
+    _rows = rows;
+    _row_fec = row_fec;
+    reset();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Restart the encoding with an empty matrix.
+//----------------------------------------------------------------------------
+
+void ts::SMPTE2022FECEncoder::reset()
+{
+    _valid = false;
+    _index = 0;
+    _column_acc.resize(_columns);
+    for (auto& acc : _column_acc) {
+        acc.count = 0;
+    }
+    _row_acc.count = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a media RTP packet in the FEC matrix.
+//----------------------------------------------------------------------------
+
+bool ts::SMPTE2022FECEncoder::addMediaPacket(const void* rtp, size_t size, ByteBlock& column_fec, ByteBlock& row_fec)
+{
+    column_fec.clear();
+    row_fec.clear();
+
+    // Protected payload: everything after the fixed RTP header.
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(rtp);
+    if (data == nullptr || size < RTP_HEADER_SIZE || (data[0] & 0xC0) != 0x80) {
+        return false;
+    }
+    const uint8_t pt = data[1] & 0x7F;
+    const uint16_t seq = GetUInt16(data + 2);
+    const uint32_t timestamp = GetUInt32(data + 4);
+
+    // Restart the matrix on sequence discontinuity.
+    if (!_valid || seq != _next_seq) {
+        reset();
+        _valid = true;
+    }
+    _next_seq = uint16_t(seq + 1);
+
+    // Position of the media packet in the matrix, filled row by row.
+    const size_t col = _index % _columns;
+    const size_t row = _index / _columns;
+    _index = (_index + 1) % (_columns * _rows);
+
+    // Column FEC: SNBase is the first packet of the column, offset L, NA is D.
+    Add(_column_acc[col], seq, pt, timestamp, data + RTP_HEADER_SIZE, size - RTP_HEADER_SIZE);
+    if (row + 1 == _rows) {
+        Build(column_fec, _column_acc[col], _column_seq, false, uint8_t(_columns), uint8_t(_rows));
+    }
+
+    // Row FEC: SNBase is the first packet of the row, offset 1, NA is L.
+    if (_row_fec) {
+        Add(_row_acc, seq, pt, timestamp, data + RTP_HEADER_SIZE, size - RTP_HEADER_SIZE);
+        if (col + 1 == _columns) {
+            Build(row_fec, _row_acc, _row_seq, true, 1, uint8_t(_columns));
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a media packet in an accumulator.
+//----------------------------------------------------------------------------
+
+void ts::SMPTE2022FECEncoder::Add(Accumulator& acc, uint16_t seq, uint8_t pt, uint32_t timestamp, const uint8_t* payload, size_t size)
+{
+    if (acc.count == 0) {
+        acc.sn_base = seq;
+        acc.length = uint16_t(size);
+        acc.pt = pt;
+        acc.timestamp = timestamp;
+        acc.payload.copy(payload, size);
+    }
+    else {
+        // Shorter payloads are virtually padded with zeroes.
+        if (size > acc.payload.size()) {
+            acc.payload.resize(size, 0);
+        }
+        acc.length ^= uint16_t(size);
+        acc.pt ^= pt;
+        acc.timestamp ^= timestamp;
+        MemXor(acc.payload.data(), acc.payload.data(), payload, size);
+    }
+    acc.count++;
+}
+
+
+//----------------------------------------------------------------------------
+// Build a FEC packet from an accumulator and reset it.
+//----------------------------------------------------------------------------
+
+void ts::SMPTE2022FECEncoder::Build(ByteBlock& fec, Accumulator& acc, uint16_t& fec_seq, bool row, uint8_t offset, uint8_t na)
+{
+    fec.resize(RTP_HEADER_SIZE + FEC_HEADER_SIZE + acc.payload.size());
+    uint8_t* data = fec.data();
+
+    // RTP header: version 2, no padding, extension, CSRC or marker, SSRC is zero.
+    data[0] = 0x80;
+    data[1] = RTP_PT_FEC;
+    PutUInt16(data + 2, fec_seq++);
+    PutUInt32(data + 4, 0);
+    PutUInt32(data + 8, 0);
+
+    // FEC header: E=1, no mask, XOR type (0), index 0, SNBase extension is zero.
+    data += RTP_HEADER_SIZE;
+    PutUInt16(data, acc.sn_base);
+    PutUInt16(data + 2, acc.length);
+    data[4] = 0x80 | (acc.pt & 0x7F);
+    PutUInt24(data + 5, 0);
+    PutUInt32(data + 8, acc.timestamp);
+    data[12] = row ? 0x40 : 0x00;
+    data[13] = offset;
+    data[14] = na;
+    data[15] = 0;
+
+    // FEC payload.
+    ::memcpy(data + FEC_HEADER_SIZE, acc.payload.data(), acc.payload.size());
+    acc.count = 0;
+}
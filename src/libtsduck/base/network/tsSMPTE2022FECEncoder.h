@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  SMPTE 2022-1 FEC encoder for RTP streams.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsIPProtocols.h"
+#include "tsByteBlock.h"
+
+namespace ts {
+    //!
+    //! SMPTE 2022-1 FEC (Forward Error Correction) encoder for RTP streams.
+    //!
+    //! Consecutive media RTP packets are arranged in a matrix of L columns and D rows,
+    //! filled row by row. One column FEC packet is generated for each column and,
+    //! optionally, one row FEC packet is generated for each row. Each FEC packet contains
+    //! the exclusive or of the payloads of the media packets it protects. The matrix is
+    //! block-aligned: the column FEC packets are produced while the last row is filled.
+    //!
+    //! The column FEC stream is sent on the UDP port of the media stream plus
+    //! FEC_COLUMN_PORT_OFFSET and the row FEC stream on the port plus FEC_ROW_PORT_OFFSET.
+    //!
+    //! @ingroup net
+    //! @see SMPTE 2022-1, Forward Error Correction for Real-Time Video/Audio Transport Over IP Networks.
+    //!
+    class TSDUCKDLL SMPTE2022FECEncoder
+    {
+        TS_NOCOPY(SMPTE2022FECEncoder);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] columns Number of columns (L parameter) in the FEC matrix.
+        //! @param [in] rows Number of rows (D parameter) in the FEC matrix.
+        //! @param [in] row_fec If true, generate row FEC packets in addition to column FEC packets.
+        //!
+        SMPTE2022FECEncoder(size_t columns = 5, size_t rows = 5, bool row_fec = true);
+
+        //!
+        //! Change the size of the FEC matrix and restart the encoding.
+        //! @param [in] columns Number of columns (L parameter) in the FEC matrix, 1 to FEC_MAX_COLUMNS.
+        //! @param [in] rows Number of rows (D parameter) in the FEC matrix, 1 to FEC_MAX_ROWS.
+        //! @param [in] row_fec If true, generate row FEC packets in addition to column FEC packets.
+        //! @return True on success, false if the matrix size is invalid.
+        //!
+        bool setMatrix(size_t columns, size_t rows, bool row_fec = true);
+
+        //!
+        //! Get the number of columns (L parameter) in the FEC matrix.
+        //! @return The number of columns in the FEC matrix.
+        //!
+        size_t columns() const { return _columns; }
+
+        //!
+        //! Get the number of rows (D parameter) in the FEC matrix.
+        //! @return The number of rows in the FEC matrix.
+        //!
+        size_t rows() const { return _rows; }
+
+        //!
+        //! Check if row FEC packets are generated.
+        //! @return True if row FEC packets are generated.
+        //!
+        bool rowFEC() const { return _row_fec; }
+
+        //!
+        //! Restart the encoding with an empty matrix.
+        //!
+        void reset();
+
+        //!
+        //! Add a media RTP packet in the FEC matrix.
+        //! The media packets are expected with consecutive RTP sequence numbers.
+        //! In case of discontinuity, the encoding restarts with an empty matrix.
+        //! @param [in] rtp Address of the complete RTP packet, starting with the RTP header.
+        //! @param [in] size Size in bytes of the RTP packet.
+        //! @param [out] column_fec Receive a complete column FEC packet (RTP header, FEC header
+        //! and payload) when this media packet completes a column. Empty otherwise.
+        //! @param [out] row_fec Receive a complete row FEC packet when this media packet
+        //! completes a row. Empty otherwise.
+        //! @return True on success, false if @a rtp is not a valid RTP packet.
+        //!
+        bool addMediaPacket(const void* rtp, size_t size, ByteBlock& column_fec, ByteBlock& row_fec);
+
+    private:
+        // Accumulated exclusive or of a set of media packets.
+        class Accumulator
+        {
+        public:
+            Accumulator();
+            uint16_t  sn_base;     // Sequence number of first media packet.
+            uint16_t  length;      // Exclusive or of payload lengths.
+            uint8_t   pt;          // Exclusive or of payload types.
+            uint32_t  timestamp;   // Exclusive or of timestamps.
+            size_t    count;       // Number of media packets.
+            ByteBlock payload;     // Exclusive or of payloads, padded with zeroes.
+        };
+
+        size_t   _columns;        // Number of columns (L).
+        size_t   _rows;           // Number of rows (D).
+        bool     _row_fec;        // Generate row FEC.
+        bool     _valid;          // Next sequence number is valid.
+        uint16_t _next_seq;       // Next expected media sequence number.
+        size_t   _index;          // Index of next media packet in the matrix.
+        uint16_t _column_seq;     // Next RTP sequence number in column FEC stream.
+        uint16_t _row_seq;        // Next RTP sequence number in row FEC stream.
+        std::vector<Accumulator> _column_acc;  // One accumulator per column.
+        Accumulator              _row_acc;     // Accumulator for current row.
+
+        // Add a media packet in an accumulator.
+        static void Add(Accumulator& acc, uint16_t seq, uint8_t pt, uint32_t timestamp, const uint8_t* payload, size_t size);
+
+        // Build a FEC packet from an accumulator and reset it.
+        static void Build(ByteBlock& fec, Accumulator& acc, uint16_t& fec_seq, bool row, uint8_t offset, uint8_t na);
+    };
+}
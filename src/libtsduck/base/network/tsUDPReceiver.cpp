@@ -270,6 +270,35 @@ void ts::UDPReceiver::setParameters(const IPv4SocketAddress& localAddress, bool
 }
 
 
+//----------------------------------------------------------------------------
+// Set the parameters of another receiver, on a different UDP port.
+//----------------------------------------------------------------------------
+
+void ts::UDPReceiver::setParameters(const UDPReceiver& other, uint16_t portOffset)
+{
+    _receiver_specified = other._receiver_specified;
+    _use_ssm = other._use_ssm;
+    _dest_addr = other._dest_addr;
+    _dest_addr.setPort(uint16_t(other._dest_addr.port() + portOffset));
+    _local_address = other._local_address;
+    _reuse_port = other._reuse_port;
+    _default_interface = other._default_interface;
+    _use_first_source = other._use_first_source;
+    _recv_timestamps = false;
+    _recv_bufsize = other._recv_bufsize;
+    _recv_timeout = -1;
+    // The associated stream comes from the same host but not necessarily from the same port.
+    // With --first-source, the source is independently learned from the associated stream.
+    if (_use_first_source) {
+        _use_source.clear();
+    }
+    else {
+        _use_source = other._use_source;
+        _use_source.setPort(IPv4SocketAddress::AnyPort);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Open the socket. Override UDPSocket::open().
 //----------------------------------------------------------------------------
@@ -75,6 +75,15 @@ namespace ts {
         //!
         void setParameters(const IPv4SocketAddress& localAddress, bool reusePort, size_t bufferSize = 0);
 
+        //!
+        //! Set the parameters of another receiver, on a different UDP port.
+        //! This method is used to receive a stream which is associated with the main one,
+        //! on the same address, such as SMPTE 2022-1 FEC streams. There is no receive timeout.
+        //! @param [in] other Another receiver from which all parameters are copied.
+        //! @param [in] portOffset Offset to add to the UDP port of @a other.
+        //!
+        void setParameters(const UDPReceiver& other, uint16_t portOffset);
+
         //!
         //! Set reception timeout as if it comes from command line.
         //! @param [in] timeout Receive timeout in milliseconds. No timeout if zero or negative.
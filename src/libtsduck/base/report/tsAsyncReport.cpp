@@ -28,6 +28,8 @@
 //----------------------------------------------------------------------------
 
 #include "tsAsyncReport.h"
+#include "tsGuardCondition.h"
+#include "tsTime.h"
 
 
 //----------------------------------------------------------------------------
@@ -37,7 +39,15 @@
 ts::AsyncReport::AsyncReport(int max_severity, const AsyncReportArgs& args) :
     Report(max_severity),
     Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority())),
-    _log_queue(args.log_msg_count),
+    _mutex(),
+    _enqueued(),
+    _dequeued(),
+    _max_messages(args.log_msg_count),
+    _log_queue(),
+    _free_messages(_max_messages),
+    _terminating(false),
+    _log_text(),
+    _log_line(),
     _time_stamp(args.timed_log),
     _synchronous(args.sync_log),
     _terminated(false)
@@ -64,9 +74,12 @@ ts::AsyncReport::~AsyncReport()
 void ts::AsyncReport::terminate()
 {
     if (!_terminated) {
-        // Insert an "end of report" message in the queue.
-        // This message will tell the logging thread to terminate.
-        _log_queue.forceEnqueue(new LogMessage(true, 0, UString()));
+        // Tell the logging thread to terminate after logging all queued messages.
+        {
+            GuardCondition lock(_mutex, _enqueued);
+            _terminating = true;
+            lock.signal();
+        }
 
         // Wait for termination of the logging thread
         waitForTermination();
@@ -91,9 +104,23 @@ void ts::AsyncReport::writeLog(int severity, const UString &msg)
 #endif
 
     if (!_terminated) {
-        // Enqueue the message immediately (timeout = 0), drop message on overflow.
+        GuardCondition lock(_mutex, _dequeued);
+
+        // Enqueue the message immediately, drop message on overflow.
         // On the contrary, in synchronous mode, wait infinitely until the message is queued.
-        _log_queue.enqueue(new LogMessage(false, severity, msg), _synchronous ? Infinite : 0);
+        while (_synchronous && _max_messages > 0 && _log_queue.size() >= _max_messages) {
+            lock.waitCondition();
+        }
+        if (_max_messages == 0 || _log_queue.size() < _max_messages) {
+            // Reuse a free message slot, allocate one only when none is available.
+            if (_free_messages.empty()) {
+                _free_messages.emplace_back();
+            }
+            _log_queue.splice(_log_queue.end(), _free_messages, _free_messages.begin());
+            _log_queue.back().severity = severity;
+            _log_queue.back().message.assign(msg);
+            _enqueued.signal();
+        }
     }
 }
 
@@ -104,17 +131,35 @@ void ts::AsyncReport::writeLog(int severity, const UString &msg)
 
 void ts::AsyncReport::main()
 {
-    LogMessagePtr msg;
+    // The message being logged, out of the queue (at most one element).
+    LogMessageList msg;
 
     // Notify subclasses (if any) of thread start.
     asyncThreadStarted();
 
-    while (_log_queue.dequeue(msg) && !msg->terminate) {
+    for (;;) {
+        {
+            GuardCondition lock(_mutex, _enqueued);
+
+            // Recycle the slot of the previous message.
+            _free_messages.splice(_free_messages.end(), msg);
+
+            // Wait for a message or a termination request.
+            while (_log_queue.empty() && !_terminating) {
+                lock.waitCondition();
+            }
+            if (_log_queue.empty()) {
+                // Termination requested and all messages were logged.
+                break;
+            }
+            msg.splice(msg.end(), _log_queue, _log_queue.begin());
+            _dequeued.signal();
+        }
 
-        asyncThreadLog(msg->severity, msg->message);
+        asyncThreadLog(msg.front().severity, msg.front().message);
 
         // Abort application on fatal error
-        if (msg->severity == Severity::Fatal) {
+        if (msg.front().severity == Severity::Fatal) {
             ::exit(EXIT_FAILURE);
         }
     }
@@ -140,11 +185,18 @@ void ts::AsyncReport::asyncThreadStarted()
 void ts::AsyncReport::asyncThreadLog(int severity, const UString& message)
 {
     // The default implementation logs on stderr.
-    std::cerr << "* ";
+    // The line is built in reused buffers and written in one operation.
+    _log_text.assign(u"* ");
     if (_time_stamp) {
-        std::cerr << ts::Time::CurrentLocalTime().format(ts::Time::DATETIME) << " - ";
+        _log_text.append(ts::Time::CurrentLocalTime().format(ts::Time::DATETIME));
+        _log_text.append(u" - ");
     }
-    std::cerr << Severity::Header(severity) << message << std::endl;
+    _log_text.append(Severity::Header(severity));
+    _log_text.append(message);
+    _log_text.append(u'\n');
+    _log_text.toUTF8(_log_line);
+    std::cerr.write(_log_line.data(), std::streamsize(_log_line.size()));
+    std::cerr.flush();
 }
 
 void ts::AsyncReport::asyncThreadCompleted()
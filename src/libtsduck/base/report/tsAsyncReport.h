@@ -35,9 +35,9 @@
 #pragma once
 #include "tsReport.h"
 #include "tsAsyncReportArgs.h"
-#include "tsMessageQueue.h"
-#include "tsNullMutex.h"
 #include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 
 namespace ts {
     //!
@@ -134,22 +134,30 @@ namespace ts {
         // This hook is invoked in the context of the logging thread.
         virtual void main() override;
 
-        // The application threads send that type of message to the logging thread
+        // The application threads send that type of message to the logging thread.
+        // Message slots are recycled between the queue and a free list, using std::list::splice()
+        // which moves list nodes without reallocation. The message strings keep their capacity
+        // from one use to another. This way, no memory allocation occurs in steady state.
         struct LogMessage
         {
-            LogMessage(bool t, int s, const UString& m) : terminate(t), severity(s), message(m) {}
-
-            bool    terminate;  // ask the logging thread to terminate
+            LogMessage() : severity(0), message() {}
             int     severity;
             UString message;
         };
-        typedef SafePtr <LogMessage, NullMutex> LogMessagePtr;
-        typedef MessageQueue <LogMessage, NullMutex> LogMessageQueue;
+        typedef std::list<LogMessage> LogMessageList;
 
         // Private members:
-        LogMessageQueue _log_queue;
-        volatile bool   _time_stamp;
-        volatile bool   _synchronous;
-        volatile bool   _terminated;
+        Mutex           _mutex;           // Protect the two lists and the termination request.
+        Condition       _enqueued;        // Signaled when a message is enqueued or on termination request.
+        Condition       _dequeued;        // Signaled when a message is dequeued.
+        size_t          _max_messages;    // Maximum number of queued messages, zero means unlimited.
+        LogMessageList  _log_queue;       // Messages to log.
+        LogMessageList  _free_messages;   // Message slots to reuse.
+        bool            _terminating;     // Ask the logging thread to terminate after last message.
+        UString         _log_text;        // Message line, as built by the default asyncThreadLog().
+        std::string     _log_line;        // Same in UTF-8.
+        volatile bool   _time_stamp;      // Add time stamps in messages.
+        volatile bool   _synchronous;     // Wait for free space in the queue instead of dropping messages.
+        volatile bool   _terminated;      // The logging thread is terminated.
     };
 }
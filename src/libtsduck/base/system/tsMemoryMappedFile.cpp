@@ -0,0 +1,254 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemoryMappedFile.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+
+#if !defined(TS_WINDOWS)
+#include <sys/mman.h>
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::MemoryMappedFile::MemoryMappedFile() :
+    _filename(),
+    _is_open(false),
+    _read_only(true),
+    _file_size(0),
+    _mapped_offset(0),
+    _mapped_size(0),
+    _data(nullptr),
+#if defined(TS_WINDOWS)
+    _file(INVALID_HANDLE_VALUE),
+    _mapping(nullptr)
+#else
+    _fd(-1)
+#endif
+{
+}
+
+ts::MemoryMappedFile::~MemoryMappedFile()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Get the granularity of the offsets in the file.
+//----------------------------------------------------------------------------
+
+size_t ts::MemoryMappedFile::Granularity()
+{
+#if defined(TS_WINDOWS)
+    ::SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return size_t(info.dwAllocationGranularity);
+#else
+    const long size = ::sysconf(_SC_PAGESIZE);
+    return size > 0 ? size_t(size) : 4096;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Open the file.
+//----------------------------------------------------------------------------
+
+bool ts::MemoryMappedFile::open(const UString& filename, bool read_only, Report& report)
+{
+    if (_is_open) {
+        report.error(u"%s is already open", {_filename});
+        return false;
+    }
+
+    _filename = filename;
+    _read_only = read_only;
+    _file_size = 0;
+
+#if defined(TS_WINDOWS)
+
+    const ::DWORD access = read_only ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE);
+    ::LARGE_INTEGER size;
+    _file = ::CreateFileW(filename.wc_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        report.error(u"cannot open file %s: %s", {filename, SysErrorCodeMessage()});
+        return false;
+    }
+    if (::GetFileSizeEx(_file, &size) == 0) {
+        report.error(u"cannot get size of %s: %s", {filename, SysErrorCodeMessage()});
+        ::CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    _file_size = uint64_t(size.QuadPart);
+
+    // A mapping object cannot be created on an empty file.
+    if (_file_size > 0) {
+        _mapping = ::CreateFileMappingW(_file, nullptr, read_only ? PAGE_READONLY : PAGE_READWRITE, 0, 0, nullptr);
+        if (_mapping == nullptr) {
+            report.error(u"cannot map file %s: %s", {filename, SysErrorCodeMessage()});
+            ::CloseHandle(_file);
+            _file = INVALID_HANDLE_VALUE;
+            return false;
+        }
+    }
+
+#else
+
+    struct stat st;
+    _fd = ::open(filename.toUTF8().c_str(), read_only ? O_RDONLY : O_RDWR);
+    if (_fd < 0) {
+        report.error(u"cannot open file %s: %s", {filename, SysErrorCodeMessage()});
+        return false;
+    }
+    if (::fstat(_fd, &st) < 0) {
+        report.error(u"cannot get size of %s: %s", {filename, SysErrorCodeMessage()});
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    _file_size = uint64_t(st.st_size);
+
+#endif
+
+    _is_open = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the file.
+//----------------------------------------------------------------------------
+
+bool ts::MemoryMappedFile::close(Report& report)
+{
+    if (!_is_open) {
+        return true;
+    }
+
+    bool ok = unmap(report);
+
+#if defined(TS_WINDOWS)
+    if (_mapping != nullptr) {
+        ::CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+    if (::CloseHandle(_file) == 0) {
+        report.error(u"error closing %s: %s", {_filename, SysErrorCodeMessage()});
+        ok = false;
+    }
+    _file = INVALID_HANDLE_VALUE;
+#else
+    if (::close(_fd) < 0) {
+        report.error(u"error closing %s: %s", {_filename, SysErrorCodeMessage()});
+        ok = false;
+    }
+    _fd = -1;
+#endif
+
+    _is_open = false;
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Map a region of the file in memory.
+//----------------------------------------------------------------------------
+
+bool ts::MemoryMappedFile::map(uint64_t offset, size_t size, Report& report)
+{
+    if (!unmap(report)) {
+        return false;
+    }
+    if (!_is_open) {
+        report.error(u"file not open");
+        return false;
+    }
+    if (offset % Granularity() != 0) {
+        report.error(u"invalid mapping offset %'d in %s", {offset, _filename});
+        return false;
+    }
+
+    // Truncate at end of file. Mapping nothing is not an error.
+    if (offset >= _file_size) {
+        return true;
+    }
+    size = size_t(std::min<uint64_t>(size, _file_size - offset));
+
+#if defined(TS_WINDOWS)
+    void* addr = ::MapViewOfFile(_mapping, _read_only ? FILE_MAP_READ : (FILE_MAP_READ | FILE_MAP_WRITE), ::DWORD(offset >> 32), ::DWORD(offset), size);
+    if (addr == nullptr) {
+        report.error(u"error mapping %s: %s", {_filename, SysErrorCodeMessage()});
+        return false;
+    }
+#else
+    void* addr = ::mmap(nullptr, size, _read_only ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, _fd, off_t(offset));
+    if (addr == MAP_FAILED) {
+        report.error(u"error mapping %s: %s", {_filename, SysErrorCodeMessage()});
+        return false;
+    }
+    // The view is typically processed sequentially, this is only a hint.
+    ::madvise(addr, size, MADV_SEQUENTIAL);
+#endif
+
+    _data = reinterpret_cast<uint8_t*>(addr);
+    _mapped_offset = offset;
+    _mapped_size = size;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Unmap the current view.
+//----------------------------------------------------------------------------
+
+bool ts::MemoryMappedFile::unmap(Report& report)
+{
+    if (_data == nullptr) {
+        return true;
+    }
+
+#if defined(TS_WINDOWS)
+    const bool ok = ::UnmapViewOfFile(_data) != 0;
+#else
+    const bool ok = ::munmap(_data, _mapped_size) == 0;
+#endif
+
+    if (!ok) {
+        report.error(u"error unmapping %s: %s", {_filename, SysErrorCodeMessage()});
+    }
+    _data = nullptr;
+    _mapped_offset = 0;
+    _mapped_size = 0;
+    return ok;
+}
@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Memory-mapped access to a file.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsUString.h"
+#include "tsReport.h"
+#include "tsCerrReport.h"
+
+namespace ts {
+    //!
+    //! Memory-mapped access to a file, in read-only or read/write mode.
+    //! @ingroup system
+    //!
+    //! Only one region of the file, the "view", is mapped at a time. Large files
+    //! are processed by successively mapping consecutive regions of the file.
+    //! In read/write mode, modifications in the view are directly applied to the file.
+    //!
+    class TSDUCKDLL MemoryMappedFile
+    {
+        TS_NOCOPY(MemoryMappedFile);
+    public:
+        //!
+        //! Default constructor.
+        //!
+        MemoryMappedFile();
+
+        //!
+        //! Destructor.
+        //! The file is unmapped and closed.
+        //!
+        ~MemoryMappedFile();
+
+        //!
+        //! Open the file.
+        //! @param [in] filename File name.
+        //! @param [in] read_only If true, open the file in read-only mode. Otherwise,
+        //! the file is open in read/write mode and modifications in the mapped view are
+        //! written back into the file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool open(const UString& filename, bool read_only, Report& report = CERR);
+
+        //!
+        //! Close the file.
+        //! The current view is unmapped first.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report = CERR);
+
+        //!
+        //! Check if the file is open.
+        //! @return True if the file is open.
+        //!
+        bool isOpen() const { return _is_open; }
+
+        //!
+        //! Get the file name.
+        //! @return The file name.
+        //!
+        const UString& fileName() const { return _filename; }
+
+        //!
+        //! Get the file size, as when the file was open.
+        //! @return The file size in bytes.
+        //!
+        uint64_t fileSize() const { return _file_size; }
+
+        //!
+        //! Map a region of the file in memory.
+        //! The previous view, if any, is unmapped first.
+        //! @param [in] offset Offset of the region in the file. Must be a multiple of Granularity().
+        //! @param [in] size Size in bytes of the region. Truncated at end of file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool map(uint64_t offset, size_t size, Report& report = CERR);
+
+        //!
+        //! Unmap the current view, if any.
+        //! In read/write mode, the modifications are written back into the file
+        //! asynchronously by the operating system.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool unmap(Report& report = CERR);
+
+        //!
+        //! Get the address of the current view.
+        //! @return The address of the mapped region or a null pointer if no region is mapped.
+        //!
+        uint8_t* data() const { return _data; }
+
+        //!
+        //! Get the size of the current view.
+        //! @return The size in bytes of the mapped region.
+        //!
+        size_t mappedSize() const { return _mapped_size; }
+
+        //!
+        //! Get the offset in the file of the current view.
+        //! @return The offset in bytes of the mapped region.
+        //!
+        uint64_t mappedOffset() const { return _mapped_offset; }
+
+        //!
+        //! Get the granularity of the offsets in the file for map().
+        //! This is the system page size on UNIX systems and the allocation granularity on Windows.
+        //! @return The mapping granularity in bytes.
+        //!
+        static size_t Granularity();
+
+    private:
+        UString  _filename;
+        bool     _is_open;
+        bool     _read_only;
+        uint64_t _file_size;
+        uint64_t _mapped_offset;
+        size_t   _mapped_size;
+        uint8_t* _data;
+#if defined(TS_WINDOWS)
+        ::HANDLE _file;
+        ::HANDLE _mapping;
+#else
+        int      _fd;
+#endif
+    };
+}
@@ -195,25 +195,38 @@ ts::TextFormatter& ts::TextFormatter::setMarginSize(size_t margin)
 
 bool ts::TextFormatter::writeStreamBuffer(const void* addr, size_t size)
 {
-    const char* const last = static_cast<const char*>(addr) + size;
-    for (const char* p = static_cast<const char*>(addr); p < last; ++p) {
-        if (*p == '\t') {
-            // Tabulations are expanded as spaces.
-            // Without formatting, a tabulation is just one space.
-            do {
-                *_out << ' ';
-            } while (++_column % _tabSize != 0 && _formatting);
+    const char* p = static_cast<const char*>(addr);
+    const char* const last = p + size;
+    while (p < last) {
+
+        // Write the longest sequence of characters without special processing at once.
+        const char* next = p;
+        while (next < last && *next != '\t' && *next != '\r' && *next != '\n') {
+            _afterSpace = _afterSpace || *next != ' ';
+            ++next;
         }
-        else if (*p == '\r' || *p == '\n') {
-            // CR and LF indifferently move back to begining of current/next line.
-            *_out << *p;
-            _column = 0;
-            _afterSpace = false;
+        if (next > p) {
+            _out->write(p, next - p);
+            _column += next - p;
+            p = next;
         }
-        else {
-            *_out << *p;
-            ++_column;
-            _afterSpace = _afterSpace || *p != ' ';
+
+        // Process one special character.
+        if (p < last) {
+            if (*p == '\t') {
+                // Tabulations are expanded as spaces.
+                // Without formatting, a tabulation is just one space.
+                do {
+                    *_out << ' ';
+                } while (++_column % _tabSize != 0 && _formatting);
+            }
+            else {
+                // CR and LF indifferently move back to begining of current/next line.
+                *_out << *p;
+                _column = 0;
+                _afterSpace = false;
+            }
+            ++p;
         }
     }
     return !_out->fail();
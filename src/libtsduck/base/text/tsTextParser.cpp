@@ -36,8 +36,8 @@
 
 ts::TextParser::TextParser(Report& report) :
     _report(report),
-    _lines(),
-    _pos(_lines)
+    _text(),
+    _pos(_text)
 {
 }
 
@@ -53,9 +53,8 @@ ts::TextParser::TextParser(const UString& text, Report& report) :
     loadDocument(text);
 }
 
-ts::TextParser::Position::Position(const UStringList& textLines) :
-    _lines(&textLines),
-    _curLine(textLines.begin()),
+ts::TextParser::Position::Position(const UString& text) :
+    _text(&text),
     _curLineNumber(1),
     _curIndex(0)
 {
@@ -72,8 +71,8 @@ ts::TextParser::~TextParser()
 
 void ts::TextParser::clear()
 {
-    _lines.clear();
-    _pos = Position(_lines);
+    _text.clear();
+    _pos = Position(_text);
 }
 
 
@@ -83,55 +82,122 @@ void ts::TextParser::clear()
 
 void ts::TextParser::loadDocument(const UStringList& lines)
 {
-    _lines.clear();
-    _pos = Position(lines);
+    size_t size = 0;
+    for (const auto& line : lines) {
+        size += line.length() + 1;
+    }
+    _text.clear();
+    _text.reserve(size);
+    for (const auto& line : lines) {
+        _text.append(line);
+        _text.append(LINE_FEED);
+    }
+    _pos = Position(_text);
 }
 
 void ts::TextParser::loadDocument(const UString& text)
 {
-    text.toSubstituted(u"\r", UString()).split(_lines, u'\n', false);
-    _pos = Position(_lines);
+    // All CR are removed and there is always one last line, even empty.
+    _text.clear();
+    _text.reserve(text.length() + 1);
+    for (const UChar c : text) {
+        if (c != CARRIAGE_RETURN) {
+            _text.push_back(c);
+        }
+    }
+    _text.append(LINE_FEED);
+    _pos = Position(_text);
 }
 
 bool ts::TextParser::loadFile(const UString& fileName)
 {
-    // Load the file into the internal lines buffer.
-    const bool ok = UString::Load(_lines, fileName);
+    std::ifstream file(fileName.toUTF8().c_str());
+    const bool ok = file && loadStream(file);
     if (!ok) {
         _report.error(u"error reading file %s", {fileName});
+        // Initialize the parser on an empty document on file error.
+        clear();
     }
-
-    // Initialize the parser on the internal lines buffer, including on file error (empty).
-    _pos = Position(_lines);
     return ok;
 }
 
 bool ts::TextParser::loadStream(std::istream& strm)
 {
-    // Load the file into the internal lines buffer.
-    const bool ok = UString::Load(_lines, strm);
+    // Read the complete UTF-8 content in one single buffer.
+    std::string utf8;
+    std::array<char, 65536> buffer;
+    while (strm) {
+        strm.read(buffer.data(), buffer.size());
+        utf8.append(buffer.data(), size_t(strm.gcount()));
+    }
+    const bool ok = strm.eof();
+
+    // Remove potential UTF-8 BOM (Byte Order Mark) at beginning of document.
+    size_t start = 0;
+    if (utf8.compare(0, UString::UTF8_BOM_SIZE, UString::UTF8_BOM, UString::UTF8_BOM_SIZE) == 0) {
+        start = UString::UTF8_BOM_SIZE;
+    }
+
+    // Convert the document to UTF-16 in one pass.
+    _text.assignFromUTF8(utf8.data() + start, utf8.size() - start);
+    normalizeDocument();
+    _pos = Position(_text);
+
     if (!ok) {
         _report.error(u"error reading input document");
     }
-
-    // Initialize the parser on the internal lines buffer, including on file error (empty).
-    _pos = Position(_lines);
     return ok;
 }
 
 
+//----------------------------------------------------------------------------
+// Normalize the internal document after loading.
+//----------------------------------------------------------------------------
+
+void ts::TextParser::normalizeDocument()
+{
+    // Remove trailing CR at end of lines. The CR in the middle of a line are kept.
+    const size_t first_cr = _text.find(CARRIAGE_RETURN);
+    size_t out = first_cr == NPOS ? _text.length() : first_cr;
+    size_t pending_cr = 0;
+    for (size_t in = out; in < _text.length(); ++in) {
+        const UChar c = _text[in];
+        if (c == CARRIAGE_RETURN) {
+            pending_cr++;
+        }
+        else {
+            if (c != LINE_FEED) {
+                while (pending_cr > 0) {
+                    _text[out++] = CARRIAGE_RETURN;
+                    pending_cr--;
+                }
+            }
+            pending_cr = 0;
+            _text[out++] = c;
+        }
+    }
+    _text.resize(out);
+
+    // All lines, including the last one, are terminated by a LF.
+    if (!_text.empty() && _text.back() != LINE_FEED) {
+        _text.append(LINE_FEED);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Save the document to parse to a text file.
 //----------------------------------------------------------------------------
 
 bool ts::TextParser::saveFile(const UString& fileName)
 {
-    return UString::Save(_lines, fileName);
+    return _text.save(fileName);
 }
 
 bool ts::TextParser::saveStream(std::ostream& strm)
 {
-    return UString::Save(_lines, strm);
+    strm << _text;
+    return !strm.fail();
 }
 
 
@@ -142,8 +208,8 @@ bool ts::TextParser::saveStream(std::ostream& strm)
 bool ts::TextParser::seek(const Position& pos)
 {
     // Check that we are still on the same document. This is a minimum fool-proof check.
-    // But there is no guarantee that pos.curLine is still valid.
-    if (pos._lines == _pos._lines) {
+    // But there is no guarantee that pos._curIndex is still valid.
+    if (pos._text == _pos._text) {
         _pos = pos;
         return true;
     }
@@ -159,17 +225,28 @@ bool ts::TextParser::seek(const Position& pos)
 
 bool ts::TextParser::eof() const
 {
-    return _pos._curLine == _pos._lines->end();
+    return _pos._curIndex >= _text.length();
 }
 
 bool ts::TextParser::eol() const
 {
-    return _pos._curLine == _pos._lines->end() || _pos._curIndex >= _pos._curLine->length();
+    return _pos._curIndex >= _text.length() || _text[_pos._curIndex] == LINE_FEED;
 }
 
 void ts::TextParser::rewind()
 {
-    _pos = Position(_lines);
+    _pos = Position(_text);
+}
+
+void ts::TextParser::skipTo(size_t index)
+{
+    const UChar* const data = _text.data();
+    for (size_t i = _pos._curIndex; i < index; ++i) {
+        if (data[i] == LINE_FEED) {
+            _pos._curLineNumber++;
+        }
+    }
+    _pos._curIndex = index;
 }
 
 
@@ -179,19 +256,12 @@ void ts::TextParser::rewind()
 
 bool ts::TextParser::skipWhiteSpace()
 {
-    while (_pos._curLine != _pos._lines->end()) {
-        // Skip spaces in current line.
-        while (_pos._curIndex < _pos._curLine->length() && IsSpace((*_pos._curLine)[_pos._curIndex])) {
-            _pos._curIndex++;
-        }
-        // Stop if not at end of line (non-space character found).
-        if (_pos._curIndex < _pos._curLine->length()) {
-            return true;
+    const UChar* const data = _text.data();
+    const size_t end = _text.length();
+    while (_pos._curIndex < end && IsSpace(data[_pos._curIndex])) {
+        if (data[_pos._curIndex++] == LINE_FEED) {
+            _pos._curLineNumber++;
         }
-        // Move to next line.
-        _pos._curLine++;
-        _pos._curLineNumber++;
-        _pos._curIndex = 0;
     }
     return true;
 }
@@ -203,11 +273,8 @@ bool ts::TextParser::skipWhiteSpace()
 
 bool ts::TextParser::skipLine()
 {
-    while (_pos._curLine != _pos._lines->end()) {
-        _pos._curLine++;
-        _pos._curLineNumber++;
-        _pos._curIndex = 0;
-    }
+    const size_t lf = _text.find(LINE_FEED, _pos._curIndex);
+    skipTo(lf == NPOS ? _text.length() : lf + 1);
     return true;
 }
 
@@ -218,22 +285,34 @@ bool ts::TextParser::skipLine()
 
 bool ts::TextParser::match(const UString& str, bool skipIfMatch, CaseSensitivity cs)
 {
-    if (_pos._curLine == _pos._lines->end()) {
+    return matchChars(str.data(), str.length(), skipIfMatch, cs);
+}
+
+bool ts::TextParser::match(const UChar* str, bool skipIfMatch, CaseSensitivity cs)
+{
+    return matchChars(str, str == nullptr ? 0 : std::char_traits<UChar>::length(str), skipIfMatch, cs);
+}
+
+bool ts::TextParser::matchChars(const UChar* str, size_t len, bool skipIfMatch, CaseSensitivity cs)
+{
+    if (_pos._curIndex >= _text.length()) {
         // Already at end of document.
         return false;
     }
 
-    size_t lineIndex = _pos._curIndex;
-    size_t strIndex = 0;
-    while (strIndex < str.length()) {
-        if (lineIndex >= _pos._curLine->length() || !Match(str[strIndex++], (*_pos._curLine)[lineIndex++], cs)) {
+    // The string shall be entirely in the current line.
+    const UChar* const data = _text.data();
+    const size_t end = _text.length();
+    size_t index = _pos._curIndex;
+    for (size_t i = 0; i < len; ++i, ++index) {
+        if (index >= end || data[index] == LINE_FEED || !Match(str[i], data[index], cs)) {
             // str does not match
             return false;
         }
     }
 
     if (skipIfMatch) {
-        _pos._curIndex = lineIndex;
+        _pos._curIndex = index;
     }
     return true;
 }
@@ -255,9 +334,7 @@ bool ts::TextParser::isXMLNameChar(UChar c) const
 
 bool ts::TextParser::isAtXMLNameStart() const
 {
-    return _pos._curLine != _pos._lines->end() &&
-        _pos._curIndex < _pos._curLine->length() &&
-        isXMLNameStartChar((*_pos._curLine)[_pos._curIndex]);
+    return _pos._curIndex < _text.length() && isXMLNameStartChar(_text[_pos._curIndex]);
 }
 
 
@@ -267,19 +344,19 @@ bool ts::TextParser::isAtXMLNameStart() const
 
 bool ts::TextParser::parseXMLName(UString& name)
 {
-    name.clear();
-
     // Check that the next character is valid to start a name.
     if (!isAtXMLNameStart()) {
+        name.clear();
         return false;
     }
 
-    // Get the name.
-    UChar c;
-    while (_pos._curIndex < _pos._curLine->length() && isXMLNameChar(c = (*_pos._curLine)[_pos._curIndex])) {
-        name.append(c);
+    // Get the name. A name never contains a new line.
+    const size_t start = _pos._curIndex;
+    const size_t end = _text.length();
+    while (_pos._curIndex < end && isXMLNameChar(_text[_pos._curIndex])) {
         _pos._curIndex++;
     }
+    name.assign(_text, start, _pos._curIndex - start);
     return true;
 }
 
@@ -291,9 +368,7 @@ bool ts::TextParser::parseXMLName(UString& name)
 bool ts::TextParser::isAtNumberStart() const
 {
     UChar c = CHAR_NULL;
-    return _pos._curLine != _pos._lines->end() &&
-        _pos._curIndex < _pos._curLine->length() &&
-        (IsDigit(c = (*_pos._curLine)[_pos._curIndex]) || c == u'-' || c == u'+');
+    return _pos._curIndex < _text.length() && (IsDigit(c = _text[_pos._curIndex]) || c == u'-' || c == u'+');
 }
 
 
@@ -306,11 +381,12 @@ bool ts::TextParser::parseNumericLiteral(UString& str, bool allowHexa, bool allo
     str.clear();
 
     // Eliminate end of file or line.
-    if (_pos._curLine == _pos._lines->end() || _pos._curIndex >= _pos._curLine->length()) {
+    if (eol()) {
         return false;
     }
 
-    const UString& line(*_pos._curLine);
+    // Digits, signs, dots and letters never match the end of line.
+    const UString& line(_text);
     const size_t end = line.length();
     size_t index = _pos._curIndex;
 
@@ -371,7 +447,7 @@ bool ts::TextParser::parseNumericLiteral(UString& str, bool allowHexa, bool allo
     }
     else {
         // Now we have a valid numeric literal.
-        str = _pos._curLine->substr(_pos._curIndex, index - _pos._curIndex);
+        str = line.substr(_pos._curIndex, index - _pos._curIndex);
         _pos._curIndex = index;
         return true;
     }
@@ -387,12 +463,12 @@ bool ts::TextParser::parseStringLiteral(UString& str, UChar requiredQuote)
     str.clear();
 
     // Check that we are at the beginning of something.
-    if (_pos._curLine == _pos._lines->end() || _pos._curIndex >= _pos._curLine->length()) {
+    if (eol()) {
         // At eol or eof.
         return false;
     }
 
-    const UString& line(*_pos._curLine);
+    const UString& line(_text);
     const size_t end = line.length();
     size_t index = _pos._curIndex;
 
@@ -408,15 +484,15 @@ bool ts::TextParser::parseStringLiteral(UString& str, UChar requiredQuote)
         return false;
     }
 
-    // Now parse all characters in the string.
+    // Now parse all characters in the string, up to the end of line.
     UChar c = CHAR_NULL;
-    while (index < end && (c = line[index]) != quote) {
+    while (index < end && (c = line[index]) != quote && c != LINE_FEED) {
         index++;
-        if (c == u'\\') {
+        if (c == u'\\' && index < end && line[index] != LINE_FEED) {
             index++; // skip character after backslash.
         }
     }
-    if (index >= end) {
+    if (index >= end || line[index] != quote) {
         // Reached eol without finding the closing quote.
         return false;
     }
@@ -454,31 +530,17 @@ bool ts::TextParser::parseJSONStringLiteral(UString& str)
 // Parse text up to a given token.
 //----------------------------------------------------------------------------
 
-bool ts::TextParser::parseText(UString& result, const UString endToken, bool skipIfMatch, bool translateEntities)
+bool ts::TextParser::parseText(UString& result, const UString& endToken, bool skipIfMatch, bool translateEntities)
 {
-    result.clear();
-    bool found = false;
-
-    // Loop on all lines until the end token is found.
-    while (!found && _pos._curLine != _pos._lines->end()) {
-
-        // Search for the end token in current line.
-        const size_t end = _pos._curLine->find(endToken, _pos._curIndex);
-        if (end == NPOS) {
-            // End token not found, include the complete end of line.
-            result.append(*_pos._curLine, _pos._curIndex);
-            result.append(LINE_FEED);
-            _pos._curLine++;
-            _pos._curLineNumber++;
-            _pos._curIndex = 0;
-        }
-        else {
-            // Found end token, stop here.
-            result.append(*_pos._curLine, _pos._curIndex, end - _pos._curIndex);
-            _pos._curIndex = skipIfMatch ? end + endToken.length() : end;
-            found = true;
-        }
-    }
+    // Search for the end token in the rest of the document.
+    // The end token never spans several lines, all lines are LF-terminated.
+    const size_t end = _text.find(endToken, _pos._curIndex);
+    const bool found = end != NPOS;
+
+    // Without end token, the complete end of document is returned.
+    const size_t stop = found ? end : _text.length();
+    result.assign(_text, _pos._curIndex, stop - _pos._curIndex);
+    skipTo(found && skipIfMatch ? end + endToken.length() : stop);
 
     // Translate HTML entities in the result if required.
     if (translateEntities) {
@@ -38,6 +38,11 @@
 namespace ts {
     //!
     //! A support class for applications which parse various text formats.
+    //!
+    //! The document is stored as one contiguous UTF-16 buffer where all lines are
+    //! terminated by a new-line character. Files and streams are read and converted
+    //! from UTF-8 in one single pass, without intermediate list of lines.
+    //!
     //! @ingroup cpp
     //!
     class TextParser
@@ -53,8 +58,7 @@ namespace ts {
 
         //!
         //! Constructor.
-        //! @param [in] lines Reference to a list of text lines forming the document.
-        //! The lifetime of the referenced list must equals or exceeds the lifetime of the parser.
+        //! @param [in] lines List of text lines forming the document.
         //! @param [in,out] report Where to report errors.
         //!
         TextParser(const UStringList& lines, Report& report);
@@ -78,8 +82,7 @@ namespace ts {
 
         //!
         //! Load the document to parse from a list of lines.
-        //! @param [in] lines Reference to a list of text lines forming the document.
-        //! The lifetime of the referenced list must equals or exceeds the lifetime of the parser.
+        //! @param [in] lines List of text lines forming the document.
         //!
         void loadDocument(const UStringList& lines);
 
@@ -142,16 +145,15 @@ namespace ts {
         private:
             // Constructors.
             Position() = delete;
-            Position(const UStringList&);
+            Position(const UString&);
 
             // Everything is private to the application.
             // Only TextParser can use it.
             friend class TextParser;
 
-            const UStringList*          _lines;
-            UStringList::const_iterator _curLine;
-            size_t                      _curLineNumber;
-            size_t                      _curIndex;
+            const UString* _text;           // Complete document, all lines terminated by a LF.
+            size_t         _curLineNumber;  // Current line number, starting at 1.
+            size_t         _curIndex;       // Current index in _text.
         };
 
         //!
@@ -195,6 +197,16 @@ namespace ts {
         //!
         bool match(const UString& str, bool skipIfMatch, CaseSensitivity cs = CASE_SENSITIVE);
 
+        //!
+        //! Check if the current position in the document matches a string.
+        //! This version avoids the construction of a temporary UString when matching literals.
+        //! @param [in] str A nul-terminated string to check at the current position in the document.
+        //! @param [in] skipIfMatch If true and @a str matches the current position, skip it in the document.
+        //! @param [in] cs Case sensitivity of the comparision.
+        //! @return True if @a str matches the current position in the document.
+        //!
+        bool match(const UChar* str, bool skipIfMatch, CaseSensitivity cs = CASE_SENSITIVE);
+
         //!
         //! Parse text up to a given token.
         //! @param [out] result Returned parsed text.
@@ -203,7 +215,7 @@ namespace ts {
         //! @param [in] translateEntities If true, translate HTML entities in the text.
         //! @return True on success, false if @a endToken was not found.
         //!
-        virtual bool parseText(UString& result, const UString endToken, bool skipIfMatch, bool translateEntities);
+        virtual bool parseText(UString& result, const UString& endToken, bool skipIfMatch, bool translateEntities);
 
         //!
         //! Check if a character is suitable for starting an XML @e name.
@@ -271,8 +283,17 @@ namespace ts {
         virtual bool parseJSONStringLiteral(UString& str);
 
     private:
-        Report&     _report;
-        UStringList _lines;
-        Position    _pos;
+        Report&  _report;
+        UString  _text;
+        Position _pos;
+
+        // Check if a string matches at current position, without crossing end of line.
+        bool matchChars(const UChar* str, size_t len, bool skipIfMatch, CaseSensitivity cs);
+
+        // Normalize the internal document after loading: remove trailing CR on each line, terminate last line.
+        void normalizeDocument();
+
+        // Skip characters in the document, up to a given index, updating the line number.
+        void skipTo(size_t index);
     };
 }
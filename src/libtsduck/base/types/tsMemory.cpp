@@ -87,6 +87,23 @@ bool ts::IdenticalBytes(const void * area, size_t area_size)
 }
 
 
+//----------------------------------------------------------------------------
+// Compute an exclusive or over memory areas.
+// This module is compiled at full speed optimization. This simple byte loop
+// is vectorized by the compiler, using the widest available vector registers.
+//----------------------------------------------------------------------------
+
+void ts::MemXor(void* dest, const void* src1, const void* src2, size_t size)
+{
+    uint8_t* d = reinterpret_cast<uint8_t*>(dest);
+    const uint8_t* s1 = reinterpret_cast<const uint8_t*>(src1);
+    const uint8_t* s2 = reinterpret_cast<const uint8_t*>(src2);
+    for (size_t i = 0; i < size; ++i) {
+        d[i] = s1[i] ^ s2[i];
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Memory accesses with non-natural sizes
 //----------------------------------------------------------------------------
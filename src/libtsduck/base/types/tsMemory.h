@@ -86,6 +86,18 @@ namespace ts {
     //!
     TSDUCKDLL bool IdenticalBytes(const void* area, size_t area_size);
 
+    //!
+    //! Compute an exclusive or over memory areas.
+    //! This function is typically used in FEC computations. Large areas are processed
+    //! in a loop which can be vectorized by the compiler.
+    //! @param [out] dest Destination start address. It can be the same as @a src1 or @a src2
+    //! but partially overlapping areas are not supported.
+    //! @param [in] src1 Start address of the first area.
+    //! @param [in] src2 Start address of the second area.
+    //! @param [in] size Size in bytes of the memory areas.
+    //!
+    TSDUCKDLL void MemXor(void* dest, const void* src1, const void* src2, size_t size);
+
 
     //----------------------------------------------------------------------------
     // Cross-platforms portable definitions for memory barrier.
@@ -1914,11 +1914,35 @@ namespace {
     }) {}
 }
 
+namespace {
+    // Direct table of characteristics for ASCII characters.
+    // This is the fast path for parsers which check all characters of large texts.
+    class AsciiChar
+    {
+        TS_DECLARE_SINGLETON(AsciiChar);
+    public:
+        uint32_t table[0x80];
+    };
+    TS_DEFINE_SINGLETON(AsciiChar);
+    AsciiChar::AsciiChar() : table()
+    {
+        const auto cc = CharChar::Instance();
+        for (auto it = cc->begin(); it != cc->end() && it->first < 0x80; ++it) {
+            table[it->first] = it->second;
+        }
+    }
+}
+
 uint32_t ts::UCharacteristics(UChar c)
 {
-    const auto ll = CharChar::Instance();
-    const auto it = ll->find(c);
-    return it == ll->end() ? 0 : it->second;
+    if (c < 0x80) {
+        return AsciiChar::Instance()->table[c];
+    }
+    else {
+        const auto ll = CharChar::Instance();
+        const auto it = ll->find(c);
+        return it == ll->end() ? 0 : it->second;
+    }
 }
 
 
@@ -1968,8 +1992,8 @@ bool ts::IsUpper(UChar c)
 ts::UChar ts::ToLower(UChar c)
 {
     const UChar result = UChar(std::towlower(wint_t(c)));
-    if (result != c) {
-        // The standard function has found a translation.
+    if (result != c || c < 0x80) {
+        // The standard function has found a translation or there is no additional ASCII translation.
         return result;
     }
     else {
@@ -1983,8 +2007,8 @@ ts::UChar ts::ToLower(UChar c)
 ts::UChar ts::ToUpper(UChar c)
 {
     const UChar result = UChar(std::towupper(wint_t(c)));
-    if (result != c) {
-        // The standard function has found a translation.
+    if (result != c || c < 0x80) {
+        // The standard function has found a translation or there is no additional ASCII translation.
         return result;
     }
     else {
@@ -868,17 +868,14 @@ bool ts::xml::Element::parseNode(TextParser& parser, const Node* parent)
             // Read attribute value.
             ok = ok && parser.parseText(attrValue, quote, true, true);
 
-            // Store the attribute.
+            // Store the attribute. The attribute key is computed only once.
             if (!ok) {
                 report().error(u"line %d: error parsing attribute '%s' in tag <%s>", {line, attrName, value()});
             }
-            else if (hasAttribute(attrName)) {
+            else if (!_attributes.emplace(attributeKey(attrName), Attribute(attrName, attrValue, line)).second) {
                 report().error(u"line %d: duplicate attribute '%s' in tag <%s>", {line, attrName, value()});
                 ok = false;
             }
-            else {
-                _attributes[attributeKey(attrName)] = Attribute(attrName, attrValue, line);
-            }
         }
         else {
             report().error(u"line %d: parsing error, tag <%s>", {lineNumber(), value()});
@@ -73,7 +73,8 @@ bool ts::xml::ModelDocument::validate(const Document& doc) const
         return false;
     }
     else if (modelRoot->haveSameName(docRoot)) {
-        return validateElement(modelRoot, docRoot);
+        ModelCache cache;
+        return validateElement(modelRoot, docRoot, cache);
     }
     else {
         report().error(u"invalid XML document, expected <%s> as root, found <%s>", {modelRoot->name(), docRoot->name()});
@@ -86,7 +87,7 @@ bool ts::xml::ModelDocument::validate(const Document& doc) const
 // Validate an XML tree of elements, used by validate().
 //----------------------------------------------------------------------------
 
-bool ts::xml::ModelDocument::validateElement(const Element* model, const Element* doc) const
+bool ts::xml::ModelDocument::validateElement(const Element* model, const Element* doc, ModelCache& cache) const
 {
     if (model == nullptr) {
         report().error(u"invalid XML model document");
@@ -116,13 +117,19 @@ bool ts::xml::ModelDocument::validateElement(const Element* model, const Element
 
     // Check that all children elements in doc exist in model.
     for (const Element* docChild = doc->firstChildElement(); docChild != nullptr; docChild = docChild->nextSiblingElement()) {
-        const Element* modelChild = findModelElement(model, docChild->name());
+        // Search the model only once per parent model and child name.
+        const auto key(std::make_pair(model, docChild->name()));
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            it = cache.insert(std::make_pair(key, findModelElement(model, docChild->name()))).first;
+        }
+        const Element* modelChild = it->second;
         if (modelChild == nullptr) {
             // The corresponding node does not exist in the model.
             report().error(u"unexpected node <%s> in <%s>, line %d", {docChild->name(), doc->name(), docChild->lineNumber()});
             success = false;
         }
-        else if (!validateElement(modelChild, docChild)) {
+        else if (!validateElement(modelChild, docChild, cache)) {
             success = false;
         }
     }
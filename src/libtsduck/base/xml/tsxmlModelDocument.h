@@ -71,7 +71,6 @@ namespace ts {
             //!
             bool validate(const Document& doc) const;
 
-        protected:
             //!
             //! Find a child element by name in an XML model element.
             //! @param [in] elem An XML element in a model document.
@@ -81,13 +80,18 @@ namespace ts {
             const Element* findModelElement(const Element* elem, const UString& name) const;
 
         private:
+            // Cache of model element lookups during one validation, indexed by model parent and child name.
+            // Large documents repeat the same few element names thousands of times.
+            typedef std::map<std::pair<const Element*, UString>, const Element*> ModelCache;
+
             //!
             //! Validate an XML tree of elements, used by validate().
             //! @param [in] model The model element.
             //! @param [in] doc The element to validate.
+            //! @param [in,out] cache Cache of model lookups for the current validation.
             //! @return True if @a doc matches @a model, false if it does not.
             //!
-            bool validateElement(const Element* model, const Element* doc) const;
+            bool validateElement(const Element* model, const Element* doc, ModelCache& cache) const;
         };
     }
 }
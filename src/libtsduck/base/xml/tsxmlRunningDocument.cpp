@@ -37,6 +37,7 @@
 ts::xml::RunningDocument::RunningDocument(Report& report) :
     Document(report),
     _text(report),
+    _writer(report),
     _open_root(false)
 {
 }
@@ -88,12 +89,18 @@ void ts::xml::RunningDocument::flush()
     }
     else {
         // The document header and previous elements where already displayed.
-        // Display elements one by one.
+        // Display elements one by one, at the margin of the children of the root.
+        // The streaming writer formats them faster than printing them through the text formatter.
+        _writer.setTweaks(tweaks());
+        _writer.setIndentSize(_text.indentSize());
+        _writer.setMarginSize(_text.marginSize() + _text.indentSize());
+        _writer.setOneLiner(!_text.formatting());
         for (Element* elem = root->firstChildElement(); elem != nullptr; elem = elem->nextSiblingElement()) {
             // Print the element.
-            _text << ts::margin;
-            elem->print(_text, false);
-            _text << std::endl;
+            _writer.clear();
+            _writer.margin();
+            _writer.addElement(*elem);
+            _text << _writer.content() << std::endl;
         }
     }
 
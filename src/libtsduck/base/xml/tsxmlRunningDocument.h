@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsxmlDocument.h"
+#include "tsxmlStreamWriter.h"
 
 namespace ts {
     namespace xml {
@@ -93,6 +94,7 @@ namespace ts {
 
         private:
             TextFormatter _text;       // The text formatter.
+            StreamWriter  _writer;     // Streaming writer for elements after the document header.
             bool          _open_root;  // Document root has been printed and is left open.
         };
     }
@@ -0,0 +1,672 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsxmlStreamWriter.h"
+#include "tsxmlJSONConverter.h"
+#include "tsxmlElement.h"
+#include "tsxmlText.h"
+#include "tsxmlComment.h"
+#include "tsxmlDeclaration.h"
+#include "tsxmlUnknown.h"
+
+// Size of tabulations, same as TextFormatter.
+#define TAB_SIZE 8
+
+
+//----------------------------------------------------------------------------
+// Constructors.
+//----------------------------------------------------------------------------
+
+ts::xml::StreamWriter::StreamWriter(Report& report) :
+    _report(report),
+    _tweaks(),
+    _converter(nullptr),
+    _json_root(),
+    _indent(2),
+    _margin(0),
+    _formatting(true),
+    _out(),
+    _utf8(),
+    _temp(),
+    _cur_margin(0),
+    _column(0),
+    _after_space(false),
+    _depth(0),
+    _stack(),
+    _key(),
+    _elem_models(),
+    _attr_models()
+{
+}
+
+ts::xml::StreamWriter::Context::Context() :
+    name(),
+    attributes(),
+    attr_count(0),
+    model(nullptr),
+    has_children(false),
+    has_items(false),
+    sticky(false),
+    text_model(false),
+    hexa_model(false)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Configuration.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::setJSON(const JSONConverter* converter, const UString& root_name)
+{
+    _converter = converter;
+    _json_root = root_name;
+    _elem_models.clear();
+    _attr_models.clear();
+}
+
+void ts::xml::StreamWriter::setMarginSize(size_t margin)
+{
+    // Try to adjust current margin by the same amount.
+    if (margin > _margin) {
+        _cur_margin += margin - _margin;
+    }
+    else if (margin < _margin) {
+        _cur_margin -= std::min(_cur_margin, _margin - margin);
+    }
+    _margin = margin;
+}
+
+
+//----------------------------------------------------------------------------
+// Access to the internal buffer.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::clear()
+{
+    _out.clear();
+    _cur_margin = _margin;
+    _column = 0;
+    _after_space = false;
+    _depth = 0;
+}
+
+ts::UString ts::xml::StreamWriter::toString() const
+{
+    UString str;
+    str.assignFromUTF8(_out);
+    str.substitute(UString(1, CARRIAGE_RETURN), UString());
+    return str;
+}
+
+
+//----------------------------------------------------------------------------
+// Write text, with the same processing as a TextFormatter.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::write(const char* text, size_t size)
+{
+    const char* const last = text + size;
+    while (text < last) {
+
+        // Locate the longest sequence of characters without special processing.
+        const char* end = text;
+        while (end < last && *end != '\t' && *end != '\r' && *end != '\n') {
+            _after_space = _after_space || *end != ' ';
+            ++end;
+        }
+        _out.append(text, end - text);
+        _column += end - text;
+
+        // Process the special character.
+        if (end < last) {
+            if (*end == '\t') {
+                // Tabulations are expanded as spaces.
+                // Without formatting, a tabulation is just one space.
+                do {
+                    _out.push_back(' ');
+                } while (++_column % TAB_SIZE != 0 && _formatting);
+            }
+            else {
+                // CR and LF indifferently move back to begining of current/next line.
+                _out.push_back(*end);
+                _column = 0;
+                _after_space = false;
+            }
+            ++end;
+        }
+        text = end;
+    }
+}
+
+void ts::xml::StreamWriter::write(const UString& text)
+{
+    text.toUTF8(_utf8);
+    write(_utf8.data(), _utf8.size());
+}
+
+void ts::xml::StreamWriter::writeQuoted(const UString& text)
+{
+    write("\"", 1);
+    write(text.toJSON());
+    write("\"", 1);
+}
+
+void ts::xml::StreamWriter::endLine()
+{
+    if (_formatting) {
+        _out.push_back('\n');
+        _column = 0;
+    }
+    else {
+        _out.push_back(' ');
+        _column++;
+    }
+    _after_space = false;
+}
+
+void ts::xml::StreamWriter::margin()
+{
+    // Do nothing if no line breaks are produced (there is no margin).
+    if (_formatting) {
+        // New line if we are farther than the margin or no longer in the margin.
+        if (_column > _cur_margin || _after_space) {
+            endLine();
+        }
+        _out.append(_cur_margin - _column, ' ');
+        _column = _cur_margin;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Start a new element.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::startElement(const UString& name)
+{
+    // Locate the model of the element in JSON format.
+    const Element* model = nullptr;
+    if (_converter != nullptr) {
+        if (_depth > 0) {
+            model = elementModel(_stack[_depth - 1].model, name);
+        }
+        else {
+            const Element* root = _converter->rootElement();
+            if (root != nullptr && _json_root.empty()) {
+                model = root->name().similar(name) ? root : nullptr;
+            }
+            else if (root != nullptr && root->name().similar(_json_root)) {
+                model = elementModel(root, name);
+            }
+        }
+    }
+
+    // The new element is a child of the current one.
+    if (_depth > 0) {
+        startChild(false, true);
+    }
+
+    // Push a new context. Reuse previously allocated contexts.
+    if (_depth >= _stack.size()) {
+        _stack.resize(_depth + 1);
+    }
+    Context& ctx(_stack[_depth++]);
+    ctx.name = name;
+    ctx.attr_count = 0;
+    ctx.model = model;
+    ctx.has_children = ctx.has_items = ctx.sticky = ctx.text_model = ctx.hexa_model = false;
+
+    if (_converter != nullptr) {
+        // Start a JSON object with the element name.
+        write("{", 1);
+        _cur_margin += _indent;
+        endLine();
+        margin();
+        write("\"#name\": ");
+        writeQuoted(name);
+    }
+    else {
+        // Start the XML tag. The attributes are written when the tag is closed.
+        write("<", 1);
+        write(name);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Set an attribute of the current element.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::setAttribute(const UString& name, const UString& value)
+{
+    if (_depth == 0 || _stack[_depth - 1].has_children) {
+        _report.error(u"XML attribute '%s' set outside an element start tag", {name});
+        return;
+    }
+    Context& ctx(_stack[_depth - 1]);
+
+    // Attribute names are not case-sensitive. A modified attribute is moved last.
+    for (size_t i = 0; i < ctx.attr_count; ++i) {
+        if (ctx.attributes[i].first.similar(name)) {
+            std::rotate(ctx.attributes.begin() + i, ctx.attributes.begin() + i + 1, ctx.attributes.begin() + ctx.attr_count);
+            ctx.attr_count--;
+            break;
+        }
+    }
+    if (ctx.attr_count >= ctx.attributes.size()) {
+        ctx.attributes.resize(ctx.attr_count + 1);
+    }
+    AttributeValue& attr(ctx.attributes[ctx.attr_count++]);
+    attr.first = name;
+    attr.second = value;
+
+    // JSON uses the attribute key, in lower case.
+    if (_converter != nullptr) {
+        attr.first.convertToLower();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Prepare the output of a child in the current element.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::startChild(bool sticky, bool json_item)
+{
+    assert(_depth > 0);
+    Context& ctx(_stack[_depth - 1]);
+
+    if (_converter != nullptr) {
+        // Open the array of children.
+        if (!ctx.has_children) {
+            ctx.has_children = true;
+            write(",", 1);
+            endLine();
+            margin();
+            write("\"#nodes\": [");
+            _cur_margin += _indent;
+        }
+        // Start a new item in the array.
+        if (json_item) {
+            if (ctx.has_items) {
+                write(",", 1);
+            }
+            ctx.has_items = true;
+            endLine();
+            margin();
+        }
+    }
+    else {
+        // Close the start tag of the parent.
+        if (!ctx.has_children) {
+            ctx.has_children = true;
+            writeXMLAttributes(ctx);
+            write(">", 1);
+            _cur_margin += _indent;
+        }
+        // Non-sticky nodes are written on a new line.
+        const bool previous_sticky = ctx.sticky;
+        ctx.sticky = sticky;
+        if (!previous_sticky && !sticky) {
+            endLine();
+            margin();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Write the XML attributes of an element in modification order.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::writeXMLAttributes(const Context& ctx)
+{
+    for (size_t i = 0; i < ctx.attr_count; ++i) {
+        const UString& value(ctx.attributes[i].second);
+
+        // Get the quote character to use and the list of characters to escape.
+        UChar quote = _tweaks.attributeValueQuote();
+        UString escape;
+        if (_tweaks.strictAttributeFormatting) {
+            escape = u"<>&'\"";
+        }
+        else {
+            // Without strict formatting, escape required characters only and try to find a unique quote.
+            escape = u"&";
+            if (value.find(quote) != NPOS) {
+                const UChar other_quote = _tweaks.attributeValueOtherQuote();
+                if (value.find(other_quote) == NPOS) {
+                    quote = other_quote;
+                }
+                else {
+                    escape.append(quote);
+                }
+            }
+        }
+        const char* const qstr = quote == u'"' ? "\"" : "'";
+
+        write(" ", 1);
+        write(ctx.attributes[i].first);
+        write("=", 1);
+        write(qstr, 1);
+        _temp = value;
+        _temp.convertToHTML(escape);
+        write(_temp);
+        write(qstr, 1);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the model of an element or the type of an attribute in JSON.
+// Searching the model is slow, the results are cached.
+//----------------------------------------------------------------------------
+
+const ts::xml::Element* ts::xml::StreamWriter::elementModel(const Element* parent, const UString& name)
+{
+    if (parent == nullptr) {
+        return nullptr;
+    }
+    _key.first = parent;
+    _key.second = name;
+    const auto it = _elem_models.find(_key);
+    if (it != _elem_models.end()) {
+        return it->second;
+    }
+    return _elem_models[_key] = _converter->findModelElement(parent, name);
+}
+
+ts::xml::StreamWriter::AttributeType ts::xml::StreamWriter::attributeModel(const Element* model, const UString& name)
+{
+    if (model == nullptr) {
+        return STRING_ATTR;
+    }
+    _key.first = model;
+    _key.second = name;
+    const auto it = _attr_models.find(_key);
+    if (it != _attr_models.end()) {
+        return it->second;
+    }
+
+    // Get description of this attribute in the model, empty string without error if not found.
+    UString description;
+    model->getAttribute(description, name, false);
+    description.trim(true, false, false);
+    AttributeType type = STRING_ATTR;
+    if (description.startWith(u"uint", CASE_INSENSITIVE) || description.startWith(u"int", CASE_INSENSITIVE)) {
+        type = INTEGER_ATTR;
+    }
+    else if (description.startWith(u"bool", CASE_INSENSITIVE)) {
+        type = BOOLEAN_ATTR;
+    }
+    return _attr_models[_key] = type;
+}
+
+
+//----------------------------------------------------------------------------
+// Write a JSON attribute in an object.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::writeJSONAttribute(const Context& ctx, const AttributeValue& attr)
+{
+    const Tweaks& tweaks(_converter->tweaks());
+
+    write(",", 1);
+    endLine();
+    margin();
+    writeQuoted(attr.first);
+    write(": ", 2);
+
+    // Get the type of this attribute in the model.
+    const AttributeType type = attributeModel(ctx.model, attr.first);
+    const bool int_model = type == INTEGER_ATTR;
+    const bool bool_model = type == BOOLEAN_ATTR;
+
+    // Same conversion rules as JSONConverter.
+    int64_t int_value = 0;
+    bool bool_value = false;
+    if (int_model && attr.second.toInteger(int_value, UString::DEFAULT_THOUSANDS_SEPARATOR)) {
+        if (int_value < -TS_CONST64(0xFFFFFFFF)) {
+            // Typically a large unsigned hexadecimal value, leave it as a string.
+            writeQuoted(attr.second);
+        }
+        else {
+            write(UString::Decimal(int_value, 0, true, UString()));
+        }
+        return;
+    }
+    if (int_model) {
+        _report.warning(u"attribute '%s' in <%s> is '%s' but should be an integer", {attr.first, ctx.name, attr.second});
+    }
+    else if (bool_model) {
+        if (attr.second.toBool(bool_value)) {
+            write(bool_value ? "true" : "false");
+            return;
+        }
+        _report.warning(u"attribute '%s' in <%s> is '%s' but should be a boolean", {attr.first, ctx.name, attr.second});
+    }
+    if (tweaks.x2jEnforceInteger && !int_model && attr.second.toInteger(int_value, UString::DEFAULT_THOUSANDS_SEPARATOR)) {
+        write(UString::Decimal(int_value, 0, true, UString()));
+    }
+    else if (tweaks.x2jEnforceBoolean && !bool_model && attr.second.toBool(bool_value)) {
+        write(bool_value ? "true" : "false");
+    }
+    else {
+        writeQuoted(attr.second);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Close the current element.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::endElement()
+{
+    if (_depth == 0) {
+        return;
+    }
+    Context& ctx(_stack[_depth - 1]);
+
+    if (_converter != nullptr) {
+        // Close the array of children.
+        if (ctx.has_children) {
+            endLine();
+            _cur_margin -= std::min(_cur_margin, _indent);
+            margin();
+            write("]", 1);
+        }
+        // Attributes are written in the order of their names, after the children.
+        std::sort(ctx.attributes.begin(), ctx.attributes.begin() + ctx.attr_count);
+        for (size_t i = 0; i < ctx.attr_count; ++i) {
+            writeJSONAttribute(ctx, ctx.attributes[i]);
+        }
+        endLine();
+        _cur_margin -= std::min(_cur_margin, _indent);
+        margin();
+        write("}", 1);
+    }
+    else if (!ctx.has_children) {
+        // Element without children.
+        writeXMLAttributes(ctx);
+        write("/>", 2);
+    }
+    else {
+        // Sticky children are immediately followed by the closing tag.
+        if (!ctx.sticky) {
+            endLine();
+        }
+        _cur_margin -= std::min(_cur_margin, _indent);
+        if (!ctx.sticky) {
+            margin();
+        }
+        write("</", 2);
+        write(ctx.name);
+        write(">", 1);
+    }
+    _depth--;
+}
+
+
+//----------------------------------------------------------------------------
+// Add text, comments and declarations.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::addText(const UString& text, bool trimmable, bool cdata)
+{
+    if (_converter != nullptr) {
+        // In JSON, a text is a string in the array of children. Top-level texts are dropped.
+        if (_depth > 0) {
+            startChild(false, true);
+            Context& ctx(_stack[_depth - 1]);
+            // Get the model description once only.
+            if (!ctx.text_model) {
+                ctx.text_model = true;
+                if (ctx.model != nullptr) {
+                    UString text_model;
+                    ctx.model->getText(text_model, true);
+                    ctx.hexa_model = text_model.startWith(u"hexa", CASE_INSENSITIVE);
+                }
+            }
+            // Trim the text content according to model and tweaks.
+            const Tweaks& tweaks(_converter->tweaks());
+            _temp = text;
+            _temp.trim(ctx.hexa_model || tweaks.x2jTrimText, ctx.hexa_model || tweaks.x2jTrimText, ctx.hexa_model || tweaks.x2jCollapseText);
+            writeQuoted(_temp);
+        }
+    }
+    else {
+        if (_depth > 0) {
+            startChild(!cdata, false);
+        }
+        if (cdata) {
+            write("<![CDATA[");
+            write(text);
+            write("]]>");
+        }
+        else {
+            // In one-liner mode, trim all spaces when allowed.
+            _temp = text;
+            if (trimmable && !_formatting) {
+                _temp.trim(true, true, true);
+            }
+            // Escape 3 out of 5 XML characters in non-strict mode, see xml::Text::print().
+            _temp.convertToHTML(_tweaks.strictTextNodeFormatting ? u"<>&'\"" : u"<>&");
+            write(_temp);
+        }
+    }
+}
+
+void ts::xml::StreamWriter::addComment(const UString& text)
+{
+    if (_depth > 0) {
+        startChild(false, false);
+    }
+    if (_converter == nullptr) {
+        write("<!--");
+        write(text);
+        write("-->");
+    }
+}
+
+void ts::xml::StreamWriter::addDeclaration(const UString& text)
+{
+    if (_depth > 0) {
+        startChild(false, false);
+    }
+    if (_converter == nullptr) {
+        write("<?");
+        write(text);
+        write("?>");
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Write existing XML nodes.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::addElement(const Element& elem)
+{
+    startElement(elem.name());
+
+    // Set all attributes in modification order.
+    UStringList names;
+    elem.getAttributesNamesInModificationOrder(names);
+    for (const auto& name : names) {
+        setAttribute(name, elem.attribute(name).value());
+    }
+
+    // Write all children.
+    for (const Node* node = elem.firstChild(); node != nullptr; node = node->nextSibling()) {
+        addNode(*node);
+    }
+    endElement();
+}
+
+void ts::xml::StreamWriter::addDocument(const Document& doc)
+{
+    for (const Node* node = doc.firstChild(); node != nullptr; node = node->nextSibling()) {
+        addNode(*node);
+        endLine();
+    }
+}
+
+void ts::xml::StreamWriter::addNode(const Node& node)
+{
+    const Element* elem = nullptr;
+    const Text* text = nullptr;
+    const Comment* comment = nullptr;
+    const Declaration* decl = nullptr;
+
+    if ((elem = dynamic_cast<const Element*>(&node)) != nullptr) {
+        addElement(*elem);
+    }
+    else if ((text = dynamic_cast<const Text*>(&node)) != nullptr) {
+        addText(text->value(), text->isTrimmable(), text->isCData());
+    }
+    else if ((comment = dynamic_cast<const Comment*>(&node)) != nullptr) {
+        addComment(comment->value());
+    }
+    else if ((decl = dynamic_cast<const Declaration*>(&node)) != nullptr) {
+        addDeclaration(decl->value());
+    }
+    else if (dynamic_cast<const Unknown*>(&node) != nullptr) {
+        // Unknown node, escape all 5 XML characters, see xml::Unknown::print().
+        if (_depth > 0) {
+            startChild(false, false);
+        }
+        if (_converter == nullptr) {
+            write("<!");
+            write(node.value().toHTML(u"<>&'\""));
+            write(">");
+        }
+    }
+}
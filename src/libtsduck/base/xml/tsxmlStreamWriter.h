@@ -0,0 +1,280 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Streaming writer of XML or JSON text, without building a document.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsxml.h"
+#include "tsxmlTweaks.h"
+#include "tsNullReport.h"
+
+namespace ts {
+    namespace xml {
+
+        class JSONConverter;
+
+        //!
+        //! Streaming writer of XML or JSON text, without building a document.
+        //! @ingroup xml
+        //!
+        //! The XML or JSON text is built in a SAX-like way, using a sequence of calls to
+        //! startElement(), setAttribute(), addText() and endElement(). The text is directly
+        //! produced in UTF-8, in an internal buffer. No XML node is created and the same
+        //! instance can be reused to format many elements without reallocating memory.
+        //!
+        //! The produced text is exactly the same as the result of printing the equivalent
+        //! XML document (see xml::Node::print()) or the JSON value which is created by
+        //! xml::JSONConverter from this document, using a TextFormatter, either in standard
+        //! format (with indentation) or as a one-liner.
+        //!
+        //! Existing XML elements can also be written using addElement(). This is typically
+        //! faster than printing the element and converting it into JSON.
+        //!
+        class TSDUCKDLL StreamWriter
+        {
+            TS_NOCOPY(StreamWriter);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in,out] report Where to report errors.
+            //!
+            explicit StreamWriter(Report& report = NULLREP);
+
+            //!
+            //! Set the XML tweaks to format XML text.
+            //! In JSON format, the tweaks of the XML-to-JSON converter are used instead.
+            //! @param [in] tweaks The new tweaks.
+            //!
+            void setTweaks(const Tweaks& tweaks) { _tweaks = tweaks; }
+
+            //!
+            //! Get the XML tweaks to format XML text.
+            //! @return A constant reference to the XML tweaks.
+            //!
+            const Tweaks& tweaks() const { return _tweaks; }
+
+            //!
+            //! Set the output format to JSON.
+            //! @param [in] converter The XML-to-JSON converter. Its model is used to infer the type
+            //! of attributes and texts. If null, the output format is XML.
+            //! @param [in] root_name Name of the root element in which the top-level elements are
+            //! virtually inserted, as in a document. If empty, the top-level elements are themselves
+            //! considered as roots of a document. This is only used to locate the models of the elements.
+            //! The caller must ensure that the referenced object remains valid as long as this object.
+            //! The lookups in the model are cached. This method must be called again when the model is reloaded.
+            //!
+            void setJSON(const JSONConverter* converter, const UString& root_name = UString());
+
+            //!
+            //! Check if the output format is JSON.
+            //! @return True for JSON, false for XML.
+            //!
+            bool isJSON() const { return _converter != nullptr; }
+
+            //!
+            //! Set the indentation size for each level of element.
+            //! @param [in] indent The indentation size in characters.
+            //!
+            void setIndentSize(size_t indent) { _indent = indent; }
+
+            //!
+            //! Set the margin size for the top-level elements.
+            //! @param [in] margin The margin size in characters.
+            //!
+            void setMarginSize(size_t margin);
+
+            //!
+            //! Set the one-liner mode.
+            //! In one-liner mode, end of lines are replaced by one space and there is no margin,
+            //! as with the end-of-line mode TextFormatter::EndOfLineMode::SPACING.
+            //! @param [in] on True to produce one-liners, false to produce indented text.
+            //!
+            void setOneLiner(bool on) { _formatting = !on; }
+
+            //!
+            //! Clear the content of the internal buffer and reset the state of the writer.
+            //! All elements are closed, the margin is reset to the margin of top-level elements.
+            //! The configuration is unchanged.
+            //!
+            void clear();
+
+            //!
+            //! Get the current content of the internal buffer.
+            //! @return A constant reference to the UTF-8 text in the internal buffer.
+            //!
+            const std::string& content() const { return _out; }
+
+            //!
+            //! Get the current content of the internal buffer as a string.
+            //! As with TextFormatter::getString(), carriage returns are removed.
+            //! @return The text in the internal buffer.
+            //!
+            UString toString() const;
+
+            //!
+            //! Insert an end-of-line, one space in one-liner mode.
+            //!
+            void endLine();
+
+            //!
+            //! Insert all necessary new-lines and spaces to move to the current margin.
+            //! Do nothing in one-liner mode.
+            //!
+            void margin();
+
+            //!
+            //! Start a new element, child of the current element, if any.
+            //! @param [in] name Name of the element.
+            //!
+            void startElement(const UString& name);
+
+            //!
+            //! Set an attribute of the current element.
+            //! Must be called before adding any child to the current element.
+            //! @param [in] name Attribute name. If the attribute already exists, its value is replaced.
+            //! @param [in] value Attribute value.
+            //!
+            void setAttribute(const UString& name, const UString& value);
+
+            //!
+            //! Add a text node in the current element.
+            //! @param [in] text Text content.
+            //! @param [in] trimmable If true, the spaces in the text can be trimmed in one-liner mode.
+            //! @param [in] cdata If true, the text is a CDATA section.
+            //!
+            void addText(const UString& text, bool trimmable = false, bool cdata = false);
+
+            //!
+            //! Add a comment in the current element.
+            //! Comments are dropped in JSON format.
+            //! @param [in] text Comment text.
+            //!
+            void addComment(const UString& text);
+
+            //!
+            //! Add a declaration.
+            //! Declarations are dropped in JSON format.
+            //! @param [in] text Declaration text.
+            //!
+            void addDeclaration(const UString& text);
+
+            //!
+            //! Close the current element.
+            //!
+            void endElement();
+
+            //!
+            //! Write an existing XML element and all its children, as child of the current element, if any.
+            //! @param [in] elem The element to write.
+            //!
+            void addElement(const Element& elem);
+
+            //!
+            //! Write a complete XML document.
+            //! Each top-level node is followed by an end-of-line, as in xml::Document::print().
+            //! @param [in] doc The document to write.
+            //!
+            void addDocument(const Document& doc);
+
+        private:
+            // Attribute name and value.
+            typedef std::pair<UString,UString> AttributeValue;
+
+            // Type of an attribute, according to the JSON model.
+            enum AttributeType {STRING_ATTR, INTEGER_ATTR, BOOLEAN_ATTR};
+
+            // Caches of model lookups, indexed by parent model and name.
+            typedef std::pair<const Element*, UString> ModelKey;
+            typedef std::map<ModelKey, const Element*> ElementModels;
+            typedef std::map<ModelKey, AttributeType> AttributeModels;
+
+            // Description of a currently open element.
+            class Context
+            {
+            public:
+                Context();
+                Context(const Context&) = default;
+                Context& operator=(const Context&) = default;
+                UString                     name;          // Element name.
+                std::vector<AttributeValue> attributes;    // Attributes pending output, only attr_count first ones are used.
+                size_t                      attr_count;    // Number of attributes.
+                const Element*              model;         // Model of the element for JSON.
+                bool                        has_children;  // Start tag closed in XML, array of children open in JSON.
+                bool                        has_items;     // Some JSON items were written in the array of children.
+                bool                        sticky;        // Last child was a sticky output in XML.
+                bool                        text_model;    // The text model was searched in JSON.
+                bool                        hexa_model;    // The text model is hexadecimal data in JSON.
+            };
+
+            Report&              _report;       // Where to report errors.
+            Tweaks               _tweaks;       // XML formatting tweaks.
+            const JSONConverter* _converter;    // XML-to-JSON converter, null for XML.
+            UString              _json_root;    // Virtual root of top-level elements in JSON.
+            size_t               _indent;       // Indentation size.
+            size_t               _margin;       // Margin of top-level elements.
+            bool                 _formatting;   // Not in one-liner mode.
+            std::string          _out;          // Output buffer, UTF-8.
+            std::string          _utf8;         // Temporary buffer for UTF-8 conversions.
+            UString              _temp;         // Temporary buffer for string manipulations.
+            size_t               _cur_margin;   // Current margin.
+            size_t               _column;       // Current column in the output.
+            bool                 _after_space;  // Current line contains non-space characters.
+            size_t               _depth;        // Number of currently open elements.
+            std::vector<Context> _stack;        // Contexts of open elements, only _depth first ones are used.
+            ModelKey             _key;          // Temporary key for model lookups.
+            ElementModels        _elem_models;  // Cache of element models.
+            AttributeModels      _attr_models;  // Cache of attribute types.
+
+            // Write text, as printed through a TextFormatter.
+            void write(const char* text, size_t size);
+            void write(const char* text) { write(text, ::strlen(text)); }
+            void write(const UString& text);
+            void writeQuoted(const UString& text);
+
+            // Prepare the output of a child in the current element.
+            void startChild(bool sticky, bool json_item);
+
+            // Write the XML attributes of an element.
+            void writeXMLAttributes(const Context& ctx);
+
+            // Get the model of an element or the type of an attribute in JSON, using the caches.
+            const Element* elementModel(const Element* parent, const UString& name);
+            AttributeType attributeModel(const Element* model, const UString& name);
+
+            // Write a JSON attribute in an object.
+            void writeJSONAttribute(const Context& ctx, const AttributeValue& attr);
+
+            // Write a node and all its children.
+            void addNode(const Node& node);
+        };
+    }
+}
@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsStartCode.h"
+
+
+//----------------------------------------------------------------------------
+// Locate the next 00 00 xx sequence, with min_code <= xx <= max_code.
+// Compressed video rarely contains zero bytes. We search zero bytes using
+// memchr() which is vectorized in all decent C libraries and check the
+// neighbouring bytes only when a zero is found.
+//----------------------------------------------------------------------------
+
+namespace {
+    const uint8_t* LocateZeroZero(const void* area, size_t area_size, uint8_t min_code, uint8_t max_code)
+    {
+        if (area == nullptr || area_size < 3) {
+            return nullptr;
+        }
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(area);
+        const uint8_t* const last = p + area_size - 3; // last possible start of a sequence
+        while (p <= last) {
+            // Any sequence starting at or after p has its second zero in [p+1, last+1].
+            const uint8_t* const zero = reinterpret_cast<const uint8_t*>(::memchr(p + 1, 0, last - p + 1));
+            if (zero == nullptr) {
+                break;
+            }
+            else if (zero[-1] == 0 && zero[1] >= min_code && zero[1] <= max_code) {
+                return zero - 1;
+            }
+            else if (zero < last + 1 && zero[1] == 0 && zero[2] >= min_code && zero[2] <= max_code) {
+                return zero;
+            }
+            p = zero + 1;
+        }
+        return nullptr;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Public functions.
+//----------------------------------------------------------------------------
+
+const uint8_t* ts::LocateStartCodePrefix(const void* area, size_t area_size)
+{
+    return LocateZeroZero(area, area_size, 0x01, 0x01);
+}
+
+const uint8_t* ts::LocateNALUnitEnd(const void* area, size_t area_size)
+{
+    return LocateZeroZero(area, area_size, 0x00, 0x01);
+}
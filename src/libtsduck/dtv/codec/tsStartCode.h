@@ -0,0 +1,59 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  @ingroup mpeg
+//!  Fast location of start codes in video elementary streams.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Locate the next start code prefix 00 00 01 in a video elementary stream.
+    //! This is faster than a generic LocatePattern() on large PES payloads.
+    //! @param [in] area Address of a memory area to check.
+    //! @param [in] area_size Size in bytes of the memory area.
+    //! @return Address of the first 00 00 01 sequence in @a area or zero if not found.
+    //!
+    TSDUCKDLL const uint8_t* LocateStartCodePrefix(const void* area, size_t area_size);
+
+    //!
+    //! Locate the end of a NALunit in an AVC, HEVC or VVC elementary stream.
+    //! A NALunit ends at the next 00 00 00 or 00 00 01 sequence. Because of the
+    //! start code emulation prevention (00 00 03), these sequences never appear
+    //! inside a valid NALunit.
+    //! @param [in] area Address of a memory area to check, typically the first byte of a NALunit.
+    //! @param [in] area_size Size in bytes of the memory area.
+    //! @return Address of the first 00 00 00 or 00 00 01 sequence in @a area or zero if not found.
+    //!
+    TSDUCKDLL const uint8_t* LocateNALUnitEnd(const void* area, size_t area_size);
+}
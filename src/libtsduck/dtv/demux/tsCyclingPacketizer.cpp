@@ -100,47 +100,7 @@ void ts::CyclingPacketizer::addTable(DuckContext& duck, const AbstractTable& tab
 
 
 //----------------------------------------------------------------------------
-// Check if this section shall be inserted after some other one.
-//----------------------------------------------------------------------------
-
-bool ts::CyclingPacketizer::SectionDesc::insertAfter(const SectionDesc& other) const
-{
-    // Insert sections according due time when due times are different.
-    if (due_packet != other.due_packet) {
-        return due_packet > other.due_packet;
-    }
-
-    // At this point, the two sections have the same due time.
-    // Decide insertion order based on the sections contents.
-    const Section& sec1(*section);
-    const Section& sec2(*(other.section));
-
-    if (sec1.tableId() != sec2.tableId() || (sec1.isLongSection() && sec1.tableIdExtension() != sec2.tableIdExtension())) {
-        // Sections do not belong to the same table => insert before
-        return false;
-    }
-    else if (last_cycle > other.last_cycle) {
-        // This section in one cycle in advance => insert after
-        return true;
-    }
-    else if (last_cycle < other.last_cycle) {
-        // This section in one cycle late => insert before
-        return false;
-    }
-    else if (sec1.isShortSection() || sec2.isShortSection() || sec1.tableIdExtension() != sec2.tableIdExtension()) {
-        // Both sections have the same due packet and in the same cycle. They also have the same table id.
-        // Either they are short equivalent sections or do not have the same table id ext => insert after.
-        return true;
-    }
-    else {
-        // Same due packet, same cycle, same long table => insert in order of section number.
-        return sec1.sectionNumber() >= sec2.sectionNumber();
-    }
-}
-
-
-//----------------------------------------------------------------------------
-// Insert a scheduled section in the list, sorted by due_packet.
+// Insert a scheduled section in the timer wheel, at its due_packet.
 //----------------------------------------------------------------------------
 
 void ts::CyclingPacketizer::addScheduledSection(const SectionDescPtr& sect)
@@ -150,11 +110,8 @@ void ts::CyclingPacketizer::addScheduledSection(const SectionDescPtr& sect)
                   sect->section->sectionNumber(), sect->section->lastSectionNumber(),
                   sect->last_cycle, sect->last_packet, sect->due_packet});
 
-    auto it = _sched_sections.begin();
-    while (it != _sched_sections.end() && sect->insertAfter(**it)) {
-        ++it;
-    }
-    _sched_sections.insert(it, sect);
+    // Sections with the same due packet are extracted in order of insertion.
+    _sched_sections.insert(sect, sect->due_packet);
 }
 
 
@@ -190,51 +147,58 @@ void ts::CyclingPacketizer::addSection(const SectionPtr& sect, MilliSecond rep_r
 
 void ts::CyclingPacketizer::removeSections(TID tid)
 {
-    removeSections(_sched_sections, tid, 0, 0, false, false, true);
-    removeSections(_other_sections, tid, 0, 0, false, false, false);
+    removeSections(tid, 0, 0, false, false);
 }
 
 void ts::CyclingPacketizer::removeSections(TID tid, uint16_t tid_ext)
 {
-    removeSections(_sched_sections, tid, tid_ext, 0, true, false, true);
-    removeSections(_other_sections, tid, tid_ext, 0, true, false, false);
+    removeSections(tid, tid_ext, 0, true, false);
 }
 
 void ts::CyclingPacketizer::removeSections(TID tid, uint16_t tid_ext, uint8_t sec_number)
 {
-    removeSections(_sched_sections, tid, tid_ext, sec_number, true, true, true);
-    removeSections(_other_sections, tid, tid_ext, sec_number, true, true, false);
+    removeSections(tid, tid_ext, sec_number, true, true);
 }
 
 
 //----------------------------------------------------------------------------
-// Remove all sections with the specified tid/tid_ext in the specified list.
+// Remove all sections with the specified tid/tid_ext.
 //----------------------------------------------------------------------------
 
-void ts::CyclingPacketizer::removeSections(SectionDescList& list, TID tid, uint16_t tid_ext, uint8_t sec_number, bool use_tid_ext, bool use_sec_number, bool scheduled)
+void ts::CyclingPacketizer::removeSections(TID tid, uint16_t tid_ext, uint8_t sec_number, bool use_tid_ext, bool use_sec_number)
 {
-    SectionDescList::iterator it(list.begin());
-    while (it != list.end()) {
-        const SectionDescPtr& sp(*it);
-        const Section& sect(*sp->section);
-        if (sect.tableId() == tid && (!use_tid_ext || sect.tableIdExtension() == tid_ext) && (!use_sec_number || sect.sectionNumber() == sec_number)) {
-            // Section match, remove it
-            assert(_section_count > 0);
-            _section_count--;
-            if (sp->last_cycle != _current_cycle) {
-                assert(_remain_in_cycle > 0);
-                _remain_in_cycle--;
-            }
-            if (scheduled) {
-                assert(_sched_packets >= sect.packetCount());
-                _sched_packets -= sect.packetCount();
-            }
-            it = list.erase(it);
-        }
-        else {
-            ++it;
-        }
+    _sched_sections.removeIf([&](const SectionDescPtr& sp) {
+        return matchRemove(sp, tid, tid_ext, sec_number, use_tid_ext, use_sec_number, true);
+    });
+    _other_sections.remove_if([&](const SectionDescPtr& sp) {
+        return matchRemove(sp, tid, tid_ext, sec_number, use_tid_ext, use_sec_number, false);
+    });
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a section matches the specified tid/tid_ext and update counters.
+//----------------------------------------------------------------------------
+
+bool ts::CyclingPacketizer::matchRemove(const SectionDescPtr& sp, TID tid, uint16_t tid_ext, uint8_t sec_number, bool use_tid_ext, bool use_sec_number, bool scheduled)
+{
+    const Section& sect(*sp->section);
+    if (sect.tableId() != tid || (use_tid_ext && sect.tableIdExtension() != tid_ext) || (use_sec_number && sect.sectionNumber() != sec_number)) {
+        return false;
+    }
+
+    // Section match, it will be removed
+    assert(_section_count > 0);
+    _section_count--;
+    if (sp->last_cycle != _current_cycle) {
+        assert(_remain_in_cycle > 0);
+        _remain_in_cycle--;
     }
+    if (scheduled) {
+        assert(_sched_packets >= sect.packetCount());
+        _sched_packets -= sect.packetCount();
+    }
+    return true;
 }
 
 
@@ -279,10 +243,11 @@ void ts::CyclingPacketizer::setBitRate(const BitRate& new_bitrate)
     else if (new_bitrate == 0) {
         // Bitrate now unknown, unable to schedule sections, move them all
         // into the list of unscheduled sections.
-        while (!_sched_sections.empty()) {
-            _other_sections.push_back(_sched_sections.front());
-            _sched_sections.pop_front();
+        SectionDescPtr sp;
+        while (_sched_sections.pop(sp)) {
+            _other_sections.push_back(sp);
         }
+        _sched_sections.clear();
         _sched_packets = 0;
     }
     else if (_bitrate == 0) {
@@ -309,14 +274,16 @@ void ts::CyclingPacketizer::setBitRate(const BitRate& new_bitrate)
     }
     else {
         // Old and new bitrate not null. Compute new due packet for all
-        // scheduled sections and re-sort list according to new due packet.
+        // scheduled sections and reschedule them according to new due packet.
         SectionDescList tmp_list;
-        tmp_list.swap(_sched_sections);
-        while (!tmp_list.empty()) {
-            SectionDesc* sp(tmp_list.back().pointer());
-            sp->due_packet = sp->last_packet + PacketDistance(new_bitrate, sp->repetition);
-            addScheduledSection(tmp_list.back());
-            tmp_list.pop_back();
+        SectionDescPtr sp;
+        while (_sched_sections.pop(sp)) {
+            tmp_list.push_back(sp);
+        }
+        _sched_sections.clear();
+        for (auto& it : tmp_list) {
+            it->due_packet = it->last_packet + PacketDistance(new_bitrate, it->repetition);
+            addScheduledSection(it);
         }
     }
 
@@ -354,10 +321,8 @@ void ts::CyclingPacketizer::provideSection(SectionCounter counter, SectionPtr& s
          // .. or previous unscheduled section passed in this cycle a long time ago
          spp->last_packet + spp->section->packetCount() + _sched_packets < current_packet);
 
-    if (!force_unscheduled && !_sched_sections.empty() && _sched_sections.front()->due_packet <= current_packet) {
+    if (!force_unscheduled && _sched_sections.popReady(sp, current_packet)) {
         // One scheduled section is ready
-        sp = _sched_sections.front();
-        _sched_sections.pop_front();
         // Reschedule the section. Make sure we add at least one packet to
         // ensure that all scheduled sections may pass.
         sp->due_packet = current_packet + std::max(PacketCounter(1), PacketDistance(_bitrate, sp->repetition));
@@ -451,9 +416,7 @@ std::ostream& ts::CyclingPacketizer::display(std::ostream& strm) const
         << "  Stored sections: " << _section_count << std::endl
         << "  Scheduled sections: " << _sched_sections.size() << std::endl
         << "  Scheduled packets max: " << _sched_packets << std::endl;
-    for (SectionDescList::const_iterator it = _sched_sections.begin(); it != _sched_sections.end(); ++it) {
-        (*it)->display(duck(), strm);
-    }
+    _sched_sections.forEach([this, &strm](const SectionDescPtr& sp, SectionDescWheel::Tick) { sp->display(duck(), strm); });
     strm << "  Unscheduled sections: " << _other_sections.size() << std::endl;
     for (SectionDescList::const_iterator it = _other_sections.begin(); it != _other_sections.end(); ++it) {
         (*it)->display(duck(), strm);
@@ -37,6 +37,7 @@
 #include "tsSectionProviderInterface.h"
 #include "tsBinaryTable.h"
 #include "tsAbstractTable.h"
+#include "tsTimerWheel.h"
 
 namespace ts {
     //!
@@ -236,9 +237,6 @@ namespace ts {
             // Constructor
             SectionDesc(const SectionPtr& sec, MilliSecond rep);
 
-            // Check if this section shall be inserted after some other one.
-            bool insertAfter(const SectionDesc& other) const;
-
             // Display the internal state, mainly for debug.
             std::ostream& display(const DuckContext&, std::ostream&) const;
         };
@@ -249,24 +247,30 @@ namespace ts {
         // List of sections
         typedef std::list <SectionDescPtr> SectionDescList;
 
+        // Scheduled sections, in a timer wheel indexed by due packet.
+        typedef TimerWheel<SectionDescPtr> SectionDescWheel;
+
         // Private members:
-        StuffingPolicy  _stuffing;
-        BitRate         _bitrate;
-        size_t          _section_count;   // Number of sections in the 2 lists
-        SectionDescList _sched_sections;  // Scheduled sections, with repetition rates
-        SectionDescList _other_sections;  // Unscheduled sections
-        PacketCounter   _sched_packets;   // Size in TS packets of all sections in _sched_sections
-        SectionCounter  _current_cycle;   // Cycle number (start at 1, always increasing)
-        size_t          _remain_in_cycle; // Number of unsent sections in this cycle
-        SectionCounter  _cycle_end;       // At end of cycle, contains the index of last section
+        StuffingPolicy   _stuffing;
+        BitRate          _bitrate;
+        size_t           _section_count;   // Number of sections in the 2 lists
+        SectionDescWheel _sched_sections;  // Scheduled sections, with repetition rates
+        SectionDescList  _other_sections;  // Unscheduled sections
+        PacketCounter    _sched_packets;   // Size in TS packets of all sections in _sched_sections
+        SectionCounter   _current_cycle;   // Cycle number (start at 1, always increasing)
+        size_t           _remain_in_cycle; // Number of unsent sections in this cycle
+        SectionCounter   _cycle_end;       // At end of cycle, contains the index of last section
 
         static const SectionCounter UNDEFINED = ~SectionCounter(0);
 
-        // Insert a scheduled section in the list, sorted by due_packet.
+        // Insert a scheduled section in the timer wheel, at its due_packet.
         void addScheduledSection(const SectionDescPtr&);
 
-        // Remove all sections with the specified tid/tid_ext in the specified list.
-        void removeSections(SectionDescList&, TID tid, uint16_t tid_ext, uint8_t sec_number, bool use_tid_ext, bool use_sec_number, bool scheduled);
+        // Remove all sections with the specified tid/tid_ext.
+        void removeSections(TID tid, uint16_t tid_ext, uint8_t sec_number, bool use_tid_ext, bool use_sec_number);
+
+        // Check if a section matches the specified tid/tid_ext. If true, update the counters, the section shall be removed.
+        bool matchRemove(const SectionDescPtr&, TID tid, uint16_t tid_ext, uint8_t sec_number, bool use_tid_ext, bool use_sec_number, bool scheduled);
 
         // Inherited from SectionProviderInterface
         virtual void provideSection(SectionCounter, SectionPtr&) override;
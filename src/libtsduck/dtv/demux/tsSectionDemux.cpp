@@ -199,7 +199,8 @@ ts::SectionDemux::PIDContext::PIDContext() :
     continuity(0),
     sync(false),
     ts(),
-    tids()
+    tids(),
+    signatures()
 {
 }
 
@@ -225,6 +226,7 @@ ts::SectionDemux::SectionDemux(DuckContext& duck, TableHandlerInterface* table_h
     _get_current(true),
     _get_next(false),
     _track_invalid_version(false),
+    _filter_repeated(false),
     _ts_error_level(Severity::Debug)
 {
 }
@@ -481,7 +483,22 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             section_ok = false;
         }
 
-        if (section_ok) {
+        // With the repeated sections filter, the signature of a long section is made of its version and CRC32, as
+        // read from the stream. A repeated section is identical to the previous one with the same section number.
+        // It is dropped without creating a Section object or checking its CRC32. An additional marker bit in the
+        // signature makes sure that a new (zero) entry in the map of signatures never matches.
+
+        bool repeated = false;
+        uint64_t* signature = nullptr;
+        uint64_t new_signature = 0;
+
+        if (section_ok && _filter_repeated && long_header) {
+            new_signature = (uint64_t(0x0100 | version) << 32) | GetUInt32(ts_start + section_length - SECTION_CRC32_SIZE);
+            signature = &pc.signatures[std::make_pair(etid, section_number)];
+            repeated = *signature == new_signature;
+        }
+
+        if (section_ok && !repeated) {
 
             // Get the list of standards which define this table id and add them in context.
             _duck.addStandards(PSIRepository::Instance()->getTableStandards(etid.tid(), pid));
@@ -543,6 +560,10 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                     _status.wrong_crc++;  // only possible error (hum?)
                     section_ok = false;
                 }
+                else if (signature != nullptr) {
+                    // Only sections with a verified CRC32 are remembered for the repeated sections filter.
+                    *signature = new_signature;
+                }
             }
 
             // Mark that we are in the context of a table or section handler.
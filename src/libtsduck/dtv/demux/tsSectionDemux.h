@@ -161,6 +161,23 @@ namespace ts {
             _track_invalid_version = on;
         }
 
+        //!
+        //! Filter out repeated sections.
+        //! Most PSI/SI sections are cyclically repeated without modification. By default, each
+        //! occurrence is reassembled in a new Section object, its CRC32 is checked and the section
+        //! handler, if any, is invoked. When this filter is enabled, a long section which is
+        //! identical to the previous occurrence of the same section in the same PID is dropped
+        //! before creating a Section object and checking the CRC32. Two sections are considered
+        //! identical when they have the same table id, table id extension, version, section number
+        //! and CRC32 (as read from the stream, not recomputed). Short sections are never filtered.
+        //! This is useful to applications which are only interested in changes.
+        //! @param [in] on Filter out repeated sections. This is false by default.
+        //!
+        void filterRepeatedSections(bool on)
+        {
+            _filter_repeated = on;
+        }
+
         //!
         //! Set the log level for messages reporting transport stream errors in demux.
         //! By default, the log level is Severity::Debug.
@@ -286,6 +303,7 @@ namespace ts {
             bool          sync;               // We are synchronous in this PID
             ByteBlock     ts;                 // TS payload buffer
             std::map<ETID,ETIDContext> tids;  // TID analysis contexts
+            std::map<std::pair<ETID,uint8_t>,uint64_t> signatures;  // Last signature of long sections by ETID and section number
 
             // Default constructor.
             PIDContext();
@@ -309,6 +327,7 @@ namespace ts {
         bool   _get_current;
         bool   _get_next;
         bool   _track_invalid_version;
+        bool   _filter_repeated;
         int    _ts_error_level;
     };
 }
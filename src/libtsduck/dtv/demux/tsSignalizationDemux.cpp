@@ -67,6 +67,8 @@ ts::SignalizationDemux::SignalizationDemux(DuckContext& duck, SignalizationHandl
     _pids(),
     _services()
 {
+    // Only changes in the signalization are useful, drop repeated sections before reassembly.
+    _demux.filterRepeatedSections(true);
     _last_pat.invalidate();
     for (auto it = tids.begin(); it != tids.end(); ++it) {
         addFilteredTableId(*it);
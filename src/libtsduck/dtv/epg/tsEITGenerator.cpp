@@ -32,6 +32,8 @@
 #include "tsEIT.h"
 #include "tsMJD.h"
 #include "tsBCD.h"
+#include "tsGuardMutex.h"
+#include "tsGuardCondition.h"
 
 
 //----------------------------------------------------------------------------
@@ -58,7 +60,15 @@ ts::EITGenerator::EITGenerator(DuckContext& duck, PID pid, EITOption options, co
     _services(),
     _injects(),
     _obsolete_count(0),
-    _versions()
+    _versions(),
+    _workers(),
+    _jobs(),
+    _jobs_mutex(),
+    _jobs_start(),
+    _jobs_done(),
+    _jobs_next(0),
+    _jobs_completed(0),
+    _jobs_terminate(false)
 {
     // We need the PAT as long as the TS id is not known.
     _demux.addPID(PID_PAT);
@@ -73,12 +83,20 @@ ts::EITGenerator::EITGenerator(DuckContext& duck, PID pid, EITOption options, co
 }
 
 
+ts::EITGenerator::~EITGenerator()
+{
+    cancelJobs();
+    stopWorkers();
+}
+
+
 //----------------------------------------------------------------------------
 // Reset the EIT generator to default state.
 //----------------------------------------------------------------------------
 
 void ts::EITGenerator::reset()
 {
+    cancelJobs();
     _actual_ts_id = 0;
     _actual_ts_id_set = false;
     _regenerate = false;
@@ -135,9 +153,29 @@ ts::EITGenerator::ESection::ESection(EITGenerator* gen, const ServiceIdTriplet&
     injected(false),
     next_inject(),
     section()
+{
+    // Build a section from the binary data.
+    section = new Section(NewSectionData(srv, tid, gen->nextVersion(tid, srv.service_id, section_number), section_number, last_section_number, 0), PID_NULL, CRC32::IGNORE);
+    CheckNonNull(section.pointer());
+}
+
+ts::EITGenerator::ESection::ESection(const SectionPtr& sec) :
+    obsolete(false),
+    injected(false),
+    next_inject(),
+    section(sec)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Build the binary data of an EIT section (events and CRC32 not set).
+//----------------------------------------------------------------------------
+
+ts::ByteBlockPtr ts::EITGenerator::NewSectionData(const ServiceIdTriplet& srv, TID tid, uint8_t version, uint8_t section_number, uint8_t last_section_number, size_t events_size)
 {
     // Build section data.
-    ByteBlockPtr section_data(new ByteBlock(LONG_SECTION_HEADER_SIZE + EIT::EIT_PAYLOAD_FIXED_SIZE + SECTION_CRC32_SIZE));
+    ByteBlockPtr section_data(new ByteBlock(LONG_SECTION_HEADER_SIZE + EIT::EIT_PAYLOAD_FIXED_SIZE + events_size + SECTION_CRC32_SIZE));
     CheckNonNull(section_data.pointer());
     uint8_t* data = section_data->data();
 
@@ -145,7 +183,7 @@ ts::EITGenerator::ESection::ESection(EITGenerator* gen, const ServiceIdTriplet&
     PutUInt8(data, tid);
     PutUInt16(data + 1, 0xF000 | uint16_t(section_data->size() - 3));
     PutUInt16(data + 3, srv.service_id);       // table id extension
-    PutUInt8(data + 5, 0xC1 | uint8_t(gen->nextVersion(tid, srv.service_id, section_number) << 1));
+    PutUInt8(data + 5, 0xC1 | uint8_t(version << 1));
     PutUInt8(data + 6, section_number);
     PutUInt8(data + 7, last_section_number);
 
@@ -155,9 +193,7 @@ ts::EITGenerator::ESection::ESection(EITGenerator* gen, const ServiceIdTriplet&
     PutUInt8(data + 12, last_section_number);  // last section number in this segment
     PutUInt8(data + 13, tid);                  // last table id in this service
 
-    // Build a section from the binary data.
-    section = new Section(section_data, PID_NULL, CRC32::IGNORE);
-    CheckNonNull(section.pointer());
+    return section_data;
 }
 
 
@@ -233,14 +269,19 @@ ts::EITGenerator::EService::EService() :
 // Get next version of a section.
 //----------------------------------------------------------------------------
 
-uint8_t ts::EITGenerator::nextVersion(TID tid, uint16_t service_id, uint8_t section_number)
+uint32_t ts::EITGenerator::VersionIndex(TID tid, uint16_t service_id, uint8_t section_number)
 {
     // Build a unique section identifier on 32 bits.
-    const uint32_t index = (uint32_t(tid) << 24) | (uint32_t(service_id) << 8) | section_number;
-    const auto it = _versions.find(index);
-    if (it == _versions.end()) {
+    return (uint32_t(tid) << 24) | (uint32_t(service_id) << 8) | section_number;
+}
+
+uint8_t ts::EITGenerator::NextVersion(VersionMap& versions, TID tid, uint16_t service_id, uint8_t section_number)
+{
+    const uint32_t index = VersionIndex(tid, service_id, section_number);
+    const auto it = versions.find(index);
+    if (it == versions.end()) {
         // Section did not exist, use 0 as first version.
-        return _versions[index] = 0;
+        return versions[index] = 0;
     }
     else {
         // Update version.
@@ -399,7 +440,7 @@ void ts::EITGenerator::saveEITs(SectionPtrVector& sections)
     // Ensure all EIT sections are correctly regenerated.
     const Time now(getCurrentTime());
     updateForNewTime(now);
-    regenerateSchedule(now);
+    regenerateSchedule(now, true);
 
     size_t pf_count = 0;
     size_t sched_count = 0;
@@ -440,6 +481,9 @@ void ts::EITGenerator::setTransportStreamId(uint16_t new_ts_id)
     }
     _duck.report().debug(u"setting EIT generator TS id to 0x%X (%<d)", {new_ts_id});
 
+    // Pending EIT schedule regenerations are based on the previous TS id.
+    cancelJobs();
+
     // Set new TS id.
     const uint16_t old_ts_id = _actual_ts_id_set ? _actual_ts_id : 0xFFFF;
     _actual_ts_id = new_ts_id;
@@ -530,6 +574,9 @@ void ts::EITGenerator::setTransportStreamId(uint16_t new_ts_id)
 
 void ts::EITGenerator::setOptions(EITOption options)
 {
+    // Pending EIT schedule regenerations are based on the previous options.
+    cancelJobs();
+
     // Update the options.
     const EITOption old_options = _options;
     _options = options;
@@ -676,19 +723,9 @@ void ts::EITGenerator::markObsoleteSection(ESection& sec)
         // EIT schedule never get a chance to get selected (and discarded when marked
         // as obsolete). Do some garbage collecting to avoid infinite accumulation.
         if (_obsolete_count > 100) {
-            // Loop on all injection queues.
+            // Loop on all injection queues, remove all obsolete sections.
             for (size_t index = 0; index < _injects.size(); ++index) {
-                // Loop on all sections in the queue.
-                ESectionList& list(_injects[index]);
-                auto it = list.begin();
-                while (it != list.end()) {
-                    if ((*it)->obsolete) {
-                        it = list.erase(it);
-                    }
-                    else {
-                        ++it;
-                    }
-                }
+                _injects[index].removeIf([](const ESectionPtr& s) { return s->obsolete; });
             }
             _obsolete_count = 0;
         }
@@ -700,32 +737,14 @@ void ts::EITGenerator::markObsoleteSection(ESection& sec)
 // Enqueue a section for injection.
 //----------------------------------------------------------------------------
 
-void ts::EITGenerator::enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject, bool try_front)
+void ts::EITGenerator::enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject)
 {
     // Update section injection time.
     sec->next_inject = next_inject;
 
-    // Compute which injection queue to use.
-    ESectionList& list(_injects[size_t(_profile.sectionToProfile(*sec->section))]);
-
-    // Even start at from or back of the queue (possible optimization).
-    if (try_front) {
-        auto it = list.begin();
-        while (it != list.end() && (*it)->next_inject <= next_inject) {
-            ++it;
-        }
-        list.insert(it, sec);
-    }
-    else {
-        auto it = list.end();
-        while (it != list.begin() && (*--it)->next_inject > next_inject) {
-        }
-        if (it != list.end()) {
-            // it points to a section before sec, must insert after.
-            ++it;
-        }
-        list.insert(it, sec);
-    }
+    // Insert in the injection queue for the profile of the section.
+    // Sections with the same injection time are extracted in order of insertion.
+    _injects[size_t(_profile.sectionToProfile(*sec->section))].insert(sec, ToTick(next_inject));
 }
 
 
@@ -801,7 +820,7 @@ void ts::EITGenerator::regeneratePresentFollowingSection(const ServiceIdTriplet&
             sec->section->appendPayload(event->event_data, true);
         }
         // Place the section in the inject queue.
-        enqueueInjectSection(sec, inject_time, true);
+        enqueueInjectSection(sec, inject_time);
     }
     else if (event.isNull()) {
         // The section already exists. It must be already in an injection queue.
@@ -837,16 +856,42 @@ void ts::EITGenerator::regeneratePresentFollowingSection(const ServiceIdTriplet&
 // Regenerate all EIT schedule, create missing segments and sections.
 //----------------------------------------------------------------------------
 
-void ts::EITGenerator::regenerateSchedule(const Time& now)
+void ts::EITGenerator::regenerateSchedule(const Time& now, bool wait)
 {
     // We cannot regenerate EIT if the TS id or the current time is unknown.
-    if (!_regenerate || !_actual_ts_id_set || now == Time::Epoch) {
+    if (!_actual_ts_id_set || now == Time::Epoch) {
+        return;
+    }
+
+    // Swap in the results of the current batch of jobs, when all of them are completed.
+    if (!_jobs.empty()) {
+        if (wait) {
+            waitJobs();
+        }
+        else {
+            GuardMutex lock(_jobs_mutex);
+            if (_jobs_completed < _jobs.size()) {
+                // The previous sections continue to be injected in the meantime.
+                return;
+            }
+        }
+        commitJobs(now);
+    }
+
+    // Nothing to do if no service needs to be regenerated.
+    if (!_regenerate) {
         return;
     }
 
     // Reference time for EIT schedule.
     const Time last_midnight(now.thisDay());
 
+    // Jobs to build the EIT schedule sections of the regenerated services.
+    // Services with the same service id in distinct TS share the same section versions.
+    // Their jobs are chained and run in sequence.
+    ServiceJobVector jobs;
+    std::map<uint16_t, ServiceJob*> last_jobs;
+
     // Loop on all services, regenerating those which are marked for regeneration.
     for (auto srv_iter = _services.begin(); srv_iter != _services.end(); ++srv_iter) {
         if (srv_iter->second.regenerate) {
@@ -881,7 +926,6 @@ void ts::EITGenerator::regenerateSchedule(const Time& now)
 
             // Loop on all segments. The first segment must be at last midnight.
             Time segment_start_time(last_midnight);
-            size_t segment_number = 0;
             for (auto seg_iter = srv.segments.begin(); seg_iter != srv.segments.end(); ++seg_iter) {
 
                 // Enforce the existence of contiguous segments. Create missing segments when necessary.
@@ -898,164 +942,478 @@ void ts::EITGenerator::regenerateSchedule(const Time& now)
                     // We do not need EIT schedule here, delete all sections.
                     markObsoleteSegment(seg);
                     seg.sections.clear();
+                    seg.regenerate = false;
                 }
-                else if (seg.regenerate) {
-                    // Regenerate EIT schedule in the segment.
-
-                    // Table id and first section number in that segment.
-                    const TID table_id = EIT::SegmentToTableId(actual, segment_number);
-                    const uint8_t first_section_number = EIT::SegmentToSection(segment_number);
-                    uint8_t section_number = first_section_number;
-
-                    // Update or generate all sections.
-                    auto ev_iter = seg.events.begin();
-                    auto sec_iter = seg.sections.begin();
-                    while (ev_iter != seg.events.end()) {
-
-                        // Check if the current section is still valid, meaning it exactly contains the next events.
-                        const auto saved_ev_iter = ev_iter;
-                        bool section_still_valid = sec_iter != seg.sections.end() && (*sec_iter)->section->payloadSize() >= EIT::EIT_PAYLOAD_FIXED_SIZE;
-                        const uint8_t* pl = section_still_valid ? (*sec_iter)->section->payload() + EIT::EIT_PAYLOAD_FIXED_SIZE : nullptr;
-                        size_t pl_size = section_still_valid ? (*sec_iter)->section->payloadSize() - EIT::EIT_PAYLOAD_FIXED_SIZE : 0;
-
-                        while (section_still_valid && pl_size > 0 && ev_iter != seg.events.end()) {
-                            const uint8_t* ev = (*ev_iter)->event_data.data();
-                            const size_t ev_size = (*ev_iter)->event_data.size();
-                            section_still_valid = pl_size >= ev_size && ::memcmp(pl, ev, ev_size) == 0;
-                            if (section_still_valid) {
-                                ++ev_iter;
-                                pl += ev_size;
-                                pl_size -= ev_size;
-                            }
-                        }
-                        if (section_still_valid) {
-                            // If the next event exists and could fit in the section, then the section is no longer valid.
-                            section_still_valid = ev_iter == seg.events.end() ||
-                                (*sec_iter)->section->payloadSize() + (*ev_iter)->event_data.size() > MAX_PRIVATE_LONG_SECTION_PAYLOAD_SIZE;
-                        }
 
-                        // If the current section is still valid, skip those events and move to next section.
-                        if (section_still_valid) {
-                            ++sec_iter;
-                            ++section_number;
-                            continue;
-                        }
+                // Time of next expected segment:
+                segment_start_time += EIT::SEGMENT_DURATION;
+            }
 
-                        // The section is no longer valid or does not exist, rebuild it.
-                        const ESectionPtr sec(new ESection(this, service_id, table_id, section_number, section_number));
-                        CheckNonNull(sec.pointer());
-                        if (sec_iter != seg.sections.end()) {
-                            // Existing section, invalidate it and replace it.
-                            markObsoleteSection(**sec_iter);
-                            *sec_iter = sec;
-                        }
-                        else if (seg.sections.size() >= EIT::SECTIONS_PER_SEGMENT) {
-                            // Too many sections for that segment, skip the last events.
-                            break;
-                        }
-                        else {
-                            // Insert a new section for that segment.
-                            sec_iter = seg.sections.insert(sec_iter, sec);
-                        }
+            // Build the EIT schedule sections of the service from a snapshot of its segments.
+            // This clears the segment regeneration flags.
+            if (need_eits) {
+                const ServiceJobPtr job(newJob(service_id, srv, actual));
+                const auto last = last_jobs.find(service_id.service_id);
+                if (last == last_jobs.end()) {
+                    jobs.push_back(job);
+                }
+                else {
+                    last->second->next = job;
+                }
+                last_jobs[service_id.service_id] = job.pointer();
+            }
 
-                        // Restart exploring events at the beginning of the section.
-                        ev_iter = saved_ev_iter;
+            // Clear service regeneration flag.
+            srv.regenerate = false;
+        }
+    }
 
-                        // Insert events in the section, as long as they fit.
-                        while (ev_iter != seg.events.end() && sec->section->payloadSize() + (*ev_iter)->event_data.size() <= MAX_PRIVATE_LONG_SECTION_PAYLOAD_SIZE) {
-                            // Append the event to the section payload.
-                            sec->section->appendPayload((*ev_iter)->event_data, false);
-                            ++ev_iter;
-                        }
+    // Clear global regeneration flag.
+    _regenerate = false;
 
-                        // Section complete.
-                        sec->section->recomputeCRC();
-                        enqueueInjectSection(sec, getCurrentTime(), true);
+    if (_workers.empty()) {
+        // No worker thread, build and swap in the sections immediately.
+        for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+            (*it)->run();
+            commitJob(**it, now);
+        }
+    }
+    else if (!jobs.empty()) {
+        // Submit the batch of jobs to the worker threads.
+        {
+            GuardCondition lock(_jobs_mutex, _jobs_start);
+            _jobs.swap(jobs);
+            _jobs_next = _jobs_completed = 0;
+            lock.signal();
+        }
+        if (wait) {
+            waitJobs();
+            commitJobs(now);
+        }
+    }
+}
 
-                        // Move to next section (if it exists).
-                        ++sec_iter;
-                        ++section_number;
-                    }
 
-                    // Deallocate remaining sections, if any.
-                    while (sec_iter != seg.sections.end()) {
-                        markObsoleteSection(**sec_iter);
-                        sec_iter = seg.sections.erase(sec_iter);
-                    }
+//----------------------------------------------------------------------------
+// Build a regeneration job for a service.
+//----------------------------------------------------------------------------
 
-                    // We need at least one section, possibly empty, in each segment.
-                    if (seg.sections.empty()) {
-                        const ESectionPtr sec(new ESection(this, service_id, table_id, first_section_number, first_section_number));
-                        CheckNonNull(sec.pointer());
-                        seg.sections.push_back(sec);
-                        enqueueInjectSection(sec, getCurrentTime(), true);
-                    }
+ts::EITGenerator::ServiceJobPtr ts::EITGenerator::newJob(const ServiceIdTriplet& service_id, EService& srv, bool actual)
+{
+    ServiceJobPtr job(new ServiceJob(service_id, actual));
+    CheckNonNull(job.pointer());
+
+    // Snapshot of the versions of all EIT schedule sections of the service, actual and other.
+    for (TID tid = TID_EIT_S_ACT_MIN; tid <= TID_EIT_S_OTH_MAX; ++tid) {
+        job->versions.insert(_versions.lower_bound(VersionIndex(tid, service_id.service_id, 0)),
+                             _versions.upper_bound(VersionIndex(tid, service_id.service_id, 0xFF)));
+    }
+
+    // Snapshot of all segments. The segments to regenerate also need their events.
+    job->segments.resize(srv.segments.size());
+    auto seg_job = job->segments.begin();
+    for (auto seg_iter = srv.segments.begin(); seg_iter != srv.segments.end(); ++seg_iter, ++seg_job) {
+        ESegment& seg(**seg_iter);
+        seg_job->segment = *seg_iter;
+        seg_job->regenerate = seg.regenerate;
+        if (seg.regenerate) {
+            seg_job->events = seg.events;
+        }
+        seg_job->esections.assign(seg.sections.begin(), seg.sections.end());
+        seg_job->sections.reserve(seg.sections.size());
+        for (auto sec_iter = seg.sections.begin(); sec_iter != seg.sections.end(); ++sec_iter) {
+            seg_job->sections.push_back((*sec_iter)->section);
+        }
+
+        // Clear segment regeneration flag. It will be set again if the segment is modified in the meantime.
+        seg.regenerate = false;
+    }
+    return job;
+}
+
+
+//----------------------------------------------------------------------------
+// Regeneration jobs constructors.
+//----------------------------------------------------------------------------
+
+ts::EITGenerator::SegmentJob::SegmentJob() :
+    segment(),
+    regenerate(false),
+    events(),
+    esections(),
+    sections(),
+    origin(),
+    results()
+{
+}
+
+ts::EITGenerator::ServiceJob::ServiceJob(const ServiceIdTriplet& srv, bool act) :
+    service_id(srv),
+    actual(act),
+    segments(),
+    versions(),
+    next()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Build the EIT schedule sections of a service. Can run in a worker thread.
+//----------------------------------------------------------------------------
+
+void ts::EITGenerator::ServiceJob::run()
+{
+    // Build the list of sections in all segments.
+    for (size_t segment_number = 0; segment_number < segments.size(); ++segment_number) {
+
+        SegmentJob& seg(segments[segment_number]);
+        seg.origin.clear();
+        seg.results.clear();
+
+        if (!seg.regenerate) {
+            // Keep all existing sections. Their synthetic fields are fixed later.
+            for (size_t i = 0; i < seg.sections.size(); ++i) {
+                seg.origin.push_back(i);
+                seg.results.push_back(SectionPtr());
+            }
+            continue;
+        }
+
+        // Table id and first section number in that segment.
+        const TID table_id = EIT::SegmentToTableId(actual, segment_number);
+        const uint8_t first_section_number = EIT::SegmentToSection(segment_number);
+        uint8_t section_number = first_section_number;
+
+        // Update or generate all sections.
+        auto ev_iter = seg.events.begin();
+        size_t sec_index = 0;
+        while (ev_iter != seg.events.end()) {
+
+            // Check if the current section is still valid, meaning it exactly contains the next events.
+            const auto saved_ev_iter = ev_iter;
+            const Section* const current = sec_index < seg.sections.size() ? seg.sections[sec_index].pointer() : nullptr;
+            bool section_still_valid = current != nullptr && current->payloadSize() >= EIT::EIT_PAYLOAD_FIXED_SIZE;
+            const uint8_t* pl = section_still_valid ? current->payload() + EIT::EIT_PAYLOAD_FIXED_SIZE : nullptr;
+            size_t pl_size = section_still_valid ? current->payloadSize() - EIT::EIT_PAYLOAD_FIXED_SIZE : 0;
+
+            while (section_still_valid && pl_size > 0 && ev_iter != seg.events.end()) {
+                const uint8_t* ev = (*ev_iter)->event_data.data();
+                const size_t ev_size = (*ev_iter)->event_data.size();
+                section_still_valid = pl_size >= ev_size && ::memcmp(pl, ev, ev_size) == 0;
+                if (section_still_valid) {
+                    ++ev_iter;
+                    pl += ev_size;
+                    pl_size -= ev_size;
                 }
+            }
+            if (section_still_valid) {
+                // If the next event exists and could fit in the section, then the section is no longer valid.
+                section_still_valid = ev_iter == seg.events.end() ||
+                    current->payloadSize() + (*ev_iter)->event_data.size() > MAX_PRIVATE_LONG_SECTION_PAYLOAD_SIZE;
+            }
+
+            // If the current section is still valid, skip those events and move to next section.
+            if (section_still_valid) {
+                seg.origin.push_back(sec_index++);
+                seg.results.push_back(SectionPtr());
+                ++section_number;
+                continue;
+            }
 
-                // Clear segment regeneration flag.
-                seg.regenerate = false;
+            // The section is no longer valid or does not exist, rebuild it.
+            if (sec_index >= seg.sections.size() && seg.origin.size() >= EIT::SECTIONS_PER_SEGMENT) {
+                // Too many sections for that segment, skip the last events.
+                break;
+            }
 
-                // Time and index of next expected segment:
-                segment_start_time += EIT::SEGMENT_DURATION;
-                segment_number++;
+            // Restart exploring events at the beginning of the section. Get events as long as they fit.
+            ev_iter = saved_ev_iter;
+            auto ev_end = ev_iter;
+            size_t events_size = 0;
+            while (ev_end != seg.events.end() && EIT::EIT_PAYLOAD_FIXED_SIZE + events_size + (*ev_end)->event_data.size() <= MAX_PRIVATE_LONG_SECTION_PAYLOAD_SIZE) {
+                events_size += (*ev_end)->event_data.size();
+                ++ev_end;
             }
 
-            // Fix synthetic fields in all EIT-schedule sections: last_section_number, segment_last_section_number, last_table_id.
-            if (need_eits) {
-                assert(!srv.segments.empty());
-                assert(!srv.segments.back()->sections.empty());
-
-                segment_number = srv.segments.size();
-                TID previous_table_id = TID_NULL;
-                TID last_table_id = TID_NULL;
-                uint8_t last_section_number = 0;
-
-                // Loop on segments from last to first.
-                for (auto seg_iter = srv.segments.rbegin(); seg_iter != srv.segments.rend(); ++seg_iter) {
-                    ESegment& seg(**seg_iter);
-                    assert(!seg.sections.empty());
-
-                    const TID table_id = EIT::SegmentToTableId(actual, --segment_number);
-                    uint8_t section_number = EIT::SegmentToSection(segment_number);
-                    const uint8_t segment_last_section_number = uint8_t(section_number + seg.sections.size() - 1);
-
-                    if (table_id != previous_table_id) {
-                        // Changed table. We are on the last segment of the previous table.
-                        last_section_number = segment_last_section_number;
-                        previous_table_id = table_id;
-                    }
-                    if (seg_iter == srv.segments.rbegin()) {
-                        // Last segment.
-                        last_table_id = table_id;
-                    }
-                    for (auto sec_iter = seg.sections.begin(); sec_iter != seg.sections.end(); ++sec_iter) {
-                        ESection& sec(**sec_iter);
-                        const uint8_t* pl = sec.section->payload();
-                        if (sec.section->sectionNumber() != section_number ||
-                            sec.section->lastSectionNumber() != last_section_number ||
-                            pl[4] != segment_last_section_number ||
-                            pl[5] != last_table_id)
-                        {
-                            if (sec.section->sectionNumber() != section_number) {
-                                sec.section->setSectionNumber(section_number, false);
-                                sec.updateVersion(this, false);
-                            }
-                            sec.section->setLastSectionNumber(last_section_number, false);
-                            sec.section->setUInt8(4, segment_last_section_number, false);
-                            sec.section->setUInt8(5, last_table_id, true);
+            // Build the new section with these events. The CRC32 is computed later.
+            const ByteBlockPtr data(NewSectionData(service_id, table_id, NextVersion(versions, table_id, service_id.service_id, section_number), section_number, section_number, events_size));
+            uint8_t* ev_data = data->data() + LONG_SECTION_HEADER_SIZE + EIT::EIT_PAYLOAD_FIXED_SIZE;
+            for (; ev_iter != ev_end; ++ev_iter) {
+                ::memcpy(ev_data, (*ev_iter)->event_data.data(), (*ev_iter)->event_data.size());
+                ev_data += (*ev_iter)->event_data.size();
+            }
+            const SectionPtr sec(new Section(data, PID_NULL, CRC32::IGNORE));
+            CheckNonNull(sec.pointer());
+
+            // The new section replaces the current one, if any.
+            seg.origin.push_back(NPOS);
+            seg.results.push_back(sec);
+            ++sec_index;
+            ++section_number;
+        }
+
+        // We need at least one section, possibly empty, in each segment.
+        if (seg.origin.empty()) {
+            const SectionPtr sec(new Section(NewSectionData(service_id, table_id, NextVersion(versions, table_id, service_id.service_id, first_section_number), first_section_number, first_section_number, 0), PID_NULL, CRC32::IGNORE));
+            CheckNonNull(sec.pointer());
+            seg.origin.push_back(NPOS);
+            seg.results.push_back(sec);
+        }
+    }
+
+    // Fix synthetic fields in all EIT-schedule sections: last_section_number, segment_last_section_number, last_table_id.
+    assert(!segments.empty());
+    assert(!segments.back().origin.empty());
+
+    size_t segment_number = segments.size();
+    TID previous_table_id = TID_NULL;
+    TID last_table_id = TID_NULL;
+    uint8_t last_section_number = 0;
+
+    // Loop on segments from last to first.
+    for (auto seg_iter = segments.rbegin(); seg_iter != segments.rend(); ++seg_iter) {
+        SegmentJob& seg(*seg_iter);
+        assert(!seg.origin.empty());
+
+        const TID table_id = EIT::SegmentToTableId(actual, --segment_number);
+        uint8_t section_number = EIT::SegmentToSection(segment_number);
+        const uint8_t segment_last_section_number = uint8_t(section_number + seg.origin.size() - 1);
+
+        if (table_id != previous_table_id) {
+            // Changed table. We are on the last segment of the previous table.
+            last_section_number = segment_last_section_number;
+            previous_table_id = table_id;
+        }
+        if (seg_iter == segments.rbegin()) {
+            // Last segment.
+            last_table_id = table_id;
+        }
+        for (size_t i = 0; i < seg.origin.size(); ++i) {
+            const Section& sec(seg.results[i].isNull() ? *seg.sections[seg.origin[i]] : *seg.results[i]);
+            const uint8_t* pl = sec.payload();
+            if (sec.sectionNumber() != section_number ||
+                sec.lastSectionNumber() != last_section_number ||
+                pl[4] != segment_last_section_number ||
+                pl[5] != last_table_id)
+            {
+                // The current binary section may be in use in a packetizer, modify a copy of it.
+                if (seg.results[i].isNull()) {
+                    seg.results[i] = new Section(sec, ShareMode::COPY);
+                    CheckNonNull(seg.results[i].pointer());
+                }
+                Section& msec(*seg.results[i]);
+                if (msec.sectionNumber() != section_number) {
+                    msec.setSectionNumber(section_number, false);
+                    msec.setVersion(NextVersion(versions, msec.tableId(), msec.tableIdExtension(), section_number), false);
+                }
+                msec.setLastSectionNumber(last_section_number, false);
+                msec.setUInt8(4, segment_last_section_number, false);
+                msec.setUInt8(5, last_table_id, false);
+            }
+            section_number++;
+        }
+    }
+
+    // Compute the CRC32 of all new or modified sections.
+    for (auto seg_iter = segments.begin(); seg_iter != segments.end(); ++seg_iter) {
+        for (auto sec_iter = seg_iter->results.begin(); sec_iter != seg_iter->results.end(); ++sec_iter) {
+            if (!sec_iter->isNull()) {
+                (*sec_iter)->recomputeCRC();
+            }
+        }
+    }
+
+    // The next job for the same service id continues with the updated versions.
+    if (!next.isNull()) {
+        next->versions = versions;
+        next->run();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Swap the results of a regeneration job into its service.
+//----------------------------------------------------------------------------
+
+void ts::EITGenerator::commitJob(ServiceJob& job, const Time& now)
+{
+    for (auto seg_job = job.segments.begin(); seg_job != job.segments.end(); ++seg_job) {
+
+        // Build the new list of sections in the segment.
+        std::vector<bool> reused(seg_job->esections.size(), false);
+        ESectionList sections;
+        for (size_t i = 0; i < seg_job->origin.size(); ++i) {
+            if (seg_job->origin[i] == NPOS) {
+                // New section, inject it as soon as possible.
+                const ESectionPtr sec(new ESection(seg_job->results[i]));
+                CheckNonNull(sec.pointer());
+                sections.push_back(sec);
+                enqueueInjectSection(sec, now);
+            }
+            else {
+                // Existing section, keep its position in the injection queue.
+                const ESectionPtr& sec(seg_job->esections[seg_job->origin[i]]);
+                reused[seg_job->origin[i]] = true;
+                sections.push_back(sec);
+                if (!seg_job->results[i].isNull()) {
+                    // Modified content. The previous binary section may still be referenced by the packetizer.
+                    sec->section = seg_job->results[i];
+                    sec->injected = false;
+                }
+            }
+        }
+
+        // Deallocate sections which are no longer used.
+        for (size_t i = 0; i < reused.size(); ++i) {
+            if (!reused[i]) {
+                markObsoleteSection(*seg_job->esections[i]);
+            }
+        }
+        seg_job->segment->sections.swap(sections);
+    }
+
+    // Update the versions of the EIT schedule sections of the service.
+    for (auto it = job.versions.begin(); it != job.versions.end(); ++it) {
+        _versions[it->first] = it->second;
+    }
+
+    // Commit the next job for the same service id, with the final versions.
+    if (!job.next.isNull()) {
+        commitJob(*job.next, now);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Management of the batch of regeneration jobs.
+//----------------------------------------------------------------------------
+
+bool ts::EITGenerator::waitJobs()
+{
+    if (_jobs.empty()) {
+        return false;
+    }
+    GuardCondition lock(_jobs_mutex, _jobs_done);
+    while (_jobs_completed < _jobs.size()) {
+        lock.waitCondition();
+    }
+    return true;
+}
+
+void ts::EITGenerator::commitJobs(const Time& now)
+{
+    for (auto it = _jobs.begin(); it != _jobs.end(); ++it) {
+        commitJob(**it, now);
+    }
+    GuardMutex lock(_jobs_mutex);
+    _jobs.clear();
+    _jobs_next = _jobs_completed = 0;
+}
+
+void ts::EITGenerator::cancelJobs()
+{
+    if (waitJobs()) {
+        // Mark the services and segments of the aborted jobs for regeneration.
+        for (auto it = _jobs.begin(); it != _jobs.end(); ++it) {
+            for (ServiceJob* job = it->pointer(); job != nullptr; job = job->next.pointer()) {
+                const auto srv = _services.find(job->service_id);
+                if (srv != _services.end()) {
+                    _regenerate = srv->second.regenerate = true;
+                    for (auto seg_job = job->segments.begin(); seg_job != job->segments.end(); ++seg_job) {
+                        if (seg_job->regenerate) {
+                            seg_job->segment->regenerate = true;
                         }
-                        section_number++;
                     }
                 }
             }
+        }
+        GuardMutex lock(_jobs_mutex);
+        _jobs.clear();
+        _jobs_next = _jobs_completed = 0;
+    }
+}
 
-            // Clear service regeneration flag.
-            srv.regenerate = false;
+
+//----------------------------------------------------------------------------
+// Set the number of worker threads for the regeneration of EIT schedule.
+//----------------------------------------------------------------------------
+
+void ts::EITGenerator::setRegenerationThreads(size_t count)
+{
+    if (count != _workers.size()) {
+        // The aborted jobs will be restarted in the new threads.
+        cancelJobs();
+        stopWorkers();
+        for (size_t i = 0; i < count; ++i) {
+            const RegenerationThreadPtr thread(new RegenerationThread(this));
+            CheckNonNull(thread.pointer());
+            _workers.push_back(thread);
+            thread->start();
         }
     }
+}
 
-    // Clear global regeneration flag.
-    _regenerate = false;
+void ts::EITGenerator::stopWorkers()
+{
+    if (!_workers.empty()) {
+        {
+            GuardCondition lock(_jobs_mutex, _jobs_start);
+            _jobs_terminate = true;
+            lock.signal();
+        }
+        _workers.clear();
+        _jobs_terminate = false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Worker thread running regeneration jobs.
+//----------------------------------------------------------------------------
+
+ts::EITGenerator::RegenerationThread::RegenerationThread(EITGenerator* gen) :
+    Thread(),
+    _gen(gen)
+{
+}
+
+ts::EITGenerator::RegenerationThread::~RegenerationThread()
+{
+    waitForTermination();
+}
+
+void ts::EITGenerator::RegenerationThread::main()
+{
+    for (;;) {
+        ServiceJob* job = nullptr;
+
+        // Wait for a job to run or for termination.
+        {
+            GuardCondition lock(_gen->_jobs_mutex, _gen->_jobs_start);
+            while (!_gen->_jobs_terminate && _gen->_jobs_next >= _gen->_jobs.size()) {
+                lock.waitCondition();
+            }
+            if (_gen->_jobs_terminate) {
+                // Propagate the termination to other threads.
+                lock.signal();
+                break;
+            }
+            job = _gen->_jobs[_gen->_jobs_next++].pointer();
+            if (_gen->_jobs_next < _gen->_jobs.size()) {
+                // More jobs to run, wake up another thread.
+                lock.signal();
+            }
+        }
+
+        // Build the sections outside the mutex.
+        job->run();
+
+        // Signal the completion of the batch.
+        GuardCondition lock(_gen->_jobs_mutex, _gen->_jobs_done);
+        if (++_gen->_jobs_completed == _gen->_jobs.size()) {
+            lock.signal();
+        }
+    }
 }
 
 
@@ -1135,13 +1493,10 @@ void ts::EITGenerator::provideSection(SectionCounter counter, SectionPtr& sectio
     // Loop on all injection queues, in decreasing order of priority.
     for (size_t index = 0; index < _injects.size(); ++index) {
 
-        // Check if the first section in the queue is ready for injection.
+        // Extract the first section in the queue if it is ready for injection.
         // Loop on obsolete events. Return on first injected event.
-        while (!_injects[index].empty() && _injects[index].front()->next_inject <= now) {
-
-            // Remove the first section from the queue.
-            const ESectionPtr sec(_injects[index].front());
-            _injects[index].pop_front();
+        ESectionPtr sec;
+        while (_injects[index].popReady(sec, ToTick(now))) {
 
             if (sec->obsolete) {
                 // This is an obsolete section, no longer in the base, drop it.
@@ -1154,7 +1509,7 @@ void ts::EITGenerator::provideSection(SectionCounter counter, SectionPtr& sectio
                 sec->injected = true;
 
                 // Requeue next iteration of that section.
-                enqueueInjectSection(sec, now + _profile.repetitionSeconds(*sec->section) * MilliSecPerSec, false);
+                enqueueInjectSection(sec, now + _profile.repetitionSeconds(*sec->section) * MilliSecPerSec);
                 _duck.report().log(2, u"inject section TID 0x%X (%<d), service 0x%X (%<d), at %s, requeue for %s",
                                    {section->tableId(), section->tableIdExtension(), now, sec->next_inject});
                 return;
@@ -1252,6 +1607,7 @@ void ts::EITGenerator::dumpInternalState(int lev) const
         rep.log(lev, u"Reference time: %s at packet %'d", {_ref_time, _ref_time_pkt});
         rep.log(lev, u"Obsolete sections count: %d", {_obsolete_count});
         rep.log(lev, u"Regenerate: %s", {_regenerate});
+        rep.log(lev, u"Regeneration threads: %d, pending jobs: %d", {_workers.size(), _jobs.size()});
 
         // Dump internal state of services.
         for (auto it1 = _services.begin(); it1 != _services.end(); ++it1) {
@@ -1280,9 +1636,7 @@ void ts::EITGenerator::dumpInternalState(int lev) const
         for (size_t index = 0; index < _injects.size(); ++index) {
             rep.log(lev, u"");
             rep.log(lev, u"- Injection queue #%d: %d sections", {index, _injects[index].size()});
-            for (auto it = _injects[index].begin(); it != _injects[index].end(); ++it) {
-                dumpSection(lev, u"  - ", *it);
-            }
+            _injects[index].forEach([this, lev](const ESectionPtr& sec, ESectionWheel::Tick) { dumpSection(lev, u"  - ", sec); });
         }
         rep.log(lev, u"");
     }
@@ -40,6 +40,10 @@
 #include "tsServiceIdTriplet.h"
 #include "tsTSPacket.h"
 #include "tsEnumUtils.h"
+#include "tsTimerWheel.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 
 namespace ts {
     //!
@@ -186,6 +190,10 @@ namespace ts {
     //!   - When an EIT section needs to be injected, we check the global "regenerate" flag. When
     //!     set, all services and segments are inspected and regenerated when necessary. All "regenerate"
     //!     flags are then cleared.
+    //! - The content of the EIT schedule sections of a service is built from a snapshot of its events
+    //!   and existing sections. This can be done by a pool of worker threads (see setRegenerationThreads()).
+    //!   In that case, the previous sections continue to be injected until all new sections are ready.
+    //!   They are then swapped in, in the packet processing thread, and the versions are updated there.
     //!
     //! @see ETSI EN 300 468, 5.2.4
     //! @see ETSI TS 101 211, 4.1.4
@@ -210,6 +218,11 @@ namespace ts {
                               EITOption options = EITOption::GEN_ALL | EITOption::LOAD_INPUT,
                               const EITRepetitionProfile& profile = EITRepetitionProfile::SatelliteCable);
 
+        //!
+        //! Destructor.
+        //!
+        ~EITGenerator();
+
         //!
         //! Reset the EIT generator to default state.
         //! The EPG content is deleted. The TS id and current time are forgotten.
@@ -230,6 +243,22 @@ namespace ts {
         //!
         void setProfile(const EITRepetitionProfile& profile) { _profile = profile; }
 
+        //!
+        //! Set the number of worker threads for the regeneration of EIT schedule.
+        //!
+        //! By default, there is no worker thread and the EIT schedule sections are regenerated
+        //! in the thread which calls processPacket(). Loading a large EPG or crossing midnight
+        //! may then create a spike of processing time in the packet processing path.
+        //!
+        //! With worker threads, the EIT schedule sections are rebuilt in the background while
+        //! the previous sections continue to be injected. The new sections are swapped in when
+        //! they are all ready. The exact packet where the new sections appear is consequently
+        //! not deterministic.
+        //!
+        //! @param [in] count Number of worker threads. Zero means synchronous regeneration.
+        //!
+        void setRegenerationThreads(size_t count);
+
         //!
         //! Define the "actual" transport stream id for generated EIT's.
         //! When this method is called, all events for the specified TS are stored in
@@ -405,6 +434,9 @@ namespace ts {
             // Constructor, build an empty section for the specified service (CRC32 not set).
             ESection(EITGenerator* gen, const ServiceIdTriplet& service_id, TID tid, uint8_t section_number, uint8_t last_section_number);
 
+            // Constructor from a section which was built by a regeneration job.
+            ESection(const SectionPtr& sec);
+
             // Indicate that the section will be modified. It the section is or has recently been used in a
             // packetizer, a copy of the section is created first to avoid corrupting the section being packetized.
             void startModifying();
@@ -468,12 +500,77 @@ namespace ts {
         // The injection lists are organized by repetition profile, in order of profile
         // priority (from EIT p/f actual to EID sched other/later). In each list, all
         // sections have the same profile and, consequently, the same repetition rate.
-        // The sections are sorted in order of next injection. When a section is ready
-        // to inject, it is passed to the packetizer and requeued at the end of the list
-        // for the next injection.
+        // The sections are stored in a timer wheel, indexed by next injection time in
+        // milliseconds. When a section is ready to inject, it is passed to the packetizer
+        // and requeued in the timer wheel for the next injection.
 
         typedef std::map<ServiceIdTriplet, EService> EServiceMap;
-        typedef std::array<ESectionList, EITRepetitionProfile::PROFILE_COUNT> ESectionListArray;
+        typedef TimerWheel<ESectionPtr> ESectionWheel;
+        typedef std::array<ESectionWheel, EITRepetitionProfile::PROFILE_COUNT> ESectionWheelArray;
+
+        // Last version of sections, indexed by TID, service id and section number.
+        typedef std::map<uint32_t, uint8_t> VersionMap;
+
+        // ----------------------------------------------
+        // Regeneration of the EIT schedule of a service
+        // ----------------------------------------------
+
+        // A ServiceJob builds the binary EIT schedule sections of one service. It works on a
+        // snapshot of the events, sections and versions of the service and never accesses the
+        // event database. Safe pointers in the snapshot are copied and released in the packet
+        // processing thread only. The method run() can be executed by a worker thread.
+        // The result is then swapped into the event database by commitJob().
+
+        class SegmentJob
+        {
+        public:
+            ESegmentPtr              segment;     // Segment in the event database (not used in run()).
+            bool                     regenerate;  // Rebuild the sections of the segment.
+            EventList                events;      // Snapshot of the events in the segment (when regenerated).
+            std::vector<ESectionPtr> esections;   // Current sections of the segment (not used in run()).
+            std::vector<SectionPtr>  sections;    // Snapshot of the binary content of the current sections.
+            std::vector<size_t>      origin;      // Result: for each new section, index in current sections or NPOS.
+            std::vector<SectionPtr>  results;     // Result: for each new section, new binary content or null if unchanged.
+
+            // Constructor.
+            SegmentJob();
+        };
+
+        class ServiceJob
+        {
+            TS_NOBUILD_NOCOPY(ServiceJob);
+        public:
+            const ServiceIdTriplet  service_id;  // Service of the EIT schedule.
+            const bool              actual;      // The service is in the actual TS.
+            std::vector<SegmentJob> segments;    // All segments in the service, starting at last midnight.
+            VersionMap              versions;    // Snapshot of the versions of EIT schedule sections in the service.
+            SafePtr<ServiceJob>     next;        // Next job for the same service id in another TS, sharing the same versions.
+
+            // Constructor.
+            ServiceJob(const ServiceIdTriplet& srv, bool act);
+
+            // Build the EIT schedule sections, fill the results in the segments.
+            // Then run the next jobs for the same service id, in sequence.
+            void run();
+        };
+
+        typedef SafePtr<ServiceJob> ServiceJobPtr;
+        typedef std::vector<ServiceJobPtr> ServiceJobVector;
+
+        // Worker thread running service jobs.
+        class RegenerationThread : public Thread
+        {
+            TS_NOBUILD_NOCOPY(RegenerationThread);
+        public:
+            RegenerationThread(EITGenerator* gen);
+            virtual ~RegenerationThread() override;
+        private:
+            EITGenerator* const _gen;
+            virtual void main() override;
+        };
+
+        typedef SafePtr<RegenerationThread> RegenerationThreadPtr;
+        typedef std::vector<RegenerationThreadPtr> RegenerationThreadVector;
 
         // ---------------------------
         // EITGenerator private fields
@@ -496,15 +593,29 @@ namespace ts {
         SectionDemux         _demux;             // Section demux for input stream, get PAT, TDT, TOT, EIT.
         Packetizer           _packetizer;        // Packetizer for generated EIT's.
         EServiceMap          _services;          // Map of services -> segments -> events and sections.
-        ESectionListArray    _injects;           // Arrays of sections for injection.
+        ESectionWheelArray   _injects;           // Arrays of sections for injection.
         size_t               _obsolete_count;    // Number of obsolete sections in the injection lists.
-        std::map<uint32_t,uint8_t> _versions;    // Last version of sections.
+        VersionMap           _versions;          // Last version of sections.
+        RegenerationThreadVector _workers;       // Worker threads for EIT schedule regeneration (none: synchronous).
+        ServiceJobVector     _jobs;              // Current batch of regeneration jobs, modified under mutex only.
+        Mutex                _jobs_mutex;        // Protect the following fields.
+        Condition            _jobs_start;        // Signaled when new jobs are available or on termination.
+        Condition            _jobs_done;         // Signaled when all jobs of the batch are completed.
+        size_t               _jobs_next;         // Index of next job to run in the batch.
+        size_t               _jobs_completed;    // Number of completed jobs in the batch.
+        bool                 _jobs_terminate;    // Request worker threads to terminate.
 
         // Set a bitrate field and update EIT inter-packet.
         void setBitRateField(BitRate EITGenerator::* field, const BitRate& bitrate);
 
         // Get next version of a section.
-        uint8_t nextVersion(TID tid, uint16_t service_id, uint8_t section_number);
+        uint8_t nextVersion(TID tid, uint16_t service_id, uint8_t section_number) { return NextVersion(_versions, tid, service_id, section_number); }
+        static uint8_t NextVersion(VersionMap& versions, TID tid, uint16_t service_id, uint8_t section_number);
+        static uint32_t VersionIndex(TID tid, uint16_t service_id, uint8_t section_number);
+
+        // Build the binary data of an EIT section for a service, with room for events after the fixed payload.
+        // The events and the CRC32 are not set.
+        static ByteBlockPtr NewSectionData(const ServiceIdTriplet& service_id, TID tid, uint8_t version, uint8_t section_number, uint8_t last_section_number, size_t events_size);
 
         // Update the EIT database according to the current time.
         // Obsolete events, sections and segments are discarded.
@@ -516,7 +627,26 @@ namespace ts {
         void regeneratePresentFollowingSection(const ServiceIdTriplet& service_id, ESectionPtr& sec, TID tid, bool section_number, const EventPtr& event, const Time&inject_time);
 
         // Regenerate all EIT schedule, create missing segments and sections.
-        void regenerateSchedule(const Time& now);
+        // With worker threads, the regeneration is asynchronous, unless wait is true.
+        void regenerateSchedule(const Time& now, bool wait = false);
+
+        // Build a regeneration job for a service, clear the regeneration flags of the service.
+        ServiceJobPtr newJob(const ServiceIdTriplet& service_id, EService& srv, bool actual);
+
+        // Swap the results of a regeneration job into its service.
+        void commitJob(ServiceJob& job, const Time& now);
+
+        // Wait for the completion of the current batch of jobs. Return false if there is no batch.
+        bool waitJobs();
+
+        // Swap in the results of all jobs in the current batch, which must be completed.
+        void commitJobs(const Time& now);
+
+        // Abort the current batch of jobs. Mark the corresponding services and segments for regeneration.
+        void cancelJobs();
+
+        // Stop all worker threads.
+        void stopWorkers();
 
         // Mark a section as obsolete, garbage collect obsolete sections if too many were not
         // naturally discarded from the injection lists. Also apply to entire segments.
@@ -524,7 +654,10 @@ namespace ts {
         void markObsoleteSegment(ESegment& seg);
 
         // Enqueue a section for injection.
-        void enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject, bool try_front);
+        void enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject);
+
+        // Convert a time into a tick in the injection timer wheels (milliseconds since Epoch).
+        static ESectionWheel::Tick ToTick(const Time& time) { return ESectionWheel::Tick(time - Time::Epoch); }
 
         // Helper for dumpInternalState()
         void dumpSection(int level, const UString& margin, const ESectionPtr& section) const;
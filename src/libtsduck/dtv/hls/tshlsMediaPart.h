@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Description of a partial segment in a low-latency HLS playlist.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tshlsMediaElement.h"
+#include "tsTS.h"
+
+namespace ts {
+    namespace hls {
+        //!
+        //! Description of a partial segment in a low-latency HLS playlist.
+        //! A partial segment is described by an EXT-X-PART tag. It is usually
+        //! a byte range inside the parent media segment which is still being built.
+        //! The same structure is used to describe an EXT-X-PRELOAD-HINT.
+        //! @ingroup hls
+        //! @see draft-pantos-hls-rfc8216bis-10, section 4.4.4.9
+        //!
+        class TSDUCKDLL MediaPart : public MediaElement
+        {
+        public:
+            //!
+            //! Constructor.
+            //!
+            MediaPart();
+
+            //!
+            //! Destructor.
+            //!
+            virtual ~MediaPart() override;
+
+            // Public fields.
+            MilliSecond duration;         //!< Partial segment duration in milliseconds.
+            uint64_t    byteRangeStart;   //!< Offset of the partial segment in the resource.
+            uint64_t    byteRangeLength;  //!< Size in bytes of the partial segment, zero means up to the end of the resource.
+            bool        independent;      //!< The partial segment contains an independent frame.
+            bool        gap;              //!< Media is a "gap", should not be loaded by clients.
+        };
+    }
+}
@@ -39,7 +39,8 @@ ts::hls::MediaSegment::MediaSegment() :
     title(),
     duration(0),
     bitrate(0),
-    gap(false)
+    gap(false),
+    parts()
 {
 }
 
@@ -33,7 +33,7 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include "tshlsMediaElement.h"
+#include "tshlsMediaPart.h"
 #include "tsTCPServer.h"
 #include "tsTS.h"
 
@@ -61,6 +61,7 @@ namespace ts {
             MilliSecond duration;  //!< Segment duration in milliseconds.
             BitRate     bitrate;   //!< Indicative bitrate.
             bool        gap;       //!< Media is a "gap", should not be loaded by clients.
+            std::vector<MediaPart> parts;  //!< Partial segments of this segment (low-latency HLS).
         };
     }
 }
@@ -53,6 +53,9 @@ ts::hls::PlayList::PlayList() :
     _segments(),
     _playlists(),
     _altPlaylists(),
+    _partTarget(0),
+    _parts(),
+    _preloadHint(),
     _loadedContent(),
     _autoSaveDir()
 {
@@ -80,6 +83,9 @@ void ts::hls::PlayList::clear()
     _segments.clear();
     _playlists.clear();
     _altPlaylists.clear();
+    _partTarget = 0;
+    _parts.clear();
+    _preloadHint = MediaPart();
     _loadedContent.clear();
     // Preserve _autoSaveDir
 }
@@ -190,6 +196,17 @@ bool ts::hls::PlayList::setTargetDuration(ts::Second duration, Report& report)
     }
 }
 
+bool ts::hls::PlayList::setPartTarget(MilliSecond duration, Report& report)
+{
+    if (setTypeMedia(report)) {
+        _partTarget = duration;
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
 bool ts::hls::PlayList::setMediaSequence(size_t seq, Report& report)
 {
     if (setTypeMedia(report)) {
@@ -295,10 +312,25 @@ bool ts::hls::PlayList::addSegment(const MediaSegment& seg, Report& report)
     else if (setTypeMedia(report)) {
         // Add the segment.
         _segments.push_back(seg);
-        // Build a relative URI.
-        if (!_isURL && !_original.empty()) {
-            // The playlist's URI is a file name, update the segment's URI.
-            _segments.back().relativeURI = RelativeFilePath(seg.relativeURI, _fileBase, FileSystemCaseSensitivity, true);
+        MediaSegment& last(_segments.back());
+        makeRelativeURI(last);
+        // The pending partial segments belong to this new segment.
+        if (last.parts.empty()) {
+            last.parts.swap(_parts);
+        }
+        else {
+            for (auto& part : last.parts) {
+                makeRelativeURI(part);
+            }
+        }
+        _parts.clear();
+        // Partial segments older than three target durations are no longer useful to clients.
+        MilliSecond recent = 0;
+        for (auto it = _segments.rbegin(); it != _segments.rend(); ++it) {
+            if (recent >= 3 * _targetDuration * MilliSecPerSec) {
+                it->parts.clear();
+            }
+            recent += it->duration;
         }
         return true;
     }
@@ -308,6 +340,45 @@ bool ts::hls::PlayList::addSegment(const MediaSegment& seg, Report& report)
 }
 
 
+bool ts::hls::PlayList::addPart(const MediaPart& part, Report& report)
+{
+    if (part.relativeURI.empty()) {
+        report.error(u"empty partial segment URI");
+        return false;
+    }
+    else if (setTypeMedia(report)) {
+        _parts.push_back(part);
+        makeRelativeURI(_parts.back());
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+
+bool ts::hls::PlayList::setPreloadHint(const MediaPart& hint, Report& report)
+{
+    if (setTypeMedia(report)) {
+        _preloadHint = hint;
+        makeRelativeURI(_preloadHint);
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+
+void ts::hls::PlayList::makeRelativeURI(MediaElement& media) const
+{
+    if (!_isURL && !_original.empty() && !media.relativeURI.empty()) {
+        // The playlist's URI is a file name, update the media's URI.
+        media.relativeURI = RelativeFilePath(media.relativeURI, _fileBase, FileSystemCaseSensitivity, true);
+    }
+}
+
+
 bool ts::hls::PlayList::addPlayList(const MediaPlayList& pl, Report& report)
 {
     if (pl.relativeURI.empty()) {
@@ -1176,10 +1247,19 @@ ts::UString ts::hls::PlayList::textContent(ts::Report &report) const
         else if (_type == PlayListType::EVENT) {
             text.format(u"#%s:EVENT\n", {TagNames.name(PLAYLIST_TYPE)});
         }
+        if (_partTarget > 0) {
+            // Low-latency HLS: the recommended hold back is three part target durations.
+            const MilliSecond holdBack = 3 * _partTarget;
+            text.format(u"#%s:PART-HOLD-BACK=%d.%03d\n", {TagNames.name(SERVER_CONTROL), holdBack / MilliSecPerSec, holdBack % MilliSecPerSec});
+            text.format(u"#%s:PART-TARGET=%d.%03d\n", {TagNames.name(PART_INF), _partTarget / MilliSecPerSec, _partTarget % MilliSecPerSec});
+        }
 
         // Loop on all media segments.
         for (const auto& seg : _segments) {
             if (!seg.relativeURI.empty()) {
+                for (const auto& part : seg.parts) {
+                    formatPart(text, part);
+                }
                 text.format(u"#%s:%d.%03d,%s\n", {TagNames.name(EXTINF), seg.duration / MilliSecPerSec, seg.duration % MilliSecPerSec, seg.title});
                 if (seg.bitrate > 1024) {
                     text.format(u"#%s:%d\n", {TagNames.name(BITRATE), (seg.bitrate / 1024).toInt()});
@@ -1191,6 +1271,18 @@ ts::UString ts::hls::PlayList::textContent(ts::Report &report) const
             }
         }
 
+        // Partial segments of the segment which is currently built.
+        for (const auto& part : _parts) {
+            formatPart(text, part);
+        }
+        if (!_endList && !_preloadHint.relativeURI.empty()) {
+            text.format(u"#%s:TYPE=PART,URI=\"%s\"", {TagNames.name(PRELOAD_HINT), _preloadHint.relativeURI});
+            if (_preloadHint.byteRangeStart > 0) {
+                text.format(u",BYTERANGE-START=%d", {_preloadHint.byteRangeStart});
+            }
+            text.append(u'\n');
+        }
+
         // Mark end of list when necessary.
         if (_endList) {
             text.format(u"#%s\n", {TagNames.name(ENDLIST)});
@@ -1203,3 +1295,25 @@ ts::UString ts::hls::PlayList::textContent(ts::Report &report) const
 
     return text;
 }
+
+
+//----------------------------------------------------------------------------
+// Format an EXT-X-PART tag.
+//----------------------------------------------------------------------------
+
+void ts::hls::PlayList::formatPart(UString& text, const MediaPart& part)
+{
+    if (!part.relativeURI.empty()) {
+        text.format(u"#%s:DURATION=%d.%03d,URI=\"%s\"", {TagNames.name(PART), part.duration / MilliSecPerSec, part.duration % MilliSecPerSec, part.relativeURI});
+        if (part.byteRangeLength > 0) {
+            text.format(u",BYTERANGE=\"%d@%d\"", {part.byteRangeLength, part.byteRangeStart});
+        }
+        if (part.independent) {
+            text.append(u",INDEPENDENT=YES");
+        }
+        if (part.gap) {
+            text.append(u",GAP=YES");
+        }
+        text.append(u'\n');
+    }
+}
@@ -317,6 +317,47 @@ namespace ts {
             //!
             bool addSegment(const MediaSegment& seg, Report& report = CERR);
 
+            //!
+            //! Get the partial segment target duration (low-latency media playlist).
+            //! @return The partial segment target duration in milliseconds, zero if there is no partial segment.
+            //!
+            MilliSecond partTarget() const { return _partTarget; }
+
+            //!
+            //! Set the partial segment target duration in a low-latency media playlist.
+            //! When non zero, the EXT-X-PART-INF and EXT-X-SERVER-CONTROL tags are generated.
+            //! @param [in] duration The partial segment target duration in milliseconds.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool setPartTarget(MilliSecond duration, Report& report = CERR);
+
+            //!
+            //! Get the number of partial segments after the last complete media segment (low-latency media playlist).
+            //! @return The number of partial segments of the media segment which is currently built.
+            //!
+            size_t pendingPartCount() const { return _parts.size(); }
+
+            //!
+            //! Add a partial segment of the media segment which is currently built (low-latency media playlist).
+            //! The pending partial segments are attached to the next media segment which is added with addSegment().
+            //! Partial segments of media segments which are older than three target durations are automatically dropped.
+            //! @param [in] part The new partial segment to append. If the playlist's URI is a file
+            //! name, the URI of the partial segment is transformed into a relative URI from the playlist's path.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool addPart(const MediaPart& part, Report& report = CERR);
+
+            //!
+            //! Set the preload hint of the next partial segment (low-latency media playlist).
+            //! @param [in] hint Description of the next partial segment, only the URI and byte range start
+            //! are used. If the URI is empty, the EXT-X-PRELOAD-HINT tag is removed.
+            //! @param [in,out] report Where to report errors.
+            //! @return True on success, false on error.
+            //!
+            bool setPreloadHint(const MediaPart& hint, Report& report = CERR);
+
             //!
             //! Get the download UTC time of the playlist.
             //! @return The download UTC time of the playlist.
@@ -440,6 +481,7 @@ namespace ts {
             typedef std::deque<MediaSegment> MediaSegmentQueue;
             typedef std::deque<MediaPlayList> MediaPlayListQueue;
             typedef std::deque<AltPlayList> AltPlayListQueue;
+            typedef std::vector<MediaPart> MediaPartVector;
 
             bool               _valid;           // Content loaded and valid.
             int                _version;         // Playlist format version.
@@ -456,6 +498,9 @@ namespace ts {
             MediaSegmentQueue  _segments;        // List of media segments (media playlist).
             MediaPlayListQueue _playlists;       // List of media playlists (master playlist).
             AltPlayListQueue   _altPlaylists;    // List of alternative rendition media playlists (master playlist).
+            MilliSecond        _partTarget;      // Partial segment target duration (low-latency media playlist).
+            MediaPartVector    _parts;           // Partial segments after the last complete segment (low-latency media playlist).
+            MediaPart          _preloadHint;     // Next expected partial segment (low-latency media playlist).
             UStringList        _loadedContent;   // Loaded text content (can be different from current content).
             UString            _autoSaveDir;     // If not empty, automatically save loaded playlist to this directory.
 
@@ -474,6 +519,12 @@ namespace ts {
 
             // Perform automatic save of the loaded playlist.
             bool autoSave(Report& report);
+
+            // Format an EXT-X-PART tag.
+            static void formatPart(UString& text, const MediaPart& part);
+
+            // Build a relative URI for a segment or part.
+            void makeRelativeURI(MediaElement& media) const;
         };
     }
 }
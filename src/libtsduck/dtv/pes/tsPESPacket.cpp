@@ -34,6 +34,7 @@
 #include "tsHEVC.h"
 #include "tsVVC.h"
 #include "tsAccessUnitIterator.h"
+#include "tsStartCode.h"
 #include "tsAVCAccessUnitDelimiter.h"
 #include "tsHEVCAccessUnitDelimiter.h"
 #include "tsVVCAccessUnitDelimiter.h"
@@ -570,8 +571,7 @@ size_t ts::PESPacket::FindIntraImage(const uint8_t* data, size_t size, uint8_t s
         // The beginning of the PES payload is already a start code prefix in MPEG-1/2.
         while (pl_size > 0) {
             // Look for next start code
-            static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
-            const uint8_t* pl_next = LocatePattern(pl_data + 1, pl_size - 1, StartCodePrefix, sizeof(StartCodePrefix));
+            const uint8_t* pl_next = LocateStartCodePrefix(pl_data + 1, pl_size - 1);
             if (pl_next == nullptr) {
                 // No next start code, current one extends up to the end of the payload.
                 pl_next = pl_data + pl_size;
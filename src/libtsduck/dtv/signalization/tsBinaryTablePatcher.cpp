@@ -0,0 +1,322 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsBinaryTablePatcher.h"
+#include "tsSection.h"
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::BinaryTablePatcher::BinaryTablePatcher() :
+    _payloads(),
+    _modified(0)
+{
+}
+
+ts::BinaryTablePatcher::Location::Location() :
+    table_id(TID_NULL),
+    table_id_ext(0),
+    global(true),
+    entry_id(0),
+    entry_info(0)
+{
+}
+
+ts::BinaryTablePatcher::Handler::~Handler()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Default implementation of the handler.
+//----------------------------------------------------------------------------
+
+bool ts::BinaryTablePatcher::Handler::keepEntry(const Location&)
+{
+    return true;
+}
+
+void ts::BinaryTablePatcher::Handler::patchDescriptorList(DescriptorList&, const Location&)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the layout of a table is known.
+//----------------------------------------------------------------------------
+
+bool ts::BinaryTablePatcher::IsSupported(TID tid)
+{
+    switch (tid) {
+        case TID_PAT:
+        case TID_CAT:
+        case TID_PMT:
+        case TID_NIT_ACT:
+        case TID_NIT_OTH:
+        case TID_SDT_ACT:
+        case TID_SDT_OTH:
+        case TID_BAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Patch a binary table in place.
+//----------------------------------------------------------------------------
+
+bool ts::BinaryTablePatcher::patch(BinaryTable& table, Handler& handler)
+{
+    _modified = 0;
+
+    if (!table.isValid() || !IsSupported(table.tableId())) {
+        return false;
+    }
+
+    // First pass: build all new payloads. Nothing is modified in the table
+    // until we know that all sections can be patched.
+    const size_t count = table.sectionCount();
+    if (_payloads.size() < count) {
+        _payloads.resize(count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const SectionPtr sect(table.sectionAt(i));
+        if (sect.isNull() || !sect->isValid() || !sect->isLongSection() || !patchSection(*sect, _payloads[i], handler)) {
+            return false;
+        }
+    }
+
+    // Second pass: replace the payloads of modified sections.
+    for (size_t i = 0; i < count; ++i) {
+        const SectionPtr sect(table.sectionAt(i));
+        const ByteBlock& pl(_payloads[i]);
+        if (pl.size() != sect->payloadSize() || ::memcmp(pl.data(), sect->payload(), pl.size()) != 0) {
+            sect->truncatePayload(0, false);
+            sect->appendPayload(pl, false);
+            sect->recomputeCRC();
+            _modified++;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Build the patched payload of one section.
+//----------------------------------------------------------------------------
+
+bool ts::BinaryTablePatcher::patchSection(const Section& section, ByteBlock& out, Handler& handler)
+{
+    const size_t max_size = section.isPrivateSection() ? MAX_PRIVATE_LONG_SECTION_PAYLOAD_SIZE : MAX_PSI_LONG_SECTION_PAYLOAD_SIZE;
+    const uint8_t* data = section.payload();
+    size_t size = section.payloadSize();
+
+    Location loc;
+    loc.table_id = section.tableId();
+    loc.table_id_ext = section.tableIdExtension();
+    out.clear();
+
+    switch (loc.table_id) {
+        case TID_PAT: {
+            // Only a loop of service entries, without descriptors.
+            loc.global = false;
+            for (; size >= 4; data += 4, size -= 4) {
+                loc.entry_id = GetUInt16(data);
+                loc.entry_info = GetUInt16(data + 2) & 0x1FFF;
+                if (handler.keepEntry(loc)) {
+                    out.append(data, 4);
+                }
+            }
+            break;
+        }
+        case TID_CAT: {
+            // Only one global descriptor loop, without length field.
+            DescriptorList dlist(nullptr);
+            if (!dlist.add(data, size)) {
+                return false;
+            }
+            handler.patchDescriptorList(dlist, loc);
+            out.resize(max_size);
+            uint8_t* addr = out.data();
+            size_t remain = max_size;
+            if (dlist.serialize(addr, remain) < dlist.count()) {
+                return false;
+            }
+            out.resize(max_size - remain);
+            size = 0;
+            break;
+        }
+        case TID_PMT: {
+            // PCR PID, program info loop, elementary streams loop.
+            if (size < 4) {
+                return false;
+            }
+            out.append(data, 2);
+            data += 2; size -= 2;
+            if (!PatchLoop(data, size, out, max_size, loc, handler)) {
+                return false;
+            }
+            loc.global = false;
+            while (size >= 5) {
+                const size_t len = 5 + (GetUInt16(data + 3) & 0x0FFF);
+                if (len > size) {
+                    return false;
+                }
+                loc.entry_info = data[0];
+                loc.entry_id = GetUInt16(data + 1) & 0x1FFF;
+                if (handler.keepEntry(loc)) {
+                    out.append(data, 3);
+                    data += 3; size -= 3;
+                    if (!PatchLoop(data, size, out, max_size, loc, handler)) {
+                        return false;
+                    }
+                }
+                else {
+                    data += len; size -= len;
+                }
+            }
+            break;
+        }
+        case TID_NIT_ACT:
+        case TID_NIT_OTH:
+        case TID_BAT: {
+            // Network descriptors loop, transport stream loop.
+            if (!PatchLoop(data, size, out, max_size, loc, handler) || size < 2) {
+                return false;
+            }
+            // Transport stream loop length, updated at end of loop.
+            const size_t loop_length_index = out.size();
+            const uint16_t reserved = GetUInt16(data) & 0xF000;
+            out.appendUInt16(0);
+            data += 2; size -= 2;
+            loc.global = false;
+            while (size >= 6) {
+                const size_t len = 6 + (GetUInt16(data + 4) & 0x0FFF);
+                if (len > size) {
+                    return false;
+                }
+                loc.entry_id = GetUInt16(data);
+                loc.entry_info = GetUInt16(data + 2);
+                if (handler.keepEntry(loc)) {
+                    out.append(data, 4);
+                    data += 4; size -= 4;
+                    if (!PatchLoop(data, size, out, max_size, loc, handler)) {
+                        return false;
+                    }
+                }
+                else {
+                    data += len; size -= len;
+                }
+            }
+            PutUInt16(out.data() + loop_length_index, reserved | uint16_t((out.size() - loop_length_index - 2) & 0x0FFF));
+            break;
+        }
+        case TID_SDT_ACT:
+        case TID_SDT_OTH: {
+            // Original network id, reserved byte, service loop.
+            if (size < 3) {
+                return false;
+            }
+            loc.global = false;
+            loc.entry_info = GetUInt16(data);
+            out.append(data, 3);
+            data += 3; size -= 3;
+            while (size >= 5) {
+                const size_t len = 5 + (GetUInt16(data + 3) & 0x0FFF);
+                if (len > size) {
+                    return false;
+                }
+                loc.entry_id = GetUInt16(data);
+                if (handler.keepEntry(loc)) {
+                    out.append(data, 3);
+                    data += 3; size -= 3;
+                    if (!PatchLoop(data, size, out, max_size, loc, handler)) {
+                        return false;
+                    }
+                }
+                else {
+                    data += len; size -= len;
+                }
+            }
+            break;
+        }
+        default: {
+            return false;
+        }
+    }
+
+    // Reject trailing garbage (malformed section) and overflows.
+    return size == 0 && out.size() <= max_size;
+}
+
+
+//----------------------------------------------------------------------------
+// Patch a descriptor loop which is preceded by a 12-bit length field.
+//----------------------------------------------------------------------------
+
+bool ts::BinaryTablePatcher::PatchLoop(const uint8_t*& data, size_t& size, ByteBlock& out, size_t max_size, const Location& loc, Handler& handler)
+{
+    // Get the input descriptor loop.
+    if (size < 2) {
+        return false;
+    }
+    const uint16_t reserved = GetUInt16(data) & 0xF000;
+    const size_t len = GetUInt16(data) & 0x0FFF;
+    if (len + 2 > size) {
+        return false;
+    }
+
+    // Load the descriptor loop and let the handler modify it.
+    DescriptorList dlist(nullptr);
+    if (!dlist.add(data + 2, len)) {
+        return false;
+    }
+    data += 2 + len;
+    size -= 2 + len;
+    handler.patchDescriptorList(dlist, loc);
+
+    // Serialize the descriptor list in the output payload, after the length field.
+    const size_t start = out.size();
+    if (start + 2 > max_size) {
+        return false;
+    }
+    out.resize(max_size);
+    uint8_t* addr = out.data() + start + 2;
+    size_t remain = max_size - start - 2;
+    if (dlist.serialize(addr, remain) < dlist.count()) {
+        return false;
+    }
+    out.resize(max_size - remain);
+    PutUInt16(out.data() + start, reserved | uint16_t((out.size() - start - 2) & 0x0FFF));
+    return true;
+}
@@ -0,0 +1,150 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  In-place patching of descriptor loops and loop entries in binary tables.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsBinaryTable.h"
+#include "tsDescriptorList.h"
+#include "tsByteBlock.h"
+
+namespace ts {
+    //!
+    //! In-place patching of descriptor loops and loop entries in binary tables.
+    //! @ingroup mpeg
+    //!
+    //! The usual way to modify a table is to deserialize it (e.g. a NIT object from a
+    //! BinaryTable), modify the C++ structure and reserialize it. With large tables,
+    //! this is a lot of work when only a few descriptors are modified.
+    //!
+    //! This class directly patches the binary sections of a table, without full
+    //! deserialization. It knows the layout of the main PSI/SI tables (PAT, CAT, PMT,
+    //! NIT, SDT, BAT). Each descriptor loop is presented to a handler which can
+    //! modify it and each loop entry (transport stream, service, elementary stream)
+    //! can be removed. The other parts of the sections are left unchanged. The
+    //! section layout of the table is preserved: the table is never resplit.
+    //!
+    //! If one section would overflow after modification, the patch fails and the table
+    //! is left unmodified. The application shall then fall back to a full
+    //! deserialization / modification / serialization of the table.
+    //!
+    class TSDUCKDLL BinaryTablePatcher
+    {
+        TS_NOCOPY(BinaryTablePatcher);
+    public:
+        //!
+        //! Location of a descriptor loop or a loop entry in a table.
+        //!
+        class TSDUCKDLL Location
+        {
+        public:
+            TID      table_id;      //!< Table id of the section.
+            uint16_t table_id_ext;  //!< Table id extension of the section.
+            bool     global;        //!< True for the top-level descriptor loop, false for a loop entry.
+            uint16_t entry_id;      //!< Loop entry id: transport stream id (NIT, BAT), service id (SDT, PAT), elementary PID (PMT).
+            uint16_t entry_info;    //!< Loop entry info: original network id (NIT, BAT, SDT), PMT PID (PAT), stream type (PMT).
+            //!
+            //! Default constructor.
+            //!
+            Location();
+        };
+
+        //!
+        //! Interface which is invoked to modify the content of a table.
+        //!
+        class TSDUCKDLL Handler
+        {
+        public:
+            //!
+            //! Invoked for each entry of the main loop in a section.
+            //! The default implementation keeps all entries.
+            //! @param [in] loc Location of the loop entry.
+            //! @return True to keep the entry, false to remove it.
+            //!
+            virtual bool keepEntry(const Location& loc);
+
+            //!
+            //! Invoked for each descriptor loop in a section.
+            //! The default implementation does not modify the descriptors.
+            //! @param [in,out] dlist Descriptor list from the section. The descriptor list is
+            //! not attached to any table. It can be modified by the handler.
+            //! @param [in] loc Location of the descriptor loop.
+            //!
+            virtual void patchDescriptorList(DescriptorList& dlist, const Location& loc);
+
+            //!
+            //! Virtual destructor.
+            //!
+            virtual ~Handler();
+        };
+
+        //!
+        //! Constructor.
+        //!
+        BinaryTablePatcher();
+
+        //!
+        //! Check if the layout of a table is known and the table can be patched.
+        //! @param [in] tid Table id.
+        //! @return True if tables with that id can be patched.
+        //!
+        static bool IsSupported(TID tid);
+
+        //!
+        //! Patch a binary table in place.
+        //! The sections of the table are directly modified. The CRC32 of each modified section
+        //! is recomputed. Unmodified sections are not touched.
+        //! @param [in,out] table The table to patch.
+        //! @param [in,out] handler The handler which is invoked on each loop entry and descriptor loop.
+        //! @return True on success, false if the table is not supported, is malformed or if a section
+        //! would overflow after modification. In case of error, @a table is left unmodified.
+        //!
+        bool patch(BinaryTable& table, Handler& handler);
+
+        //!
+        //! Get the number of sections which were modified by the last successful call to patch().
+        //! @return The number of modified sections.
+        //!
+        size_t modifiedSections() const { return _modified; }
+
+    private:
+        std::vector<ByteBlock> _payloads;  // New payloads of each section, reused between calls to limit allocations.
+        size_t                 _modified;  // Number of sections modified in last patch.
+
+        // Build the patched payload of one section. Return false on malformed section or overflow.
+        bool patchSection(const Section& section, ByteBlock& out, Handler& handler);
+
+        // Patch a descriptor loop which is preceded by a 12-bit length field.
+        // Input data and size are updated after the loop. Return false on error.
+        static bool PatchLoop(const uint8_t*& data, size_t& size, ByteBlock& out, size_t max_size, const Location& loc, Handler& handler);
+    };
+}
@@ -115,6 +115,8 @@ ts::TablesLogger::TablesLogger(TablesDisplay& display) :
     _xml_doc(_report),
     _x2j_conv(_report),
     _json_doc(_report),
+    _log_xml_writer(),
+    _log_json_writer(),
     _bin_file(),
     _sock(false, _report),
     _short_sections(),
@@ -488,6 +490,12 @@ bool ts::TablesLogger::open()
     _xml_doc.setTweaks(_xml_tweaks);
     _x2j_conv.setTweaks(_xml_tweaks);
 
+    // One-liners are formatted using the default XML options and the converter options, as if they
+    // were a complete document with a "tsduck" root.
+    _log_xml_writer.setOneLiner(true);
+    _log_json_writer.setOneLiner(true);
+    _log_json_writer.setJSON(&_x2j_conv, u"tsduck");
+
     // Open/create the XML output.
     if (_use_xml && !_rewrite_xml && _xml_doc.open(u"tsduck", u"", _xml_destination, std::cout) == nullptr) {
         _abort = true;
@@ -890,32 +898,19 @@ void ts::TablesLogger::logXMLJSON(const BinaryTable& table)
         return;
     }
 
-    // Initialize a text formatter for one-liner.
-    TextFormatter text(_report);
-    text.setString();
-    text.setEndOfLineMode(TextFormatter::EndOfLineMode::SPACING);
-
-    // Log the XML line.
+    // Log the XML line: the complete document, formatted by a streaming writer.
     if (_log_xml_line) {
-        doc.print(text);
-        _report.info(_log_xml_prefix + text.toString());
+        _log_xml_writer.clear();
+        _log_xml_writer.addDocument(doc);
+        _report.info(_log_xml_prefix + _log_xml_writer.toString());
     }
 
-    // Log the JSON line.
+    // Log the JSON line: the table only, converted and formatted by a streaming writer.
+    // Since the "tsduck" root is implicit, the path to the first table is always the same.
     if (_log_json_line) {
-
-        // Convert the XML document into JSON.
-        // Force "tsduck" root to appear so that the path to the first table is always the same.
-        const json::ValuePtr root(_x2j_conv.convertToJSON(doc, true));
-
-        // Reset the text formatter if already used for XML.
-        if (_log_xml_line) {
-            text.setString();
-        }
-
-        // Query the first (and only) converted table and log it as one line.
-        root->query(u"#nodes[0]").print(text);
-        _report.info(_log_json_prefix + text.toString());
+        _log_json_writer.clear();
+        _log_json_writer.addElement(*elem);
+        _report.info(_log_json_prefix + _log_json_writer.toString());
     }
 }
 
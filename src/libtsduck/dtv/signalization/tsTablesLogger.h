@@ -46,6 +46,7 @@
 #include "tsxmlTweaks.h"
 #include "tsxmlRunningDocument.h"
 #include "tsxmlJSONConverter.h"
+#include "tsxmlStreamWriter.h"
 #include "tsjsonRunningDocument.h"
 
 namespace ts {
@@ -237,6 +238,8 @@ namespace ts {
         xml::RunningDocument     _xml_doc;           // XML document, built on-the-fly.
         xml::JSONConverter       _x2j_conv;          // XML-to-JSON converter.
         json::RunningDocument    _json_doc;          // JSON document, built on-the-fly.
+        xml::StreamWriter        _log_xml_writer;    // Streaming writer for XML one-liners.
+        xml::StreamWriter        _log_json_writer;   // Streaming writer for JSON one-liners.
         std::ofstream            _bin_file;          // Binary output file.
         UDPSocket                _sock;              // Output socket.
         std::map<PID,ByteBlock>  _short_sections;    // Tracking duplicate short sections by PID with a section hash.
@@ -32,3 +32,10 @@
 ts::T2MIHandlerInterface::~T2MIHandlerInterface()
 {
 }
+
+void ts::T2MIHandlerInterface::handleTSPackets(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket* ts, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        handleTSPacket(demux, t2mi, ts[i]);
+    }
+}
@@ -76,6 +76,18 @@ namespace ts {
         //!
         virtual void handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts) = 0;
 
+        //!
+        //! This hook is invoked when new TS packets are extracted from one T2-MI packet.
+        //! The packets are passed directly from the internal buffer of the demux, without copy.
+        //! The default implementation invokes handleTSPacket() for each packet. Applications
+        //! which process packets in groups (typically to write them) may override this method.
+        //! @param [in,out] demux A reference to the T2-MI demux.
+        //! @param [in] t2mi The T2-MI packet from which @a ts were extracted.
+        //! @param [in] ts Address of the first extracted TS packet.
+        //! @param [in] count Number of contiguous extracted TS packets.
+        //!
+        virtual void handleTSPackets(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket* ts, size_t count);
+
         //!
         //! Virtual destructor.
         //!
@@ -27,9 +27,13 @@
 //
 //----------------------------------------------------------------------------
 
+
 #include "tsTimeShiftBuffer.h"
 #include "tsNullReport.h"
 #include "tsFileUtils.h"
+#include "tsGuardCondition.h"
+#include "tsGuardMutex.h"
+#include "tsMonotonic.h"
 
 #if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
 constexpr size_t ts::TimeShiftBuffer::MIN_TOTAL_PACKETS;
@@ -44,6 +48,7 @@ constexpr size_t ts::TimeShiftBuffer::DEFAULT_MEMORY_PACKETS;
 //----------------------------------------------------------------------------
 
 ts::TimeShiftBuffer::TimeShiftBuffer(size_t count) :
+    Thread(),
     _is_open(false),
     _cur_packets(0),
     _total_packets(std::max(count, MIN_TOTAL_PACKETS)),
@@ -52,13 +57,20 @@ ts::TimeShiftBuffer::TimeShiftBuffer(size_t count) :
     _file(),
     _next_read(0),
     _next_write(0),
-    _wcache_next(0),
-    _rcache_end(0),
-    _rcache_next(0),
+    _read_ahead(0),
+    _read_started(false),
+    _wcur(0),
+    _rcur(0),
+    _buffer(),
+    _mdata(),
     _wcache(),
     _rcache(),
-    _wmdata(),
-    _rmdata()
+    _mutex(),
+    _io_request(),
+    _io_done(),
+    _io_queue(),
+    _io_terminate(false),
+    _stats()
 {
 }
 
@@ -67,6 +79,29 @@ ts::TimeShiftBuffer::~TimeShiftBuffer()
     close(NULLREP);
 }
 
+ts::TimeShiftBuffer::Statistics::Statistics() :
+    read_count(0),
+    write_count(0),
+    io_time(0),
+    io_max(0),
+    wait_count(0),
+    wait_time(0),
+    wait_max(0)
+{
+}
+
+ts::TimeShiftBuffer::Cache::Cache() :
+    pkt(),
+    mdata(),
+    index(0),
+    count(0),
+    next(0),
+    write(false),
+    pending(false),
+    success(true)
+{
+}
+
 
 //----------------------------------------------------------------------------
 // Set various characteristics, must be called before open.
@@ -117,12 +152,12 @@ bool ts::TimeShiftBuffer::open(Report& report)
         return false;
     }
 
+    _stats = Statistics();
+
     if (memoryResident()) {
-        // The buffer is entirely memory-resident in _wcache.
-        _wcache.resize(_total_packets);
-        _wmdata.resize(_total_packets);
-        _rcache.clear();
-        _rmdata.clear();
+        // The buffer is entirely memory-resident in _buffer.
+        _buffer.resize(_total_packets);
+        _mdata.resize(_total_packets);
     }
     else {
         // The buffer is backed up on disk.
@@ -144,18 +179,37 @@ bool ts::TimeShiftBuffer::open(Report& report)
             return false;
         }
 
-        // The read and write buffers use half of memory quota each.
-        // Since the size of the file is larger than the sum of the two,
-        // the read and write caches never overlap when the buffer is full.
-        _wcache.resize(_mem_packets / 2);
-        _wmdata.resize(_mem_packets / 2);
-        _rcache.resize(_mem_packets / 2);
-        _rmdata.resize(_mem_packets / 2);
+        // The two write caches and the two read caches use a quarter of memory quota each.
+        // Since the size of the file is larger than the sum of the four caches, a packet
+        // is always written before being read back.
+        const size_t cache_size = std::max<size_t>(1, _mem_packets / 4);
+        for (size_t i = 0; i < 2; ++i) {
+            _wcache[i].pkt.resize(cache_size);
+            _wcache[i].mdata.resize(cache_size);
+            _wcache[i].next = _wcache[i].count = 0;
+            _wcache[i].pending = false;
+            _wcache[i].success = true;
+            _rcache[i].pkt.resize(cache_size);
+            _rcache[i].mdata.resize(cache_size);
+            _rcache[i].next = _rcache[i].count = 0;
+            _rcache[i].pending = false;
+            _rcache[i].success = true;
+        }
+
+        // Start the I/O thread.
+        _io_queue.clear();
+        _io_terminate = false;
+        if (!start()) {
+            report.error(u"error starting time-shift I/O thread");
+            _file.close(report);
+            return false;
+        }
     }
 
     _cur_packets = 0;
-    _next_read = _next_write = 0;
-    _wcache_next = _rcache_end = _rcache_next = 0;
+    _next_read = _next_write = _read_ahead = 0;
+    _wcur = _rcur = 0;
+    _read_started = false;
     _is_open = true;
     return true;
 }
@@ -171,16 +225,40 @@ bool ts::TimeShiftBuffer::close(Report& report)
         return false;
     }
 
+    // Stop the I/O thread, if any. Pending I/O are useless.
+    {
+        GuardCondition lock(_mutex, _io_request);
+        _io_terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+    _io_queue.clear();
+
     _is_open = false;
     _cur_packets = 0;
-    _wcache.clear();
-    _wmdata.clear();
-    _rcache.clear();
-    _rmdata.clear();
+    _buffer.clear();
+    _mdata.clear();
+    for (size_t i = 0; i < 2; ++i) {
+        _wcache[i].pkt.clear();
+        _wcache[i].mdata.clear();
+        _rcache[i].pkt.clear();
+        _rcache[i].mdata.clear();
+    }
     return !_file.isOpen() || _file.close(report);
 }
 
 
+//----------------------------------------------------------------------------
+// Get the statistics on the disk backup of the time-shift buffer.
+//----------------------------------------------------------------------------
+
+ts::TimeShiftBuffer::Statistics ts::TimeShiftBuffer::statistics() const
+{
+    GuardMutex lock(_mutex);
+    return _stats;
+}
+
+
 //----------------------------------------------------------------------------
 // Push a packet in the time-shift buffer and pull the oldest one.
 //----------------------------------------------------------------------------
@@ -201,71 +279,74 @@ bool ts::TimeShiftBuffer::shift(TSPacket& packet, TSPacketMetadata& mdata, Repor
     assert(_next_write < _total_packets);
 
     if (memoryResident()) {
-        // The buffer is entirely memory-resident in _wcache.
-        assert(_wcache.size() == _total_packets);
+        // The buffer is entirely memory-resident in _buffer.
+        assert(_buffer.size() == _total_packets);
         if (was_full) {
             // Buffer full: return oldest packet.
-            ret_packet = _wcache[_next_read];
-            ret_mdata = _wmdata[_next_read];
-            _next_read = (_next_read + 1) % _wcache.size();
+            ret_packet = _buffer[_next_read];
+            ret_mdata = _mdata[_next_read];
+            _next_read = (_next_read + 1) % _buffer.size();
         }
         else {
             // Buffer not full, increase the packet count.
             _cur_packets++;
         }
-        _wcache[_next_write] = packet;
-        _wmdata[_next_write] = mdata;
-        _next_write = (_next_write + 1) % _wcache.size();
+        _buffer[_next_write] = packet;
+        _mdata[_next_write] = mdata;
+        _next_write = (_next_write + 1) % _buffer.size();
     }
     else {
         // The buffer uses a backup file.
-        if (!was_full) {
-            // While the buffer is not full, simply write the packet in the file.
-            if (!_file.writePackets(&packet, &mdata, 1, report)) {
-                return false;
-            }
-            _cur_packets++;
-        }
-        else {
-            // The buffer is full, now read and write in caches.
-            // First, make sure the read cache is filled.
-            if (_rcache_next >= _rcache_end) {
-                // Read cache is empty, load it.
-                const size_t count = std::min(_rcache.size(), _total_packets - _next_read);
-                _rcache_next = 0;
-                _rcache_end = readFile(_next_read, &_rcache[0], &_rmdata[0], count, report);
-                if (_rcache_end == 0) {
-                    report.error(u"error reading time-shift file");
+        if (was_full) {
+            // The buffer is full, get the oldest packet from the current read cache.
+            if (!_read_started) {
+                // First read, start reading in the two caches.
+                readAhead(_rcache[0]);
+                readAhead(_rcache[1]);
+                _rcur = 0;
+                _read_started = true;
+                if (!wait(_rcache[_rcur], report)) {
                     return false;
                 }
             }
-            // Return oldest packet from memory cache.
-            ret_packet = _rcache[_rcache_next];
-            ret_mdata = _rmdata[_rcache_next++];
-            _next_read = (_next_read + 1) % _total_packets;
-            // Flush the write cache if necessary.
-            if (_wcache_next >= _wcache.size()) {
-                // Flush the entire write cache on disk.
-                // Split in two operations if exceeds the end of file.
-                // Write index in file of the start of the write cache:
-                const size_t file_index = _next_write >= _wcache.size() ? _next_write - _wcache.size() : _total_packets + _next_write - _wcache.size();
-                assert(file_index < _total_packets);
-                const size_t count = std::min(_wcache.size(), _total_packets - file_index);
-                if (!writeFile(file_index, &_wcache[0], &_wmdata[0], count, report)) {
+            else if (_rcache[_rcur].next >= _rcache[_rcur].count) {
+                // Current read cache exhausted, reuse it for read-ahead and switch to the other one.
+                readAhead(_rcache[_rcur]);
+                _rcur ^= 1;
+                if (!wait(_rcache[_rcur], report)) {
                     return false;
                 }
-                // Write second part at begining of file if required.
-                if (count < _wcache.size() && !writeFile(0, &_wcache[count], &_wmdata[count], _wcache.size() - count, report)) {
-                    return false;
-                }
-                // Write cache is now empty.
-                _wcache_next = 0;
             }
-            // Write the next packet in the write cache.
-            _wcache[_wcache_next] = packet;
-            _wmdata[_wcache_next++] = mdata;
+            Cache& rc(_rcache[_rcur]);
+            assert(rc.next < rc.count);
+            ret_packet = rc.pkt[rc.next];
+            ret_mdata = rc.mdata[rc.next++];
+            _next_read = (_next_read + 1) % _total_packets;
+        }
+        else {
+            _cur_packets++;
+        }
+
+        // Push the new packet in the current write cache. This is always done after reading the
+        // oldest packet because the new packet will be written in the file at the same index.
+        Cache& wc(_wcache[_wcur]);
+        if (wc.next == 0) {
+            wc.index = _next_write;
         }
+        wc.pkt[wc.next] = packet;
+        wc.mdata[wc.next++] = mdata;
         _next_write = (_next_write + 1) % _total_packets;
+
+        // When the write cache is full, write it behind and switch to the other one.
+        if (wc.next >= wc.pkt.size()) {
+            wc.count = wc.next;
+            submit(wc, true);
+            _wcur ^= 1;
+            if (!wait(_wcache[_wcur], report)) {
+                return false;
+            }
+            _wcache[_wcur].next = 0;
+        }
     }
 
     // Returned packet. It is a null packet when the buffer was not yet full.
@@ -283,56 +364,114 @@ bool ts::TimeShiftBuffer::shift(TSPacket& packet, TSPacketMetadata& mdata, Repor
 
 
 //----------------------------------------------------------------------------
-// Seek in the backup file.
+// Submit an I/O on a cache to the I/O thread.
 //----------------------------------------------------------------------------
 
-bool ts::TimeShiftBuffer::seekFile(size_t index, Report& report)
+void ts::TimeShiftBuffer::submit(Cache& cache, bool write)
 {
-    if (_file.seek(index, report)) {
-        return true;
+    GuardCondition lock(_mutex, _io_request);
+    cache.write = write;
+    cache.pending = true;
+    _io_queue.push_back(&cache);
+    lock.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Submit the read-ahead of the next part of the backup file in a read cache.
+//----------------------------------------------------------------------------
+
+void ts::TimeShiftBuffer::readAhead(Cache& cache)
+{
+    // A read operation never wraps at the end of the file.
+    cache.index = _read_ahead;
+    cache.count = std::min(cache.pkt.size(), _total_packets - _read_ahead);
+    cache.next = 0;
+    _read_ahead = (_read_ahead + cache.count) % _total_packets;
+    submit(cache, false);
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for the completion of pending I/O on a cache.
+//----------------------------------------------------------------------------
+
+bool ts::TimeShiftBuffer::wait(Cache& cache, Report& report)
+{
+    GuardCondition lock(_mutex, _io_done);
+    if (cache.pending) {
+        // The packet thread is blocked by the disk, this is what we want to avoid.
+        const Monotonic start(true);
+        while (cache.pending) {
+            lock.waitCondition();
+        }
+        const NanoSecond duration = Monotonic(true) - start;
+        _stats.wait_count++;
+        _stats.wait_time += duration;
+        _stats.wait_max = std::max(_stats.wait_max, duration);
     }
-    else {
-        report.error(u"error seeking time-shift file at packet index %d", {index});
-        return false;
+    if (!cache.success) {
+        report.error(u"error %s %d packets in time-shift file at packet index %d", {cache.write ? u"writing" : u"reading", cache.count, cache.index});
     }
+    return cache.success;
 }
 
 
 //----------------------------------------------------------------------------
-// Seek and write in the backup file.
+// Perform an I/O on a cache, in the context of the I/O thread.
 //----------------------------------------------------------------------------
 
-bool ts::TimeShiftBuffer::writeFile(size_t index, const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, Report& report)
+bool ts::TimeShiftBuffer::performIO(Cache& cache)
 {
-    if (!seekFile(index, report)) {
-        return false;
-    }
-    else if (_file.writePackets(buffer, mdata, count, report)) {
-        report.debug(u"written %d packets in time-shift file at packet index %d", {count, index});
-        return true;
+    if (!cache.write) {
+        // A read operation never wraps at the end of the file.
+        return _file.seek(cache.index, NULLREP) && _file.readPackets(cache.pkt.data(), cache.mdata.data(), cache.count, NULLREP) == cache.count;
     }
     else {
-        report.error(u"error writing %d packets in time-shift file at packet index %d", {count, index});
-        return false;
+        // Split in two write operations if exceeds the end of file.
+        const size_t count = std::min(cache.count, _total_packets - cache.index);
+        return _file.seek(cache.index, NULLREP) &&
+               _file.writePackets(cache.pkt.data(), cache.mdata.data(), count, NULLREP) &&
+               (count >= cache.count || (_file.seek(0, NULLREP) && _file.writePackets(&cache.pkt[count], &cache.mdata[count], cache.count - count, NULLREP)));
     }
 }
 
 
 //----------------------------------------------------------------------------
-// Seek and read in the backup file.
+// Implementation of Thread: the I/O thread.
 //----------------------------------------------------------------------------
 
-size_t ts::TimeShiftBuffer::readFile(size_t index, TSPacket* buffer, TSPacketMetadata* mdata, size_t count, Report& report)
+void ts::TimeShiftBuffer::main()
 {
-    if (!seekFile(index, report)) {
-        return false;
-    }
-    const size_t retcount = _file.readPackets(buffer, mdata, count, report);
-    if (retcount == 0) {
-        report.error(u"error reading %d packets in time-shift file at packet index %d", {count, index});
-    }
-    else {
-        report.debug(u"read %d packets in time-shift file at packet index %d", {retcount, index});
+    for (;;) {
+        // Wait for the next I/O request. It is removed from the queue after completion.
+        Cache* cache = nullptr;
+        {
+            GuardCondition lock(_mutex, _io_request);
+            while (_io_queue.empty() && !_io_terminate) {
+                lock.waitCondition();
+            }
+            if (_io_terminate) {
+                break;
+            }
+            cache = _io_queue.front();
+        }
+
+        // Perform the I/O outside the lock, the packet thread does not touch a pending cache.
+        const Monotonic start(true);
+        const bool success = performIO(*cache);
+        const NanoSecond duration = Monotonic(true) - start;
+
+        // Signal the completion.
+        {
+            GuardCondition lock(_mutex, _io_done);
+            _io_queue.pop_front();
+            cache->success = success;
+            cache->pending = false;
+            (cache->write ? _stats.write_count : _stats.read_count)++;
+            _stats.io_time += duration;
+            _stats.io_max = std::max(_stats.io_max, duration);
+            lock.signal();
+        }
     }
-    return retcount;
 }
@@ -37,6 +37,9 @@
 #include "tsTSFile.h"
 #include "tsTSPacketMetadata.h"
 #include "tsReport.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 
 namespace ts {
 
@@ -45,9 +48,12 @@ namespace ts {
     //!
     //! A TS packet buffer for time shift.
     //! The buffer is partly implemented in virtual memory and partly on disk.
+    //! When the buffer is backed up on disk, all file operations are performed by
+    //! a background thread, with read-ahead and write-behind. The thread which
+    //! calls shift() waits only when the disk is slower than the packet rate.
     //! @ingroup mpeg
     //!
-    class TSDUCKDLL TimeShiftBuffer
+    class TSDUCKDLL TimeShiftBuffer: private Thread
     {
         TS_NOCOPY(TimeShiftBuffer);
     public:
@@ -68,6 +74,26 @@ namespace ts {
         //!
         static constexpr size_t DEFAULT_MEMORY_PACKETS = 128;
 
+        //!
+        //! Statistics on the disk backup of a time-shift buffer.
+        //!
+        class TSDUCKDLL Statistics
+        {
+        public:
+            PacketCounter read_count;   //!< Number of read operations in the backup file.
+            PacketCounter write_count;  //!< Number of write operations in the backup file.
+            NanoSecond    io_time;      //!< Cumulated duration of all file operations.
+            NanoSecond    io_max;       //!< Duration of the longest file operation.
+            PacketCounter wait_count;   //!< Number of times shift() waited for a file operation.
+            NanoSecond    wait_time;    //!< Cumulated waiting time in shift().
+            NanoSecond    wait_max;     //!< Longest waiting time in shift().
+
+            //!
+            //! Constructor.
+            //!
+            Statistics();
+        };
+
         //!
         //! Constructor.
         //! @param [in] count Max number of packets in the buffer.
@@ -89,7 +115,8 @@ namespace ts {
 
         //!
         //! Set the maximum number of cached packets to be held in memory.
-        //! Must be called before open().
+        //! Must be called before open(). When the buffer is backed up on disk,
+        //! half of the memory is used for write-behind and half for read-ahead.
         //! @param [in] count Max number of cached packets in memory.
         //! @return True on success, false if already open.
         //!
@@ -175,26 +202,65 @@ namespace ts {
         //!
         bool shift(TSPacket& packet, TSPacketMetadata& metadata, Report& report);
 
+        //!
+        //! Get the statistics on the disk backup of the time-shift buffer.
+        //! @return A copy of the statistics since open().
+        //!
+        Statistics statistics() const;
+
     private:
+        // A cache of packets which is read or written in the backup file by the I/O thread.
+        // The packet thread never accesses a cache while an I/O is pending on it.
+        class Cache
+        {
+        public:
+            TSPacketVector         pkt;      // Cached packets.
+            TSPacketMetadataVector mdata;    // Metadata of cached packets.
+            size_t                 index;    // Index in backup file of first packet.
+            size_t                 count;    // Number of packets in the cache.
+            size_t                 next;     // Index in cache of next packet to read or write.
+            bool                   write;    // Pending operation is a write.
+            bool                   pending;  // An I/O is pending on this cache.
+            bool                   success;  // Status of last I/O.
+            Cache();
+        };
+
         bool    _is_open;                // Buffer is open.
         size_t  _cur_packets;            // Current number of packets in the buffer.
         size_t  _total_packets;          // Total capacity of the buffer.
         size_t  _mem_packets;            // Max packets in memory.
         UString _directory;              // Where to store the backup file.
-        TSFile  _file;                   // Backup file on disk.
+        TSFile  _file;                   // Backup file on disk, used by the I/O thread only.
         size_t  _next_read;              // Index in buffer of next packet to read.
         size_t  _next_write;             // Index in buffer of next packet to write.
-        size_t  _wcache_next;            // Next index to write in _wcache (up to end of _wcache).
-        size_t  _rcache_end;             // End index in _rcache (after last loaded packet).
-        size_t  _rcache_next;            // Next index to read in _rcache.
-        TSPacketVector         _wcache;  // Write cache (or complete buffer if in memory).
-        TSPacketVector         _rcache;  // Read cache.
-        TSPacketMetadataVector _wmdata;  // Packet metadata for _wcache.
-        TSPacketMetadataVector _rmdata;  // Packet metadata for _rcache.
-
-        // Seek, read, write in the backup file.
-        bool seekFile(size_t index, Report& report);
-        bool writeFile(size_t index, const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, Report& report);
-        size_t readFile(size_t index, TSPacket* buffer, TSPacketMetadata* mdata, size_t count, Report& report);
+        size_t  _read_ahead;             // Index in backup file of next packet to read ahead.
+        bool    _read_started;           // The read caches are in use.
+        size_t  _wcur;                   // Index of current write cache.
+        size_t  _rcur;                   // Index of current read cache.
+        TSPacketVector         _buffer;  // Complete buffer if in memory.
+        TSPacketMetadataVector _mdata;   // Packet metadata for _buffer.
+        Cache   _wcache[2];              // Write caches: one is filled while the other one is written.
+        Cache   _rcache[2];              // Read caches: one is used while the other one is read ahead.
+        mutable Mutex _mutex;            // Protect all subsequent fields.
+        Condition     _io_request;       // Signaled when an I/O is requested.
+        Condition     _io_done;          // Signaled when an I/O is completed.
+        std::deque<Cache*> _io_queue;    // Queue of pending I/O, in order of submission.
+        bool          _io_terminate;     // Terminate the I/O thread.
+        Statistics    _stats;            // Statistics on file operations.
+
+        // Submit an I/O on a cache to the I/O thread.
+        void submit(Cache& cache, bool write);
+
+        // Submit the read-ahead of the next part of the backup file in a read cache.
+        void readAhead(Cache& cache);
+
+        // Wait for the completion of pending I/O on a cache. Return false on I/O error.
+        bool wait(Cache& cache, Report& report);
+
+        // Perform an I/O on a cache, in the context of the I/O thread.
+        bool performIO(Cache& cache);
+
+        // Implementation of Thread: the I/O thread.
+        virtual void main() override;
     };
 }
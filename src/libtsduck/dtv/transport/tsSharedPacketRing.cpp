@@ -0,0 +1,527 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedPacketRing.h"
+#include "tsSysUtils.h"
+#include "tsMonotonic.h"
+#include "tsIntegerUtils.h"
+#include "tsMemory.h"
+
+#if defined(TS_LINUX)
+#include <sys/eventfd.h>
+#include <poll.h>
+#endif
+
+const ts::UString ts::SharedPacketRing::ENVIRONMENT_VARIABLE(u"TSDUCK_FORK_RING");
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::SharedPacketRing::DEFAULT_PACKET_COUNT;
+constexpr ts::MilliSecond ts::SharedPacketRing::DEFAULT_ATTACH_TIMEOUT;
+#endif
+
+namespace {
+    // Identification of the shared memory area.
+    constexpr uint32_t RING_MAGIC = 0x54535247;  // "TSRG"
+
+    // Each slot contains a TS packet, followed by its serialized metadata.
+    constexpr size_t SLOT_SIZE = ts::PKT_SIZE + ts::TSPacketMetadata::SERIALIZATION_SIZE;
+
+    // Interval in milliseconds between checks of the peer process while waiting.
+    constexpr int POLL_INTERVAL = 100;
+}
+
+
+//----------------------------------------------------------------------------
+// Description of the shared memory area. The indexes are counted from the
+// creation of the ring, the slot index is the modulo of the capacity.
+//----------------------------------------------------------------------------
+
+struct ts::SharedPacketRing::Header
+{
+    uint32_t              magic;       // RING_MAGIC
+    uint32_t              slot_size;   // SLOT_SIZE
+    uint64_t              capacity;    // Number of slots.
+    uint32_t              creator;     // Side of the parent process.
+    std::atomic<int32_t>  pid[2];      // Process id of reader and writer, zero when not attached.
+    std::atomic<uint32_t> closed[2];   // Reader and writer have closed the ring.
+    std::atomic<uint32_t> waiting[2];  // Reader and writer are waiting for an event.
+    alignas(64) std::atomic<uint64_t> head;  // Index of next packet to write.
+    alignas(64) std::atomic<uint64_t> tail;  // Index of next packet to read.
+};
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::SharedPacketRing::SharedPacketRing() :
+    _side(READER),
+    _mem_fd(-1),
+    _data_fd(-1),
+    _space_fd(-1),
+    _map_size(0),
+    _header(nullptr),
+    _slots(nullptr),
+    _aborted(false)
+{
+}
+
+ts::SharedPacketRing::~SharedPacketRing()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Check if shared memory rings are supported on this platform.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::IsSupported()
+{
+#if defined(TS_LINUX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Create a new ring in the parent process.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::create(Side side, size_t packet_count, Report& report)
+{
+    close();
+
+#if defined(TS_LINUX)
+
+    _side = side;
+    _aborted = false;
+    _map_size = round_up(sizeof(Header), size_t(64)) + std::max<size_t>(packet_count, 1) * SLOT_SIZE;
+
+    // All file descriptors are inherited by the child process.
+    if ((_mem_fd = ::memfd_create("tsduck-ring", 0)) < 0) {
+        report.error(u"error creating shared memory: %s", {SysErrorCodeMessage()});
+        release();
+        return false;
+    }
+    if (::ftruncate(_mem_fd, off_t(_map_size)) < 0) {
+        report.error(u"error resizing shared memory: %s", {SysErrorCodeMessage()});
+        release();
+        return false;
+    }
+    if ((_data_fd = ::eventfd(0, EFD_NONBLOCK)) < 0 || (_space_fd = ::eventfd(0, EFD_NONBLOCK)) < 0) {
+        report.error(u"error creating event file descriptor: %s", {SysErrorCodeMessage()});
+        release();
+        return false;
+    }
+    if (!map(report)) {
+        release();
+        return false;
+    }
+
+    // The shared memory is initially zero, initialize the header.
+    _header->magic = RING_MAGIC;
+    _header->slot_size = uint32_t(SLOT_SIZE);
+    _header->capacity = std::max<size_t>(packet_count, 1);
+    _header->creator = uint32_t(side);
+    _header->pid[side] = int32_t(::getpid());
+    return true;
+
+#else
+
+    report.error(u"shared memory rings are not supported on this platform");
+    return false;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Attach to a ring in the child process.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::attach(Side side, const UString& description, Report& report)
+{
+    close();
+
+#if defined(TS_LINUX)
+
+    // The description is a list of inherited file descriptors: memory, data, space.
+    _side = side;
+    _aborted = false;
+    if (!description.scan(u"%d,%d,%d", {&_mem_fd, &_data_fd, &_space_fd}) || _mem_fd < 0 || _data_fd < 0 || _space_fd < 0) {
+        report.error(u"invalid shared memory ring description \"%s\"", {description});
+        _mem_fd = _data_fd = _space_fd = -1;
+        return false;
+    }
+
+    // The size of the mapping is the size of the shared memory.
+    struct stat st;
+    if (::fstat(_mem_fd, &st) < 0) {
+        report.error(u"invalid shared memory ring: %s", {SysErrorCodeMessage()});
+        release();
+        return false;
+    }
+    _map_size = size_t(st.st_size);
+    if (_map_size < sizeof(Header) || !map(report)) {
+        release();
+        return false;
+    }
+
+    // Check the consistency of the ring.
+    if (_header->magic != RING_MAGIC || _header->slot_size != SLOT_SIZE || _map_size < round_up(sizeof(Header), size_t(64)) + _header->capacity * SLOT_SIZE) {
+        report.error(u"invalid shared memory ring content");
+        release();
+        return false;
+    }
+    if (_header->creator == uint32_t(side)) {
+        report.error(u"invalid shared memory ring direction, the parent process is also a %s", {side == READER ? u"reader" : u"writer"});
+        release();
+        return false;
+    }
+    if (_header->pid[side] != 0) {
+        report.error(u"shared memory ring already in use by process %d", {_header->pid[side].load()});
+        release();
+        return false;
+    }
+
+    // Do not propagate the ring to our own child processes.
+    setCloseOnExec();
+
+    // Signal our presence to the parent process.
+    _header->pid[side] = int32_t(::getpid());
+    return true;
+
+#else
+
+    report.error(u"shared memory rings are not supported on this platform");
+    return false;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Map the shared memory area.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::map(Report& report)
+{
+#if defined(TS_LINUX)
+    void* addr = ::mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_SHARED, _mem_fd, 0);
+    if (addr == MAP_FAILED) {
+        report.error(u"error mapping shared memory: %s", {SysErrorCodeMessage()});
+        return false;
+    }
+    _header = reinterpret_cast<Header*>(addr);
+    _slots = reinterpret_cast<uint8_t*>(addr) + round_up(sizeof(Header), size_t(64));
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Get the description of the ring.
+//----------------------------------------------------------------------------
+
+ts::UString ts::SharedPacketRing::description() const
+{
+    return isOpen() ? UString::Format(u"%d,%d,%d", {_mem_fd, _data_fd, _space_fd}) : UString();
+}
+
+
+//----------------------------------------------------------------------------
+// Prevent the system resources from being inherited by other processes.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::setCloseOnExec()
+{
+#if defined(TS_LINUX)
+    for (int fd : {_mem_fd, _data_fd, _space_fd}) {
+        if (fd >= 0) {
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for the peer process to attach to the ring.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::waitPeer(MilliSecond timeout)
+{
+    const Side peer = _side == READER ? WRITER : READER;
+    Monotonic end(true);
+    end += timeout * NanoSecPerMilliSec;
+    while (isOpen() && !_aborted && _header->pid[peer] == 0 && _header->closed[peer] == 0) {
+        if (Monotonic(true) >= end) {
+            return false;
+        }
+        SleepThread(10);
+    }
+    return isOpen() && !_aborted && _header->pid[peer] != 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the peer process is still alive.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::peerAlive() const
+{
+#if defined(TS_LINUX)
+    const ::pid_t pid = _header->pid[_side == READER ? WRITER : READER];
+    if (pid <= 0) {
+        return true;
+    }
+    // For a direct child, check if the process has exited, without collecting its status.
+    ::siginfo_t info;
+    TS_ZERO(info);
+    if (::waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0) {
+        return info.si_pid == 0;
+    }
+    // Other processes (indirect child, parent).
+    return ::kill(pid, 0) == 0 || errno != ESRCH;
+#else
+    return false;
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Wait on an event file descriptor with a short timeout.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::waitEvent(int fd)
+{
+#if defined(TS_LINUX)
+    ::pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (::poll(&pfd, 1, POLL_INTERVAL) > 0) {
+        // Reset the event counter.
+        uint64_t value = 0;
+        TS_UNUSED const ssize_t insize = ::read(fd, &value, sizeof(value));
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Signal an event file descriptor.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::signalEvent(int fd)
+{
+#if defined(TS_LINUX)
+    const uint64_t value = 1;
+    TS_UNUSED const ssize_t outsize = ::write(fd, &value, sizeof(value));
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Read TS packets from the ring.
+//----------------------------------------------------------------------------
+
+size_t ts::SharedPacketRing::read(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets, Report& report)
+{
+    if (!isOpen() || _side != READER || buffer == nullptr || max_packets == 0) {
+        return 0;
+    }
+
+    const uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+    uint64_t head = _header->head.load(std::memory_order_acquire);
+
+    // Wait until packets are available.
+    while (head == tail) {
+        // Check the end of stream before the last check of the head index.
+        const bool closed = _header->closed[WRITER] != 0;
+        head = _header->head.load(std::memory_order_acquire);
+        if (head != tail) {
+            break;
+        }
+        if (closed || _aborted) {
+            return 0;
+        }
+        if (!peerAlive()) {
+            report.error(u"shared memory ring writer process has terminated");
+            return 0;
+        }
+        // Declare that we wait before checking the head index one last time.
+        _header->waiting[READER] = 1;
+        if (_header->head.load() == tail) {
+            waitEvent(_data_fd);
+        }
+        _header->waiting[READER] = 0;
+        head = _header->head.load(std::memory_order_acquire);
+    }
+
+    // Copy packets from the ring.
+    const size_t count = size_t(std::min<uint64_t>(head - tail, max_packets));
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* slot = _slots + ((tail + i) % _header->capacity) * SLOT_SIZE;
+        std::memcpy(buffer[i].b, slot, PKT_SIZE);
+        if (metadata != nullptr) {
+            metadata[i].deserialize(slot + PKT_SIZE, TSPacketMetadata::SERIALIZATION_SIZE);
+        }
+    }
+
+    // Release the slots and wake up the writer if it waits for free space.
+    _header->tail.store(tail + count);
+    if (_header->waiting[WRITER] != 0) {
+        signalEvent(_space_fd);
+    }
+    return count;
+}
+
+
+//----------------------------------------------------------------------------
+// Write TS packets into the ring.
+//----------------------------------------------------------------------------
+
+bool ts::SharedPacketRing::write(const TSPacket* buffer, const TSPacketMetadata* metadata, size_t packet_count, Report& report)
+{
+    if (!isOpen() || _side != WRITER) {
+        return false;
+    }
+
+    const uint64_t capacity = _header->capacity;
+    uint64_t head = _header->head.load(std::memory_order_relaxed);
+
+    while (packet_count > 0) {
+
+        // Wait until some space is available.
+        uint64_t tail = _header->tail.load(std::memory_order_acquire);
+        while (head - tail >= capacity) {
+            if (_header->closed[READER] != 0 || _aborted) {
+                return false;
+            }
+            if (!peerAlive()) {
+                report.error(u"shared memory ring reader process has terminated");
+                return false;
+            }
+            // Declare that we wait before checking the tail index one last time.
+            _header->waiting[WRITER] = 1;
+            if (head - _header->tail.load() >= capacity) {
+                waitEvent(_space_fd);
+            }
+            _header->waiting[WRITER] = 0;
+            tail = _header->tail.load(std::memory_order_acquire);
+        }
+        if (_header->closed[READER] != 0 || _aborted) {
+            return false;
+        }
+
+        // Copy packets into the ring.
+        const size_t count = size_t(std::min<uint64_t>(capacity - (head - tail), packet_count));
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t* slot = _slots + ((head + i) % capacity) * SLOT_SIZE;
+            std::memcpy(slot, buffer[i].b, PKT_SIZE);
+            if (metadata != nullptr) {
+                metadata[i].serialize(slot + PKT_SIZE, TSPacketMetadata::SERIALIZATION_SIZE);
+            }
+            else {
+                TSPacketMetadata().serialize(slot + PKT_SIZE, TSPacketMetadata::SERIALIZATION_SIZE);
+            }
+        }
+
+        // Publish the packets and wake up the reader if it waits for data.
+        head += count;
+        _header->head.store(head);
+        if (_header->waiting[READER] != 0) {
+            signalEvent(_data_fd);
+        }
+        buffer += count;
+        if (metadata != nullptr) {
+            metadata += count;
+        }
+        packet_count -= count;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Abort any read or write operation in progress.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::abort()
+{
+    _aborted = true;
+    if (isOpen()) {
+        signalEvent(_side == READER ? _data_fd : _space_fd);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Close the ring.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::close()
+{
+    if (isOpen()) {
+        // Notify the peer which may wait for data or space.
+        _header->closed[_side] = 1;
+        signalEvent(_data_fd);
+        signalEvent(_space_fd);
+    }
+    release();
+}
+
+
+//----------------------------------------------------------------------------
+// Release all system resources.
+//----------------------------------------------------------------------------
+
+void ts::SharedPacketRing::release()
+{
+#if defined(TS_LINUX)
+    if (_header != nullptr) {
+        ::munmap(_header, _map_size);
+    }
+    for (int fd : {_mem_fd, _data_fd, _space_fd}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+    _header = nullptr;
+    _slots = nullptr;
+    _map_size = 0;
+    _mem_fd = _data_fd = _space_fd = -1;
+}
@@ -0,0 +1,206 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Shared memory ring of TS packets between two processes.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Single-producer single-consumer ring of TS packets in shared memory.
+    //! @ingroup mpeg
+    //!
+    //! The ring is used between a parent process (typically a @c fork plugin)
+    //! and a cooperating child process. It replaces the pipe between the two
+    //! processes, avoiding a system call per chunk of packets. The parent process
+    //! creates the ring and passes its description to the child process in the
+    //! environment variable @link ENVIRONMENT_VARIABLE @endlink. The child process
+    //! attaches to the ring using the value of this environment variable.
+    //!
+    //! The packets and their metadata are copied once into the shared memory by
+    //! the writer and once out of the shared memory by the reader. The writer and
+    //! the reader are woken up using event file descriptors only when they wait.
+    //!
+    //! This class is currently implemented on Linux only.
+    //!
+    class TSDUCKDLL SharedPacketRing
+    {
+        TS_NOCOPY(SharedPacketRing);
+    public:
+        //!
+        //! Role of a process on a ring.
+        //!
+        enum Side {
+            READER = 0,  //!< This process reads packets from the ring.
+            WRITER = 1,  //!< This process writes packets into the ring.
+        };
+
+        //!
+        //! Name of the environment variable which describes the ring in the child process.
+        //!
+        static const UString ENVIRONMENT_VARIABLE;
+
+        //!
+        //! Default number of packets in a ring.
+        //!
+        static constexpr size_t DEFAULT_PACKET_COUNT = 8192;
+
+        //!
+        //! Default timeout in milliseconds for the child process to attach to the ring.
+        //!
+        static constexpr MilliSecond DEFAULT_ATTACH_TIMEOUT = 3000;
+
+        //!
+        //! Constructor.
+        //!
+        SharedPacketRing();
+
+        //!
+        //! Destructor.
+        //!
+        ~SharedPacketRing();
+
+        //!
+        //! Check if shared memory rings are supported on this platform.
+        //! @return True if shared memory rings are supported.
+        //!
+        static bool IsSupported();
+
+        //!
+        //! Create a new ring in the parent process.
+        //! The system resources are inheritable until setCloseOnExec() is called.
+        //! @param [in] side Role of this process on the ring.
+        //! @param [in] packet_count Maximum number of packets in the ring.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool create(Side side, size_t packet_count, Report& report);
+
+        //!
+        //! Attach to a ring in the child process.
+        //! @param [in] side Role of this process on the ring.
+        //! @param [in] description Description of the ring, as returned by description() in the parent process.
+        //! This is typically the value of the environment variable @link ENVIRONMENT_VARIABLE @endlink.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool attach(Side side, const UString& description, Report& report);
+
+        //!
+        //! Get the description of the ring, to be passed to the child process.
+        //! @return The description of the ring or an empty string if the ring is not open.
+        //!
+        UString description() const;
+
+        //!
+        //! Prevent the system resources of the ring from being inherited by other processes.
+        //! Must be called by the parent process after creating the child process.
+        //!
+        void setCloseOnExec();
+
+        //!
+        //! Check if the ring is open.
+        //! @return True if the ring is open.
+        //!
+        bool isOpen() const { return _header != nullptr; }
+
+        //!
+        //! Wait for the peer process to attach to the ring.
+        //! @param [in] timeout Maximum number of milliseconds to wait.
+        //! @return True if the peer process is attached, false on timeout or termination of the peer.
+        //!
+        bool waitPeer(MilliSecond timeout = DEFAULT_ATTACH_TIMEOUT);
+
+        //!
+        //! Read TS packets from the ring, wait until at least one packet is available.
+        //! @param [out] buffer Address of reception packet buffer.
+        //! @param [out] metadata Optional packet metadata. Ignored if null pointer.
+        //! @param [in] max_packets Size of @a buffer in packets.
+        //! @param [in,out] report Where to report errors.
+        //! @return The actual number of read packets. Returning zero means error or end of stream.
+        //!
+        size_t read(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets, Report& report);
+
+        //!
+        //! Write TS packets into the ring, wait until all packets are written.
+        //! @param [in] buffer Address of first packet to write.
+        //! @param [in] metadata Optional packet metadata. Ignored if null pointer.
+        //! @param [in] packet_count Number of packets to write.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error or when the reader has closed the ring.
+        //!
+        bool write(const TSPacket* buffer, const TSPacketMetadata* metadata, size_t packet_count, Report& report);
+
+        //!
+        //! Abort any read or write operation in progress.
+        //! The ring is left in a broken state and can be only closed.
+        //!
+        void abort();
+
+        //!
+        //! Close the ring.
+        //! On the writer side, the reader will get an end of stream after the last packet.
+        //! On the reader side, subsequent write operations will fail on the writer side.
+        //!
+        void close();
+
+    private:
+        struct Header;  // Description of the shared memory area, defined in implementation.
+
+        Side          _side;      // Role of this process.
+        int           _mem_fd;    // File descriptor of shared memory.
+        int           _data_fd;   // Event file descriptor, signaled when data are available.
+        int           _space_fd;  // Event file descriptor, signaled when space is available.
+        size_t        _map_size;  // Size of the memory mapping in bytes.
+        Header*       _header;    // Address of shared memory area, null if not open.
+        uint8_t*      _slots;     // Address of first packet slot.
+        volatile bool _aborted;   // Abort all operations.
+
+        // Map the shared memory area.
+        bool map(Report& report);
+
+        // Wait on an event file descriptor with a short timeout.
+        void waitEvent(int fd);
+
+        // Signal an event file descriptor.
+        void signalEvent(int fd);
+
+        // Check if the peer process is still alive.
+        bool peerAlive() const;
+
+        // Release all system resources.
+        void release();
+    };
+}
@@ -36,7 +36,10 @@
 
 ts::TSForkPipe::TSForkPipe() :
     ForkPipe(),
-    TSPacketStream(TSPacketFormat::AUTODETECT, this, this)
+    TSPacketStream(TSPacketFormat::AUTODETECT, this, this),
+    _ring_packets(0),
+    _ring_pending(false),
+    _ring()
 {
 }
 
@@ -52,5 +55,99 @@ ts::TSForkPipe::~TSForkPipe()
 bool ts::TSForkPipe::open(const UString& command, WaitMode wait_mode, size_t buffer_size, Report& report, OutputMode out_mode, InputMode in_mode, TSPacketFormat format)
 {
     resetPacketStream(format, this, this);
-    return ForkPipe::open(command, wait_mode, buffer_size, report, out_mode, in_mode);
+    _ring.close();
+    _ring_pending = false;
+
+    // Create the optional shared memory ring. The pipe is still created, as a fallback.
+    UString actual_command(command);
+    if (_ring_packets > 0 && wait_mode != EXIT_PROCESS) {
+        const bool writer = in_mode == STDIN_PIPE;
+        if (!SharedPacketRing::IsSupported()) {
+            report.warning(u"shared memory is not supported on this platform, using a pipe");
+        }
+        else if (_ring.create(writer ? SharedPacketRing::WRITER : SharedPacketRing::READER, _ring_packets, report)) {
+            // Pass the ring description to the created process in the environment.
+            const UString& var(SharedPacketRing::ENVIRONMENT_VARIABLE);
+            actual_command = UString::Format(u"%s=%s; export %s; %s", {var, _ring.description(), var, command});
+        }
+    }
+
+    const bool success = ForkPipe::open(actual_command, wait_mode, buffer_size, report, out_mode, in_mode);
+    if (!success) {
+        _ring.close();
+    }
+    else if (_ring.isOpen()) {
+        // The created process has inherited the ring, don't propagate it to other processes.
+        _ring.setCloseOnExec();
+        _ring_pending = true;
+    }
+    return success;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the pipe and the optional shared memory ring.
+//----------------------------------------------------------------------------
+
+bool ts::TSForkPipe::close(Report& report)
+{
+    // Closing the ring first signals the end of stream to the created process.
+    _ring.close();
+    _ring_pending = false;
+    return ForkPipe::close(report);
+}
+
+
+//----------------------------------------------------------------------------
+// Abort any currenly input/output operation.
+//----------------------------------------------------------------------------
+
+void ts::TSForkPipe::abortPipeReadWrite()
+{
+    _ring.abort();
+    ForkPipe::abortPipeReadWrite();
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the shared memory ring shall be used.
+//----------------------------------------------------------------------------
+
+bool ts::TSForkPipe::useRing(Report& report)
+{
+    if (_ring_pending) {
+        _ring_pending = false;
+        if (_ring.waitPeer()) {
+            report.debug(u"created process attached to the shared memory ring");
+        }
+        else {
+            report.verbose(u"created process did not attach to the shared memory ring, using the pipe");
+            _ring.close();
+        }
+    }
+    return _ring.isOpen();
+}
+
+
+//----------------------------------------------------------------------------
+// Read or write TS packets, using the shared memory ring when available.
+//----------------------------------------------------------------------------
+
+size_t ts::TSForkPipe::readPackets(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets, Report& report)
+{
+    return useRing(report) ? _ring.read(buffer, metadata, max_packets, report) : TSPacketStream::readPackets(buffer, metadata, max_packets, report);
+}
+
+bool ts::TSForkPipe::writePackets(const TSPacket* buffer, const TSPacketMetadata* metadata, size_t packet_count, Report& report)
+{
+    if (!useRing(report)) {
+        return TSPacketStream::writePackets(buffer, metadata, packet_count, report);
+    }
+    else if (_ring.write(buffer, metadata, packet_count, report)) {
+        return true;
+    }
+    else {
+        // Same as broken pipe: ignore the error if the created process may abort.
+        return getIgnoreAbort();
+    }
 }
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsForkPipe.h"
 #include "tsTSPacketStream.h"
+#include "tsSharedPacketRing.h"
 
 namespace ts {
     //!
@@ -75,5 +76,42 @@ namespace ts {
                   OutputMode out_mode,
                   InputMode in_mode,
                   TSPacketFormat format = TSPacketFormat::AUTODETECT);
+
+        //!
+        //! Close the pipe and the optional shared memory ring.
+        //! Optionally wait for process termination if @a wait_mode was SYNCHRONOUS on open().
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Abort any currenly input/output operation in the pipe or the shared memory ring.
+        //! The pipe is left in a broken state and can be only closed.
+        //!
+        void abortPipeReadWrite();
+
+        //!
+        //! Request a shared memory ring to exchange TS packets with the created process.
+        //! Must be called before open(). The shared memory ring is described to the created
+        //! process in the environment variable SharedPacketRing::ENVIRONMENT_VARIABLE.
+        //! A cooperating process attaches to the ring, typically using a @c shmring plugin.
+        //! If the created process does not attach to the ring within a few seconds, or if shared
+        //! memory rings are not supported on this platform, the pipe is used instead.
+        //! @param [in] packet_count Number of packets in the shared memory ring. Zero means no ring.
+        //!
+        void setSharedMemory(size_t packet_count) { _ring_packets = packet_count; }
+
+        // Overridden TSPacketStream methods.
+        virtual size_t readPackets(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets, Report& report) override;
+        virtual bool writePackets(const TSPacket* buffer, const TSPacketMetadata* metadata, size_t packet_count, Report& report) override;
+
+    private:
+        size_t           _ring_packets;  // Number of packets in shared memory ring, zero if none.
+        bool             _ring_pending;  // Waiting for the created process to attach the ring.
+        SharedPacketRing _ring;          // Shared memory ring.
+
+        // Check if the shared memory ring shall be used, wait for the created process if necessary.
+        bool useRing(Report& report);
     };
 }
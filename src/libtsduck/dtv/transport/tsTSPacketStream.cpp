@@ -29,6 +29,10 @@
 
 #include "tsTSPacketStream.h"
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSPacketStream::DEFAULT_RESYNC_PACKETS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructors and destructors.
@@ -42,7 +46,11 @@ ts::TSPacketStream::TSPacketStream(TSPacketFormat format, AbstractReadStreamInte
     _writer(writer),
     _last_timestamp(0),
     _trail_size(0),
-    _trail()
+    _trail(),
+    _resync_packets(0),
+    _resync_count(0),
+    _resync_bytes(0),
+    _pending()
 {
 }
 
@@ -64,6 +72,9 @@ void ts::TSPacketStream::resetPacketStream(TSPacketFormat format, AbstractReadSt
     _writer = writer;
     _last_timestamp = 0;
     _trail_size = 0;
+    _resync_count = 0;
+    _resync_bytes = 0;
+    _pending.clear();
 }
 
 
@@ -73,7 +84,17 @@ void ts::TSPacketStream::resetPacketStream(TSPacketFormat format, AbstractReadSt
 
 size_t ts::TSPacketStream::packetHeaderSize() const
 {
-    switch (_format) {
+    return PacketHeaderSize(_format);
+}
+
+size_t ts::TSPacketStream::packetTrailerSize() const
+{
+    return PacketTrailerSize(_format);
+}
+
+size_t ts::TSPacketStream::PacketHeaderSize(TSPacketFormat format)
+{
+    switch (format) {
         case TSPacketFormat::AUTODETECT: return 0;
         case TSPacketFormat::TS:         return 0;
         case TSPacketFormat::M2TS:       return 4;
@@ -83,9 +104,9 @@ size_t ts::TSPacketStream::packetHeaderSize() const
     }
 }
 
-size_t ts::TSPacketStream::packetTrailerSize() const
+size_t ts::TSPacketStream::PacketTrailerSize(TSPacketFormat format)
 {
-    switch (_format) {
+    switch (format) {
         case TSPacketFormat::AUTODETECT: return 0;
         case TSPacketFormat::TS:         return 0;
         case TSPacketFormat::M2TS:       return 0;
@@ -96,6 +117,162 @@ size_t ts::TSPacketStream::packetTrailerSize() const
 }
 
 
+//----------------------------------------------------------------------------
+// Locate a sequence of consecutive packets in a memory buffer.
+//----------------------------------------------------------------------------
+
+namespace {
+    size_t LocateLattice(const uint8_t* data, size_t size, size_t packet_size, size_t header_size, size_t min_packets, bool check_magic)
+    {
+        min_packets = std::max<size_t>(min_packets, 1);
+        if (data == nullptr || packet_size < header_size + ts::PKT_SIZE || size < min_packets * packet_size) {
+            return ts::NPOS;
+        }
+
+        // Sync byte of the first packet, first and last possible positions.
+        const uint8_t* sync = data + header_size;
+        const uint8_t* const last = data + size - min_packets * packet_size + header_size;
+
+        // Locate candidate sync bytes using memchr(), then check the lattice of next sync bytes.
+        while (sync <= last && (sync = reinterpret_cast<const uint8_t*>(::memchr(sync, ts::SYNC_BYTE, last - sync + 1))) != nullptr) {
+            size_t count = 0;
+            for (const uint8_t* p = sync; count < min_packets && *p == ts::SYNC_BYTE && (!check_magic || p[-ptrdiff_t(header_size)] == ts::TSPacketMetadata::SERIALIZATION_MAGIC); p += packet_size) {
+                count++;
+            }
+            if (count == min_packets) {
+                return sync - data - header_size;
+            }
+            sync++;
+        }
+        return ts::NPOS;
+    }
+}
+
+size_t ts::TSPacketStream::LocatePackets(const uint8_t* data, size_t size, size_t packet_size, size_t header_size, size_t min_packets)
+{
+    return LocateLattice(data, size, packet_size, header_size, min_packets, false);
+}
+
+size_t ts::TSPacketStream::LocatePackets(const uint8_t* data, size_t size, size_t min_packets, TSPacketFormat& format)
+{
+    // Formats to try, in order of preference for a given offset.
+    static const TSPacketFormat all_formats[] = {TSPacketFormat::TS, TSPacketFormat::RS204, TSPacketFormat::M2TS, TSPacketFormat::DUCK};
+    const bool detect = format == TSPacketFormat::AUTODETECT;
+    size_t start = NPOS;
+
+    for (auto fmt : all_formats) {
+        if (detect || fmt == format) {
+            const size_t header_size = PacketHeaderSize(fmt);
+            const size_t packet_size = header_size + PKT_SIZE + PacketTrailerSize(fmt);
+            // Only search before the best sequence which was previously found.
+            const size_t search_size = start == NPOS ? size : std::min(size, start + min_packets * packet_size);
+            const size_t index = LocateLattice(data, search_size, packet_size, header_size, min_packets, fmt == TSPacketFormat::DUCK);
+            if (index < start) {
+                start = index;
+                if (detect) {
+                    format = fmt;
+                }
+            }
+        }
+    }
+    return start;
+}
+
+
+//----------------------------------------------------------------------------
+// Read data from the pending buffer first, then from the reader.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketStream::readPending(void* data, size_t size, size_t& read_size, Report& report)
+{
+    read_size = std::min(size, _pending.size());
+    if (read_size > 0) {
+        ::memcpy(data, _pending.data(), read_size);
+        _pending.erase(0, read_size);
+    }
+    if (read_size < size) {
+        size_t insize = 0;
+        const bool success = _reader->readStreamComplete(reinterpret_cast<uint8_t*>(data) + read_size, size - read_size, insize, report);
+        read_size += insize;
+        return success || read_size > 0;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Push back data which were read without synchronization.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketStream::unread(const void* data, size_t size)
+{
+    const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+    _pending.insert(_pending.begin(), bytes, bytes + size);
+}
+
+
+//----------------------------------------------------------------------------
+// Resynchronize the input stream, starting at the pending data.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketStream::resync(Report& report, PacketCounter packets)
+{
+    // When the format is unknown, use the largest packet size.
+    const bool detect = _format == TSPacketFormat::AUTODETECT;
+    const size_t packet_size = detect ? MAX_HEADER_SIZE + PKT_SIZE + MAX_TRAILER_SIZE : packetHeaderSize() + PKT_SIZE + packetTrailerSize();
+    const size_t min_size = _resync_packets * packet_size;
+    uint64_t skipped = 0;
+    bool eof = false;
+
+    for (;;) {
+        // Read enough data to find the required number of consecutive packets.
+        if (!eof && _pending.size() < 2 * min_size) {
+            const size_t previous = _pending.size();
+            size_t insize = 0;
+            _pending.resize(2 * min_size);
+            eof = !_reader->readStreamComplete(_pending.data() + previous, _pending.size() - previous, insize, report) || previous + insize < _pending.size();
+            _pending.resize(previous + insize);
+        }
+
+        // At end of stream, accept a shorter sequence of packets.
+        const size_t min_packets = eof ? std::min(_resync_packets, _pending.size() / (detect ? PKT_SIZE : packet_size)) : _resync_packets;
+        TSPacketFormat format = _format;
+        const size_t start = min_packets == 0 ? NPOS : LocatePackets(_pending.data(), _pending.size(), min_packets, format);
+
+        if (start != NPOS) {
+            skipped += start;
+            _pending.erase(0, start);
+            _format = format;
+            if (skipped > 0) {
+                _resync_count++;
+                _resync_bytes += skipped;
+                if (detect) {
+                    report.warning(u"skipped %'d bytes at start of stream", {skipped});
+                }
+                else {
+                    report.warning(u"synchronization lost after %'d packets, skipped %'d bytes to resynchronize", {packets, skipped});
+                }
+            }
+            return true;
+        }
+        if (eof) {
+            skipped += _pending.size();
+            _resync_bytes += skipped;
+            _pending.clear();
+            if (!detect) {
+                report.warning(u"synchronization lost after %'d packets, skipped %'d bytes until end of stream", {packets, skipped});
+            }
+            return false;
+        }
+
+        // Keep the last bytes, not yet checked as start of a sequence of packets.
+        const size_t drop = _pending.size() - min_size + 1;
+        skipped += drop;
+        _pending.erase(0, drop);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Read TS packets. Return the actual number of read packets.
 //----------------------------------------------------------------------------
@@ -116,6 +293,16 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
     size_t header_size = packetHeaderSize();
     assert(header_size <= sizeof(header));
 
+    // With resynchronization, autodetect the format on a sequence of packets, at any offset.
+    if (_format == TSPacketFormat::AUTODETECT && _resync_packets > 0) {
+        if (!resync(report, 0)) {
+            report.error(u"cannot detect TS file format");
+            return 0;
+        }
+        header_size = packetHeaderSize();
+        report.debug(u"detected TS file format %s", {packetFormatString()});
+    }
+
     // If format is autodetect, read one packet to check where the sync byte is.
     if (_format == TSPacketFormat::AUTODETECT) {
 
@@ -187,7 +374,7 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
     // Repeat reading packets until the buffer is full or error.
     // Rewind on end of file if repeating is set.
     bool success = true;
-    while (success && max_packets > 0 && !_reader->endOfStream()) {
+    while (success && max_packets > 0 && (!_pending.empty() || !_reader->endOfStream())) {
 
         switch (_format) {
             case TSPacketFormat::AUTODETECT: {
@@ -200,12 +387,24 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
                 // Make sure that the trailer buffer from first packet is used in second packet.
                 uint8_t* const cbuffer = reinterpret_cast<uint8_t*>(buffer);
                 ::memmove(cbuffer, _trail, _trail_size);
-                success = _reader->readStreamComplete(cbuffer + _trail_size, max_packets * PKT_SIZE - _trail_size, read_size, report);
+                success = readPending(cbuffer + _trail_size, max_packets * PKT_SIZE - _trail_size, read_size, report);
                 read_size += _trail_size;
                 _trail_size = 0;
                 // Count packets. Truncate incomplete packets at end of file.
-                const size_t count = read_size / PKT_SIZE;
+                size_t count = read_size / PKT_SIZE;
                 assert(count <= max_packets);
+                if (_resync_packets > 0) {
+                    // Keep packets up to the first loss of synchronization.
+                    size_t valid = 0;
+                    while (valid < count && buffer[valid].b[0] == SYNC_BYTE) {
+                        valid++;
+                    }
+                    if (valid < count) {
+                        unread(cbuffer + valid * PKT_SIZE, read_size - valid * PKT_SIZE);
+                        count = valid;
+                        success = resync(report, _total_read + read_packets + count);
+                    }
+                }
                 read_packets += count;
                 buffer += count;
                 max_packets -= count;
@@ -219,10 +418,15 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
                 // Read packet. Make sure that the trailer buffer from first packet is used in second packet.
                 uint8_t* const cbuffer = reinterpret_cast<uint8_t*>(buffer);
                 ::memmove(cbuffer, _trail, _trail_size);
-                success = _reader->readStreamComplete(cbuffer + _trail_size, PKT_SIZE - _trail_size, read_size, report);
+                success = readPending(cbuffer + _trail_size, PKT_SIZE - _trail_size, read_size, report);
                 read_size += _trail_size;
                 _trail_size = 0;
-                if (success && read_size == PKT_SIZE) {
+                if (success && read_size == PKT_SIZE && _resync_packets > 0 && buffer->b[0] != SYNC_BYTE) {
+                    // Lost synchronization, the trailer was not read.
+                    unread(cbuffer, PKT_SIZE);
+                    success = resync(report, _total_read + read_packets);
+                }
+                else if (success && read_size == PKT_SIZE) {
                     read_packets++;
                     buffer++;
                     max_packets--;
@@ -231,17 +435,25 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
                         metadata++;
                     }
                     // Read trailer in unused buffer.
-                    success = _reader->readStreamComplete(_trail, RS_SIZE, read_size, report) && read_size == RS_SIZE;
+                    success = readPending(_trail, RS_SIZE, read_size, report) && read_size == RS_SIZE;
                 }
                 break;
             }
             case TSPacketFormat::M2TS:
             case TSPacketFormat::DUCK: {
                 // Read header + packet. No trailer was read at first packet.
-                success = _reader->readStreamComplete(header, header_size, read_size, report);
+                success = readPending(header, header_size, read_size, report);
                 if (success && read_size == header_size) {
-                    success = _reader->readStreamComplete(buffer, PKT_SIZE, read_size, report);
-                    if (success && read_size == PKT_SIZE) {
+                    success = readPending(buffer, PKT_SIZE, read_size, report);
+                    if (success && read_size == PKT_SIZE && _resync_packets > 0 &&
+                        (buffer->b[0] != SYNC_BYTE || (_format == TSPacketFormat::DUCK && header[0] != TSPacketMetadata::SERIALIZATION_MAGIC)))
+                    {
+                        // Lost synchronization, push back header and packet.
+                        unread(buffer, PKT_SIZE);
+                        unread(header, header_size);
+                        success = resync(report, _total_read + read_packets);
+                    }
+                    else if (success && read_size == PKT_SIZE) {
                         read_packets++;
                         buffer++;
                         max_packets--;
@@ -38,6 +38,7 @@
 #include "tsTSPacketFormat.h"
 #include "tsTSPacketMetadata.h"
 #include "tsTSPacket.h"
+#include "tsByteBlock.h"
 #include "tsEnumeration.h"
 
 namespace ts {
@@ -129,6 +130,80 @@ namespace ts {
         //!
         size_t packetTrailerSize() const;
 
+        //!
+        //! Get the packet header size of a packet format.
+        //! @param [in] format Packet format.
+        //! @return The packet header size in bytes (before the TS packet).
+        //!
+        static size_t PacketHeaderSize(TSPacketFormat format);
+
+        //!
+        //! Get the packet trailer size of a packet format.
+        //! @param [in] format Packet format.
+        //! @return The packet trailer size in bytes (after the TS packet).
+        //!
+        static size_t PacketTrailerSize(TSPacketFormat format);
+
+        //!
+        //! Default minimum number of consecutive packets to find when resynchronizing an input stream.
+        //!
+        static constexpr size_t DEFAULT_RESYNC_PACKETS = 16;
+
+        //!
+        //! Set automatic resynchronization on input.
+        //!
+        //! By default, the packets are read at fixed positions in the stream and a loss of
+        //! synchronization (no 0x47 sync byte at start of a TS packet) is left to the application.
+        //! When resynchronization is enabled, the lost packet and all subsequent data are skipped
+        //! until a sequence of consecutive packets is found, with the same packet format.
+        //! When the format is auto-detected, the first packets are located the same way,
+        //! at any offset in the stream.
+        //!
+        //! This must be set before reading the first packet.
+        //! @param [in] min_packets Minimum number of consecutive packets to find in order to consider
+        //! that the stream is resynchronized. Zero means no resynchronization (the default).
+        //!
+        void setResync(size_t min_packets) { _resync_packets = min_packets; }
+
+        //!
+        //! Get the number of resynchronizations in the input stream.
+        //! @return The number of times the synchronization was lost and recovered since the stream was open.
+        //!
+        size_t resyncCount() const { return _resync_count; }
+
+        //!
+        //! Get the number of bytes which were skipped to resynchronize the input stream.
+        //! @return The number of skipped bytes since the stream was open.
+        //!
+        uint64_t resyncSkippedBytes() const { return _resync_bytes; }
+
+        //!
+        //! Locate a sequence of consecutive packets in a memory buffer.
+        //! The search is based on the lattice of 0x47 sync bytes. The candidate sync bytes
+        //! are located using memchr(), which is vectorized in most C libraries.
+        //! @param [in] data Address of the memory buffer.
+        //! @param [in] size Size in bytes of the memory buffer.
+        //! @param [in] packet_size Size in bytes of each packet, including header and trailer.
+        //! @param [in] header_size Size in bytes of the header before each TS packet.
+        //! @param [in] min_packets Minimum number of consecutive packets, all of them
+        //! entirely contained in the buffer.
+        //! @return The offset in @a data of the first packet, including its header, or NPOS if not found.
+        //!
+        static size_t LocatePackets(const uint8_t* data, size_t size, size_t packet_size, size_t header_size, size_t min_packets);
+
+        //!
+        //! Locate a sequence of consecutive packets of a known or unknown format in a memory buffer.
+        //! In the DUCK format, the header of each packet must also be valid.
+        //! @param [in] data Address of the memory buffer.
+        //! @param [in] size Size in bytes of the memory buffer.
+        //! @param [in] min_packets Minimum number of consecutive packets, all of them
+        //! entirely contained in the buffer.
+        //! @param [in,out] format Packet format. If AUTODETECT on input, all formats are tried
+        //! and @a format receives the format of the first sequence of packets.
+        //! @return The offset in @a data of the first packet, including its header, or NPOS if not found.
+        //!
+        static size_t LocatePackets(const uint8_t* data, size_t size, size_t min_packets, TSPacketFormat& format);
+
         //!
         //! Get the file format.
         //! @return The file format.
@@ -160,5 +235,19 @@ namespace ts {
         uint64_t _last_timestamp;             // Last write time stamp in PCR units (M2TS files).
         size_t   _trail_size;                 // Number of meaningful bytes in _trail
         uint8_t  _trail[MAX_TRAILER_SIZE+1];  // Transient buffer for auto-detection of trailer
+        size_t   _resync_packets;             // Minimum number of packets to resynchronize, zero if disabled.
+        size_t   _resync_count;               // Number of resynchronizations.
+        uint64_t _resync_bytes;               // Number of skipped bytes during resynchronizations.
+        ByteBlock _pending;                   // Data which were read ahead during resynchronization.
+
+        // Read data from the pending buffer first, then from the reader.
+        bool readPending(void* data, size_t size, size_t& read_size, Report& report);
+
+        // Push back data which were read without synchronization.
+        void unread(const void* data, size_t size);
+
+        // Resynchronize the input stream, starting at the pending data.
+        // Detect the format if unknown. Return false at end of stream or on error.
+        bool resync(Report& report, PacketCounter packets);
     };
 }
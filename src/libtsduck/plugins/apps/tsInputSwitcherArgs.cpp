@@ -49,6 +49,7 @@ ts::InputSwitcherArgs::InputSwitcherArgs() :
     appName(),
     fastSwitch(false),
     delayedSwitch(false),
+    seamlessSwitch(false),
     terminate(false),
     reusePort(false),
     firstInput(0),
@@ -220,6 +221,18 @@ void ts::InputSwitcherArgs::defineArgs(Args& args)
               u"If an optional address is specified, it must be a local IP address of the system. "
               u"By default, there is no remote control.");
 
+    args.option(u"seamless-switch", 's');
+    args.help(u"seamless-switch",
+              u"Perform seamless input switching. This option implies --fast-switch. "
+              u"While an input plugin is not the current one, the random access points "
+              u"(packets with a random_access_indicator) in its buffer are indexed. "
+              u"When switching to it, the output starts at the most recent random access "
+              u"point, minimizing the time-to-picture of downstream decoders. The continuity "
+              u"counters are fixed to be continuous across the switch and the first PCR in "
+              u"each PID from the new input is marked with a discontinuity_indicator.\n\n"
+              u"To be effective, the --buffer-packets value must be large enough to contain "
+              u"a complete GOP of each input.");
+
     args.option(u"terminate", 't');
     args.help(u"terminate", u"Terminate execution when the current input plugin terminates.");
 
@@ -238,6 +251,8 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
     appName = args.appName();
     fastSwitch = args.present(u"fast-switch");
     delayedSwitch = args.present(u"delayed-switch");
+    seamlessSwitch = args.present(u"seamless-switch");
+    fastSwitch = fastSwitch || seamlessSwitch;
     terminate = args.present(u"terminate");
     args.getIntValue(cycleCount, u"cycle", args.present(u"infinite") ? 0 : 1);
     args.getIntValue(bufferedPackets, u"buffer-packets", DEFAULT_BUFFERED_PACKETS);
@@ -261,7 +276,7 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
         args.error(u"options --cycle, --infinite and --terminate are mutually exclusive");
     }
     if (fastSwitch && delayedSwitch) {
-        args.error(u"options --delayed-switch and --fast-switch are mutually exclusive");
+        args.error(u"options --delayed-switch and --fast-switch (or --seamless-switch) are mutually exclusive");
     }
 
     // Resolve network names. The resolve() method reports error and set the args error state.
@@ -48,6 +48,7 @@ namespace ts {
         UString             appName;           //!< Application name, for help messages.
         bool                fastSwitch;        //!< Fast switch between input plugins.
         bool                delayedSwitch;     //!< Delayed switch between input plugins.
+        bool                seamlessSwitch;    //!< Seamless switch, start new input from its latest random access point.
         bool                terminate;         //!< Terminate when one input plugin completes.
         bool                reusePort;         //!< Reuse-port socket option.
         size_t              firstInput;        //!< Index of first input plugin.
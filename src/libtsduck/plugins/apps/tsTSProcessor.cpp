@@ -143,7 +143,7 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
         _input = new tsp::InputExecutor(_args, *this, _args.input, ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()), _mutex, &_report);
         CheckNonNull(_input);
 
-        _output = new tsp::OutputExecutor(_args, *this, _args.output, ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), _mutex, &_report);
+        _output = new tsp::OutputExecutor(_args, *this, 0, ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), _mutex, &_report);
         CheckNonNull(_output);
 
         _output->ringInsertAfter(_input);
@@ -151,6 +151,14 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
         // Check if at least one plugin prefers real-time defaults.
         bool realtime = _args.realtime == Tristate::TRUE || _input->isRealTime() || _output->isRealTime();
 
+        // Output branches are located after the main output, just before the input in the ring.
+        for (size_t i = 0; i < _args.branches.size(); ++i) {
+            tsp::PluginExecutor* p = new tsp::OutputExecutor(_args, *this, i + 1, ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), _mutex, &_report);
+            CheckNonNull(p);
+            p->ringInsertBefore(_input);
+            realtime = realtime || p->isRealTime();
+        }
+
         for (size_t i = 0; i < _args.plugins.size(); ++i) {
             tsp::PluginExecutor* p = new tsp::ProcessorExecutor(_args, *this, i, ThreadAttributes(), _mutex, &_report);
             CheckNonNull(p);
@@ -204,9 +212,9 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
         // End of locked section.
     }
 
-    // Start all processors, except output, in reverse order (input last).
+    // Start all processors, except outputs, in reverse order (input last).
     // Exit application in case of error.
-    for (tsp::PluginExecutor* proc = _output->ringPrevious<tsp::PluginExecutor>(); proc != _output; proc = proc->ringPrevious<tsp::PluginExecutor>()) {
+    for (tsp::PluginExecutor* proc = _output->ringPrevious<tsp::PluginExecutor>(); !proc->isOutput(); proc = proc->ringPrevious<tsp::PluginExecutor>()) {
         if (!proc->plugin()->start()) {
             _report.debug(u"start() error in plugin %s", {proc->pluginName()});
             cleanupInternal();
@@ -222,12 +230,14 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
         return false;
     }
 
-    // Start the output device (we now have an idea of the bitrate).
+    // Start the output devices (we now have an idea of the bitrate).
     // Exit application in case of error.
-    if (!_output->plugin()->start()) {
-        _report.debug(u"start() error in output plugin %s", {_output->pluginName()});
-        cleanupInternal();
-        return false;
+    for (tsp::PluginExecutor* proc = _output; proc != _input; proc = proc->ringNext<tsp::PluginExecutor>()) {
+        if (!proc->plugin()->start()) {
+            _report.debug(u"start() error in output plugin %s", {proc->pluginName()});
+            cleanupInternal();
+            return false;
+        }
     }
 
     // Start all plugin executors threads.
@@ -114,7 +114,7 @@ namespace ts {
         volatile bool         _terminating;      // In the process of terminating everything.
         TSProcessorArgs       _args;             // Processing options.
         tsp::InputExecutor*   _input;            // Input processor execution thread.
-        tsp::OutputExecutor*  _output;           // Output processor execution thread.
+        tsp::OutputExecutor*  _output;           // Main output processor execution thread (output branches follow in the ring).
         tsp::ControlServer*   _control;          // TSP control command server thread.
         PacketBuffer*         _packet_buffer;    // Global TS packet buffer.
         PacketMetadataBuffer* _metadata_buffer;  // Global packet metabata buffer.
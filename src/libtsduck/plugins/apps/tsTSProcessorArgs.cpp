@@ -76,7 +76,8 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     duck_args(),
     input(),
     plugins(),
-    output()
+    output(),
+    branches()
 {
 }
 
@@ -290,11 +291,17 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
         pargs->getPlugin(input, PluginType::INPUT, u"file");
         pargs->getPlugin(output, PluginType::OUTPUT, u"file");
         pargs->getPlugins(plugins, PluginType::PROCESSOR);
+        // All output plugins after the first one are output branches.
+        pargs->getPlugins(branches, PluginType::OUTPUT);
+        if (!branches.empty()) {
+            branches.erase(branches.begin());
+        }
     }
     else {
         input.set(u"file");
         output.set(u"file");
         plugins.clear();
+        branches.clear();
     }
 
     // Get default options for TSDuck contexts in each plugin.
@@ -73,6 +73,7 @@ namespace ts {
         PluginOptions          input;       //!< Input plugin description.
         PluginOptionsVector    plugins;     //!< Packet processor plugins descriptions.
         PluginOptions          output;      //!< Output plugin description.
+        PluginOptionsVector    branches;    //!< Additional output plugins descriptions, receiving the same packets as @a output.
 
         static constexpr size_t DEFAULT_BUFFER_SIZE = 16 * 1000000;  //!< Default size in bytes of global TS buffer.
         static constexpr size_t MIN_BUFFER_SIZE = 18800;             //!< Minimum size in bytes of global TS buffer.
@@ -29,6 +29,7 @@
 
 #include "tsPluginThread.h"
 #include "tsPluginRepository.h"
+#include "tsGuardMutex.h"
 
 
 //----------------------------------------------------------------------------
@@ -41,7 +42,10 @@ ts::PluginThread::PluginThread(Report* report, const UString& appName, PluginTyp
     _report(report),
     _name(options.name),
     _logname(),
-    _shlib(nullptr)
+    _shlib(nullptr),
+    _log_mutex(),
+    _log_format(),
+    _log_line()
 {
     const UChar* shellOpt = nullptr;
 
@@ -142,5 +146,25 @@ ts::Plugin* ts::PluginThread::plugin() const
 
 void ts::PluginThread::writeLog(int severity, const UString& msg)
 {
-    _report->log(severity, u"%s: %s", {_logname.empty() ? _name : _logname, msg});
+    // The mutex is recursive, it may be already held by log() below.
+    GuardMutex lock(_log_mutex);
+    _log_line.assign(_logname.empty() ? _name : _logname);
+    _log_line.append(u": ");
+    _log_line.append(msg);
+    _report->log(severity, _log_line);
+}
+
+void ts::PluginThread::log(int severity, const UChar* fmt, std::initializer_list<ArgMixIn> args)
+{
+    if (severity <= _max_severity) {
+        GuardMutex lock(_log_mutex);
+        _log_format.clear();
+        _log_format.format(fmt, args);
+        Report::log(severity, _log_format);
+    }
+}
+
+void ts::PluginThread::log(int severity, const UString& fmt, std::initializer_list<ArgMixIn> args)
+{
+    log(severity, fmt.c_str(), args);
 }
@@ -36,6 +36,7 @@
 #include "tsThread.h"
 #include "tsPlugin.h"
 #include "tsPluginOptions.h"
+#include "tsMutex.h"
 
 namespace ts {
     //!
@@ -89,14 +90,23 @@ namespace ts {
         virtual UString pluginName() const override;
         virtual Plugin* plugin() const override;
 
+        // Inherited from Report (via TSP).
+        // Messages are formatted in reused buffers instead of temporary strings.
+        using Report::log;
+        virtual void log(int severity, const UChar* fmt, std::initializer_list<ArgMixIn> args) override;
+        virtual void log(int severity, const UString& fmt, std::initializer_list<ArgMixIn> args) override;
+
     protected:
         // Inherited from Report (via TSP)
         virtual void writeLog(int severity, const UString& msg) override;
 
     private:
-        Report*       _report;  // Common report interface for all plugins
-        const UString _name;    // Plugin name.
-        UString       _logname; // Plugin name as displayed in log messages.
-        Plugin*       _shlib;   // Shared library API.
+        Report*       _report;     // Common report interface for all plugins
+        const UString _name;       // Plugin name.
+        UString       _logname;    // Plugin name as displayed in log messages.
+        Plugin*       _shlib;      // Shared library API.
+        Mutex         _log_mutex;  // Protect the log buffers, plugins may log from several threads.
+        UString       _log_format; // Buffer for formatted messages.
+        UString       _log_line;   // Buffer for messages prefixed with the plugin name.
     };
 }
@@ -45,11 +45,14 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_,
                                                              bool real_time) :
     InputPlugin(tsp_, description, syntax),
     _real_time(real_time),
+    _buffer_size(std::max(buffer_size, 7 * PKT_SIZE)),
     _eval_time(0),
     _display_time(0),
     _time_priority_enum(),
     _time_priority(RTP_TSP),
     _default_time_priority(RTP_TSP),
+    _reorder_size(0),
+    _reorder_latency(0),
     _next_display(Time::Epoch),
     _start(Time::Epoch),
     _packets(0),
@@ -60,8 +63,22 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_,
     _inbuf_count(0),
     _inbuf_next(0),
     _mdata_next(0),
-    _inbuf(std::max(buffer_size, 7 * PKT_SIZE)),
-    _mdata(_inbuf.size() / PKT_SIZE)
+    _mdata(_buffer_size / PKT_SIZE),
+    _datagrams(1, Datagram(_buffer_size)),
+    _free(),
+    _current(NPOS),
+    _pending(),
+    _rtp_valid(false),
+    _rtp_start(false),
+    _rtp_next(0),
+    _rtp_max(0),
+    _resync(NPOS),
+    _flush(false),
+    _eof(false),
+    _rtp_reordered(0),
+    _rtp_lost(0),
+    _rtp_late(0),
+    _rtp_recovered(0)
 {
     if (_real_time) {
         option(u"display-interval", 'd', POSITIVE);
@@ -90,6 +107,23 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_,
         system_help = u"- " + system_time_name + u" : " + system_time_description + u".\n";
     }
 
+    option(u"rtp-reorder-buffer", 0, INTEGER, 0, 1, 0, 10000);
+    help(u"rtp-reorder-buffer", u"count",
+         u"Reorder RTP datagrams according to their sequence number. "
+         u"The value is the maximum number of datagrams which are held while waiting for a missing one. "
+         u"When the buffer is full or the oldest held datagram exceeds --rtp-reorder-latency, "
+         u"the missing datagrams are declared lost. "
+         u"Datagrams which arrive after their position was skipped are dropped. "
+         u"Non-RTP datagrams are never reordered. "
+         u"By default, datagrams are passed in arrival order.");
+
+    option(u"rtp-reorder-latency", 0, POSITIVE);
+    help(u"rtp-reorder-latency", u"milliseconds",
+         u"With --rtp-reorder-buffer, maximum time in milliseconds a datagram is held in the reordering buffer "
+         u"while waiting for a missing one. "
+         u"The delay is checked each time a new datagram is received. "
+         u"The default is 100 ms.");
+
     option(u"timestamp-priority", 0, _time_priority_enum);
     help(u"timestamp-priority", u"name",
          u"Specify how the input time-stamp of each packet is computed. "
@@ -124,6 +158,8 @@ bool ts::AbstractDatagramInputPlugin::getOptions()
         _display_time = MilliSecPerSec * intValue<MilliSecond>(u"display-interval", 0);
     }
     getIntValue(_time_priority, u"timestamp-priority", _default_time_priority);
+    getIntValue(_reorder_size, u"rtp-reorder-buffer", 0);
+    getIntValue(_reorder_latency, u"rtp-reorder-latency", 100);
     return true;
 }
 
@@ -138,10 +174,65 @@ bool ts::AbstractDatagramInputPlugin::start()
     _inbuf_count = _inbuf_next = _mdata_next = 0;
     _start = _start_0 = _start_1 = _next_display = Time::Epoch;
     _packets = _packets_0 = _packets_1 = 0;
+
+    // One datagram buffer per reordering slot, plus one for the datagram being received.
+    _datagrams.resize(_reorder_size + 1, Datagram(_buffer_size));
+    _free.clear();
+    for (size_t i = _datagrams.size(); i > 0; --i) {
+        _free.push_back(i - 1);
+    }
+    _current = _resync = NPOS;
+
+    // Initialize RTP reordering.
+    _pending.clear();
+    _rtp_valid = _rtp_start = _flush = _eof = false;
+    _rtp_next = _rtp_max = 0;
+    _rtp_reordered = _rtp_lost = _rtp_late = _rtp_recovered = 0;
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Input stop method
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::stop()
+{
+    if (_reorder_size > 0) {
+        tsp->verbose(u"RTP reordering: %'d datagrams reordered, %'d recovered, %'d lost, %'d late or duplicated", {_rtp_reordered, _rtp_recovered, _rtp_lost, _rtp_late});
+    }
+    return InputPlugin::stop();
+}
+
+
+//----------------------------------------------------------------------------
+// Default implementation of missing datagram recovery: nothing to recover.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::recoverDatagram(uint16_t, uint8_t*, size_t, size_t& ret_size)
+{
+    ret_size = 0;
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Description of a received datagram.
+//----------------------------------------------------------------------------
+
+ts::AbstractDatagramInputPlugin::Datagram::Datagram(size_t size) :
+    data(size),
+    pkt_start(0),
+    pkt_count(0),
+    timestamp(-1),
+    rtp(false),
+    rtp_sequence(0),
+    rtp_timestamp(0),
+    arrival()
+{
+}
+
+
 //----------------------------------------------------------------------------
 // Input bitrate evaluation method
 //----------------------------------------------------------------------------
@@ -173,79 +264,61 @@ ts::BitRateConfidence ts::AbstractDatagramInputPlugin::getBitrateConfidence()
 
 size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
 {
-    MicroSecond timestamp = -1;
-
     // Check if we receive new packets or process remain of previous buffer.
     bool new_packets = false;
 
-    // If there is no remaining packet in the input buffer, wait for a datagram message.
-    // Loop until we get some TS packets.
-    while (_inbuf_count == 0) {
-
-        // Wait for a datagram message
-        size_t insize = 0;
-        if (!receiveDatagram(_inbuf.data(), _inbuf.size(), insize, timestamp)) {
+    // If there is no remaining packet in the current datagram, get the next one.
+    if (_inbuf_count == 0) {
+        if (!getDatagram()) {
             return 0;
         }
+        const Datagram& dg(_datagrams[_current]);
+        _inbuf_next = dg.pkt_start;
+        _inbuf_count = dg.pkt_count;
+        new_packets = true;
+
+        // Use RTP time stamp if there is one and RTP is the preferred choice.
+        bool use_rtp = false;
+        bool use_kernel = false;
+        switch (_time_priority) {
+            case RTP_SYSTEM_TSP:
+                use_rtp = dg.rtp;
+                use_kernel = !dg.rtp && dg.timestamp >= 0;
+                break;
+            case SYSTEM_RTP_TSP:
+                use_kernel = dg.timestamp >= 0;
+                use_rtp = !use_kernel && dg.rtp;
+                break;
+            case RTP_TSP:
+                use_rtp = dg.rtp;
+                use_kernel = false;
+                break;
+            case SYSTEM_TSP:
+                use_kernel = dg.timestamp >= 0;
+                use_rtp = false;
+                break;
+            case TSP_ONLY:
+            default:
+                use_rtp = false;
+                use_kernel = false;
+                break;
+        }
 
-        // Look for TS packets in the UDP message.
-        new_packets = TSPacket::Locate(_inbuf.data(), insize, _inbuf_next, _inbuf_count);
-
-        if (new_packets) {
-
-            // Look for an RTP header before the first packet. There is no clear proof of the presence of the RTP header.
-            // We check if the header size is large enough for an RTP header and if the "RTP payload type" is MPEG-2 TS.
-            const bool rtp = _inbuf_next >= RTP_HEADER_SIZE && (_inbuf[1] & 0x7F) == RTP_PT_MP2T;
-            const uint32_t rtp_timestamp = rtp ? GetUInt32(_inbuf.data() + 4) : 0;
-
-            // Use RTP time stamp if there is one and RTP is the preferred choice.
-            bool use_rtp = false;
-            bool use_kernel = false;
-            switch (_time_priority) {
-                case RTP_SYSTEM_TSP:
-                    use_rtp = rtp;
-                    use_kernel = !rtp && timestamp >= 0;
-                    break;
-                case SYSTEM_RTP_TSP:
-                    use_kernel = timestamp >= 0;
-                    use_rtp = !use_kernel && rtp;
-                    break;
-                case RTP_TSP:
-                    use_rtp = rtp;
-                    use_kernel = false;
-                    break;
-                case SYSTEM_TSP:
-                    use_kernel = timestamp >= 0;
-                    use_rtp = false;
-                    break;
-                case TSP_ONLY:
-                default:
-                    use_rtp = false;
-                    use_kernel = false;
-                    break;
+        // Build time stamps in packet metadata.
+        _mdata_next = 0;
+        for (size_t i = 0; i < _inbuf_count; ++i) {
+            if (use_rtp) {
+                // RTP time stamp unit is 90 kHz (RTP_RATE_MP2T)
+                _mdata[i].setInputTimeStamp(dg.rtp_timestamp, RTP_RATE_MP2T, TimeSource::RTP);
             }
-
-            // Build time stamps in packet metadata.
-            _mdata_next = 0;
-            for (size_t i = 0; i < _inbuf_count; ++i) {
-                if (use_rtp) {
-                    // RTP time stamp unit is 90 kHz (RTP_RATE_MP2T)
-                    _mdata[i].setInputTimeStamp(rtp_timestamp, RTP_RATE_MP2T, TimeSource::RTP);
-                }
-                else if (use_kernel) {
-                    // IP time stamp unit is microseconds.
-                    _mdata[i].setInputTimeStamp(uint64_t(timestamp), MicroSecPerSec, TimeSource::KERNEL);
-                }
-                else {
-                    _mdata[i].clearInputTimeStamp();
-                }
+            else if (use_kernel) {
+                // IP time stamp unit is microseconds.
+                _mdata[i].setInputTimeStamp(uint64_t(dg.timestamp), MicroSecPerSec, TimeSource::KERNEL);
+            }
+            else {
+                _mdata[i].clearInputTimeStamp();
             }
-
-            break; // found packets.
         }
-
-        // No TS packet found in UDP message, wait for another one.
-        tsp->debug(u"no TS packet in message, %s bytes", {insize});
     }
 
     // If new packets were received, we may need to re-evaluate the real-time input bitrate.
@@ -288,9 +361,9 @@ size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetada
         }
     }
 
-    // Return packets from the input buffer
+    // Return packets from the current datagram.
     size_t pkt_cnt = std::min(_inbuf_count, max_packets);
-    TSPacket::Copy(buffer, _inbuf.data() + _inbuf_next, pkt_cnt);
+    TSPacket::Copy(buffer, _datagrams[_current].data.data() + _inbuf_next, pkt_cnt);
     TSPacketMetadata::Copy(pkt_data, &_mdata[_mdata_next], pkt_cnt);
     _inbuf_count -= pkt_cnt;
     _inbuf_next += pkt_cnt * PKT_SIZE;
@@ -298,3 +371,199 @@ size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetada
 
     return pkt_cnt;
 }
+
+
+//----------------------------------------------------------------------------
+// Get the next datagram to process in _current.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::getDatagram()
+{
+    // Release the previous datagram.
+    if (_current != NPOS) {
+        releaseDatagram(_current);
+        _current = NPOS;
+    }
+
+    for (;;) {
+        // Check if the first pending datagram can be returned.
+        if (!_pending.empty()) {
+            const auto first = _pending.begin();
+            if (first->first > _rtp_next && !_rtp_start && recoverNextDatagram()) {
+                // The next missing datagram was recovered by the subclass, typically using FEC.
+                return true;
+            }
+            if ((first->first == _rtp_next && !_rtp_start) ||
+                _flush ||
+                _pending.size() >= _reorder_size ||
+                Time::CurrentUTC() >= _datagrams[first->second].arrival + _reorder_latency)
+            {
+                if (first->first > _rtp_next) {
+                    // Give up waiting for missing datagrams.
+                    const uint64_t lost = first->first - _rtp_next;
+                    _rtp_lost += lost;
+                    tsp->debug(u"lost %d RTP datagrams before sequence %d", {lost, _datagrams[first->second].rtp_sequence});
+                }
+                _rtp_next = first->first + 1;
+                _rtp_start = false;
+                _current = first->second;
+                _pending.erase(first);
+                return true;
+            }
+        }
+
+        // Once the reordering buffer is flushed, restart the RTP sequence or stop.
+        size_t index = NPOS;
+        if (_pending.empty()) {
+            _flush = false;
+            if (_resync != NPOS) {
+                // Datagrams are lost in a forward jump, not in a restart of the sequence.
+                const int16_t diff = int16_t(uint16_t(_datagrams[_resync].rtp_sequence - uint16_t(_rtp_next)));
+                if (diff > 0) {
+                    _rtp_lost += diff;
+                }
+                tsp->verbose(u"RTP sequence discontinuity, %d datagrams lost, restarting at sequence %d", {std::max<int16_t>(diff, 0), _datagrams[_resync].rtp_sequence});
+                index = _resync;
+                _resync = NPOS;
+                _rtp_valid = false;
+            }
+            else if (_eof) {
+                return false;
+            }
+        }
+
+        // Receive a new datagram directly in a free buffer.
+        if (index == NPOS) {
+            assert(!_free.empty());
+            index = _free.back();
+            _free.pop_back();
+            Datagram& dg(_datagrams[index]);
+            size_t insize = 0;
+            dg.timestamp = -1;
+            if (!receiveDatagram(dg.data.data(), dg.data.size(), insize, dg.timestamp)) {
+                // End of input, return the pending datagrams first.
+                releaseDatagram(index);
+                _eof = _flush = true;
+                continue;
+            }
+
+            // Look for TS packets in the UDP message.
+            if (!analyzeDatagram(dg, insize)) {
+                // No TS packet found in UDP message, wait for another one.
+                tsp->debug(u"no TS packet in message, %s bytes", {insize});
+                releaseDatagram(index);
+                continue;
+            }
+        }
+
+        // Without reordering, all datagrams are returned in arrival order.
+        if (_reorder_size == 0 || !_datagrams[index].rtp || reorderDatagram(index)) {
+            _current = index;
+            return true;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Locate TS packets and RTP header in a received datagram.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::analyzeDatagram(Datagram& dg, size_t size)
+{
+    if (!TSPacket::Locate(dg.data.data(), size, dg.pkt_start, dg.pkt_count)) {
+        return false;
+    }
+
+    // Look for an RTP header before the first packet. There is no clear proof of the presence of the RTP header.
+    // We check if the header size is large enough for an RTP header and if the "RTP payload type" is MPEG-2 TS.
+    dg.rtp = dg.pkt_start >= RTP_HEADER_SIZE && (dg.data[1] & 0x7F) == RTP_PT_MP2T;
+    dg.rtp_sequence = dg.rtp ? GetUInt16(dg.data.data() + 2) : 0;
+    dg.rtp_timestamp = dg.rtp ? GetUInt32(dg.data.data() + 4) : 0;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Try to recover the next expected RTP datagram in _current.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::recoverNextDatagram()
+{
+    if (_free.empty()) {
+        return false;
+    }
+    const size_t index = _free.back();
+    Datagram& dg(_datagrams[index]);
+    size_t size = 0;
+    if (!recoverDatagram(uint16_t(_rtp_next), dg.data.data(), dg.data.size(), size) || !analyzeDatagram(dg, size) || !dg.rtp) {
+        return false;
+    }
+    tsp->debug(u"recovered missing RTP datagram, sequence %d", {dg.rtp_sequence});
+    _free.pop_back();
+    dg.timestamp = -1;
+    _rtp_recovered++;
+    _rtp_next++;
+    _rtp_start = false;
+    _current = index;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Insert a new RTP datagram in the reordering buffer.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::reorderDatagram(size_t index)
+{
+    Datagram& dg(_datagrams[index]);
+
+    // The 16-bit RTP sequence numbers are extended to 64 bits, starting far from zero.
+    // The first datagram is held like the others since the previous ones may arrive later.
+    if (!_rtp_valid) {
+        _rtp_valid = _rtp_start = true;
+        _rtp_next = _rtp_max = (uint64_t(1) << 32) + dg.rtp_sequence;
+    }
+    const int16_t diff = int16_t(uint16_t(dg.rtp_sequence - uint16_t(_rtp_next)));
+    const uint64_t seq = uint64_t(int64_t(_rtp_next) + diff);
+
+    // A jump in the sequence which is much larger than the reordering buffer cannot be reordered.
+    // This is either a large loss or a restart of the sequence.
+    const int64_t max_gap = int64_t(4 * _reorder_size + 16);
+
+    if (seq == _rtp_next && _pending.empty() && !_rtp_start) {
+        // Common case, the datagram is in order, return it immediately.
+        _rtp_next = seq + 1;
+        _rtp_max = std::max(_rtp_max, seq);
+        return true;
+    }
+    else if (diff < -max_gap || diff > max_gap) {
+        // Return all pending datagrams first, then restart from this one.
+        _resync = index;
+        _flush = true;
+    }
+    else if (seq < _rtp_next && !_rtp_start) {
+        // Too late, its position was already skipped.
+        _rtp_late++;
+        tsp->debug(u"late RTP datagram, sequence %d", {dg.rtp_sequence});
+        releaseDatagram(index);
+    }
+    else if (_pending.find(seq) != _pending.end()) {
+        // Duplicated datagram.
+        _rtp_late++;
+        releaseDatagram(index);
+    }
+    else {
+        // Hold the datagram until missing ones are received.
+        if (seq < _rtp_max) {
+            _rtp_reordered++;
+        }
+        else {
+            _rtp_max = seq;
+        }
+        _rtp_next = std::min(_rtp_next, seq);
+        dg.arrival = Time::CurrentUTC();
+        _pending.insert(std::make_pair(seq, index));
+    }
+    return false;
+}
@@ -44,6 +44,11 @@ namespace ts {
     //! Abstract base class for input plugins receiving real-time datagrams.
     //! The input bitrate is computed from the received bytes and wall-clock time.
     //! TS packets are located in each received datagram, skipping potential headers.
+    //!
+    //! Optionally, RTP datagrams can be reordered according to their sequence number
+    //! in a bounded reordering buffer. Datagrams are received directly in the buffer
+    //! and in-order datagrams are returned without additional copy.
+    //!
     //! @ingroup plugin
     //!
     class TSDUCKDLL AbstractDatagramInputPlugin: public InputPlugin
@@ -53,6 +58,7 @@ namespace ts {
         // Implementation of plugin API.
         virtual bool getOptions() override;
         virtual bool start() override;
+        virtual bool stop() override;
         virtual bool isRealTime() override;
         virtual BitRate getBitrate() override;
         virtual BitRateConfidence getBitrateConfidence() override;
@@ -91,17 +97,51 @@ namespace ts {
         //!
         virtual bool receiveDatagram(uint8_t* buffer, size_t buffer_size, size_t& ret_size, MicroSecond& timestamp) = 0;
 
+        //!
+        //! Try to recover a missing RTP datagram.
+        //! With RTP reordering, this method is invoked before declaring a datagram as lost.
+        //! Subclasses which receive redundant data, such as FEC streams, may rebuild the datagram.
+        //! The default implementation always fails.
+        //! @param [in] sequence RTP sequence number of the missing datagram.
+        //! @param [out] buffer Address of the buffer for the recovered datagram.
+        //! @param [in] buffer_size Size in bytes of the buffer.
+        //! @param [out] ret_size Size in bytes of the recovered datagram. Will never be larger than @a buffer_size.
+        //! @return True if the datagram was recovered, false otherwise.
+        //!
+        virtual bool recoverDatagram(uint16_t sequence, uint8_t* buffer, size_t buffer_size, size_t& ret_size);
+
     private:
         // Order of priority for input timestamps. SYSTEM means lower layer from subclass (UDP, SRT, etc).
         enum TimePriority {RTP_SYSTEM_TSP, SYSTEM_RTP_TSP, RTP_TSP, SYSTEM_TSP, TSP_ONLY};
 
+        // Description of a received datagram.
+        class Datagram
+        {
+        public:
+            Datagram(size_t size = 0);
+            ByteBlock   data;           // Datagram buffer, the datagram is directly received here.
+            size_t      pkt_start;      // Byte index in data of first TS packet.
+            size_t      pkt_count;      // Number of TS packets in datagram.
+            MicroSecond timestamp;      // Receive timestamp from subclass, -1 if not available.
+            bool        rtp;            // There is an RTP header.
+            uint16_t    rtp_sequence;   // RTP sequence number.
+            uint32_t    rtp_timestamp;  // RTP time stamp.
+            Time        arrival;        // Arrival time, when held in the reordering buffer.
+        };
+
+        // Pending RTP datagrams, indexed by extended sequence number, value is the index in _datagrams.
+        typedef std::map<uint64_t, size_t> PendingMap;
+
         // Configuration and command line options.
         bool          _real_time;             // Real-time reception.
+        size_t        _buffer_size;           // Size of each datagram buffer.
         MilliSecond   _eval_time;             // Bitrate evaluation interval in milli-seconds
         MilliSecond   _display_time;          // Bitrate display interval in milli-seconds
         Enumeration   _time_priority_enum;    // Enumeration values for _time_priority
         TimePriority  _time_priority;         // Priority of time stamps sources.
         TimePriority  _default_time_priority; // Priority of time stamps sources.
+        size_t        _reorder_size;          // Max number of datagrams in RTP reordering buffer, zero if no reordering.
+        MilliSecond   _reorder_latency;       // Max time a datagram is held in the reordering buffer.
 
         // Working data.
         Time          _next_display;          // Next bitrate display time
@@ -111,10 +151,41 @@ namespace ts {
         PacketCounter _packets_0;             // Number of received packets since _start_0
         Time          _start_1;               // Start of previous bitrate evaluation period
         PacketCounter _packets_1;             // Number of received packets since _start_1
-        size_t        _inbuf_count;           // Number of remaining TS packets in inbuf
-        size_t        _inbuf_next;            // Byte index in _inbuf of next TS packet to return
+        size_t        _inbuf_count;           // Number of remaining TS packets in current datagram
+        size_t        _inbuf_next;            // Byte index in current datagram of next TS packet to return
         size_t        _mdata_next;            // Index in _mdata of next TS packet metadata to return
-        ByteBlock     _inbuf;                 // Input buffer
-        TSPacketMetadataVector _mdata;        // Metadata for packets in _inbuf
+        TSPacketMetadataVector _mdata;        // Metadata for packets in current datagram
+        std::vector<Datagram>  _datagrams;    // Pool of datagram buffers, one per reordering slot, plus one.
+        std::vector<size_t>    _free;         // Indexes of free datagram buffers.
+        size_t        _current;               // Index of current datagram in _datagrams, NPOS if none.
+
+        // RTP reordering state and statistics.
+        PendingMap    _pending;               // Datagrams which are held, waiting for missing ones.
+        bool          _rtp_valid;             // The following sequence numbers are valid.
+        bool          _rtp_start;             // Start of sequence, no datagram returned yet, earlier ones are accepted.
+        uint64_t      _rtp_next;              // Next expected extended sequence number.
+        uint64_t      _rtp_max;               // Highest received extended sequence number.
+        size_t        _resync;                // Index of a datagram restarting the sequence, NPOS if none.
+        bool          _flush;                 // Flush all pending datagrams, regardless of missing ones.
+        bool          _eof;                   // End of input from subclass.
+        PacketCounter _rtp_reordered;         // Number of datagrams received out of order and reordered.
+        PacketCounter _rtp_lost;              // Number of missing datagrams.
+        PacketCounter _rtp_late;              // Number of datagrams received too late or duplicated, dropped.
+        PacketCounter _rtp_recovered;         // Number of missing datagrams which were recovered by the subclass.
+
+        // Get the next datagram to process in _current. Return false on end of input.
+        bool getDatagram();
+
+        // Locate TS packets and RTP header in a received datagram. Return false if there is no TS packet.
+        bool analyzeDatagram(Datagram& dg, size_t size);
+
+        // Try to recover the next expected RTP datagram in _current. Return false if not recovered.
+        bool recoverNextDatagram();
+
+        // Insert a new RTP datagram in the reordering buffer. Return true if it can be immediately returned.
+        bool reorderDatagram(size_t index);
+
+        // Release a datagram buffer.
+        void releaseDatagram(size_t index) { _free.push_back(index); }
     };
 }
@@ -58,8 +58,12 @@ ts::AbstractTablePlugin::AbstractTablePlugin(TSP* tsp_,
     _new_version(0),
     _demux(duck, this),
     _pzer(duck, pid),
-    _patch_xml(duck)
+    _patch_xml(duck),
+    _patcher()
 {
+    // Only new versions of the table are useful, drop repeated sections before reassembly.
+    _demux.filterRepeatedSections(true);
+
     _patch_xml.defineArgs(*this);
 
     option<BitRate>(u"bitrate", 'b');
@@ -203,6 +207,23 @@ void ts::AbstractTablePlugin::forceTableUpdate(BinaryTable& table)
 }
 
 
+//----------------------------------------------------------------------------
+// Patch a table in place, without full deserialization and reserialization.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractTablePlugin::patchTable(BinaryTable& table, BinaryTablePatcher::Handler& handler)
+{
+    if (_patcher.patch(table, handler)) {
+        tsp->debug(u"%s patched in place, %d sections modified out of %d", {_table_name, _patcher.modifiedSections(), table.sectionCount()});
+        return true;
+    }
+    else {
+        tsp->debug(u"cannot patch %s in place, regenerating the table", {_table_name});
+        return false;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Reinsert a table in the target PID.
 //----------------------------------------------------------------------------
@@ -37,6 +37,7 @@
 #include "tsSectionDemux.h"
 #include "tsCyclingPacketizer.h"
 #include "tsTablePatchXML.h"
+#include "tsBinaryTablePatcher.h"
 
 namespace ts {
     //!
@@ -111,6 +112,18 @@ namespace ts {
         //!
         void forceTableUpdate(BinaryTable& table);
 
+        //!
+        //! Patch a table in place, without full deserialization and reserialization.
+        //! Subclasses may use this method in modifyTable() when all their modifications
+        //! can be expressed at descriptor loop or loop entry level. When this method fails,
+        //! typically when a section overflows, the table is unmodified and the subclass
+        //! shall fall back to a full deserialization / modification / serialization.
+        //! @param [in,out] table The table to patch.
+        //! @param [in,out] handler The handler which is invoked on each loop entry and descriptor loop.
+        //! @return True if the table was successfully patched, false otherwise.
+        //!
+        bool patchTable(BinaryTable& table, BinaryTablePatcher::Handler& handler);
+
         //!
         //! Set the error flag to terminate the processing asap.
         //! @param [in] on Error state (true by default).
@@ -127,23 +140,24 @@ namespace ts {
         virtual void handleTable(SectionDemux&, const BinaryTable&) override;
 
     private:
-        bool              _abort;            // Error, abort as soon as possible.
-        UString           _table_name;       // Table name, informational only.
-        BitRate           _default_bitrate;  // Default bitrate of new PID.
-        PID               _pid;              // PID to process.
-        bool              _found_pid;        // Found the target PID.
-        bool              _found_table;      // Found an instance of the target table.
-        PacketCounter     _pkt_create;       // Packet# after which a new table shall be created
-        PacketCounter     _pkt_insert;       // Packet# after which a PID packet shall be inserted
-        MilliSecond       _create_after_ms;  // Create a new table if none found after that time.
-        BitRate           _bitrate;          // PID's bitrate (if no previous table found).
-        PacketCounter     _inter_pkt;        // Packet interval between two PID packets.
-        bool              _incr_version;     // Increment table version.
-        bool              _set_version;      // Set a new table version.
-        uint8_t           _new_version;      // New table version.
-        SectionDemux      _demux;            // Section demux.
-        CyclingPacketizer _pzer;             // Packetizer for modified tables.
-        TablePatchXML     _patch_xml;        // Table patcher using XML patch files.
+        bool               _abort;            // Error, abort as soon as possible.
+        UString            _table_name;       // Table name, informational only.
+        BitRate            _default_bitrate;  // Default bitrate of new PID.
+        PID                _pid;              // PID to process.
+        bool               _found_pid;        // Found the target PID.
+        bool               _found_table;      // Found an instance of the target table.
+        PacketCounter      _pkt_create;       // Packet# after which a new table shall be created
+        PacketCounter      _pkt_insert;       // Packet# after which a PID packet shall be inserted
+        MilliSecond        _create_after_ms;  // Create a new table if none found after that time.
+        BitRate            _bitrate;          // PID's bitrate (if no previous table found).
+        PacketCounter      _inter_pkt;        // Packet interval between two PID packets.
+        bool               _incr_version;     // Increment table version.
+        bool               _set_version;      // Set a new table version.
+        uint8_t            _new_version;      // New table version.
+        SectionDemux       _demux;            // Section demux.
+        CyclingPacketizer  _pzer;             // Packetizer for modified tables.
+        TablePatchXML      _patch_xml;        // Table patcher using XML patch files.
+        BinaryTablePatcher _patcher;          // In-place binary table patcher.
 
         // Reinsert a table in the target PID.
         void reinsertTable(BinaryTable& table, bool is_target_table);
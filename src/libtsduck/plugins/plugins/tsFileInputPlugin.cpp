@@ -50,6 +50,7 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
     _repeat_count(1),
     _start_offset(0),
     _base_label(0),
+    _resync(0),
     _file_format(TSPacketFormat::AUTODETECT),
     _filenames(),
     _start_stuffing(),
@@ -120,6 +121,17 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
     help(u"repeat",
          u"Repeat the playout of each file the specified number of times (default: only once). "
          u"This option is allowed only if all input files are regular files.");
+
+    option(u"resync", 0, INTEGER, 0, 1, 1, UNLIMITED_VALUE, true);
+    help(u"resync", u"count",
+         u"Automatically resynchronize the input when the synchronization is lost, "
+         u"for instance when the sync byte 0x47 is not found at the expected position "
+         u"because some bytes are missing in the file. "
+         u"The data are skipped until a sequence of consecutive packets is found. "
+         u"The optional value is the minimum number of consecutive packets to find "
+         u"(default: " + UString::Decimal(TSPacketStream::DEFAULT_RESYNC_PACKETS) + u"). "
+         u"When the format is automatically detected, leading garbage at the start of the file is skipped. "
+         u"By default, the input terminates when the synchronization is lost.");
 }
 
 
@@ -137,6 +149,7 @@ bool ts::FileInputPlugin::getOptions()
     _first_terminate = present(u"first-terminate");
     getIntValue(_interleave_chunk, u"interleave", 1);
     getIntValue(_base_label, u"label-base", TSPacketMetadata::LABEL_MAX + 1);
+    getIntValue(_resync, u"resync", present(u"resync") ? TSPacketStream::DEFAULT_RESYNC_PACKETS : 0);
     getIntValues(_start_stuffing, u"add-start-stuffing");
     getIntValues(_stop_stuffing, u"add-stop-stuffing");
     _file_format = LoadTSPacketFormatInputOption(*this);
@@ -184,8 +197,9 @@ bool ts::FileInputPlugin::openFile(size_t name_index, size_t file_index)
         tsp->verbose(u"reading file %s", {name.empty() ? u"'stdin'" : name});
     }
 
-    // Preset artificial stuffing.
+    // Preset artificial stuffing and resynchronization.
     _files[file_index].setStuffing(_start_stuffing[name_index], _stop_stuffing[name_index]);
+    _files[file_index].setResync(_resync);
 
     // Actually open the file.
     return _files[file_index].openRead(name, _repeat_count, _start_offset, *tsp, _file_format);
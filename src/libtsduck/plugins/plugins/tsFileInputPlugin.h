@@ -69,6 +69,7 @@ namespace ts {
         size_t         _repeat_count;
         uint64_t       _start_offset;
         size_t         _base_label;
+        size_t         _resync;             // Minimum number of packets to resynchronize, zero if disabled.
         TSPacketFormat _file_format;
         UStringVector  _filenames;
         std::vector<size_t>  _start_stuffing;
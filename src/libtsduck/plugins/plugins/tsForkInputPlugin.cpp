@@ -53,8 +53,26 @@ ts::ForkInputPlugin::ForkInputPlugin(TSP* tsp_) :
     option(u"buffered-packets", 'b', POSITIVE);
     help(u"buffered-packets", u"Windows only: Specifies the pipe buffer size in number of TS packets.");
 
+    option(u"shared-memory", 0, INTEGER, 0, 1, 1, UNLIMITED_VALUE, true);
+    help(u"shared-memory", u"packets",
+         u"Linux only: exchange TS packets with the created process using a shared memory ring "
+         u"instead of the pipe. The optional value is the number of packets in the ring. The default "
+         u"is " + UString::Decimal(SharedPacketRing::DEFAULT_PACKET_COUNT) + u" packets. The created "
+         u"process shall cooperate and attach to the ring, typically using a command such as "
+         u"'tsp -O shmring ...'. If the created process does not attach to the ring within a few seconds, "
+         u"the pipe is used.");
+
     option(u"nowait", 'n');
     help(u"nowait", u"Do not wait for child process termination at end of its output.");
+
+    option(u"resync", 0, INTEGER, 0, 1, 1, UNLIMITED_VALUE, true);
+    help(u"resync", u"count",
+         u"Automatically resynchronize the input when the synchronization is lost in the output of the created process. "
+         u"The data are skipped until a sequence of consecutive packets is found. "
+         u"The optional value is the minimum number of consecutive packets to find "
+         u"(default: " + UString::Decimal(TSPacketStream::DEFAULT_RESYNC_PACKETS) + u"). "
+         u"This option is ignored when a shared memory ring is used. "
+         u"By default, the input terminates when the synchronization is lost.");
 }
 
 
@@ -68,6 +86,8 @@ bool ts::ForkInputPlugin::getOptions()
     getValue(_command, u"");
     getIntValue(_buffer_size, u"buffered-packets", 0);
     _nowait = present(u"nowait");
+    _pipe.setSharedMemory(present(u"shared-memory") ? intValue<size_t>(u"shared-memory", SharedPacketRing::DEFAULT_PACKET_COUNT) : 0);
+    _pipe.setResync(present(u"resync") ? intValue<size_t>(u"resync", TSPacketStream::DEFAULT_RESYNC_PACKETS) : 0);
     _format = LoadTSPacketFormatInputOption(*this);
     return true;
 }
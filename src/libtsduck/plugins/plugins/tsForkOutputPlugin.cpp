@@ -53,6 +53,15 @@ ts::ForkOutputPlugin::ForkOutputPlugin(TSP* tsp_) :
     option(u"buffered-packets", 'b', POSITIVE);
     help(u"buffered-packets", u"Windows only: Specifies the pipe buffer size in number of TS packets.");
 
+    option(u"shared-memory", 0, INTEGER, 0, 1, 1, UNLIMITED_VALUE, true);
+    help(u"shared-memory", u"packets",
+         u"Linux only: exchange TS packets with the created process using a shared memory ring "
+         u"instead of the pipe. The optional value is the number of packets in the ring. The default "
+         u"is " + UString::Decimal(SharedPacketRing::DEFAULT_PACKET_COUNT) + u" packets. The created "
+         u"process shall cooperate and attach to the ring, typically using a command such as "
+         u"'tsp -I shmring ...'. If the created process does not attach to the ring within a few seconds, "
+         u"the pipe is used.");
+
     option(u"nowait", 'n');
     help(u"nowait", u"Do not wait for child process termination at end of input.");
 }
@@ -68,6 +77,7 @@ bool ts::ForkOutputPlugin::getOptions()
     getValue(_command, u"");
     getIntValue(_buffer_size, u"buffered-packets", 0);
     _nowait = present(u"nowait");
+    _pipe.setSharedMemory(present(u"shared-memory") ? intValue<size_t>(u"shared-memory", SharedPacketRing::DEFAULT_PACKET_COUNT) : 0);
     _format = LoadTSPacketFormatOutputOption(*this);
     return true;
 }
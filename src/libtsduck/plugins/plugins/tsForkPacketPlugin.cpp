@@ -65,6 +65,15 @@ ts::ForkPacketPlugin::ForkPacketPlugin(TSP* tsp_) :
          u"Ignore early termination of child process. By default, if the child "
          u"process aborts and no longer reads the packets, tsp also aborts.");
 
+    option(u"shared-memory", 0, INTEGER, 0, 1, 1, UNLIMITED_VALUE, true);
+    help(u"shared-memory", u"packets",
+         u"Linux only: exchange TS packets with the created process using a shared memory ring "
+         u"instead of the pipe. The optional value is the number of packets in the ring. The default "
+         u"is " + UString::Decimal(SharedPacketRing::DEFAULT_PACKET_COUNT) + u" packets. The created "
+         u"process shall cooperate and attach to the ring, typically using a command such as "
+         u"'tsp -I shmring ...'. If the created process does not attach to the ring within a few seconds, "
+         u"the pipe is used.");
+
     option(u"nowait", 'n');
     help(u"nowait", u"Do not wait for child process termination at end of input.");
 }
@@ -81,6 +90,7 @@ bool ts::ForkPacketPlugin::getOptions()
     getValue(_command, u"");
     getIntValue(_buffer_size, u"buffered-packets", tsp->realtime() ? 500 : 1000);
     _nowait = present(u"nowait");
+    _pipe.setSharedMemory(present(u"shared-memory") ? intValue<size_t>(u"shared-memory", SharedPacketRing::DEFAULT_PACKET_COUNT) : 0);
     _format = LoadTSPacketFormatOutputOption(*this);
     _pipe.setIgnoreAbort(present(u"ignore-abort"));
 
@@ -31,6 +31,8 @@
 #include "tsPluginRepository.h"
 #include "tsIPProtocols.h"
 #include "tsSysUtils.h"
+#include "tsGuardMutex.h"
+#include "tsNullReport.h"
 
 TS_REGISTER_INPUT_PLUGIN(u"ip", ts::IPInputPlugin);
 
@@ -43,10 +45,24 @@ ts::IPInputPlugin::IPInputPlugin(TSP* tsp_) :
     AbstractDatagramInputPlugin(tsp_, IP_MAX_PACKET_SIZE, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port",
                                 u"kernel", u"A kernel-provided time-stamp for the packet, when available (Linux only)",
                                 true), // real-time network reception
-    _sock(*tsp_)
+    _sock(*tsp_),
+    _fec(false),
+    _fec_mutex(),
+    _fec_decoder(),
+    _fec_column(this, FEC_COLUMN_PORT_OFFSET),
+    _fec_row(this, FEC_ROW_PORT_OFFSET)
 {
     // Add UDP receiver common options.
     _sock.defineArgs(*this);
+
+    option(u"fec");
+    help(u"fec",
+         u"Receive SMPTE 2022-1 FEC (Forward Error Correction) streams and recover lost RTP datagrams. "
+         u"The column FEC stream is received on the UDP port of the media stream plus " + UString::Decimal(FEC_COLUMN_PORT_OFFSET) + u" "
+         u"and the optional row FEC stream on the UDP port plus " + UString::Decimal(FEC_ROW_PORT_OFFSET) + u". "
+         u"The size of the FEC matrix is learned from the FEC packets. "
+         u"This option requires --rtp-reorder-buffer, with a buffer which is larger than the FEC matrix, "
+         u"since missing datagrams are recovered when they are about to be declared lost.");
 }
 
 
@@ -57,6 +73,15 @@ ts::IPInputPlugin::IPInputPlugin(TSP* tsp_) :
 bool ts::IPInputPlugin::getOptions()
 {
     // Get command line arguments for superclass and socket.
+    _fec = present(u"fec");
+    if (_fec && !present(u"rtp-reorder-buffer")) {
+        tsp->error(u"--fec requires --rtp-reorder-buffer");
+        return false;
+    }
+    if (_fec) {
+        // Keep media packets while they can be held in the reordering buffer.
+        _fec_decoder.setMediaWindow(intValue<size_t>(u"rtp-reorder-buffer") + 2 * FEC_MAX_COLUMNS * FEC_MAX_ROWS);
+    }
     return AbstractDatagramInputPlugin::getOptions() && _sock.loadArgs(duck, *this);
 }
 
@@ -68,7 +93,21 @@ bool ts::IPInputPlugin::getOptions()
 bool ts::IPInputPlugin::start()
 {
     // Initialize superclass and UDP socket.
-    return AbstractDatagramInputPlugin::start() && _sock.open(*tsp);
+    if (!AbstractDatagramInputPlugin::start() || !_sock.open(*tsp)) {
+        return false;
+    }
+
+    // Start the reception of FEC streams.
+    if (_fec) {
+        _fec_decoder.reset();
+        if (!_fec_column.open() || !_fec_row.open()) {
+            _fec_column.close();
+            _fec_row.close();
+            _sock.close(*tsp);
+            return false;
+        }
+    }
+    return true;
 }
 
 
@@ -79,6 +118,10 @@ bool ts::IPInputPlugin::start()
 bool ts::IPInputPlugin::stop()
 {
     _sock.close(*tsp);
+    if (_fec) {
+        _fec_column.close();
+        _fec_row.close();
+    }
     return AbstractDatagramInputPlugin::stop();
 }
 
@@ -116,5 +159,93 @@ bool ts::IPInputPlugin::receiveDatagram(uint8_t* buffer, size_t buffer_size, siz
 {
     IPv4SocketAddress sender;
     IPv4SocketAddress destination;
-    return _sock.receive(buffer, buffer_size, ret_size, sender, destination, tsp, *tsp, &timestamp);
+    if (!_sock.receive(buffer, buffer_size, ret_size, sender, destination, tsp, *tsp, &timestamp)) {
+        return false;
+    }
+
+    // Keep a copy of media datagrams for FEC recovery.
+    if (_fec) {
+        GuardMutex lock(_fec_mutex);
+        _fec_decoder.addMediaPacket(buffer, ret_size);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Recover a missing datagram using FEC.
+//----------------------------------------------------------------------------
+
+bool ts::IPInputPlugin::recoverDatagram(uint16_t sequence, uint8_t* buffer, size_t buffer_size, size_t& ret_size)
+{
+    ret_size = 0;
+    if (!_fec) {
+        return false;
+    }
+    GuardMutex lock(_fec_mutex);
+    return _fec_decoder.recoverPacket(sequence, buffer, buffer_size, ret_size);
+}
+
+
+//----------------------------------------------------------------------------
+// Reception thread for one SMPTE 2022-1 FEC stream.
+//----------------------------------------------------------------------------
+
+ts::IPInputPlugin::FECReceiver::FECReceiver(IPInputPlugin* plugin, uint16_t port_offset) :
+    Thread(),
+    _plugin(plugin),
+    _port_offset(port_offset),
+    _sock(*plugin->tsp, false, false),
+    _terminate(false)
+{
+}
+
+ts::IPInputPlugin::FECReceiver::~FECReceiver()
+{
+    close();
+}
+
+// Open the FEC socket and start the thread.
+bool ts::IPInputPlugin::FECReceiver::open()
+{
+    _sock.setParameters(_plugin->_sock, _port_offset);
+    if (!_sock.open(*_plugin->tsp)) {
+        return false;
+    }
+    _terminate = false;
+    Thread::start();
+    return true;
+}
+
+// Close the FEC socket and wait for the thread termination.
+void ts::IPInputPlugin::FECReceiver::close()
+{
+    // Closing the socket forces the thread to terminate on receive error.
+    _terminate = true;
+    if (_sock.isOpen()) {
+        _sock.close(NULLREP);
+    }
+    Thread::waitForTermination();
+}
+
+// Receive errors are not reported when the socket is closed on termination.
+bool ts::IPInputPlugin::FECReceiver::aborting() const
+{
+    return _terminate || _plugin->tsp->aborting();
+}
+
+// Thread main code.
+void ts::IPInputPlugin::FECReceiver::main()
+{
+    size_t insize = 0;
+    IPv4SocketAddress sender;
+    IPv4SocketAddress destination;
+    ByteBlock buffer(IP_MAX_PACKET_SIZE);
+
+    while (!_terminate && _sock.receive(buffer.data(), buffer.size(), insize, sender, destination, this, *_plugin->tsp)) {
+        GuardMutex lock(_plugin->_fec_mutex);
+        if (!_plugin->_fec_decoder.addFECPacket(buffer.data(), insize)) {
+            _plugin->tsp->debug(u"invalid FEC packet, %d bytes, from %s", {insize, sender});
+        }
+    }
 }
@@ -35,6 +35,10 @@
 #pragma once
 #include "tsAbstractDatagramInputPlugin.h"
 #include "tsUDPReceiver.h"
+#include "tsSMPTE2022FECDecoder.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsAbortInterface.h"
 
 namespace ts {
     //!
@@ -61,8 +65,32 @@ namespace ts {
     protected:
         // Implementation of AbstractDatagramInputPlugin.
         virtual bool receiveDatagram(uint8_t* buffer, size_t buffer_size, size_t& ret_size, MicroSecond& timestamp) override;
+        virtual bool recoverDatagram(uint16_t sequence, uint8_t* buffer, size_t buffer_size, size_t& ret_size) override;
 
     private:
-        UDPReceiver _sock; // Incoming socket with associated command line options.
+        // Reception thread for one SMPTE 2022-1 FEC stream.
+        class FECReceiver: public Thread, private AbortInterface
+        {
+            TS_NOBUILD_NOCOPY(FECReceiver);
+        public:
+            FECReceiver(IPInputPlugin* plugin, uint16_t port_offset);
+            virtual ~FECReceiver() override;
+            bool open();
+            void close();
+        private:
+            IPInputPlugin* _plugin;       // Parent plugin.
+            uint16_t       _port_offset;  // UDP port offset from the media stream.
+            UDPReceiver    _sock;         // Incoming socket for FEC packets.
+            volatile bool  _terminate;    // Force termination flag for thread.
+            virtual void main() override;
+            virtual bool aborting() const override;
+        };
+
+        UDPReceiver         _sock;         // Incoming socket with associated command line options.
+        bool                _fec;          // Receive SMPTE 2022-1 FEC streams.
+        Mutex               _fec_mutex;    // Protect access to _fec_decoder from the FEC threads.
+        SMPTE2022FECDecoder _fec_decoder;  // FEC decoder, receives media and FEC packets.
+        FECReceiver         _fec_column;   // Reception of column FEC packets.
+        FECReceiver         _fec_row;      // Reception of row FEC packets.
     };
 }
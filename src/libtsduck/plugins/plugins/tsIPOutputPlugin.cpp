@@ -46,7 +46,13 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
     _ttl(0),
     _tos(-1),
     _force_mc_local(false),
-    _sock(false, *tsp_)
+    _sock(false, *tsp_),
+    _fec(false),
+    _fec_encoder(),
+    _fec_column_dest(),
+    _fec_row_dest(),
+    _fec_column(),
+    _fec_row()
 {
     option(u"", 0, STRING, 1, 1);
     help(u"",
@@ -55,6 +61,24 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
          u"multicast. It can be also a host name that translates to an IP address. "
          u"The 'port' specifies the destination UDP port.");
 
+    option(u"fec-columns", 0, INTEGER, 0, 1, 1, FEC_MAX_COLUMNS);
+    help(u"fec-columns",
+         u"With --rtp, generate SMPTE 2022-1 FEC (Forward Error Correction) streams. "
+         u"The value is the number of columns in the FEC matrix (L parameter). "
+         u"The column FEC stream is sent on the destination UDP port plus " + UString::Decimal(FEC_COLUMN_PORT_OFFSET) + u" "
+         u"and the row FEC stream on the destination UDP port plus " + UString::Decimal(FEC_ROW_PORT_OFFSET) + u". "
+         u"The SMPTE 2022-1 standard limits the matrix to 100 datagrams but larger matrices are allowed. "
+         u"By default, no FEC stream is generated.");
+
+    option(u"fec-column-only");
+    help(u"fec-column-only",
+         u"With --fec-columns, generate the column FEC stream only, without row FEC stream.");
+
+    option(u"fec-rows", 0, INTEGER, 0, 1, 1, FEC_MAX_ROWS);
+    help(u"fec-rows",
+         u"With --fec-columns, specify the number of rows in the FEC matrix (D parameter). "
+         u"The default is the same as the number of columns.");
+
     option(u"force-local-multicast-outgoing", 'f');
     help(u"force-local-multicast-outgoing",
          u"When the destination is a multicast address and --local-address is specified, "
@@ -124,6 +148,20 @@ bool ts::IPOutputPlugin::getOptions()
     _force_mc_local = present(u"force-local-multicast-outgoing");
     setRS204Format(present(u"rs204"));
 
+    // SMPTE 2022-1 FEC options.
+    _fec = present(u"fec-columns");
+    if (_fec) {
+        const size_t columns = intValue<size_t>(u"fec-columns");
+        _fec_encoder.setMatrix(columns, intValue<size_t>(u"fec-rows", columns), !present(u"fec-column-only"));
+        if (!present(u"rtp")) {
+            tsp->error(u"--fec-columns requires --rtp");
+            success = false;
+        }
+    }
+    _fec_column_dest = _fec_row_dest = _destination;
+    _fec_column_dest.setPort(uint16_t(_destination.port() + FEC_COLUMN_PORT_OFFSET));
+    _fec_row_dest.setPort(uint16_t(_destination.port() + FEC_ROW_PORT_OFFSET));
+
     return success;
 }
 
@@ -151,6 +189,7 @@ bool ts::IPOutputPlugin::start()
         _sock.close(*tsp);
         return false;
     }
+    _fec_encoder.reset();
     return true;
 }
 
@@ -174,5 +213,18 @@ bool ts::IPOutputPlugin::stop()
 
 bool ts::IPOutputPlugin::sendDatagram(const void* address, size_t size)
 {
-    return _sock.send(address, size, *tsp);
+    if (!_sock.send(address, size, *tsp)) {
+        return false;
+    }
+
+    // Send the FEC packets which are completed by this datagram.
+    if (_fec) {
+        _fec_encoder.addMediaPacket(address, size, _fec_column, _fec_row);
+        if ((!_fec_column.empty() && !_sock.send(_fec_column.data(), _fec_column.size(), _fec_column_dest, *tsp)) ||
+            (!_fec_row.empty() && !_sock.send(_fec_row.data(), _fec_row.size(), _fec_row_dest, *tsp)))
+        {
+            return false;
+        }
+    }
+    return true;
 }
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsAbstractDatagramOutputPlugin.h"
 #include "tsUDPSocket.h"
+#include "tsSMPTE2022FECEncoder.h"
 
 namespace ts {
     //!
@@ -62,12 +63,18 @@ namespace ts {
         virtual bool sendDatagram(const void* address, size_t size) override;
 
     private:
-        IPv4SocketAddress _destination;     // Destination address/port.
-        IPv4Address       _local_addr;      // Local address.
-        uint16_t          _local_port;      // Local UDP source port.
-        int               _ttl;             // Time to live option.
-        int               _tos;             // Type of service option.
-        bool              _force_mc_local;  // Force multicast outgoing local interface
-        UDPSocket         _sock;            // Outgoing socket
+        IPv4SocketAddress   _destination;     // Destination address/port.
+        IPv4Address         _local_addr;      // Local address.
+        uint16_t            _local_port;      // Local UDP source port.
+        int                 _ttl;             // Time to live option.
+        int                 _tos;             // Type of service option.
+        bool                _force_mc_local;  // Force multicast outgoing local interface
+        UDPSocket           _sock;            // Outgoing socket
+        bool                _fec;             // Generate SMPTE 2022-1 FEC streams.
+        SMPTE2022FECEncoder _fec_encoder;     // FEC encoder, with matrix size.
+        IPv4SocketAddress   _fec_column_dest; // Destination of column FEC packets.
+        IPv4SocketAddress   _fec_row_dest;    // Destination of row FEC packets.
+        ByteBlock           _fec_column;      // Column FEC packet to send.
+        ByteBlock           _fec_row;         // Row FEC packet to send.
     };
 }
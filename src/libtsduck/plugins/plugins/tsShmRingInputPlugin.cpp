@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsShmRingInputPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsSysUtils.h"
+
+TS_REGISTER_INPUT_PLUGIN(u"shmring", ts::ShmRingInputPlugin);
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::ShmRingInputPlugin::ShmRingInputPlugin(TSP* tsp_) :
+    InputPlugin(tsp_, u"Receive TS packets from a parent process through a shared memory ring", u"[options]"),
+    _description(),
+    _ring()
+{
+    setIntro(u"This plugin is used in a process which is created by a tsp 'fork' output "
+             u"or packet processing plugin with option --shared-memory (Linux only). "
+             u"The TS packets are received from the parent process through a shared memory "
+             u"ring instead of the standard input.");
+}
+
+
+//----------------------------------------------------------------------------
+// Input methods
+//----------------------------------------------------------------------------
+
+bool ts::ShmRingInputPlugin::getOptions()
+{
+    _description = GetEnvironment(SharedPacketRing::ENVIRONMENT_VARIABLE);
+    if (_description.empty()) {
+        tsp->error(u"no shared memory ring, the parent process must use a fork plugin with --shared-memory");
+        return false;
+    }
+    return true;
+}
+
+bool ts::ShmRingInputPlugin::start()
+{
+    return _ring.attach(SharedPacketRing::READER, _description, *tsp);
+}
+
+bool ts::ShmRingInputPlugin::stop()
+{
+    _ring.close();
+    return true;
+}
+
+bool ts::ShmRingInputPlugin::abortInput()
+{
+    _ring.abort();
+    return true;
+}
+
+size_t ts::ShmRingInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
+{
+    return _ring.read(buffer, pkt_data, max_packets, *tsp);
+}
@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsShmRingOutputPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsSysUtils.h"
+
+TS_REGISTER_OUTPUT_PLUGIN(u"shmring", ts::ShmRingOutputPlugin);
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::ShmRingOutputPlugin::ShmRingOutputPlugin(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Send TS packets to a parent process through a shared memory ring", u"[options]"),
+    _description(),
+    _ring()
+{
+    setIntro(u"This plugin is used in a process which is created by a tsp 'fork' input "
+             u"plugin with option --shared-memory (Linux only). The TS packets are sent "
+             u"to the parent process through a shared memory ring instead of the standard output.");
+}
+
+
+//----------------------------------------------------------------------------
+// Output methods
+//----------------------------------------------------------------------------
+
+bool ts::ShmRingOutputPlugin::getOptions()
+{
+    _description = GetEnvironment(SharedPacketRing::ENVIRONMENT_VARIABLE);
+    if (_description.empty()) {
+        tsp->error(u"no shared memory ring, the parent process must use a fork plugin with --shared-memory");
+        return false;
+    }
+    return true;
+}
+
+bool ts::ShmRingOutputPlugin::start()
+{
+    return _ring.attach(SharedPacketRing::WRITER, _description, *tsp);
+}
+
+bool ts::ShmRingOutputPlugin::stop()
+{
+    // The parent process gets an end of stream after the last packet.
+    _ring.close();
+    return true;
+}
+
+bool ts::ShmRingOutputPlugin::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
+{
+    return _ring.write(buffer, pkt_data, packet_count, *tsp);
+}
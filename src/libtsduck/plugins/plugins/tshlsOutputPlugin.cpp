@@ -31,6 +31,8 @@
 #include "tsPluginRepository.h"
 #include "tsOneShotPacketizer.h"
 #include "tsFileUtils.h"
+#include "tsGuardMutex.h"
+#include "tsGuardCondition.h"
 #include "tsPESPacket.h"
 #include "tsPAT.h"
 #include "tsPMT.h"
@@ -40,6 +42,7 @@ TS_REGISTER_OUTPUT_PLUGIN(u"hls", ts::hls::OutputPlugin);
 #define DEFAULT_OUT_DURATION      10  // Default segment target duration for output streams.
 #define DEFAULT_OUT_LIVE_DURATION  5  // Default segment target duration for output live streams.
 #define DEFAULT_EXTRA_DURATION     2  // Default segment extra duration when intra image is not found.
+#define DEFAULT_MAX_QUEUED     50000  // Default maximum number of packets buffered for the writer thread.
 
 
 //----------------------------------------------------------------------------
@@ -59,6 +62,8 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     _maxExtraDuration(0),
     _fixedSegmentSize(0),
     _initialMediaSeq(0),
+    _partDuration(0),
+    _maxQueuedPackets(0),
     _closeLabels(),
     _nameGenerator(),
     _demux(duck, this),
@@ -69,12 +74,17 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     _videoStreamType(ST_NULL),
     _segStarted(false),
     _segClosePending(false),
-    _segmentFile(),
+    _segmentName(),
+    _segmentPackets(0),
+    _partStart(0),
+    _partIndependent(false),
+    _outPackets(),
     _liveSegmentFiles(),
     _playlist(),
     _pcrAnalyzer(1, 4),  // Minimum required: 1 PID, 4 PCR
     _previousBitrate(0),
-    _ccFixer(NoPID, tsp)
+    _ccFixer(NoPID, tsp),
+    _writer(this)
 {
     option(u"", 0, FILENAME, 1, 1);
     help(u"",
@@ -144,11 +154,28 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
          u"The default is to wait a maximum of " TS_STRINGIFY(DEFAULT_EXTRA_DURATION) u" additional seconds "
          u"for an intra-coded image.");
 
+    option(u"max-queued-packets", 0, POSITIVE);
+    help(u"max-queued-packets",
+         u"Specify the maximum number of TS packets which are buffered for the background writer thread. "
+         u"All file operations (media segments, playlist, deletion of obsolete segments) are performed "
+         u"by a background thread so that slow storage does not stall the processing chain at each "
+         u"segment boundary. When the buffer is full, the processing is suspended until the writer "
+         u"catches up. The default is " TS_STRINGIFY(DEFAULT_MAX_QUEUED) u" packets.");
+
     option(u"no-bitrate");
     help(u"no-bitrate",
          u"With --playlist, do not specify EXT-X-BITRATE tags for each segment in the playlist. "
          u"This optional tag is present by default.");
 
+    option(u"part-duration", 0, POSITIVE);
+    help(u"part-duration", u"milliseconds",
+         u"Generate a low-latency HLS (LL-HLS) playlist with partial segments of the specified target "
+         u"duration in milliseconds. Each partial segment is a byte range of the media segment which is "
+         u"currently written and is referenced in the playlist using an EXT-X-PART tag. The next partial "
+         u"segment is announced using an EXT-X-PRELOAD-HINT tag. The playlist is rewritten each time a "
+         u"partial segment is completed. This option requires --playlist and --live or --event. "
+         u"Typical values range from 200 to 1000 milliseconds.");
+
     option(u"playlist", 'p', FILENAME);
     help(u"playlist", u"filename",
          u"Specify the name of the playlist file. "
@@ -190,6 +217,8 @@ bool ts::hls::OutputPlugin::getOptions()
     getIntValue(_maxExtraDuration, u"max-extra-duration", DEFAULT_EXTRA_DURATION);
     _fixedSegmentSize = intValue<PacketCounter>(u"fixed-segment-size") / PKT_SIZE;
     getIntValue(_initialMediaSeq, u"start-media-sequence", 0);
+    getIntValue(_partDuration, u"part-duration", 0);
+    getIntValue(_maxQueuedPackets, u"max-queued-packets", DEFAULT_MAX_QUEUED);
     getIntValues(_closeLabels, u"label-close");
 
     if (present(u"event")) {
@@ -211,6 +240,15 @@ bool ts::hls::OutputPlugin::getOptions()
         return false;
     }
 
+    if (_partDuration > 0 && (_playlistFile.empty() || _playlistType == hls::PlayListType::VOD)) {
+        tsp->error(u"option --part-duration requires --playlist and --live or --event");
+        return false;
+    }
+    if (_partDuration >= _targetDuration * MilliSecPerSec) {
+        tsp->error(u"the partial segment duration must be lower than the segment duration");
+        return false;
+    }
+
     return true;
 }
 
@@ -246,15 +284,21 @@ bool ts::hls::OutputPlugin::start()
     _liveSegmentFiles.clear();
     _segStarted = false;
     _segClosePending = false;
-    if (_segmentFile.isOpen()) {
-        _segmentFile.close(*tsp);
-    }
+    _segmentName.clear();
+    _segmentPackets = 0;
+    _partStart = 0;
+    _partIndependent = false;
+    _outPackets.clear();
     if (!_playlistFile.empty()) {
-        _playlist.reset(_playlistType, _playlistFile);
+        // Byte ranges in partial segments require a more recent playlist version.
+        _playlist.reset(_playlistType, _playlistFile, _partDuration > 0 ? 6 : 3);
         _playlist.setTargetDuration(_targetDuration, *tsp);
         _playlist.setMediaSequence(_initialMediaSeq, *tsp);
+        _playlist.setPartTarget(_partDuration, *tsp);
     }
-    return true;
+
+    // Start the background writer thread.
+    return _writer.startWriter(_maxQueuedPackets);
 }
 
 
@@ -264,31 +308,76 @@ bool ts::hls::OutputPlugin::start()
 
 bool ts::hls::OutputPlugin::stop()
 {
-    // Simply close the current segmetn (and generate the corresponding playlist).
-    return closeCurrentSegment(true);
+    // Close the current segment (and generate the corresponding playlist).
+    // Then wait for the writer thread to complete all pending file operations.
+    const bool ok = closeCurrentSegment(true);
+    _writer.stopWriter();
+    return ok && !_writer.failed();
 }
 
 
 //----------------------------------------------------------------------------
-// Create the next segment file (also close the previous one if necessary).
+// Get the best known bitrate of the current segment.
 //----------------------------------------------------------------------------
 
-bool ts::hls::OutputPlugin::createNextSegment()
+ts::BitRate ts::hls::OutputPlugin::currentBitRate() const
 {
-    // Close the previous segment file.
-    if (!closeCurrentSegment(false)) {
+    return _pcrAnalyzer.bitrateIsValid() ? _pcrAnalyzer.bitrate188() : _previousBitrate;
+}
+
+
+//----------------------------------------------------------------------------
+// Queue a new version of the playlist file.
+//----------------------------------------------------------------------------
+
+bool ts::hls::OutputPlugin::savePlayList()
+{
+    // Segment data must reach the file before the playlist references them.
+    flushPackets();
+    const UString text(_playlist.textContent(*tsp));
+    if (text.empty()) {
         return false;
     }
+    _writer.savePlayList(_playlistFile, text);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Queue the pending output packets to the writer thread.
+//----------------------------------------------------------------------------
+
+void ts::hls::OutputPlugin::flushPackets()
+{
+    if (!_outPackets.empty()) {
+        _writer.writePackets(_outPackets);
+        _outPackets.clear();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Create the next segment file (also close the previous one if necessary).
+//----------------------------------------------------------------------------
 
+bool ts::hls::OutputPlugin::createNextSegment()
+{
     // Generate a new segment file name.
     const UString fileName(_nameGenerator.newFileName());
 
-    // Create the segment file.
-    tsp->verbose(u"creating media segment %s", {fileName});
-    if (!_segmentFile.open(fileName, TSFile::WRITE | TSFile::SHARED, *tsp)) {
+    // Close the previous segment file.
+    if (!closeCurrentSegment(false, fileName)) {
         return false;
     }
 
+    // Create the segment file.
+    tsp->verbose(u"creating media segment %s", {fileName});
+    _writer.openSegment(fileName);
+    _segmentName = fileName;
+    _segmentPackets = 0;
+    _partStart = 0;
+    _partIndependent = false;
+
     // Reset the PCR analysis in each segment to get to bitrate of this segment.
     _pcrAnalyzer.reset();
 
@@ -305,21 +394,26 @@ bool ts::hls::OutputPlugin::createNextSegment()
 // Also purge obsolete segment files and regenerate playlist.
 //----------------------------------------------------------------------------
 
-bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
+bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream, const UString& nextSegment)
 {
     // If no segment file is open, there is nothing to do.
-    if (!_segmentFile.isOpen()) {
+    if (_segmentName.empty()) {
         return true;
     }
 
+    // With low-latency HLS, the rest of the segment is the last partial segment.
+    if (_partDuration > 0 && !closeCurrentPart()) {
+        return false;
+    }
+
     // Get the segment file name and size (to be inserted in the playlist).
-    const UString segName(_segmentFile.getFileName());
-    const PacketCounter segPackets = _segmentFile.writePacketsCount();
+    const UString segName(_segmentName);
+    const PacketCounter segPackets = _segmentPackets;
 
     // Close the TS file.
-    if (!_segmentFile.close(*tsp)) {
-        return false;
-    }
+    flushPackets();
+    _writer.closeSegment();
+    _segmentName.clear();
 
     // On live streams, we need to maintain a list of active segments.
     if (_liveDepth > 0) {
@@ -362,8 +456,17 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
             _playlist.popFirstSegment();
         }
 
+        // With low-latency HLS, the next partial segment starts the next segment.
+        if (_partDuration > 0) {
+            MediaPart hint;
+            if (!nextSegment.empty()) {
+                _playlist.buildURL(hint, nextSegment);
+            }
+            _playlist.setPreloadHint(hint, *tsp);
+        }
+
         // Write the playlist file.
-        if (!_playlist.saveFile(UString(), *tsp)) {
+        if (!savePlayList()) {
             return false;
         }
 
@@ -384,7 +487,7 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
 
         // Delete the segment file.
         tsp->verbose(u"deleting obsolete segment file %s", {name});
-        DeleteFile(name, *tsp);
+        _writer.deleteFile(name);
 
         // WARNING: several improvements are possible here.
         // - It could be better to delay the purge of obsolete segments. Clients may have loaded
@@ -397,7 +500,37 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
         //   is already open (the file actually disappears when the file is closed).
     }
 
-    return true;
+    return !_writer.failed();
+}
+
+
+//----------------------------------------------------------------------------
+// Close the current LL-HLS partial segment.
+//----------------------------------------------------------------------------
+
+bool ts::hls::OutputPlugin::closeCurrentPart()
+{
+    // Nothing to do if the current partial segment is empty.
+    if (_segmentPackets <= _partStart) {
+        return true;
+    }
+
+    // The partial segment is a byte range in the current segment file.
+    MediaPart part;
+    _playlist.buildURL(part, _segmentName);
+    part.duration = PacketInterval(currentBitRate(), _segmentPackets - _partStart);
+    part.byteRangeStart = _partStart * PKT_SIZE;
+    part.byteRangeLength = (_segmentPackets - _partStart) * PKT_SIZE;
+    part.independent = _partIndependent;
+
+    // The next partial segment starts here, in the same segment file.
+    _partStart = _segmentPackets;
+    _partIndependent = false;
+    MediaPart hint;
+    _playlist.buildURL(hint, _segmentName);
+    hint.byteRangeStart = _partStart * PKT_SIZE;
+
+    return _playlist.addPart(part, *tsp) && _playlist.setPreloadHint(hint, *tsp);
 }
 
 
@@ -462,31 +595,17 @@ void ts::hls::OutputPlugin::handleTable(SectionDemux& demux, const BinaryTable&
 
 bool ts::hls::OutputPlugin::writePackets(const TSPacket* pkt, size_t packetCount)
 {
-    // Temporary packet buffer if a packet needs to be modified.
-    TSPacket tmp;
-
     // Loop on all packets.
     for (size_t i = 0; i < packetCount; ++i) {
 
-        // Address of the next packet to write.
-        const TSPacket* p = pkt + i;
+        // Copy the packet in the output buffer, queued later to the writer thread.
+        _outPackets.push_back(pkt[i]);
+        _segmentPackets++;
 
-        // If the packet comes from the PAT or PMT, get a copy and fix continuity counter.
+        // If the packet comes from the PAT or PMT, fix continuity counter.
         const PID pid = pkt[i].getPID();
-        if (pid == PID_PAT) {
-            tmp = *p;
-            _ccFixer.feedPacket(tmp);
-            p = &tmp;
-        }
-        else if (_pmtPID != PID_NULL && pid == _pmtPID) {
-            tmp = *p;
-            _ccFixer.feedPacket(tmp);
-            p = &tmp;
-        }
-
-        // Write the packet in the segment file.
-        if (!_segmentFile.writePackets(p, nullptr, 1, *tsp)) {
-            return false;
+        if (pid == PID_PAT || (_pmtPID != PID_NULL && pid == _pmtPID)) {
+            _ccFixer.feedPacket(_outPackets.back());
         }
     }
     return true;
@@ -536,7 +655,7 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
             bool renewOnPUSI = false;
             if (_fixedSegmentSize > 0) {
                 // Each segment shall have a fixed size.
-                renewNow = _segmentFile.writePacketsCount() >= _fixedSegmentSize;
+                renewNow = _segmentPackets >= _fixedSegmentSize;
             }
             else if (!_segClosePending) {
                 if (pktData->hasAnyLabel(_closeLabels)) {
@@ -545,7 +664,7 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
                 }
                 else if (_pcrAnalyzer.bitrateIsValid()) {
                     // The segment file shall be closed when the estimated duration exceeds the target duration.
-                    const MilliSecond segDuration = PacketInterval(_pcrAnalyzer.bitrate188(), _segmentFile.writePacketsCount());
+                    const MilliSecond segDuration = PacketInterval(_pcrAnalyzer.bitrate188(), _segmentPackets);
                     _segClosePending = segDuration >= _targetDuration * MilliSecPerSec;
                     // With --intra-close, force renew on next PES packet if extra duration is exceeded.
                     renewOnPUSI = segDuration >= (_targetDuration + _maxExtraDuration) * MilliSecPerSec;
@@ -575,14 +694,212 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
                 }
             }
 
+            // With low-latency HLS, close the current partial segment when the packet would exceed the target duration.
+            if (!renewNow && _partDuration > 0) {
+                const BitRate bitrate(currentBitRate());
+                if (bitrate > 0 && PacketInterval(bitrate, _segmentPackets - _partStart + 1) > _partDuration) {
+                    ok = closeCurrentPart() && savePlayList();
+                }
+            }
+
             // Close current segment and recreate a new one when necessary.
             // Finally write the packet.
-            ok = (!renewNow || createNextSegment()) && writePackets(pkt, 1);
+            ok = ok && (!renewNow || createNextSegment()) && writePackets(pkt, 1);
+
+            // A partial segment is independent when it contains the start of an intra-image.
+            if (ok && _partDuration > 0 && !_partIndependent && _videoPID != PID_NULL && pkt->getPID() == _videoPID && pkt->getPUSI() && pkt->isClear()) {
+                _partIndependent = PESPacket::FindIntraImage(pkt->getPayload(), pkt->getPayloadSize(), _videoStreamType) != NPOS;
+            }
         }
 
         // Process next packet.
         ++pkt;
         ++pktData;
     }
-    return ok;
+
+    // Queue all output packets of this call to the writer thread.
+    flushPackets();
+    return ok && !_writer.failed();
+}
+
+
+//----------------------------------------------------------------------------
+// Background writer thread.
+//----------------------------------------------------------------------------
+
+ts::hls::OutputPlugin::Writer::Request::Request(RequestType t, const UString& n, const UString& s) :
+    type(t),
+    name(n),
+    text(s),
+    packets()
+{
+}
+
+ts::hls::OutputPlugin::Writer::Writer(OutputPlugin* plugin) :
+    Thread(),
+    _plugin(plugin),
+    _file(),
+    _mutex(),
+    _enqueued(),
+    _dequeued(),
+    _queue(),
+    _maxPackets(0),
+    _packets(0),
+    _terminate(false),
+    _failed(false)
+{
+}
+
+bool ts::hls::OutputPlugin::Writer::startWriter(size_t maxPackets)
+{
+    {
+        GuardMutex lock(_mutex);
+        _queue.clear();
+        _maxPackets = maxPackets;
+        _packets = 0;
+        _terminate = false;
+        _failed = false;
+    }
+    return start();
+}
+
+void ts::hls::OutputPlugin::Writer::stopWriter()
+{
+    {
+        GuardMutex lock(_mutex);
+        _terminate = true;
+        _enqueued.signal();
+    }
+    waitForTermination();
+}
+
+bool ts::hls::OutputPlugin::Writer::failed() const
+{
+    GuardMutex lock(_mutex);
+    return _failed;
+}
+
+void ts::hls::OutputPlugin::Writer::openSegment(const UString& name)
+{
+    Request req(RequestType::OPEN, name);
+    enqueue(req);
+}
+
+void ts::hls::OutputPlugin::Writer::writePackets(TSPacketVector& packets)
+{
+    Request req(RequestType::WRITE);
+    req.packets.swap(packets);
+    enqueue(req);
+}
+
+void ts::hls::OutputPlugin::Writer::closeSegment()
+{
+    Request req(RequestType::CLOSE);
+    enqueue(req);
+}
+
+void ts::hls::OutputPlugin::Writer::savePlayList(const UString& name, const UString& text)
+{
+    Request req(RequestType::SAVE, name, text);
+    enqueue(req);
+}
+
+void ts::hls::OutputPlugin::Writer::deleteFile(const UString& name)
+{
+    Request req(RequestType::PURGE, name);
+    enqueue(req);
+}
+
+
+//----------------------------------------------------------------------------
+// Queue a request to the writer thread.
+//----------------------------------------------------------------------------
+
+void ts::hls::OutputPlugin::Writer::enqueue(Request& req)
+{
+    GuardCondition lock(_mutex, _dequeued);
+
+    // Wait while the buffer is full. A request which is larger than the
+    // buffer is accepted when the queue is empty. Never wait after an error.
+    while (!_failed && _packets > 0 && _packets + req.packets.size() > _maxPackets) {
+        lock.waitCondition();
+    }
+    _packets += req.packets.size();
+    _queue.emplace_back();
+    _queue.back().type = req.type;
+    _queue.back().name.swap(req.name);
+    _queue.back().text.swap(req.text);
+    _queue.back().packets.swap(req.packets);
+    _enqueued.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Writer thread main code.
+//----------------------------------------------------------------------------
+
+void ts::hls::OutputPlugin::Writer::main()
+{
+    Report& report(*_plugin->tsp);
+    Request req;
+
+    for (;;) {
+        // Wait for the next request.
+        {
+            GuardCondition lock(_mutex, _enqueued);
+            while (_queue.empty() && !_terminate) {
+                lock.waitCondition();
+            }
+            if (_queue.empty()) {
+                // Termination requested and all requests were processed.
+                break;
+            }
+            req.type = _queue.front().type;
+            req.name.swap(_queue.front().name);
+            req.text.swap(_queue.front().text);
+            req.packets.swap(_queue.front().packets);
+            _queue.pop_front();
+        }
+
+        // Perform the file operation without holding the mutex.
+        bool ok = true;
+        switch (req.type) {
+            case RequestType::OPEN:
+                ok = _file.open(req.name, TSFile::WRITE | TSFile::SHARED, report);
+                break;
+            case RequestType::WRITE:
+                // Silently drop packets when the segment file could not be created, error already reported.
+                ok = !_file.isOpen() || _file.writePackets(req.packets.data(), nullptr, req.packets.size(), report);
+                break;
+            case RequestType::CLOSE:
+                ok = !_file.isOpen() || _file.close(report);
+                break;
+            case RequestType::SAVE:
+                ok = req.text.save(req.name, false, true);
+                if (!ok) {
+                    report.error(u"error saving HLS playlist in %s", {req.name});
+                }
+                break;
+            case RequestType::PURGE:
+                // Errors are reported but do not stop the generation of segments.
+                DeleteFile(req.name, report);
+                break;
+            default:
+                break;
+        }
+
+        // Release the buffer space.
+        {
+            GuardMutex lock(_mutex);
+            _packets -= req.packets.size();
+            _failed = _failed || !ok;
+            _dequeued.signal();
+        }
+        req.packets.clear();
+    }
+
+    // Make sure that the last segment file is closed.
+    if (_file.isOpen()) {
+        _file.close(report);
+    }
 }
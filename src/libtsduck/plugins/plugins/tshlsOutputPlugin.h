@@ -40,6 +40,9 @@
 #include "tsContinuityAnalyzer.h"
 #include "tsFileNameGenerator.h"
 #include "tshlsPlayList.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
 
 namespace ts {
     namespace hls {
@@ -52,6 +55,10 @@ namespace ts {
         //! playlists. To setup a complete HLS server, it is necessary to setup an
         //! external HTTP server such as Apache which simply serves these files.
         //!
+        //! All file operations (segments, playlist, purge of obsolete segments) are
+        //! performed by a background writer thread. The packet processing thread only
+        //! queues requests, up to a maximum number of buffered packets.
+        //!
         class TSDUCKDLL OutputPlugin: public ts::OutputPlugin, private TableHandlerInterface
         {
             TS_NOBUILD_NOCOPY(OutputPlugin);
@@ -82,6 +89,8 @@ namespace ts {
             Second             _maxExtraDuration;      // Segment target max extra duration in seconds when intra image is not found.
             PacketCounter      _fixedSegmentSize;      // Optional fixed segment size in packets.
             size_t             _initialMediaSeq;       // Initial media sequence value.
+            MilliSecond        _partDuration;          // Target duration of LL-HLS partial segments, zero if none.
+            size_t             _maxQueuedPackets;      // Maximum number of packets buffered for the writer thread.
             TSPacketMetadata::LabelSet _closeLabels;   // Close segment on packets with any of these labels.
 
             // Working data.
@@ -94,18 +103,89 @@ namespace ts {
             uint8_t            _videoStreamType;       // Stream type for video PID in PMT.
             bool               _segStarted;            // Generation of output segments has started.
             bool               _segClosePending;       // Close the current segment when possible.
-            TSFile             _segmentFile;           // Output segment file.
+            UString            _segmentName;           // Output segment file name, empty when no segment is open.
+            PacketCounter      _segmentPackets;        // Number of packets in current segment.
+            PacketCounter      _partStart;             // Index in current segment of the first packet of current partial segment.
+            bool               _partIndependent;       // Current partial segment contains an intra-image.
+            TSPacketVector     _outPackets;            // Packets to write in current segment, not yet queued.
             UStringList        _liveSegmentFiles;      // List of current segments in a live stream.
             hls::PlayList      _playlist;              // Generated playlist.
             PCRAnalyzer        _pcrAnalyzer;           // PCR analyzer to compute bitrates.
             BitRate            _previousBitrate;       // Bitrate of previous segment.
             ContinuityAnalyzer _ccFixer;               // To fix continuity counters in PAT and PMT PID's.
 
+            // Background writer thread, performs all file I/O in the order of requests.
+            class Writer: public Thread
+            {
+                TS_NOBUILD_NOCOPY(Writer);
+            public:
+                // Constructor.
+                Writer(OutputPlugin* plugin);
+
+                // Start and stop the writer thread. Pending requests are completed before termination.
+                bool startWriter(size_t maxPackets);
+                void stopWriter();
+
+                // Check if a previous file operation failed.
+                bool failed() const;
+
+                // Queue file operations. Wait when too many packets are already buffered.
+                void openSegment(const UString& name);
+                void writePackets(TSPacketVector& packets);
+                void closeSegment();
+                void savePlayList(const UString& name, const UString& text);
+                void deleteFile(const UString& name);
+
+            private:
+                enum class RequestType {OPEN, WRITE, CLOSE, SAVE, PURGE};
+                class Request
+                {
+                public:
+                    RequestType    type;
+                    UString        name;
+                    UString        text;
+                    TSPacketVector packets;
+                    Request(RequestType t = RequestType::WRITE, const UString& n = UString(), const UString& s = UString());
+                };
+
+                OutputPlugin*       _plugin;      // Parent plugin.
+                TSFile              _file;        // Output segment file, used in writer thread only.
+                mutable Mutex       _mutex;       // Protect all subsequent fields.
+                Condition           _enqueued;    // Signaled when a request is queued.
+                Condition           _dequeued;    // Signaled when a request is completed.
+                std::deque<Request> _queue;       // Pending requests.
+                size_t              _maxPackets;  // Maximum number of queued packets.
+                size_t              _packets;     // Current number of queued packets.
+                bool                _terminate;   // Terminate after all pending requests.
+                bool                _failed;      // A file operation failed.
+
+                // Queue a request.
+                void enqueue(Request& req);
+
+                // Implementation of Thread.
+                virtual void main() override;
+            };
+
+            Writer             _writer;                // Background writer thread.
+
             // Create the next segment file (also close the previous one if necessary).
             bool createNextSegment();
 
             // Close current segment file (also purge obsolete segment files and regenerate playlist).
-            bool closeCurrentSegment(bool endOfStream);
+            // With low-latency HLS, the preload hint points to the next segment.
+            bool closeCurrentSegment(bool endOfStream, const UString& nextSegment = UString());
+
+            // Close the current LL-HLS partial segment.
+            bool closeCurrentPart();
+
+            // Queue the pending output packets to the writer thread.
+            void flushPackets();
+
+            // Get the best known bitrate of the current segment.
+            BitRate currentBitRate() const;
+
+            // Queue a new version of the playlist file.
+            bool savePlayList();
 
             // Implementation of TableHandlerInterface.
             virtual void handleTable(SectionDemux&, const BinaryTable&) override;
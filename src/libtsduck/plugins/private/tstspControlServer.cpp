@@ -50,26 +50,30 @@ ts::tsp::ControlServer::ControlServer(TSProcessorArgs& options, Report& log, Mut
     _server(),
     _mutex(global_mutex),
     _input(input),
-    _output(nullptr),
-    _plugins()
+    _plugins(),
+    _outputs()
 {
-    // Locate output plugin, count packet processor plugins.
+    // Locate packet processor plugins and output plugins.
     if (_input != nullptr) {
         GuardMutex lock(_mutex);
 
-        // The output plugin "precedes" the input plugin in the ring.
-        _output = _input->ringPrevious<OutputExecutor>();
-        assert(_output != nullptr);
-
-        // Loop on all plugins between inputs and outputs
+        // Loop on all plugins after input. The output plugins "precede" the input plugin in the ring.
         PluginExecutor* proc = _input;
-        while ((proc = proc->ringNext<PluginExecutor>()) != _output) {
-            ProcessorExecutor* pe = dynamic_cast<ProcessorExecutor*>(proc);
-            assert(pe != nullptr);
-            _plugins.push_back(pe);
+        while ((proc = proc->ringNext<PluginExecutor>()) != _input) {
+            if (proc->isOutput()) {
+                OutputExecutor* oe = dynamic_cast<OutputExecutor*>(proc);
+                assert(oe != nullptr);
+                _outputs.push_back(oe);
+            }
+            else {
+                ProcessorExecutor* pe = dynamic_cast<ProcessorExecutor*>(proc);
+                assert(pe != nullptr);
+                _plugins.push_back(pe);
+            }
         }
+        assert(!_outputs.empty());
     }
-    _log.debug(u"found %d packet processor plugins", {_plugins.size()});
+    _log.debug(u"found %d packet processor plugins, %d output plugins", {_plugins.size(), _outputs.size()});
 
     // Register command handlers.
     _reference.setCommandLineHandler(this, &ControlServer::executeExit, u"exit");
@@ -249,7 +253,9 @@ ts::CommandStatus ts::tsp::ControlServer::executeList(const UString& command, Ar
     for (size_t i = 0; i < _plugins.size(); ++i) {
         listOnePlugin(index++, u'P', _plugins[i], args);
     }
-    listOnePlugin(index, u'O', _output, args);
+    for (size_t i = 0; i < _outputs.size(); ++i) {
+        listOnePlugin(index++, u'O', _outputs[i], args);
+    }
 
     if (args.verbose()) {
         args.info(u"");
@@ -289,14 +295,14 @@ ts::CommandStatus ts::tsp::ControlServer::executeSuspendResume(bool state, Args&
     if (index > 0 && index <= _plugins.size()) {
         _plugins[index-1]->setSuspended(state);
     }
-    else if (index == _plugins.size() + 1) {
-        _output->setSuspended(state);
+    else if (index > _plugins.size() && index <= _plugins.size() + _outputs.size()) {
+        _outputs[index - _plugins.size() - 1]->setSuspended(state);
     }
     else if (index == 0) {
         args.error(u"cannot suspend/resume the input plugin");
     }
     else {
-        args.error(u"invalid plugin index %d, specify 1 to %d", {index, _plugins.size() + 1});
+        args.error(u"invalid plugin index %d, specify 1 to %d", {index, _plugins.size() + _outputs.size()});
     }
     return CommandStatus::SUCCESS;
 }
@@ -312,7 +318,7 @@ ts::CommandStatus ts::tsp::ControlServer::executeRestart(const UString& command,
     UStringVector params;
     args.getValues(params);
     size_t index = 0;
-    if (params.empty() || !params[0].toInteger(index) || index > _plugins.size() + 1) {
+    if (params.empty() || !params[0].toInteger(index) || index > _plugins.size() + _outputs.size()) {
         args.error(u"invalid plugin index");
         return CommandStatus::ERROR;
     }
@@ -336,7 +342,7 @@ ts::CommandStatus ts::tsp::ControlServer::executeRestart(const UString& command,
         plugin = _plugins[index-1];
     }
     else {
-        plugin = _output;
+        plugin = _outputs[index - _plugins.size() - 1];
     }
 
     // Restart the plugin.
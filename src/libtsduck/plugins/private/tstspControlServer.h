@@ -88,8 +88,8 @@ namespace ts {
             TCPServer         _server;
             Mutex&            _mutex;
             InputExecutor*    _input;
-            OutputExecutor*   _output;
             std::vector<ProcessorExecutor*> _plugins;  // Packet processing plugins
+            std::vector<OutputExecutor*>    _outputs;  // Main output plugin and output branches
 
             // Implementation of Thread.
             virtual void main() override;
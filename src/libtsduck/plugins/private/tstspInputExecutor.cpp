@@ -123,9 +123,11 @@ bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer, PacketMetadata
     initBuffer(buffer, metadata, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
 
     // All other processors have an implicit empty buffer (_pkt_first and _pkt_cnt are zero).
+    // Without packet processor, all output branches receive the same loaded packets.
     // Propagate initial input bitrate to all processors
+    const bool no_processor = next->isOutput();
     while ((next = next->ringNext<PluginExecutor>()) != this) {
-        next->initBuffer(buffer, metadata, 0, 0, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
+        next->initBuffer(buffer, metadata, 0, no_processor ? pkt_read : 0, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
     }
 
     return true;
@@ -36,17 +36,18 @@
 
 ts::tsp::OutputExecutor::OutputExecutor(const TSProcessorArgs& options,
                                         const PluginEventHandlerRegistry& handlers,
-                                        const PluginOptions& pl_options,
+                                        size_t output_index,
                                         const ThreadAttributes& attributes,
                                         Mutex& global_mutex,
                                         Report* report) :
 
-    PluginExecutor(options, handlers, PluginType::OUTPUT, pl_options, attributes, global_mutex, report),
-    _output(dynamic_cast<OutputPlugin*>(PluginThread::plugin()))
+    PluginExecutor(options, handlers, PluginType::OUTPUT, output_index == 0 ? options.output : options.branches[output_index - 1], attributes, global_mutex, report),
+    _output(dynamic_cast<OutputPlugin*>(PluginThread::plugin())),
+    _plugin_index(1 + options.plugins.size() + output_index) // output plugins are after input and packet processors
 {
     if (options.log_plugin_index) {
-        // Make sure that plugins display their index. Output plugin is always last.
-        setLogName(UString::Format(u"%s[%d]", {pluginName(), options.plugins.size() + 1}));
+        // Make sure that plugins display their index.
+        setLogName(UString::Format(u"%s[%d]", {pluginName(), _plugin_index}));
     }
 }
 
@@ -62,8 +63,7 @@ ts::tsp::OutputExecutor::~OutputExecutor()
 
 size_t ts::tsp::OutputExecutor::pluginIndex() const
 {
-    // An input plugin is always last.
-    return pluginCount() - 1;
+    return _plugin_index;
 }
 
 
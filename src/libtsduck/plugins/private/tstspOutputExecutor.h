@@ -51,14 +51,15 @@ namespace ts {
             //! Constructor.
             //! @param [in] options Command line options for tsp.
             //! @param [in] handlers Registry of event handlers.
-            //! @param [in] pl_options Command line options for this plugin.
+            //! @param [in] output_index Index of the output plugin: zero for the main output
+            //! (@a output in @a options), 1 and higher for output branches (@a branches in @a options).
             //! @param [in] attributes Creation attributes for the thread executing this plugin.
             //! @param [in,out] global_mutex Global mutex to synchronize access to the packet buffer.
             //! @param [in,out] report Where to report logs.
             //!
             OutputExecutor(const TSProcessorArgs& options,
                            const PluginEventHandlerRegistry& handlers,
-                           const PluginOptions& pl_options,
+                           size_t output_index,
                            const ThreadAttributes& attributes,
                            Mutex& global_mutex,
                            Report* report);
@@ -73,6 +74,7 @@ namespace ts {
 
         private:
             OutputPlugin* _output;
+            size_t        _plugin_index;
 
             // Inherited from Thread
             virtual void main() override;
@@ -57,6 +57,7 @@ ts::tsp::PluginExecutor::PluginExecutor(const TSProcessorArgs& options,
     _input_end(false),
     _bitrate(0),
     _br_confidence(BitRateConfidence::LOW),
+    _released(0),
     _restart(false),
     _restart_data()
 {
@@ -78,8 +79,8 @@ ts::tsp::PluginExecutor::~PluginExecutor()
 
 size_t ts::tsp::PluginExecutor::pluginCount() const
 {
-    // Input plugin, all processor plugins, output plugin.
-    return _options.plugins.size() + 2;
+    // Input plugin, all processor plugins, output plugin, output branches.
+    return _options.plugins.size() + _options.branches.size() + 2;
 }
 
 
@@ -102,7 +103,59 @@ void ts::tsp::PluginExecutor::setAbort()
 {
     GuardMutex lock(_global_mutex);
     _tsp_aborting = true;
-    ringPrevious<PluginExecutor>()->_to_do.signal();
+    previousExecutor()->_to_do.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Navigation in the ring of plugin executors, taking output branches into account.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor* ts::tsp::PluginExecutor::nextExecutor()
+{
+    PluginExecutor* next = ringNext<PluginExecutor>();
+    if (isOutput()) {
+        // Skip other output branches, up to the input plugin.
+        while (next->isOutput()) {
+            next = next->ringNext<PluginExecutor>();
+        }
+    }
+    return next;
+}
+
+ts::tsp::PluginExecutor* ts::tsp::PluginExecutor::previousExecutor()
+{
+    PluginExecutor* previous = ringPrevious<PluginExecutor>();
+    if (isOutput()) {
+        // Skip other output branches, up to the last packet processor.
+        while (previous->isOutput()) {
+            previous = previous->ringPrevious<PluginExecutor>();
+        }
+    }
+    return previous;
+}
+
+bool ts::tsp::PluginExecutor::nextAborting()
+{
+    PluginExecutor* next = nextExecutor();
+    bool aborting = next->_tsp_aborting;
+
+    // When the next plugin is an output, any aborting output branch is enough.
+    while (!aborting && next->isOutput() && (next = next->ringNext<PluginExecutor>())->isOutput()) {
+        aborting = next->_tsp_aborting;
+    }
+    return aborting;
+}
+
+ts::PacketCounter ts::tsp::PluginExecutor::releasedByOutputs()
+{
+    // All output plugins are just before the input plugin in the ring.
+    PacketCounter released = std::numeric_limits<PacketCounter>::max();
+    PluginExecutor* input = nextExecutor();
+    for (PluginExecutor* out = input->ringPrevious<PluginExecutor>(); out != input && out->isOutput(); out = out->ringPrevious<PluginExecutor>()) {
+        released = std::min(released, out->_released);
+    }
+    return released;
 }
 
 
@@ -162,30 +215,33 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, const BitRate& bitrate,
     _pkt_first = (_pkt_first + count) % _buffer->count();
     _pkt_cnt -= count;
 
-    // Update next processor's buffer: add 'count' packets at the end of its slice of the buffer.
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->_pkt_cnt += count;
-
-    // Propagate bitrate and end of input flag to next processor.
-    next->_bitrate = bitrate;
-    next->_br_confidence = br_confidence;
-    next->_input_end = next->_input_end || input_end;
-
-    // Wake the next processor when there is some new input data or end of input.
-    if (count > 0 || input_end) {
-        next->_to_do.signal();
+    if (isOutput()) {
+        // With output branches, the packets are returned to the input plugin only when all outputs have released them.
+        const PacketCounter previous_release = releasedByOutputs();
+        _released += count;
+        nextExecutor()->receivePackets(size_t(releasedByOutputs() - previous_release), bitrate, br_confidence, input_end);
     }
+    else {
+        // Update next processor's buffer: add 'count' packets at the end of its slice of the buffer.
+        PluginExecutor* next = ringNext<PluginExecutor>();
+        next->receivePackets(count, bitrate, br_confidence, input_end);
+
+        // When the next plugin is an output, all output branches receive the same packets.
+        if (next->isOutput()) {
+            while ((next = next->ringNext<PluginExecutor>())->isOutput()) {
+                next->receivePackets(count, bitrate, br_confidence, input_end);
+            }
+        }
 
-    // Force to abort our processor when the next one is aborting. Already done in waitWork() but force immediately.
-    // Don't do that if current is output and next is input because there is no propagation of packets from output back to input.
-    if (plugin()->type() != PluginType::OUTPUT) {
-        aborted = aborted || next->_tsp_aborting;
+        // Force to abort our processor when the next one is aborting. Already done in waitWork() but force immediately.
+        // Don't do that if current is output and next is input because there is no propagation of packets from output back to input.
+        aborted = aborted || nextAborting();
     }
 
     // Wake the previous processor when we abort (propagate abort conditions backward).
     if (aborted) {
         _tsp_aborting = true; // volatile bool in TSP superclass
-        ringPrevious<PluginExecutor>()->_to_do.signal();
+        previousExecutor()->_to_do.signal();
     }
 
     // Return false when the current processor shall stop.
@@ -193,6 +249,27 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, const BitRate& bitrate,
 }
 
 
+//----------------------------------------------------------------------------
+// Add packets at the end of the slice of buffer of this plugin executor.
+// Called from the previous plugin executor, under the protection of the global mutex.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::receivePackets(size_t count, const BitRate& bitrate, BitRateConfidence br_confidence, bool input_end)
+{
+    _pkt_cnt += count;
+
+    // Propagate bitrate and end of input flag.
+    _bitrate = bitrate;
+    _br_confidence = br_confidence;
+    _input_end = _input_end || input_end;
+
+    // Wake the processor when there is some new input data or end of input.
+    if (count > 0 || input_end) {
+        _to_do.signal();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Wait for packets to process or some error condition.
 //----------------------------------------------------------------------------
@@ -212,11 +289,10 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
     // We access data under the protection of the global mutex.
     GuardCondition lock(_global_mutex, _to_do);
 
-    PluginExecutor* next = ringNext<PluginExecutor>();
     timeout = false;
 
     // Loop until enough packets are available (or some error condition).
-    while (_pkt_cnt < min_pkt_cnt && !_input_end && !timeout && !next->_tsp_aborting) {
+    while (_pkt_cnt < min_pkt_cnt && !_input_end && !timeout && !nextAborting()) {
         // If packet area for this processor is empty, wait for some packet.
         // The mutex is implicitely released, we wait for the condition
         // '_to_do' and, once we get it, implicitely relock the mutex.
@@ -248,7 +324,7 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
     // Force to abort our processor when the next one is aborting.
     // Don't do that if current is output and next is input because
     // there is no propagation of packets from output back to input.
-    aborted = plugin()->type() != PluginType::OUTPUT && next->_tsp_aborting;
+    aborted = !isOutput() && nextAborting();
 
     log(10, u"waitWork(min_pkt_cnt = %'d, pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
         {min_pkt_cnt, pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
@@ -149,6 +149,12 @@ namespace ts {
             virtual size_t pluginCount() const override;
             virtual void signalPluginEvent(uint32_t event_code, Object* plugin_data = nullptr) const override;
 
+            //!
+            //! Check if this plugin executor is an output one (main output or output branch).
+            //! @return True if the plugin is an output plugin.
+            //!
+            bool isOutput() const { return plugin() != nullptr && plugin()->type() == PluginType::OUTPUT; }
+
         protected:
             PacketBuffer*         _buffer;    //!< Description of shared packet buffer.
             PacketMetadataBuffer* _metadata;  //!< Description of shared packet metadata buffer.
@@ -163,6 +169,10 @@ namespace ts {
             //! If the caller thread is the output processor, the semantic of the operation is
             //! "these buffers are no longer used and can be reused by the input thread".
             //!
+            //! When there are several output plugins (output branches), all of them receive the
+            //! same packets, without copy, and each one progresses at its own pace in the buffer.
+            //! The packets are returned to the input thread when all output plugins have released them.
+            //!
             //! @param [in] count Number of packets to pass to next processor.
             //! @param [in] bitrate Bitrate, as computed by this processor or passed from the previous processor.
             //! To be passed to next processor.
@@ -234,9 +244,29 @@ namespace ts {
             bool              _input_end;      // No more packet after current ones [*]
             BitRate           _bitrate;        // Input bitrate (set by previous plugin) [*]
             BitRateConfidence _br_confidence;  // Input bitrate confidence (set by previous plugin) [*]
+            PacketCounter     _released;       // Output plugins: total number of packets released to the input plugin [*]
             bool              _restart;        // Restart the plugin asap using _restart_data
             RestartDataPtr    _restart_data;   // How to restart the plugin
 
+            // Navigation in the ring of plugin executors, taking output branches into account.
+            // All output plugins are consecutive in the ring, between the last processor and the input plugin.
+            // The next executor of an output is the input plugin. The previous executor of an output is the
+            // last processor (or the input plugin). Must be called under the protection of the global mutex.
+            PluginExecutor* nextExecutor();
+            PluginExecutor* previousExecutor();
+
+            // Add packets at the end of the slice of buffer of this executor, propagate bitrate and end of input.
+            // Called from the previous executor, under the protection of the global mutex.
+            void receivePackets(size_t count, const BitRate& bitrate, BitRateConfidence br_confidence, bool input_end);
+
+            // Check if the next plugin is aborting. When the next plugins are output branches,
+            // check if any of them is aborting. Must be called under the protection of the global mutex.
+            bool nextAborting();
+
+            // Lowest number of packets which were released by all output plugins.
+            // Must be called under the protection of the global mutex.
+            PacketCounter releasedByOutputs();
+
             // Description of a restart operation.
             class RestartData
             {
@@ -58,7 +58,9 @@ ts::tsswitch::InputExecutor::InputExecutor(const InputSwitcherArgs& opt,
     _terminated(false),
     _outFirst(0),
     _outCount(0),
-    _start_time(true) // initialized with current system time
+    _start_time(true), // initialized with current system time
+    _inTotal(0),
+    _rapCounters()
 {
     // Make sure that the input plugins display their index.
     setLogName(UString::Format(u"%s[%d]", {pluginName(), _pluginIndex}));
@@ -128,10 +130,46 @@ bool ts::tsswitch::InputExecutor::abortInput()
 void ts::tsswitch::InputExecutor::setCurrent(bool isCurrent)
 {
     GuardMutex lock(_mutex);
+    if (isCurrent && !_isCurrent && _opt.seamlessSwitch) {
+        seekRandomAccessPoint();
+    }
     _isCurrent = isCurrent;
 }
 
 
+//----------------------------------------------------------------------------
+// Drop buffered packets before the latest random access point.
+//----------------------------------------------------------------------------
+
+void ts::tsswitch::InputExecutor::seekRandomAccessPoint()
+{
+    // Packet counter of the oldest packet in the output part of the buffer.
+    const PacketCounter oldest = _inTotal - _outCount;
+
+    // Forget random access points which were already dropped or sent.
+    while (!_rapCounters.empty() && _rapCounters.front() < oldest) {
+        _rapCounters.pop_front();
+    }
+
+    // Never touch an area which is currently used by the output plugin.
+    if (_outputInUse) {
+        debug(u"output buffer in use, cannot seek random access point");
+    }
+    else if (_rapCounters.empty()) {
+        debug(u"no random access point in %d buffered packets", {_outCount});
+    }
+    else {
+        // Restart output at the most recent random access point. No packet is moved.
+        const PacketCounter rap = _rapCounters.back();
+        debug(u"starting at random access point, dropping %d packets out of %d", {rap - oldest, _outCount});
+        _outFirst = size_t(rap % _buffer.size());
+        _outCount = size_t(_inTotal - rap);
+        _rapCounters.clear();
+        _rapCounters.push_back(rap);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Terminate input.
 //----------------------------------------------------------------------------
@@ -194,6 +232,8 @@ void ts::tsswitch::InputExecutor::main()
             // Reset input buffer.
             _outFirst = 0;
             _outCount = 0;
+            _inTotal = 0;
+            _rapCounters.clear();
             // Wait for start or terminate.
             while (!_startRequest && !_terminated) {
                 lock.waitCondition();
@@ -288,7 +328,20 @@ void ts::tsswitch::InputExecutor::main()
             // Signal the presence of received packets.
             {
                 GuardMutex lock(_mutex);
+                // With --seamless-switch, index random access points in the new packets.
+                if (_opt.seamlessSwitch) {
+                    for (size_t n = 0; n < inCount; ++n) {
+                        if (_buffer[inFirst + n].getRandomAccessIndicator()) {
+                            _rapCounters.push_back(_inTotal + n);
+                        }
+                    }
+                    // Forget random access points which were already dropped or sent.
+                    while (!_rapCounters.empty() && _rapCounters.front() < _inTotal - _outCount) {
+                        _rapCounters.pop_front();
+                    }
+                }
                 _outCount += inCount;
+                _inTotal += inCount;
             }
             _core.inputReceived(_pluginIndex);
         }
@@ -305,6 +358,8 @@ void ts::tsswitch::InputExecutor::main()
             // And reset the output part of the buffer.
             _outFirst = 0;
             _outCount = 0;
+            _inTotal = 0;
+            _rapCounters.clear();
         }
 
         // End of input session.
@@ -124,20 +124,25 @@ namespace ts {
             virtual size_t pluginIndex() const override;
 
         private:
-            InputPlugin*             _input;         // Plugin API.
-            const size_t             _pluginIndex;   // Index of this input plugin.
-            TSPacketVector           _buffer;        // Packet buffer.
-            TSPacketMetadataVector   _metadata;      // Packet metadata.
-            Mutex                    _mutex;         // Mutex to protect all subsequent fields.
-            Condition                _todo;          // Condition to signal something to do.
-            bool                     _isCurrent;     // This plugin is the current input one.
-            bool                     _outputInUse;   // The output part of the buffer is currently in use by the output plugin.
-            bool                     _startRequest;  // Start input requested.
-            bool                     _stopRequest;   // Stop input requested.
-            bool                     _terminated;    // Terminate thread.
-            size_t                   _outFirst;      // Index of first packet to output in _buffer.
-            size_t                   _outCount;      // Number of packets to output, not always contiguous, may wrap up.
-            Monotonic                _start_time;    // Creation time in a monotonic clock.
+            InputPlugin*              _input;         // Plugin API.
+            const size_t              _pluginIndex;   // Index of this input plugin.
+            TSPacketVector            _buffer;        // Packet buffer.
+            TSPacketMetadataVector    _metadata;      // Packet metadata.
+            Mutex                     _mutex;         // Mutex to protect all subsequent fields.
+            Condition                 _todo;          // Condition to signal something to do.
+            bool                      _isCurrent;     // This plugin is the current input one.
+            bool                      _outputInUse;   // The output part of the buffer is currently in use by the output plugin.
+            bool                      _startRequest;  // Start input requested.
+            bool                      _stopRequest;   // Stop input requested.
+            bool                      _terminated;    // Terminate thread.
+            size_t                    _outFirst;      // Index of first packet to output in _buffer.
+            size_t                    _outCount;      // Number of packets to output, not always contiguous, may wrap up.
+            Monotonic                 _start_time;    // Creation time in a monotonic clock.
+            PacketCounter             _inTotal;       // Total number of received packets in the session, index in _buffer is _inTotal % size.
+            std::deque<PacketCounter> _rapCounters;   // With --seamless-switch, packet counters of random access points in _buffer.
+
+            // With --seamless-switch, drop buffered packets before the latest random access point (with mutex already held).
+            void seekRandomAccessPoint();
 
             // Implementation of Thread.
             virtual void main() override;
@@ -42,8 +42,13 @@ ts::tsswitch::OutputExecutor::OutputExecutor(const InputSwitcherArgs& opt,
 
     PluginExecutor(opt, handlers, PluginType::OUTPUT, opt.output, ThreadAttributes(), core, log),
     _output(dynamic_cast<OutputPlugin*>(plugin())),
-    _terminate(false)
+    _terminate(false),
+    _lastInput(NPOS),
+    _ccFixer(AllPIDs),
+    _pcrPending()
 {
+    _ccFixer.setFix(true);
+    _ccFixer.setDisplay(false);
 }
 
 ts::tsswitch::OutputExecutor::~OutputExecutor()
@@ -63,6 +68,32 @@ size_t ts::tsswitch::OutputExecutor::pluginIndex() const
 }
 
 
+//----------------------------------------------------------------------------
+// With --seamless-switch, fix packets in place after an input switch.
+//----------------------------------------------------------------------------
+
+void ts::tsswitch::OutputExecutor::fixSeamlessPackets(size_t pluginIndex, TSPacket* pkt, size_t count)
+{
+    // On input switch, the first PCR in each PID shall be marked as a time base discontinuity.
+    if (pluginIndex != _lastInput) {
+        if (_lastInput != NPOS) {
+            _pcrPending.set();
+        }
+        _lastInput = pluginIndex;
+    }
+
+    for (; count > 0; ++pkt, --count) {
+        if (_pcrPending.any() && pkt->hasPCR() && _pcrPending.test(pkt->getPID())) {
+            // The discontinuity_indicator also allows a continuity counter discontinuity in that packet.
+            _pcrPending.reset(pkt->getPID());
+            pkt->setDiscontinuityIndicator();
+        }
+        // Renumber continuity counters after a discontinuity, without discontinuity_indicator.
+        _ccFixer.feedPacket(*pkt);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Invoked in the context of the output plugin thread.
 //----------------------------------------------------------------------------
@@ -81,6 +112,11 @@ void ts::tsswitch::OutputExecutor::main()
         log(2, u"got %d packets from plugin %d, terminate: %s", {count, pluginIndex, _terminate});
         if (!_terminate && count > 0) {
 
+            // With --seamless-switch, fix continuity counters and PCR discontinuities in place.
+            if (_opt.seamlessSwitch) {
+                fixSeamlessPackets(pluginIndex, first, count);
+            }
+
             // Output the packets.
             const bool success = _output->send(first, metadata, count);
 
@@ -36,6 +36,7 @@
 #include "tstsswitchPluginExecutor.h"
 #include "tsInputSwitcherArgs.h"
 #include "tsOutputPlugin.h"
+#include "tsContinuityAnalyzer.h"
 
 namespace ts {
     namespace tsswitch {
@@ -74,8 +75,14 @@ namespace ts {
             virtual size_t pluginIndex() const override;
 
         private:
-            OutputPlugin* _output;     // Plugin API.
-            volatile bool _terminate;  // Termination request.
+            OutputPlugin*      _output;      // Plugin API.
+            volatile bool      _terminate;   // Termination request.
+            size_t             _lastInput;   // Index of input plugin of last output packets, NPOS initially.
+            ContinuityAnalyzer _ccFixer;     // With --seamless-switch, fix continuity counters across switches.
+            PIDSet             _pcrPending;  // With --seamless-switch, PID's with no PCR since last switch.
+
+            // With --seamless-switch, fix packets in place after an input switch.
+            void fixSeamlessPackets(size_t pluginIndex, TSPacket* pkt, size_t count);
 
             // Implementation of Thread.
             virtual void main() override;
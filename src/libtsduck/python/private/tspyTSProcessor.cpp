@@ -134,15 +134,24 @@ TSDUCKPY bool tspyStartTSProcessor(void* tsp, const tspyTSProcessorArgs* pyargs)
         args.app_name = *it++;
     }
     ts::PluginOptions* current = nullptr;
+    bool got_output = false;
     for (; it != fields.end(); ++it) {
         if (*it == u"-I") {
             current = &args.input;
             current->clear();
             continue;
         }
-        else if (*it == u"-O") {
+        else if (*it == u"-O" && !got_output) {
             current = &args.output;
             current->clear();
+            got_output = true;
+            continue;
+        }
+        else if (*it == u"-O") {
+            // All output plugins after the first one are output branches.
+            args.branches.resize(args.branches.size() + 1);
+            current = &args.branches.back();
+            current->clear();
             continue;
         }
         else if (*it == u"-P") {
@@ -177,6 +186,10 @@ TSDUCKPY bool tspyStartTSProcessor(void* tsp, const tspyTSProcessorArgs* pyargs)
         }
         cmd.append(u" ");
         cmd.append(args.output.toString(ts::PluginType::OUTPUT));
+        for (auto it2 = args.branches.begin(); it2 != args.branches.end(); ++it2) {
+            cmd.append(u" ");
+            cmd.append(it2->toString(ts::PluginType::OUTPUT));
+        }
         proc->report().debug(u"starting: %s", {cmd});
     }
 
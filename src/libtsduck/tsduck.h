@@ -113,6 +113,7 @@
 #include "tsBCD.h"
 #include "tsBetterSystemRandomGenerator.h"
 #include "tsBinaryTable.h"
+#include "tsBinaryTablePatcher.h"
 #include "tsBIT.h"
 #include "tsBitRate.h"
 #include "tsBitrateDifferenceDVBT.h"
@@ -329,6 +330,7 @@
 #include "tshlsAltPlayList.h"
 #include "tshlsInputPlugin.h"
 #include "tshlsMediaElement.h"
+#include "tshlsMediaPart.h"
 #include "tshlsMediaPlayList.h"
 #include "tshlsMediaSegment.h"
 #include "tshlsOutputPlugin.h"
@@ -394,6 +396,7 @@
 #include "tsMaximumBitrateDescriptor.h"
 #include "tsMemory.h"
 #include "tsMemoryInputPlugin.h"
+#include "tsMemoryMappedFile.h"
 #include "tsMemoryOutputPlugin.h"
 #include "tsMessageDescriptor.h"
 #include "tsMessagePriorityQueue.h"
@@ -557,7 +560,10 @@
 #include "tsSHA256.h"
 #include "tsSHA512.h"
 #include "tsSharedLibrary.h"
+#include "tsSharedPacketRing.h"
 #include "tsSHDeliverySystemDescriptor.h"
+#include "tsShmRingInputPlugin.h"
+#include "tsShmRingOutputPlugin.h"
 #include "tsShortEventDescriptor.h"
 #include "tsShortNodeInformationDescriptor.h"
 #include "tsShortSmoothingBufferDescriptor.h"
@@ -575,6 +581,8 @@
 #include "tsSkyLogicalChannelNumberDescriptor.h"
 #include "tsSLDescriptor.h"
 #include "tsSmoothingBufferDescriptor.h"
+#include "tsSMPTE2022FECDecoder.h"
+#include "tsSMPTE2022FECEncoder.h"
 #include "tsSocket.h"
 #include "tsSpliceAvailDescriptor.h"
 #include "tsSpliceDTMFDescriptor.h"
@@ -596,6 +604,7 @@
 #include "tsSSUURIDescriptor.h"
 #include "tsStandaloneTableDemux.h"
 #include "tsStandards.h"
+#include "tsStartCode.h"
 #include "tsStaticInstance.h"
 #include "tsSTCReferenceDescriptor.h"
 #include "tsSTDDescriptor.h"
@@ -666,6 +675,7 @@
 #include "tsThreadAttributes.h"
 #include "tsThreadLocalObjects.h"
 #include "tsTime.h"
+#include "tsTimerWheel.h"
 #include "tsTimeShiftBuffer.h"
 #include "tsTimeShiftedEventDescriptor.h"
 #include "tsTimeSliceFECIdentifierDescriptor.h"
@@ -758,6 +768,7 @@
 #include "tsxmlNode.h"
 #include "tsxmlPatchDocument.h"
 #include "tsxmlRunningDocument.h"
+#include "tsxmlStreamWriter.h"
 #include "tsxmlText.h"
 #include "tsxmlTweaks.h"
 #include "tsxmlUnknown.h"
@@ -44,7 +44,7 @@
 //----------------------------------------------------------------------------
 
 namespace ts {
-    class BATPlugin: public AbstractTablePlugin
+    class BATPlugin: public AbstractTablePlugin, private BinaryTablePatcher::Handler
     {
         TS_NOBUILD_NOCOPY(BATPlugin);
     public:
@@ -68,6 +68,10 @@ namespace ts {
 
         // Process a list of descriptors according to the command line options.
         void processDescriptorList(DescriptorList&);
+
+        // Implementation of BinaryTablePatcher::Handler, for in-place patching.
+        virtual bool keepEntry(const BinaryTablePatcher::Location& loc) override;
+        virtual void patchDescriptorList(DescriptorList& dlist, const BinaryTablePatcher::Location& loc) override;
     };
 }
 
@@ -170,7 +174,12 @@ void ts::BATPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
         return;
     }
 
-    // Process the BAT.
+    // Try to patch the BAT sections in place first.
+    if (patchTable(table, *this)) {
+        return;
+    }
+
+    // Full deserialization of the BAT when in-place patching is not possible.
     BAT bat(duck, table);
     if (!bat.isValid()) {
         tsp->warning(u"found invalid BAT");
@@ -207,6 +216,23 @@ void ts::BATPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
 }
 
 
+//----------------------------------------------------------------------------
+// Implementation of BinaryTablePatcher::Handler, for in-place patching.
+//----------------------------------------------------------------------------
+
+bool ts::BATPlugin::keepEntry(const BinaryTablePatcher::Location& loc)
+{
+    // Remove the specified transport streams.
+    return _remove_ts_ids.count(loc.entry_id) == 0;
+}
+
+void ts::BATPlugin::patchDescriptorList(DescriptorList& dlist, const BinaryTablePatcher::Location&)
+{
+    // Same processing on global and transport stream descriptor lists.
+    processDescriptorList(dlist);
+}
+
+
 //----------------------------------------------------------------------------
 //  This method processes a BAT descriptor list
 //----------------------------------------------------------------------------
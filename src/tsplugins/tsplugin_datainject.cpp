@@ -39,14 +39,15 @@
 #include "tstlvConnection.h"
 #include "tsTCPServer.h"
 #include "tsUDPReceiver.h"
-#include "tsMessageQueue.h"
 #include "tstlvMessageFactory.h"
 #include "tsContinuityAnalyzer.h"
+#include "tsSectionDemux.h"
 #include "tsThread.h"
 
 #define DEFAULT_PROTOCOL_VERSION  2     // Default protocol version for EMMG/PDG <=> MUX.
-#define DEFAULT_QUEUE_SIZE        1000  // Maximum number of TS packets in queue
-#define SERVER_BACKLOG            1     // One connection at a time
+#define DEFAULT_QUEUE_SIZE        1000  // Maximum number of sections in queue, per data stream.
+#define DEFAULT_MAX_CLIENTS       10    // Maximum number of simultaneous EMMG/PDG connections.
+#define SERVER_BACKLOG            5     // Pending connections in TCP server.
 #define SERVER_THREAD_STACK_SIZE  (128 * 1024)
 
 
@@ -66,13 +67,80 @@ namespace ts {
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
 
     private:
-        // TS packets or sections are passed from the server thread to the plugin thread using a message queue.
-        typedef MessageQueue<TSPacket, Mutex> PacketQueue;
-        typedef MessageQueue<Section, Mutex> SectionQueue;
+        // Description of a data stream from an EMMG/PDG client.
+        // A data stream is identified by its client id and data id.
+        // In packet mode, the sections are extracted from the incoming packets so that
+        // all data streams can be packetized in the same PID by the shared packetizer.
+        // Always accessed with the plugin mutex held.
+        class DataStream: private SectionHandlerInterface
+        {
+            TS_NOBUILD_NOCOPY(DataStream);
+        public:
+            DataStream(DataInjectPlugin* plugin, uint32_t client_id, uint16_t data_id, bool section_mode, BitRate bitrate);
+
+            DataInjectPlugin* const plugin;           // Parent plugin.
+            const uint32_t          client_id;        // DVB SimulCrypt client id.
+            const uint16_t          data_id;          // DVB SimulCrypt data id.
+            const bool              section_mode;     // Datagrams are sections.
+            BitRate                 bitrate;          // Allocated bitrate, zero means unlimited.
+            bool                    bitrate_changed;  // Allocated bitrate has changed.
+            PacketCounter           next_packet;      // Next insertion point.
+            SectionDemux            demux;            // Extract sections from incoming packets, in packet mode.
+            std::deque<SectionPtr>  sections;         // Queue of incoming sections.
+            size_t                  lost;             // Lost sections (queue full).
+
+            // Enqueue a section, report loss if the queue is full.
+            void enqueue(const SectionPtr&);
+
+        private:
+            // Implementation of SectionHandlerInterface.
+            virtual void handleSection(SectionDemux&, const Section&) override;
+        };
+
+        typedef SafePtr<DataStream, NullMutex> DataStreamPtr;
+        typedef std::map<uint64_t, DataStreamPtr> DataStreamMap;
+
+        // Index of a data stream in a DataStreamMap.
+        static uint64_t StreamIndex(uint32_t client_id, uint16_t data_id) { return (uint64_t(client_id) << 16) | data_id; }
 
-        // Message queues enqueue smart pointers to the message type (MT = Multi-Thread).
-        typedef PacketQueue::MessagePtr PacketPtrMT;
-        typedef SectionQueue::MessagePtr SectionPtrMT;
+        // Client session thread, one per EMMG/PDG TCP connection.
+        class ClientSession : public Thread
+        {
+            TS_NOBUILD_NOCOPY(ClientSession);
+        public:
+            // Constructor and destructor.
+            ClientSession(DataInjectPlugin* plugin);
+            virtual ~ClientSession() override;
+
+            // Connection to the client, to be accepted by the server.
+            tlv::Connection<Mutex>& connection() { return _client; }
+
+            // Check if the session is completed (client disconnected).
+            bool completed() const { return _completed; }
+
+            // Break the connection and terminate the thread.
+            void stop();
+
+            // Invoked in the context of the session thread.
+            virtual void main() override;
+
+        private:
+            typedef std::map<uint16_t, emmgmux::StreamStatus> StreamStatusMap;
+
+            DataInjectPlugin* const _plugin;
+            SwitchableReport        _report;
+            tlv::Connection<Mutex>  _client;
+            volatile bool           _completed;
+            bool                    _channel_established;  // Data channel open.
+            emmgmux::ChannelStatus  _channel_status;       // Channel description.
+            StreamStatusMap         _streams;              // Open streams, indexed by stream id.
+
+            // Close all data streams of this session.
+            void closeStreams();
+        };
+
+        typedef SafePtr<ClientSession, NullMutex> ClientSessionPtr;
+        typedef std::list<ClientSessionPtr> ClientSessionList;
 
         // TCP listener thread.
         class TCPListener : public Thread
@@ -82,7 +150,7 @@ namespace ts {
             // Constructor.
             TCPListener(DataInjectPlugin* plugin);
 
-            // Terminate the thread.
+            // Terminate the thread and all client sessions.
             void stop();
 
             // Invoked in the context of the server thread.
@@ -91,7 +159,10 @@ namespace ts {
         private:
             DataInjectPlugin* const _plugin;
             SwitchableReport        _report;
-            tlv::Connection<Mutex>  _client;
+            ClientSessionList       _sessions;  // Client sessions, only accessed in the server thread and in stop().
+
+            // Remove completed client sessions.
+            void purgeSessions();
         };
 
         // UDP listener thread.
@@ -119,44 +190,41 @@ namespace ts {
 
         // Plugin private data
         PacketCounter      _pkt_current;          // Current TS packet index
-        PacketCounter      _pkt_next_data;        // Next data insertion point
         PID                _data_pid;             // PID for data (constant after start)
         ContinuityAnalyzer _cc_fixer;             // To fix continuity counters in injected PID
-        BitRate            _max_bitrate;          // Max data PID's bitrate (constant after start)
+        BitRate            _max_bitrate;          // Max bitrate per data stream (constant after start)
         bool               _unregulated;          // Insert data packet as soon as received.
-        IPv4SocketAddress      _tcp_address;          // TCP port and optional local address.
-        IPv4SocketAddress      _udp_address;          // UDP port and optional local address.
+        size_t             _queue_size;           // Max number of sections per data stream.
+        size_t             _max_clients;          // Max number of simultaneous client sessions.
+        IPv4SocketAddress  _tcp_address;          // TCP port and optional local address.
+        IPv4SocketAddress  _udp_address;          // UDP port and optional local address.
         bool               _reuse_port;           // Reuse port option.
         size_t             _sock_buf_size;        // Socket receive buffer size.
         TCPServer          _server;               // EMMG/PDG <=> MUX TCP server
         TCPListener        _tcp_listener;         // TCP listener thread.
         UDPListener        _udp_listener;         // UDP listener thread.
-        PacketQueue        _packet_queue;         // Queue of incoming TS packets.
-        SectionQueue       _section_queue;        // Queue of incoming sections.
         tlv::Logger        _logger;               // Message logger.
-        volatile bool      _channel_established;  // Data channel open.
-        volatile bool      _stream_established;   // Data stream open.
-        volatile bool      _req_bitrate_changed;  // Requested bitrate has changed.
         // Start of protected area.
         Mutex              _mutex;                // Mutex for access to protected area
-        uint32_t           _client_id;            // DVB SimilCrypt client id.
-        uint16_t           _data_id;              // DVB SimilCrypt data id.
-        bool               _section_mode;         // Datagrams are sections.
-        Packetizer         _packetizer;           // Generate packets in the case of incoming sections.
-        BitRate            _req_bitrate;          // Requested bitrate
-        size_t             _lost_packets;         // Lost packets (queue full)
+        DataStreamMap      _streams;              // All open data streams.
+        Packetizer         _packetizer;           // Generate packets from all data streams.
 
-        // Reset all client session context information.
-        void clearSession();
+        // Open and close a data stream. Invoked in the server threads.
+        bool openStream(uint32_t client_id, uint16_t data_id, bool section_mode);
+        void closeStream(uint32_t client_id, uint16_t data_id);
 
-        // Process bandwidth request. Invoked in the server thread.
-        bool processBandwidthRequest(const tlv::MessagePtr&, emmgmux::StreamBWAllocation&);
+        // Process bandwidth request. Invoked in the server threads.
+        bool processBandwidthRequest(const emmgmux::StreamStatus&, const emmgmux::StreamBWRequest&, emmgmux::StreamBWAllocation&);
 
-        // Process data provision. Invoked in the server thread.
+        // Process data provision. Invoked in the server threads.
         bool processDataProvision(const tlv::MessagePtr&);
 
-        // Report packet/session loss. Invoked with _mutex held.
-        void processPacketLoss(const UChar* type, bool enqueueSuccess);
+
+        // Select the next data stream to insert. Invoked with _mutex held.
+        DataStreamPtr nextStream();
+
+        // Compute the next insertion point of a data stream. Invoked with _mutex held.
+        void scheduleStream(DataStream&, size_t packet_count);
 
         // Implementation of SectionProviderInterface.
         virtual void provideSection(SectionCounter counter, SectionPtr& section) override;
@@ -174,11 +242,12 @@ TS_REGISTER_PROCESSOR_PLUGIN(u"datainject", ts::DataInjectPlugin);
 ts::DataInjectPlugin::DataInjectPlugin(TSP* tsp_) :
     ProcessorPlugin(tsp_, u"DVB SimulCrypt data injector using EMMG/PDG <=> MUX protocol", u"[options]"),
     _pkt_current(0),
-    _pkt_next_data(0),
     _data_pid(PID_NULL),
     _cc_fixer(AllPIDs, tsp),
     _max_bitrate(0),
     _unregulated(false),
+    _queue_size(DEFAULT_QUEUE_SIZE),
+    _max_clients(DEFAULT_MAX_CLIENTS),
     _tcp_address(),
     _udp_address(),
     _reuse_port(false),
@@ -186,23 +255,14 @@ ts::DataInjectPlugin::DataInjectPlugin(TSP* tsp_) :
     _server(),
     _tcp_listener(this),
     _udp_listener(this),
-    _packet_queue(),
-    _section_queue(),
     _logger(ts::Severity::Debug, tsp_),
-    _channel_established(false),
-    _stream_established(false),
-    _req_bitrate_changed(false),
     _mutex(),
-    _client_id(0),
-    _data_id(0),
-    _section_mode(false),
-    _packetizer(duck, PID_NULL, this),
-    _req_bitrate(0),
-    _lost_packets(0)
+    _streams(),
+    _packetizer(duck, PID_NULL, this)
 {
     option<BitRate>(u"bitrate-max", 'b');
     help(u"bitrate-max",
-         u"Specifies the maximum bitrate for the data PID in bits / second. "
+         u"Specifies the maximum bitrate for each data stream in bits / second. "
          u"By default, the data PID bitrate is limited by the stuffing bitrate "
          u"(data insertion is performed by replacing stuffing packets).");
 
@@ -228,6 +288,11 @@ ts::DataInjectPlugin::DataInjectPlugin(TSP* tsp_) :
          u"If the option is present without value, the messages are logged at info "
          u"level. A level can be a numerical debug level or a name.");
 
+    option(u"max-clients", 'm', POSITIVE);
+    help(u"max-clients",
+         u"Specifies the maximum number of simultaneous EMMG/PDG connections. "
+         u"The default is " TS_USTRINGIFY(DEFAULT_MAX_CLIENTS) u".");
+
     option(u"no-reuse-port");
     help(u"no-reuse-port",
          u"Disable the reuse port socket option. Do not use unless completely necessary.");
@@ -238,9 +303,10 @@ ts::DataInjectPlugin::DataInjectPlugin(TSP* tsp_) :
 
     option(u"queue-size", 'q', UINT32);
     help(u"queue-size",
-         u"Specifies the maximum number of sections or TS packets in the internal "
-         u"queue, ie. sections or packets which are received from the EMMG/PDG "
-         u"client but not yet inserted into the TS. The default is " +
+         u"Specifies the maximum number of sections in the internal queue of each "
+         u"data stream, ie. sections which are received from the EMMG/PDG clients "
+         u"but not yet inserted into the TS. In packet mode, the sections are "
+         u"extracted from the received TS packets. The default is " +
          UString::Decimal(DEFAULT_QUEUE_SIZE) + u".");
 
     option(u"reuse-port", 'r');
@@ -250,12 +316,14 @@ ts::DataInjectPlugin::DataInjectPlugin(TSP* tsp_) :
 
     option(u"server", 's', STRING, 1, 1);
     help(u"server", u"[address:]port",
-         u"Specifies the local TCP port on which the plugin listens for an incoming "
-         u"EMMG/PDG connection. This option is mandatory. "
+         u"Specifies the local TCP port on which the plugin listens for incoming "
+         u"EMMG/PDG connections. This option is mandatory. "
          u"When present, the optional address shall specify a local IP address or "
          u"host name (by default, the plugin accepts connections on any local IP "
          u"interface). This plugin behaves as a MUX, ie. a TCP server, and accepts "
-         u"only one EMMG/PDG connection at a time.");
+         u"several simultaneous EMMG/PDG connections (see option --max-clients). "
+         u"Each connection may open several data streams, each one with its own "
+         u"bandwidth allocation. All data streams are injected in the same PID.");
 
     option(u"udp", 'u', STRING);
     help(u"udp", u"[address:]port",
@@ -280,7 +348,8 @@ bool ts::DataInjectPlugin::start()
     // Command line options
     getValue(_max_bitrate, u"bitrate-max");
     getIntValue(_data_pid, u"pid");
-    const size_t queue_size = intValue<size_t>(u"queue-size", DEFAULT_QUEUE_SIZE);
+    getIntValue(_queue_size, u"queue-size", DEFAULT_QUEUE_SIZE);
+    getIntValue(_max_clients, u"max-clients", DEFAULT_MAX_CLIENTS);
     _reuse_port = !present(u"no-reuse-port");
     getIntValue(_sock_buf_size, u"buffer-size");
     _unregulated = present(u"unregulated");
@@ -291,10 +360,6 @@ bool ts::DataInjectPlugin::start()
     _logger.setDefaultSeverity(log_protocol);
     _logger.setSeverity(ts::emmgmux::Tags::data_provision, log_data);
 
-    // Limit internal queues sizes.
-    _packet_queue.setMaxMessages(queue_size);
-    _section_queue.setMaxMessages(queue_size);
-
     // Specify which EMMG/PDG <=> MUX version to use.
     emmgmux::Protocol::Instance()->setVersion(intValue<tlv::VERSION>(u"emmg-mux-version", DEFAULT_PROTOCOL_VERSION));
 
@@ -334,15 +399,18 @@ bool ts::DataInjectPlugin::start()
         return false;
     }
 
-    // Clear client session.
-    clearSession();
-    tsp->verbose(u"initial bandwidth allocation is %'d", {_req_bitrate == 0 ? u"unlimited" : _req_bitrate.toString() + u" b/s"});
+    // No data stream is initially open.
+    {
+        GuardMutex lock(_mutex);
+        _streams.clear();
+        _packetizer.reset();
+    }
+    tsp->verbose(u"initial bandwidth allocation per data stream is %s", {_max_bitrate == 0 ? u"unlimited" : _max_bitrate.toString() + u" b/s"});
 
     // TS processing state
     _cc_fixer.reset();
     _cc_fixer.setGenerator(true);
     _pkt_current = 0;
-    _pkt_next_data = 0;
 
     // Start the internal threads.
     _tcp_listener.start();
@@ -352,31 +420,6 @@ bool ts::DataInjectPlugin::start()
 }
 
 
-//----------------------------------------------------------------------------
-// Reset all client session context information.
-//----------------------------------------------------------------------------
-
-void ts::DataInjectPlugin::clearSession()
-{
-    // Work on some protected data
-    GuardMutex lock(_mutex);
-
-    // No client session is established.
-    _channel_established = false;
-    _stream_established = false;
-
-    // Reset queues.
-    _packet_queue.clear();
-    _section_queue.clear();
-    _packetizer.reset();
-    _lost_packets = 0;
-
-    // Initial bandwidth allocation (zero means unlimited)
-    _req_bitrate = _max_bitrate;
-    _req_bitrate_changed = false;
-}
-
-
 //----------------------------------------------------------------------------
 // Stop method
 //----------------------------------------------------------------------------
@@ -386,6 +429,11 @@ bool ts::DataInjectPlugin::stop()
     // Stop the internal threads.
     _tcp_listener.stop();
     _udp_listener.stop();
+
+    // Drop all data streams.
+    GuardMutex lock(_mutex);
+    _streams.clear();
+    _packetizer.reset();
     return true;
 }
 
@@ -409,107 +457,178 @@ ts::ProcessorPlugin::Status ts::DataInjectPlugin::processPacket(TSPacket& pkt, T
     // Data injection may occur only be replacing null packets
     if (pid == PID_NULL) {
 
-        // Update data PID bitrate
-        if (_req_bitrate_changed) {
-            // Reinitialize insertion point when bitrate changes
-            _pkt_next_data = _pkt_current;
-            _req_bitrate_changed = false;
+        // Time to insert data packet, if any is available immediately.
+        // The data streams are selected in provideSection(), when the packetizer needs a new section.
+        GuardMutex lock(_mutex);
+        const bool got_packet = _packetizer.getNextPacket(pkt);
+
+        // Update new inserted packet.
+        if (got_packet) {
+            // Update PID and continuity counter.
+            pkt.setPID(_data_pid);
+            _cc_fixer.feedPacket(pkt);
         }
+    }
 
-        // Try to insert data
-        if (_unregulated || _pkt_next_data <= _pkt_current) {
-            // Time to insert data packet, if any is available immediately.
-            GuardMutex lock(_mutex);
+    return TSP_OK;
+}
 
-            // Get next packet to insert.
-            bool got_packet = false;
-            if (_section_mode) {
-                // Section mode: Get a packet from the packetizer.
-                got_packet = _packetizer.getNextPacket(pkt);
-            }
-            else {
-                // Packet mode: Dequeue a packet immediately.
-                PacketPtrMT pp;
-                got_packet = _packet_queue.dequeue(pp, 0);
-                if (got_packet) {
-                    pkt = *pp;
-                }
-            }
 
-            // Update new inserted packet.
-            if (got_packet) {
-                // Update PID and continuity counter.
-                pkt.setPID(_data_pid);
-                _cc_fixer.feedPacket(pkt);
-                // Compute next insertion point if the data PID bitrate is specified.
-                // Otherwise, try to update any null packet (unbounded bitrate).
-                if (!_unregulated || _req_bitrate != 0) {
-                    // TODO: refine this, works only for low injection bitrates.
-                    _pkt_next_data += (tsp->bitrate() / _req_bitrate).toInt();
-                }
-            }
+//----------------------------------------------------------------------------
+// Select the next data stream to insert. Invoked with _mutex held.
+//----------------------------------------------------------------------------
+
+ts::DataInjectPlugin::DataStreamPtr ts::DataInjectPlugin::nextStream()
+{
+    DataStreamPtr next;
+    for (auto& it : _streams) {
+        DataStream& ds(*it.second);
+        // Reinitialize insertion point when bitrate changes
+        if (ds.bitrate_changed) {
+            ds.next_packet = _pkt_current;
+            ds.bitrate_changed = false;
+        }
+        // Keep the data stream with the oldest insertion point.
+        if (!ds.sections.empty() && (_unregulated || ds.next_packet <= _pkt_current) && (next.isNull() || ds.next_packet < next->next_packet)) {
+            next = it.second;
         }
     }
+    return next;
+}
 
-    return TSP_OK;
+
+//----------------------------------------------------------------------------
+// Compute the next insertion point of a data stream. Invoked with _mutex held.
+//----------------------------------------------------------------------------
+
+void ts::DataInjectPlugin::scheduleStream(DataStream& ds, size_t packet_count)
+{
+    if (ds.bitrate == 0 || tsp->bitrate() == 0) {
+        // Unlimited bitrate, just make sure that all data streams are served in turn.
+        ds.next_packet = _pkt_current + packet_count;
+    }
+    else {
+        // TODO: refine this, works only for low injection bitrates.
+        ds.next_packet += packet_count * (tsp->bitrate() / ds.bitrate).toInt();
+    }
 }
 
 
 //----------------------------------------------------------------------------
 // Implementation of SectionProviderInterface.
-// Provide next section to packetize in section mode.
+// Provide next section to packetize from the data stream which is ready for
+// insertion for the longest time. Invoked with _mutex held.
 //----------------------------------------------------------------------------
 
 void ts::DataInjectPlugin::provideSection(SectionCounter counter, SectionPtr& section)
 {
-    // Try to dequeue a section immediately.
-    SectionPtrMT mt_section;
-    if (_section_queue.dequeue(mt_section, 0)) {
-        // A section was dequeue. Change the mutex of the safe pointer.
-        section = mt_section.changeMutex<SectionPtr::MutexType>();
-    }
-    else {
+    const DataStreamPtr ds(nextStream());
+    if (ds.isNull()) {
         // No section available.
         section.clear();
     }
+    else {
+        section = ds->sections.front();
+        ds->sections.pop_front();
+        scheduleStream(*ds, (section->size() + PKT_SIZE - 5) / (PKT_SIZE - 4));
+    }
 }
 
 
 //----------------------------------------------------------------------------
-// Process bandwidth request. Invoked in the server thread
+// Data streams.
 //----------------------------------------------------------------------------
 
-bool ts::DataInjectPlugin::processBandwidthRequest(const tlv::MessagePtr& request, emmgmux::StreamBWAllocation& response)
+ts::DataInjectPlugin::DataStream::DataStream(DataInjectPlugin* plugin_, uint32_t client_id_, uint16_t data_id_, bool section_mode_, BitRate bitrate_) :
+    plugin(plugin_),
+    client_id(client_id_),
+    data_id(data_id_),
+    section_mode(section_mode_),
+    bitrate(bitrate_),
+    bitrate_changed(true),
+    next_packet(0),
+    demux(plugin_->duck, nullptr, this, AllPIDs),
+    sections(),
+    lost(0)
 {
-    // Interpret the message as a stream_BW_request.
-    emmgmux::StreamBWRequest* m = dynamic_cast<emmgmux::StreamBWRequest*>(request.pointer());
-    if (m == nullptr) {
-        tsp->error(u"incorrect message, expected stream_BW_request");
+}
+
+void ts::DataInjectPlugin::DataStream::handleSection(SectionDemux&, const Section& section)
+{
+    enqueue(SectionPtr(new Section(section, ShareMode::SHARE)));
+}
+
+void ts::DataInjectPlugin::DataStream::enqueue(const SectionPtr& section)
+{
+    if (sections.size() < plugin->_queue_size) {
+        sections.push_back(section);
+        if (lost != 0) {
+            plugin->tsp->info(u"client id 0x%X, data id 0x%X, retransmitting after %'d lost sections", {client_id, data_id, lost});
+            lost = 0;
+        }
+    }
+    else if (lost++ == 0) {
+        plugin->tsp->warning(u"client id 0x%X, data id 0x%X, internal queue overflow, losing sections, consider using --queue-size", {client_id, data_id});
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Open and close a data stream. Invoked in the server threads.
+//----------------------------------------------------------------------------
+
+bool ts::DataInjectPlugin::openStream(uint32_t client_id, uint16_t data_id, bool section_mode)
+{
+    GuardMutex lock(_mutex);
+
+    const uint64_t index = StreamIndex(client_id, data_id);
+    if (_streams.find(index) != _streams.end()) {
+        tsp->error(u"data stream for client id 0x%X, data id 0x%X already open", {client_id, data_id});
         return false;
     }
+    _streams[index] = new DataStream(this, client_id, data_id, section_mode, _max_bitrate);
+    tsp->verbose(u"opened data stream for client id 0x%X, data id 0x%X, %d data streams", {client_id, data_id, _streams.size()});
+    return true;
+}
+
+void ts::DataInjectPlugin::closeStream(uint32_t client_id, uint16_t data_id)
+{
+    GuardMutex lock(_mutex);
+    _streams.erase(StreamIndex(client_id, data_id));
+    tsp->verbose(u"closed data stream for client id 0x%X, data id 0x%X, %d data streams", {client_id, data_id, _streams.size()});
+}
+
+
+//----------------------------------------------------------------------------
+// Process bandwidth request. Invoked in the server threads.
+//----------------------------------------------------------------------------
 
+bool ts::DataInjectPlugin::processBandwidthRequest(const emmgmux::StreamStatus& stream, const emmgmux::StreamBWRequest& request, emmgmux::StreamBWAllocation& response)
+{
     GuardMutex lock(_mutex);
 
     // Check that the stream is established.
-    if (!_stream_established) {
+    const auto it = _streams.find(StreamIndex(stream.client_id, stream.data_id));
+    if (it == _streams.end()) {
         tsp->error(u"unexpected stream_BW_request, stream not setup");
         return false;
     }
+    DataStream& ds(*it->second);
 
     // Compute new bandwidth
-    if (m->has_bandwidth) {
-        BitRate requested = 1000 * BitRate(m->bandwidth); // protocol unit is kb/s
-        _req_bitrate = _max_bitrate == 0 ? requested : std::min(requested, _max_bitrate);
-        _req_bitrate_changed = true;
-        tsp->verbose(u"requested bandwidth %'d b/s, allocated %'d b/s", {requested, _req_bitrate});
+    if (request.has_bandwidth) {
+        BitRate requested = 1000 * BitRate(request.bandwidth); // protocol unit is kb/s
+        ds.bitrate = _max_bitrate == 0 ? requested : std::min(requested, _max_bitrate);
+        ds.bitrate_changed = true;
+        tsp->verbose(u"client id 0x%X, data id 0x%X, requested bandwidth %'d b/s, allocated %'d b/s", {ds.client_id, ds.data_id, requested, ds.bitrate});
     }
 
     // Build the response
-    response.channel_id = m->channel_id;
-    response.stream_id = m->stream_id;
-    response.client_id = m->client_id;
-    response.has_bandwidth = _req_bitrate > 0;
-    response.bandwidth = uint16_t(_req_bitrate.toInt() / 1000); // protocol unit is kb/s
+    response.channel_id = request.channel_id;
+    response.stream_id = request.stream_id;
+    response.client_id = request.client_id;
+    response.has_bandwidth = ds.bitrate > 0;
+    response.bandwidth = uint16_t(ds.bitrate.toInt() / 1000); // protocol unit is kb/s
     return true;
 }
 
@@ -527,32 +646,28 @@ bool ts::DataInjectPlugin::processDataProvision(const tlv::MessagePtr& msg)
         return false;
     }
 
-    GuardMutex lock(_mutex);
-
-    // Check that the stream is established.
-    if (!_stream_established) {
-        tsp->error(u"unexpected data_provision, stream not setup");
-        return false;
-    }
-
-    // Check that the client and data id are expected.
-    if (m->client_id != _client_id) {
-        tsp->error(u"unexpected client id 0x%X in data_provision, expected 0x%X", {m->client_id, _client_id});
-        return false;
-    }
-    if (m->data_id != _data_id) {
-        tsp->error(u"unexpected data id 0x%X in data_provision, expected 0x%X", {m->data_id, _data_id});
-        return false;
+    // Check that the stream is established and get its mode.
+    const uint64_t index = StreamIndex(m->client_id, m->data_id);
+    bool section_mode = false;
+    {
+        GuardMutex lock(_mutex);
+        const auto it = _streams.find(index);
+        if (it == _streams.end()) {
+            tsp->error(u"unexpected data_provision, no stream for client id 0x%X, data id 0x%X", {m->client_id, m->data_id});
+            return false;
+        }
+        section_mode = it->second->section_mode;
     }
 
-    // Check that the stream is established.
-    bool ok = true;
-    if (_section_mode) {
-        // Section mode, one section per datagram parameter, enqueue them.
+    // Build sections or packets without blocking the other data streams.
+    std::vector<SectionPtr> sections;
+    std::vector<TSPacket> packets;
+    if (section_mode) {
+        // Section mode, one section per datagram parameter.
         for (size_t i = 0; i < m->datagram.size(); ++i) {
-            SectionPtrMT sp(new Section(m->datagram[i]));
+            SectionPtr sp(new Section(m->datagram[i]));
             if (sp->isValid()) {
-                processPacketLoss(u"sections", _section_queue.enqueue(sp, 0));
+                sections.push_back(sp);
             }
             else {
                 tsp->error(u"received an invalid section (%d bytes)", {m->datagram[i]->size()});
@@ -560,68 +675,136 @@ bool ts::DataInjectPlugin::processDataProvision(const tlv::MessagePtr& msg)
         }
     }
     else {
-        // Packet mode, locate packets and enqueue them
+        // Packet mode, locate packets.
         for (size_t i = 0; i < m->datagram.size(); ++i) {
             const uint8_t* data = m->datagram[i]->data();
             size_t size = m->datagram[i]->size();
-            while (size >= PKT_SIZE) {
-                if (*data != SYNC_BYTE) {
-                    tsp->error(u"invalid TS packet");
-                }
-                else {
-                    PacketPtrMT p(new TSPacket());
-                    p->copyFrom(data);
-                    processPacketLoss(u"packets", _packet_queue.enqueue(p, 0));
-                    data += PKT_SIZE;
-                    size -= PKT_SIZE;
-                }
+            while (size >= PKT_SIZE && *data == SYNC_BYTE) {
+                packets.resize(packets.size() + 1);
+                packets.back().copyFrom(data);
+                data += PKT_SIZE;
+                size -= PKT_SIZE;
             }
             if (size != 0) {
-                tsp->error(u"extraneous %d bytes in datagram", {size});
+                tsp->error(u"invalid TS packet or extraneous %d bytes in datagram", {size});
             }
         }
     }
 
-    return ok;
+    // Enqueue sections. The stream may have been closed in the meantime.
+    GuardMutex lock(_mutex);
+    const auto it = _streams.find(index);
+    if (it != _streams.end()) {
+        DataStream& ds(*it->second);
+        for (const auto& sp : sections) {
+            ds.enqueue(sp);
+        }
+        for (const auto& pkt : packets) {
+            ds.demux.feedPacket(pkt);
+        }
+    }
+    return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Report packet/session loss. Invoked with _mutex held.
+// TCP listener thread.
 //----------------------------------------------------------------------------
 
-void ts::DataInjectPlugin::processPacketLoss(const UChar* type, bool enqueueSuccess)
+ts::DataInjectPlugin::TCPListener::TCPListener(DataInjectPlugin* plugin) :
+    Thread(ThreadAttributes().setStackSize(SERVER_THREAD_STACK_SIZE)),
+    _plugin(plugin),
+    _report(*plugin->tsp),
+    _sessions()
+{
+}
+
+void ts::DataInjectPlugin::TCPListener::stop()
 {
-    if (!enqueueSuccess && _lost_packets++ == 0) {
-        tsp->warning(u"internal queue overflow, losing %s, consider using --queue-size", {type});
+    // Switch off error messages from the network client.
+    _report.setSwitch(false);
+
+    // Close the server. This will force the server thread to terminate.
+    _plugin->_server.close(*_plugin->tsp);
+
+    // Wait for actual thread termination
+    Thread::waitForTermination();
+
+    // Then break all client connections.
+    for (const auto& session : _sessions) {
+        session->stop();
     }
-    else if (enqueueSuccess && _lost_packets != 0) {
-        tsp->info(u"retransmitting after %'d lost %s", {_lost_packets, type});
-        _lost_packets = 0;
+    _sessions.clear();
+}
+
+void ts::DataInjectPlugin::TCPListener::purgeSessions()
+{
+    for (auto it = _sessions.begin(); it != _sessions.end(); ) {
+        if ((*it)->completed()) {
+            (*it)->stop();
+            it = _sessions.erase(it);
+        }
+        else {
+            ++it;
+        }
     }
 }
 
+void ts::DataInjectPlugin::TCPListener::main()
+{
+    _plugin->tsp->debug(u"TCP server thread started");
+
+    // Loop on client acceptance, each client is served in its own thread.
+    for (;;) {
+        IPv4SocketAddress client_address;
+        ClientSessionPtr session(new ClientSession(_plugin));
+        if (!_plugin->_server.accept(session->connection(), client_address, _report)) {
+            break;
+        }
+        purgeSessions();
+        if (_sessions.size() >= _plugin->_max_clients) {
+            _report.error(u"too many EMMG/PDG connections, rejecting connection from %s", {client_address});
+            session->connection().disconnect(NULLREP);
+            session->connection().close(NULLREP);
+        }
+        else {
+            _report.verbose(u"incoming connection from %s", {client_address});
+            session->start();
+            _sessions.push_back(session);
+        }
+    }
+
+    _plugin->tsp->debug(u"TCP server thread completed");
+}
+
 
 //----------------------------------------------------------------------------
-// TCP listener thread.
+// Client session thread.
 //----------------------------------------------------------------------------
 
-ts::DataInjectPlugin::TCPListener::TCPListener(DataInjectPlugin* plugin) :
+ts::DataInjectPlugin::ClientSession::ClientSession(DataInjectPlugin* plugin) :
     Thread(ThreadAttributes().setStackSize(SERVER_THREAD_STACK_SIZE)),
     _plugin(plugin),
     _report(*plugin->tsp),
-    _client(emmgmux::Protocol::Instance(), true, 3)
+    _client(emmgmux::Protocol::Instance(), true, 3),
+    _completed(false),
+    _channel_established(false),
+    _channel_status(),
+    _streams()
 {
 }
 
-void ts::DataInjectPlugin::TCPListener::stop()
+ts::DataInjectPlugin::ClientSession::~ClientSession()
+{
+    waitForTermination();
+}
+
+void ts::DataInjectPlugin::ClientSession::stop()
 {
     // Switch off error messages from the network client.
     _report.setSwitch(false);
 
-    // Close the server, then break client connection.
-    // This will force the server thread to terminate.
-    _plugin->_server.close(*_plugin->tsp);
+    // Break client connection. This will force the session thread to terminate.
     _client.disconnect(NULLREP);
     _client.close(NULLREP);
 
@@ -629,164 +812,163 @@ void ts::DataInjectPlugin::TCPListener::stop()
     Thread::waitForTermination();
 }
 
-void ts::DataInjectPlugin::TCPListener::main()
+void ts::DataInjectPlugin::ClientSession::closeStreams()
 {
-    _plugin->tsp->debug(u"TCP server thread started");
+    for (const auto& it : _streams) {
+        _plugin->closeStream(it.second.client_id, it.second.data_id);
+    }
+    _streams.clear();
+}
 
-    IPv4SocketAddress client_address;
-    emmgmux::ChannelStatus channel_status;
-    emmgmux::StreamStatus stream_status;
-
-    // Loop on client acceptance (accept only one client at a time).
-    while (_plugin->_server.accept(_client, client_address, _report)) {
-
-        _report.verbose(u"incoming connection from %s", {client_address});
-
-        // Start from a fresh client session context.
-        _plugin->clearSession();
-
-        // Connection state
-        bool ok = true;
-        tlv::MessagePtr msg;
-
-        // Loop on message reception from the client
-        while (ok && _client.receive(msg, _plugin->tsp, _plugin->_logger)) {
-
-            // Message handling.
-            // We do not send errors back to client, we just disconnect
-            // (not too polite, but we don't care!)
-            switch (msg->tag()) {
-
-                case emmgmux::Tags::channel_setup: {
-                    if (_plugin->_channel_established) {
-                        _report.error(u"received channel_setup when channel is already setup");
-                        ok = false;
-                    }
-                    else {
-                        emmgmux::ChannelSetup* m = dynamic_cast<emmgmux::ChannelSetup*>(msg.pointer());
-                        assert (m != nullptr);
-                        // First, declare the channel as established.
-                        {
-                            GuardMutex lock(_plugin->_mutex);
-                            _plugin->_client_id = m->client_id;
-                            _plugin->_section_mode = !m->section_TSpkt_flag; // flag == 0 means section
-                            _plugin->_channel_established = true;
-                        }
-                        // Build and send the channel_status
-                        channel_status.channel_id = m->channel_id;
-                        channel_status.client_id = m->client_id;
-                        channel_status.section_TSpkt_flag = m->section_TSpkt_flag;
-                        ok = _client.send(channel_status, _plugin->_logger);
-                    }
-                    break;
-                }
+void ts::DataInjectPlugin::ClientSession::main()
+{
+    // Connection state
+    bool ok = true;
+    tlv::MessagePtr msg;
 
-                case emmgmux::Tags::channel_test: {
-                    if (_plugin->_channel_established) {
-                        // Automatic reply to channel_test
-                        ok = _client.send(channel_status, _plugin->_logger);
-                    }
-                    else {
-                        _report.error(u"unexpected channel_test, channel not setup");
-                        ok = false;
-                    }
-                    break;
-                }
+    // Loop on message reception from the client
+    while (ok && _client.receive(msg, _plugin->tsp, _plugin->_logger)) {
 
-                case emmgmux::Tags::channel_close: {
-                    GuardMutex lock(_plugin->_mutex);
-                    _plugin->_channel_established = false;
-                    _plugin->_stream_established = false;
-                    break;
-                }
+        // Message handling.
+        // We do not send errors back to client, we just disconnect
+        // (not too polite, but we don't care!)
+        switch (msg->tag()) {
 
-                case emmgmux::Tags::stream_setup: {
-                    if (!_plugin->_channel_established) {
-                        _report.error(u"unexpected stream_setup, channel not setup");
-                        ok = false;
-                    }
-                    else if (_plugin->_stream_established) {
-                        _report.error(u"received stream_setup when stream is already setup");
-                        ok = false;
-                    }
-                    else {
-                        emmgmux::StreamSetup* m = dynamic_cast<emmgmux::StreamSetup*>(msg.pointer());
-                        assert(m != nullptr);
-                        // First, declare the stream as established.
-                        {
-                            GuardMutex lock(_plugin->_mutex);
-                            _plugin->_data_id = m->data_id;
-                            _plugin->_stream_established = true;
-                        }
-                        // Build and send the stream_status
-                        stream_status.channel_id = m->channel_id;
-                        stream_status.stream_id = m->stream_id;
-                        stream_status.client_id = m->client_id;
-                        stream_status.data_id = m->data_id;
-                        stream_status.data_type = m->data_type;
-                        ok = _client.send(stream_status, _plugin->_logger);
-                    }
-                    break;
+            case emmgmux::Tags::channel_setup: {
+                if (_channel_established) {
+                    _report.error(u"received channel_setup when channel is already setup");
+                    ok = false;
+                }
+                else {
+                    emmgmux::ChannelSetup* m = dynamic_cast<emmgmux::ChannelSetup*>(msg.pointer());
+                    assert(m != nullptr);
+                    // Build and send the channel_status
+                    _channel_established = true;
+                    _channel_status.channel_id = m->channel_id;
+                    _channel_status.client_id = m->client_id;
+                    _channel_status.section_TSpkt_flag = m->section_TSpkt_flag;
+                    ok = _client.send(_channel_status, _plugin->_logger);
                 }
+                break;
+            }
 
-                case emmgmux::Tags::stream_test: {
-                    if (_plugin->_stream_established) {
-                        // Automatic reply to stream_test
-                        ok = _client.send(stream_status, _plugin->_logger);
-                    }
-                    else {
-                        _report.error(u"unexpected stream_test, stream not setup");
-                        ok = false;
-                    }
-                    break;
+            case emmgmux::Tags::channel_test: {
+                if (_channel_established) {
+                    // Automatic reply to channel_test
+                    ok = _client.send(_channel_status, _plugin->_logger);
                 }
+                else {
+                    _report.error(u"unexpected channel_test, channel not setup");
+                    ok = false;
+                }
+                break;
+            }
+
+            case emmgmux::Tags::channel_close: {
+                closeStreams();
+                _channel_established = false;
+                break;
+            }
 
-                case emmgmux::Tags::stream_close_request: {
-                    if (!_plugin->_stream_established) {
-                        _report.error(u"unexpected stream_close_request, stream not setup");
-                        ok = false;
-                    }
-                    else {
-                        // First, declare the stream as closed.
-                        {
-                            GuardMutex lock(_plugin->_mutex);
-                            _plugin->_stream_established = false;
-                        }
-                        // Send the stream_close_response
-                        emmgmux::StreamCloseResponse resp;
-                        emmgmux::StreamCloseRequest* m = dynamic_cast<emmgmux::StreamCloseRequest*>(msg.pointer());
-                        assert (m != nullptr);
-                        resp.channel_id = m->channel_id;
-                        resp.stream_id = m->stream_id;
-                        resp.client_id = m->client_id;
-                        ok = _client.send(resp, _plugin->_logger);
-                    }
-                    break;
+            case emmgmux::Tags::stream_setup: {
+                emmgmux::StreamSetup* m = dynamic_cast<emmgmux::StreamSetup*>(msg.pointer());
+                assert(m != nullptr);
+                if (!_channel_established) {
+                    _report.error(u"unexpected stream_setup, channel not setup");
+                    ok = false;
+                }
+                else if (_streams.find(m->stream_id) != _streams.end()) {
+                    _report.error(u"received stream_setup when stream %d is already setup", {m->stream_id});
+                    ok = false;
+                }
+                else if (m->client_id != _channel_status.client_id) {
+                    _report.error(u"unexpected client id 0x%X in stream_setup, expected 0x%X", {m->client_id, _channel_status.client_id});
+                    ok = false;
+                }
+                else if (_plugin->openStream(m->client_id, m->data_id, !_channel_status.section_TSpkt_flag)) { // flag == 0 means section
+                    // Build and send the stream_status
+                    emmgmux::StreamStatus& status(_streams[m->stream_id]);
+                    status.channel_id = m->channel_id;
+                    status.stream_id = m->stream_id;
+                    status.client_id = m->client_id;
+                    status.data_id = m->data_id;
+                    status.data_type = m->data_type;
+                    ok = _client.send(status, _plugin->_logger);
                 }
+                else {
+                    ok = false;
+                }
+                break;
+            }
 
-                case emmgmux::Tags::stream_BW_request: {
-                    emmgmux::StreamBWAllocation response;
-                    ok = _plugin->processBandwidthRequest(msg, response) && _client.send(response, _plugin->_logger);
-                    break;
+            case emmgmux::Tags::stream_test: {
+                emmgmux::StreamTest* m = dynamic_cast<emmgmux::StreamTest*>(msg.pointer());
+                assert(m != nullptr);
+                const auto it = _streams.find(m->stream_id);
+                if (it != _streams.end()) {
+                    // Automatic reply to stream_test
+                    ok = _client.send(it->second, _plugin->_logger);
                 }
+                else {
+                    _report.error(u"unexpected stream_test, stream not setup");
+                    ok = false;
+                }
+                break;
+            }
 
-                case emmgmux::Tags::data_provision: {
-                    ok = _plugin->processDataProvision(msg);
-                    break;
+            case emmgmux::Tags::stream_close_request: {
+                emmgmux::StreamCloseRequest* m = dynamic_cast<emmgmux::StreamCloseRequest*>(msg.pointer());
+                assert(m != nullptr);
+                const auto it = _streams.find(m->stream_id);
+                if (it == _streams.end()) {
+                    _report.error(u"unexpected stream_close_request, stream not setup");
+                    ok = false;
                 }
+                else {
+                    // First, declare the stream as closed.
+                    _plugin->closeStream(it->second.client_id, it->second.data_id);
+                    _streams.erase(it);
+                    // Send the stream_close_response
+                    emmgmux::StreamCloseResponse resp;
+                    resp.channel_id = m->channel_id;
+                    resp.stream_id = m->stream_id;
+                    resp.client_id = m->client_id;
+                    ok = _client.send(resp, _plugin->_logger);
+                }
+                break;
+            }
 
-                default: {
-                    break;
+            case emmgmux::Tags::stream_BW_request: {
+                emmgmux::StreamBWRequest* m = dynamic_cast<emmgmux::StreamBWRequest*>(msg.pointer());
+                assert(m != nullptr);
+                emmgmux::StreamBWAllocation response;
+                const auto it = _streams.find(m->stream_id);
+                if (it == _streams.end()) {
+                    _report.error(u"unexpected stream_BW_request, stream not setup");
+                    ok = false;
                 }
+                else {
+                    ok = _plugin->processBandwidthRequest(it->second, *m, response) && _client.send(response, _plugin->_logger);
+                }
+                break;
             }
-        }
 
-        // Error while receiving messages during a client session, most likely a disconnection
-        _client.disconnect(NULLREP);
-        _client.close(NULLREP);
+            case emmgmux::Tags::data_provision: {
+                ok = _plugin->processDataProvision(msg);
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
     }
 
-    _plugin->tsp->debug(u"TCP server thread completed");
+    // Error while receiving messages during a client session, most likely a disconnection
+    _client.disconnect(NULLREP);
+    _client.close(NULLREP);
+    closeStreams();
+    _completed = true;
 }
 
 
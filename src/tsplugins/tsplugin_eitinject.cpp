@@ -104,6 +104,7 @@ namespace ts {
         MilliSecond   _poll_interval;
         MilliSecond   _min_stable_delay;
         int           _ts_id;
+        size_t        _regen_threads;
         EITRepetitionProfile _eit_profile;
 
         // Working data.
@@ -148,6 +149,7 @@ ts::EITInjectPlugin::EITInjectPlugin(TSP* tsp_) :
     _poll_interval(0),
     _min_stable_delay(0),
     _ts_id(-1),
+    _regen_threads(0),
     _eit_profile(),
     _file_listener(this),
     _eit_gen(duck, PID_EIT),
@@ -254,6 +256,14 @@ ts::EITInjectPlugin::EITInjectPlugin(TSP* tsp_) :
          u"are repeated more frequently than EIT schedule for later events. "
          u"The default is " + UString::Decimal(EITRepetitionProfile::SatelliteCable.prime_days) + u" days.");
 
+    option(u"regeneration-threads", 0, INTEGER, 0, 1, 0, 64);
+    help(u"regeneration-threads",
+         u"Number of worker threads which rebuild the EIT schedule sections after loading events or crossing midnight. "
+         u"With worker threads, the new sections are built in the background while the previous ones continue to be "
+         u"injected, avoiding processing spikes in the packet path. However, the exact packet where the new sections "
+         u"appear is no longer deterministic. "
+         u"By default, there is no worker thread and the EIT schedule are rebuilt synchronously.");
+
     option(u"schedule");
     help(u"schedule",
          u"Generate EIT schedule. If neither --pf nor --schedule are specified, both are generated.");
@@ -305,6 +315,7 @@ bool ts::EITInjectPlugin::getOptions()
     getIntValue(_poll_interval, u"poll-interval", DEFAULT_POLL_INTERVAL);
     getIntValue(_min_stable_delay, u"min-stable-delay", DEFAULT_MIN_STABLE_DELAY);
     getIntValue(_ts_id, u"ts-id", -1);
+    getIntValue(_regen_threads, u"regeneration-threads", 0);
     _delete_files = present(u"delete-files");
     _wait_first_batch = present(u"wait-first-batch");
 
@@ -380,6 +391,7 @@ bool ts::EITInjectPlugin::start()
     _eit_gen.setOptions(_eit_options);
     _eit_gen.setProfile(_eit_profile);
     _eit_gen.setMaxBitRate(_eit_bitrate);
+    _eit_gen.setRegenerationThreads(_regen_threads);
     if (_ts_id >= 0) {
         _eit_gen.setTransportStreamId(uint16_t(_ts_id));
     }
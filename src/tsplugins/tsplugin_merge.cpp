@@ -28,11 +28,13 @@
 //----------------------------------------------------------------------------
 //
 //  Transport stream processor shared library:
-//  Merge TS packets coming from the standard output of a command.
+//  Merge TS packets coming from the standard output of a command
+//  or from an input plugin which is executed inside this plugin.
 //
 //  Definitions:
 //  - Main stream: the TS which is processed by tsp, including this plugin.
-//  - Merged stream: the additional TS which is read by this plugin through a pipe.
+//  - Merged stream: the additional TS which is read by this plugin through
+//    a pipe or directly from the input plugin.
 //
 //----------------------------------------------------------------------------
 
@@ -69,6 +71,7 @@ namespace ts {
     private:
         // Command line options.
         UString        _command;             // Command which generates the main stream.
+        UString        _input_name;          // Name of the input plugin which generates the main stream (with --input).
         TSPacketFormat _format;              // Packet format on the pipe
         size_t         _max_queue;           // Maximum number of queued packets.
         size_t         _accel_threshold;     // Queue threshold after which insertion is accelerated.
@@ -90,6 +93,9 @@ namespace ts {
         // The ForkPipe is dynamically allocated to avoid reusing the same object when the command is restarted.
         typedef SafePtr<TSForkPipe> TSForkPipePtr;
 
+        // The input plugin shares the TSP context of this plugin.
+        typedef SafePtr<InputPlugin> InputPluginPtr;
+
         // Working data.
         bool          _got_eof;            // Got end of merged stream.
         volatile bool _stopping;           // Plugin stop in progress.
@@ -97,6 +103,8 @@ namespace ts {
         PacketCounter _hold_count;         // Number of times we didn't try to merge to perform smoothing insertion.
         PacketCounter _empty_count;        // Number of times we could merge but there was no packet to merge.
         TSForkPipePtr _pipe;               // Executed command.
+        InputPluginPtr _input;             // Input plugin, replaces the command (with --input).
+        TSPacketMetadataVector _input_mdata;  // Metadata of packets from the input plugin, not merged.
         TSPacketQueue _queue;              // TS packet queur from merge to main.
         PIDSet        _main_pids;          // Set of detected PID's in main stream.
         PIDSet        _merge_pids;         // Set of detected PID's in merged stream that we pass in main stream.
@@ -104,9 +112,12 @@ namespace ts {
         PSIMerger     _psi_merger;         // Used to merge PSI/SI from both streams.
         PacketInsertionController _insert_control;  // Used to control insertion points for the merge
 
-        // Start/restart/stop the merge command.
+        // Start/restart/stop the merge command or input plugin.
         bool startStopCommand(bool do_close, bool do_start);
 
+        // Read packets from the merge command or input plugin.
+        bool readPackets(TSPacket* buffer, size_t max_packets, size_t& read_size);
+
         // There is one thread which receives packet from the created process and passes
         // them to the main plugin thread. The following method is the thread main code.
         virtual void main() override;
@@ -124,9 +135,10 @@ TS_REGISTER_PROCESSOR_PLUGIN(u"merge", ts::MergePlugin);
 //----------------------------------------------------------------------------
 
 ts::MergePlugin::MergePlugin(TSP* tsp_) :
-    ProcessorPlugin(tsp_, u"Merge TS packets coming from the standard output of a command", u"[options] 'command'"),
+    ProcessorPlugin(tsp_, u"Merge TS packets coming from the standard output of a command or from an input plugin", u"[options] ['command']"),
     Thread(ThreadAttributes().setStackSize(SERVER_THREAD_STACK_SIZE)),
     _command(),
+    _input_name(),
     _format(TSPacketFormat::AUTODETECT),
     _max_queue(DEFAULT_MAX_QUEUED_PACKETS),
     _accel_threshold(_max_queue / 2),
@@ -150,6 +162,8 @@ ts::MergePlugin::MergePlugin(TSP* tsp_) :
     _hold_count(0),
     _empty_count(0),
     _pipe(),
+    _input(),
+    _input_mdata(),
     _queue(),
     _main_pids(),
     _merge_pids(),
@@ -162,9 +176,10 @@ ts::MergePlugin::MergePlugin(TSP* tsp_) :
 
     DefineTSPacketFormatInputOption(*this, 'f');
 
-    option(u"", 0, STRING, 1, 1);
+    option(u"", 0, STRING, 0, 1);
     help(u"",
-         u"Specifies the command line to execute in the created process.");
+         u"Specifies the command line to execute in the created process. "
+         u"Exactly one of a command or the option --input must be specified.");
 
     option(u"acceleration-threshold", 0, UNSIGNED);
     help(u"acceleration-threshold",
@@ -204,6 +219,13 @@ ts::MergePlugin::MergePlugin(TSP* tsp_) :
          u"bitrate (CBR) streams. The incremental method gives better results on "
          u"variable bitrate (VBR) streams. See also option --no-pcr-restamp.");
 
+    option(u"input", 0, STRING);
+    help(u"input", u"'name [options]'",
+         u"Merge the output of the specified input plugin, with its options, instead of a command. "
+         u"The input plugin is executed in a thread of this plugin, without intermediate process and pipe. "
+         u"Example: --input 'ip 230.2.2.2:1234'. "
+         u"The options --format and --no-wait apply to a command only.");
+
     option(u"joint-termination", 'j');
     help(u"joint-termination",
         u"Perform a \"joint termination\" when the merged stream is terminated. "
@@ -304,6 +326,7 @@ ts::MergePlugin::MergePlugin(TSP* tsp_) :
 bool ts::MergePlugin::getOptions()
 {
     getValue(_command);
+    const UString input(value(u"input"));
     _no_wait = present(u"no-wait");
     const bool transparent = present(u"transparent");
     getIntValue(_max_queue, u"max-queue", DEFAULT_MAX_QUEUED_PACKETS);
@@ -328,6 +351,38 @@ bool ts::MergePlugin::getOptions()
         return false;
     }
 
+    // Create the input plugin instance, if any.
+    _input.clear();
+    _input_name.clear();
+    if (_command.empty() == input.empty()) {
+        tsp->error(u"specify exactly one of a command or --input");
+        return false;
+    }
+    if (!input.empty()) {
+        UStringVector args;
+        input.splitShellStyle(args);
+        if (args.empty()) {
+            tsp->error(u"invalid input plugin specification '%s'", {input});
+            return false;
+        }
+        _input_name = args.front();
+        args.erase(args.begin());
+        PluginRepository::InputPluginFactory allocator = PluginRepository::Instance()->getInput(_input_name, *tsp);
+        if (allocator == nullptr) {
+            // Error message already displayed.
+            return false;
+        }
+        _input = allocator(tsp);
+        CheckNonNull(_input.pointer());
+
+        // Syntax errors in plugin options are reported through tsp and do not invalidate the plugin object, check both.
+        _input->setShell(getShell());
+        _input->setMaxSeverity(tsp->maxSeverity());
+        if (!_input->analyze(_input_name, args, false) || tsp->gotErrors() || !_input->getOptions()) {
+            return false;
+        }
+    }
+
     // Compute list of allowed PID's from the merged stream. Start with all PID's allowed.
     _allowed_pids.set();
 
@@ -369,8 +424,14 @@ bool ts::MergePlugin::startStopCommand(bool do_close, bool do_restart)
     // ensure that all calls are valid.
 
     if (do_close) {
-        tsp->debug(u"closing merge process pipe");
-        _pipe->close(*tsp);
+        if (_input.isNull()) {
+            tsp->debug(u"closing merge process pipe");
+            _pipe->close(*tsp);
+        }
+        else {
+            tsp->debug(u"stopping merge input plugin %s", {_input_name});
+            _input->stop();
+        }
     }
 
     if (_stopping || !do_restart) {
@@ -384,7 +445,12 @@ bool ts::MergePlugin::startStopCommand(bool do_close, bool do_restart)
         SleepThread(_restart_interval);
         // Because of the previous failure, we probably had error messages.
         // Inform the user that we restart and the error is not permanent.
-        tsp->info(u"restarting merge command");
+        tsp->info(u"restarting merge %s", {_input.isNull() ? u"command" : _input_name});
+    }
+
+    // With an input plugin, simply restart it.
+    if (!_input.isNull()) {
+        return _input->start();
     }
 
     // Allocate the new object. Atomically swap the safe pointer. This action
@@ -416,6 +482,7 @@ bool ts::MergePlugin::start()
 {
     // Resize the inter-thread packet queue.
     _queue.reset(_max_queue);
+    _input_mdata.resize(_input.isNull() ? 0 : _max_queue);
 
     // Configure the PSI merger.
     if (_merge_psi) {
@@ -464,10 +531,17 @@ bool ts::MergePlugin::stop()
 
     // Close the pipe and terminate the created process.
     _stopping = true;
-    startStopCommand(true, false);
-
-    // Wait for actual thread termination.
-    Thread::waitForTermination();
+    if (_input.isNull()) {
+        startStopCommand(true, false);
+        // Wait for actual thread termination.
+        Thread::waitForTermination();
+    }
+    else {
+        // The input plugin can be stopped only when the receiver thread no longer uses it.
+        _input->abortInput();
+        Thread::waitForTermination();
+        startStopCommand(true, false);
+    }
     return true;
 }
 
@@ -506,12 +580,8 @@ void ts::MergePlugin::main()
         // Read TS packets from the pipe, up to buffer size (but maybe less).
         // Loop on error / restart.
         while (success && read_size == 0) {
-            // Perform one read. Multi-threading warning: a close operation can occur
-            // in the meantime (when the plugin stops) but no one will restart it.
-            // So, the object which is pointed to by _pipe does not change.
-
-            // We request to read only multiples of 188 bytes (the packet size).
-            success = _pipe->readStreamChunks(buffer, PKT_SIZE * buffer_size, PKT_SIZE, read_size, *tsp);
+            // Perform one read.
+            success = readPackets(buffer, buffer_size, read_size);
 
             if (!success) {
                 // Read error or end of file.
@@ -535,6 +605,40 @@ void ts::MergePlugin::main()
 }
 
 
+//----------------------------------------------------------------------------
+// Read packets from the merge command or input plugin.
+//----------------------------------------------------------------------------
+
+bool ts::MergePlugin::readPackets(TSPacket* buffer, size_t max_packets, size_t& read_size)
+{
+    if (_input.isNull()) {
+        // Multi-threading warning: a close operation can occur in the meantime (when
+        // the plugin stops) but no one will restart it. So, the object which is pointed
+        // to by _pipe does not change. We request to read only multiples of 188 bytes
+        // (the packet size).
+        return _pipe->readStreamChunks(buffer, PKT_SIZE * max_packets, PKT_SIZE, read_size, *tsp);
+    }
+    else {
+        // Receive packets directly in the queue buffer. The metadata are not merged.
+        max_packets = std::min(max_packets, _input_mdata.size());
+        for (size_t n = 0; n < max_packets; ++n) {
+            _input_mdata[n].reset();
+        }
+        const size_t count = _input->receive(buffer, _input_mdata.data(), max_packets);
+        read_size = count * PKT_SIZE;
+
+        // Without --bitrate, use the input plugin bitrate, when known, instead of PCR's.
+        if (count > 0 && _user_bitrate == 0) {
+            const BitRate bitrate = _input->getBitrate();
+            if (bitrate > 0) {
+                _queue.setBitrate(bitrate);
+            }
+        }
+        return count > 0;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
@@ -46,7 +46,7 @@
 //----------------------------------------------------------------------------
 
 namespace ts {
-    class NITPlugin: public AbstractTablePlugin
+    class NITPlugin: public AbstractTablePlugin, private BinaryTablePatcher::Handler
     {
         TS_NOBUILD_NOCOPY(NITPlugin);
     public:
@@ -115,6 +115,10 @@ namespace ts {
 
         // Update the service list descriptors from collected services.
         void updateServiceList(NIT&);
+
+        // Implementation of BinaryTablePatcher::Handler, for in-place patching.
+        virtual bool keepEntry(const BinaryTablePatcher::Location& loc) override;
+        virtual void patchDescriptorList(DescriptorList& dlist, const BinaryTablePatcher::Location& loc) override;
     };
 }
 
@@ -477,7 +481,16 @@ void ts::NITPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
         return;
     }
 
-    // Process the NIT.
+    // Try to patch the NIT sections in place first. This is not possible when service list
+    // descriptors are built since we need to keep track of the last complete NIT.
+    if (!_build_sld && patchTable(table, *this)) {
+        if (_set_netw_id) {
+            table.setTableIdExtension(_new_netw_id);
+        }
+        return;
+    }
+
+    // Full deserialization of the NIT when in-place patching is not possible.
     NIT nit(duck, table);
     if (!nit.isValid()) {
         tsp->warning(u"found invalid NIT");
@@ -533,6 +546,29 @@ void ts::NITPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
 }
 
 
+//----------------------------------------------------------------------------
+// Implementation of BinaryTablePatcher::Handler, for in-place patching.
+//----------------------------------------------------------------------------
+
+bool ts::NITPlugin::keepEntry(const BinaryTablePatcher::Location& loc)
+{
+    // Remove the specified transport streams.
+    return _remove_ts.count(loc.entry_id) == 0;
+}
+
+void ts::NITPlugin::patchDescriptorList(DescriptorList& dlist, const BinaryTablePatcher::Location& loc)
+{
+    // Update the network name in the global descriptor list.
+    if (loc.global && !_new_netw_name.empty()) {
+        dlist.removeByTag(DID_NETWORK_NAME);
+        dlist.add(duck, NetworkNameDescriptor(_new_netw_name));
+    }
+
+    // Same processing on global and transport stream descriptor lists.
+    processDescriptorList(dlist);
+}
+
+
 //----------------------------------------------------------------------------
 //  This method processes a NIT descriptor list
 //----------------------------------------------------------------------------
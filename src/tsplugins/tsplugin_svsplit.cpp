@@ -0,0 +1,643 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//----------------------------------------------------------------------------
+//
+//  Transport stream processor shared library:
+//  Split a multi-program transport stream in several single-program ones.
+//
+//----------------------------------------------------------------------------
+
+#include "tsPluginRepository.h"
+#include "tsSignalizationDemux.h"
+#include "tsCyclingPacketizer.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+
+
+//----------------------------------------------------------------------------
+// Plugin definition
+//----------------------------------------------------------------------------
+
+namespace ts {
+    class SVSplitPlugin: public OutputPlugin, private SignalizationHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(SVSplitPlugin);
+    public:
+        // Implementation of plugin API
+        SVSplitPlugin(TSP*);
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual bool isRealTime() override;
+        virtual bool send(const TSPacket*, const TSPacketMetadata*, size_t) override;
+
+        // The output plugins of all services run in the thread of this plugin.
+        virtual size_t stackUsage() const override {return 512 * 1024;} // 512 kB
+
+    private:
+        // Maximum number of services. Each PID has a bitmap of the services where it is routed.
+        static constexpr size_t MAX_SERVICES = 64;
+        typedef std::bitset<MAX_SERVICES> ServiceSet;
+
+        // Number of packets in the output buffer of a service.
+        static constexpr size_t BUFFER_PACKETS = 512;
+
+        // Each service to extract is described by one structure.
+        class ServiceContext
+        {
+            TS_NOBUILD_NOCOPY(ServiceContext);
+        public:
+            // Command line options:
+            const UString          service_spec;  // Service name or id.
+            const UString          output_name;   // Name of output plugin.
+            OutputPlugin*          output;        // Output plugin instance.
+
+            // Working data:
+            bool                   started;       // The output plugin was successfully started.
+            bool                   id_known;      // Service id is known.
+            uint16_t               service_id;    // Service id.
+            PID                    pmt_pid;       // PID for the PMT (PID_NULL if unknown).
+            uint8_t                pat_version;   // Version of the generated PAT.
+            uint8_t                sdt_version;   // Version of the generated SDT.
+            PIDSet                 pids;          // Component PID's routed to this service.
+            CyclingPacketizer      pzer_pat;      // Packetizer for the PAT of the SPTS.
+            CyclingPacketizer      pzer_pmt;      // Packetizer for the PMT of the SPTS.
+            CyclingPacketizer      pzer_sdt;      // Packetizer for the SDT of the SPTS.
+            TSPacketVector         packets;       // Output buffer.
+            TSPacketMetadataVector mdata;         // Metadata of packets in output buffer.
+            size_t                 count;         // Number of packets in output buffer.
+
+            // Constructor and destructor.
+            ServiceContext(DuckContext& duck, const UString& spec, const UString& name, OutputPlugin* plugin);
+            ~ServiceContext();
+
+            // Add a packet in the output buffer.
+            void addPacket(const TSPacket& pkt, const TSPacketMetadata& mdata);
+        };
+        typedef SafePtr<ServiceContext> ServiceContextPtr;
+        typedef std::vector<ServiceContextPtr> ServiceContextVector;
+
+        // Plugin private data.
+        ServiceContextVector _services;                // Description of services.
+        SignalizationDemux   _demux;                   // Signalization demux.
+        uint16_t             _ts_id;                   // Transport stream id from the PAT.
+        SDT                  _last_sdt;                // Last received SDT Actual.
+        ServiceSet           _pid_outputs[PID_MAX];    // Services where each PID is passed unmodified.
+        ServiceSet           _pmt_outputs[PID_MAX];    // Services where each PID is the PMT PID.
+        ServiceSet           _all_outputs;             // All services.
+
+        // Implementation of SignalizationHandlerInterface.
+        virtual void handleSDT(const SDT& sdt, PID pid) override;
+        virtual void handleService(uint16_t ts_id, const Service& service, const PMT& pmt, bool removed) override;
+
+        // Rebuild the PAT or SDT of a service.
+        void rebuildPAT(size_t index);
+        void rebuildSDT(size_t index);
+
+        // Set the PMT PID of a service.
+        void setPMTPID(size_t index, PID pmt_pid);
+
+        // Set the components of a service from its PMT.
+        void setComponents(size_t index, const PMT& pmt);
+
+        // Forget the service, when it disappears from the transport stream.
+        void forgetService(size_t index);
+
+        // Add the PID's of all CA descriptors (ECM PID's in a PMT).
+        static void AddCAPIDs(PIDSet& pids, const DescriptorList& descs);
+
+        // Add a packet to all services in a set.
+        void addPacket(const ServiceSet& outputs, const TSPacket& pkt, const TSPacketMetadata& mdata);
+
+        // Add the next packet of a packetizer to all services in a set.
+        void addPacket(const ServiceSet& outputs, CyclingPacketizer ServiceContext::* pzer, const TSPacketMetadata& mdata);
+
+        // Send the buffered packets of all services.
+        bool flush();
+
+        // Stop all started output plugins.
+        bool stopOutputs();
+    };
+}
+
+TS_REGISTER_OUTPUT_PLUGIN(u"svsplit", ts::SVSplitPlugin);
+
+// Static constants.
+constexpr size_t ts::SVSplitPlugin::MAX_SERVICES;
+constexpr size_t ts::SVSplitPlugin::BUFFER_PACKETS;
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::SVSplitPlugin::SVSplitPlugin(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Split services into single program transport streams, each with its own output", u"[options]"),
+    _services(),
+    _demux(duck),
+    _ts_id(0),
+    _last_sdt(),
+    _pid_outputs(),
+    _pmt_outputs(),
+    _all_outputs()
+{
+    // We need to define character sets to specify service names.
+    duck.defineArgsForCharset(*this);
+
+    option(u"service", 's', STRING, 1, MAX_SERVICES);
+    help(u"service", u"'name-or-id=output-plugin [options]'",
+         u"Specifies a service to extract and the output plugin which receives it, with its options. "
+         u"If the service specification before the '=' is an integer value (either decimal or hexadecimal), "
+         u"it is interpreted as a service id. Otherwise, it is interpreted as a service name, as specified "
+         u"in the SDT. Names are not case sensitive and blanks are ignored. "
+         u"Example: --service '0x0201=ip 230.2.3.4:1234'.\n\n"
+         u"Each output receives a single program transport stream with the PAT, PMT, SDT and all components "
+         u"of the service. The input transport stream is read and demuxed only once for all services. "
+         u"Several --service options can be specified, up to 64.");
+}
+
+
+//----------------------------------------------------------------------------
+// Service context constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::SVSplitPlugin::ServiceContext::ServiceContext(DuckContext& duck, const UString& spec, const UString& name, OutputPlugin* plugin) :
+    service_spec(spec),
+    output_name(name),
+    output(plugin),
+    started(false),
+    id_known(false),
+    service_id(0),
+    pmt_pid(PID_NULL),
+    pat_version(0),
+    sdt_version(0),
+    pids(),
+    pzer_pat(duck, PID_PAT, CyclingPacketizer::StuffingPolicy::ALWAYS),
+    pzer_pmt(duck, PID_NULL, CyclingPacketizer::StuffingPolicy::ALWAYS),
+    pzer_sdt(duck, PID_SDT, CyclingPacketizer::StuffingPolicy::ALWAYS),
+    packets(BUFFER_PACKETS),
+    mdata(BUFFER_PACKETS),
+    count(0)
+{
+}
+
+ts::SVSplitPlugin::ServiceContext::~ServiceContext()
+{
+    if (output != nullptr) {
+        delete output;
+        output = nullptr;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get command line options
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::getOptions()
+{
+    duck.loadArgs(*this);
+
+    _services.clear();
+    for (size_t i = 0; i < count(u"service"); ++i) {
+
+        // Split the option value as "service=plugin [options]".
+        const UString opt(value(u"service", u"", i));
+        const size_t eq = opt.find(u'=');
+        UString spec(eq == NPOS ? UString() : opt.substr(0, eq));
+        UStringVector args;
+        spec.trim();
+        if (eq != NPOS) {
+            opt.substr(eq + 1).splitShellStyle(args);
+        }
+        if (spec.empty() || args.empty()) {
+            tsp->error(u"invalid service specification '%s', use 'name-or-id=output-plugin [options]'", {opt});
+            return false;
+        }
+        const UString name(args.front());
+        args.erase(args.begin());
+
+        // Create the output plugin instance. It shares the TSP context of this plugin.
+        PluginRepository::OutputPluginFactory allocator = PluginRepository::Instance()->getOutput(name, *tsp);
+        if (allocator == nullptr) {
+            // Error message already displayed.
+            return false;
+        }
+        ServiceContextPtr ctx(new ServiceContext(duck, spec, name, allocator(tsp)));
+        _services.push_back(ctx);
+
+        // Analyze the options of the output plugin. Syntax errors in plugin options are
+        // reported through tsp and do not invalidate the plugin object, check both.
+        ctx->output->setShell(getShell());
+        ctx->output->setMaxSeverity(tsp->maxSeverity());
+        if (!ctx->output->analyze(name, args, false) || tsp->gotErrors() || !ctx->output->getOptions()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Start method
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::start()
+{
+    // Reset the routing of PID's.
+    _ts_id = 0;
+    _last_sdt.invalidate();
+    _all_outputs.reset();
+    for (size_t pid = 0; pid < PID_MAX; ++pid) {
+        _pid_outputs[pid].reset();
+        _pmt_outputs[pid].reset();
+    }
+
+    // Start all output plugins and reset the service contexts.
+    for (size_t i = 0; i < _services.size(); ++i) {
+        ServiceContext& ctx(*_services[i]);
+        ctx.id_known = false;
+        ctx.service_id = 0;
+        ctx.pmt_pid = PID_NULL;
+        ctx.pids.reset();
+        ctx.pzer_pat.reset();
+        ctx.pzer_pmt.reset();
+        ctx.pzer_sdt.reset();
+        ctx.count = 0;
+        ctx.started = ctx.output->start();
+        if (!ctx.started) {
+            stopOutputs();
+            return false;
+        }
+        _all_outputs.set(i);
+    }
+
+    // The time reference is passed to all services.
+    _pid_outputs[PID_TDT] = _all_outputs;
+
+    // Filter PAT, SDT and the PMT of all services.
+    _demux.reset();
+    _demux.setHandler(this);
+    _demux.addFilteredTableIds({TID_PAT, TID_SDT_ACT});
+    for (size_t i = 0; i < _services.size(); ++i) {
+        _demux.addFilteredService(_services[i]->service_spec);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Stop method
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::stop()
+{
+    return stopOutputs();
+}
+
+bool ts::SVSplitPlugin::stopOutputs()
+{
+    bool ok = true;
+    for (size_t i = 0; i < _services.size(); ++i) {
+        ServiceContext& ctx(*_services[i]);
+        if (ctx.started) {
+            ok = ctx.output->stop() && ok;
+            ctx.started = false;
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// The plugin is real time when at least one output is real time.
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::isRealTime()
+{
+    bool rt = false;
+    for (size_t i = 0; !rt && i < _services.size(); ++i) {
+        rt = _services[i]->output->isRealTime();
+    }
+    return rt;
+}
+
+
+//----------------------------------------------------------------------------
+// Invoked by the demux when an SDT Actual is received.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::handleSDT(const SDT& sdt, PID)
+{
+    _last_sdt = sdt;
+    for (size_t i = 0; i < _services.size(); ++i) {
+        rebuildSDT(i);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Invoked by the demux when a service is new, modified or removed.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::handleService(uint16_t ts_id, const Service& service, const PMT& pmt, bool removed)
+{
+    // The transport stream id is copied in the PAT of all services.
+    if (ts_id != 0xFFFF && ts_id != _ts_id) {
+        _ts_id = ts_id;
+        for (size_t i = 0; i < _services.size(); ++i) {
+            rebuildPAT(i);
+        }
+    }
+
+    for (size_t i = 0; i < _services.size(); ++i) {
+        ServiceContext& ctx(*_services[i]);
+        if (removed) {
+            if (ctx.id_known && ctx.service_id == service.getId()) {
+                tsp->verbose(u"service %s (0x%X) removed from the transport stream", {ctx.service_spec, ctx.service_id});
+                forgetService(i);
+            }
+        }
+        else if (service.match(ctx.service_spec)) {
+            if (!ctx.id_known || ctx.service_id != service.getId()) {
+                tsp->verbose(u"found service %s, service id 0x%X (%<d), output to %s", {ctx.service_spec, service.getId(), ctx.output_name});
+                forgetService(i);
+                ctx.id_known = true;
+                ctx.service_id = service.getId();
+                rebuildSDT(i);
+            }
+            if (service.hasPMTPID()) {
+                setPMTPID(i, service.getPMTPID());
+            }
+            if (pmt.isValid() && pmt.service_id == ctx.service_id) {
+                setComponents(i, pmt);
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Rebuild the PAT of a service: contains this service only, no NIT.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::rebuildPAT(size_t index)
+{
+    ServiceContext& ctx(*_services[index]);
+    ctx.pzer_pat.removeAll();
+    if (ctx.id_known && ctx.pmt_pid != PID_NULL) {
+        ctx.pat_version = (ctx.pat_version + 1) & SVERSION_MASK;
+        PAT pat(ctx.pat_version, true, _ts_id, PID_NULL);
+        pat.pmts[ctx.service_id] = ctx.pmt_pid;
+        ctx.pzer_pat.addTable(duck, pat);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Rebuild the SDT of a service: contains this service only.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::rebuildSDT(size_t index)
+{
+    ServiceContext& ctx(*_services[index]);
+    ctx.pzer_sdt.removeAll();
+    if (ctx.id_known && _last_sdt.isValid() && _last_sdt.services.find(ctx.service_id) != _last_sdt.services.end()) {
+        SDT sdt(_last_sdt);
+        for (auto it = sdt.services.begin(); it != sdt.services.end(); ) {
+            if (it->first == ctx.service_id) {
+                ++it;
+            }
+            else {
+                it = sdt.services.erase(it);
+            }
+        }
+        ctx.sdt_version = (ctx.sdt_version + 1) & SVERSION_MASK;
+        sdt.version = ctx.sdt_version;
+        ctx.pzer_sdt.addTable(duck, sdt);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Set the PMT PID of a service.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::setPMTPID(size_t index, PID pmt_pid)
+{
+    ServiceContext& ctx(*_services[index]);
+    if (pmt_pid != ctx.pmt_pid) {
+        if (ctx.pmt_pid != PID_NULL) {
+            _pmt_outputs[ctx.pmt_pid].reset(index);
+        }
+        ctx.pmt_pid = pmt_pid;
+        _pmt_outputs[pmt_pid].set(index);
+        ctx.pzer_pmt.removeAll();
+        ctx.pzer_pmt.setPID(pmt_pid);
+        rebuildPAT(index);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Set the components of a service from its PMT.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::setComponents(size_t index, const PMT& pmt)
+{
+    ServiceContext& ctx(*_services[index]);
+
+    // Build the new set of PID's: components, PCR, ECM's at service and component level.
+    PIDSet pids;
+    if (pmt.pcr_pid != PID_NULL) {
+        pids.set(pmt.pcr_pid);
+    }
+    for (auto it = pmt.streams.begin(); it != pmt.streams.end(); ++it) {
+        pids.set(it->first);
+        AddCAPIDs(pids, it->second.descs);
+    }
+    AddCAPIDs(pids, pmt.descs);
+
+    // Update the routing of PID's which changed.
+    const PIDSet changed(pids ^ ctx.pids);
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        if (changed.test(pid)) {
+            _pid_outputs[pid].set(index, pids.test(pid));
+        }
+    }
+    ctx.pids = pids;
+
+    // The PMT is sent unmodified in the SPTS.
+    ctx.pzer_pmt.removeAll();
+    ctx.pzer_pmt.addTable(duck, pmt);
+}
+
+
+//----------------------------------------------------------------------------
+// Add the PID's of all CA descriptors (MPEG and ISDB).
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::AddCAPIDs(PIDSet& pids, const DescriptorList& descs)
+{
+    for (size_t index = 0; index < descs.size(); ++index) {
+        // The fixed part of a CA descriptor is 4 bytes long.
+        if ((descs[index]->tag() == DID_CA || descs[index]->tag() == DID_ISDB_CA) && descs[index]->payloadSize() >= 4) {
+            pids.set(GetUInt16(descs[index]->payload() + 2) & 0x1FFF);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Forget a service, when it disappears from the transport stream.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::forgetService(size_t index)
+{
+    ServiceContext& ctx(*_services[index]);
+    for (PID pid = 0; pid < PID_MAX; ++pid) {
+        if (ctx.pids.test(pid)) {
+            _pid_outputs[pid].reset(index);
+        }
+    }
+    if (ctx.pmt_pid != PID_NULL) {
+        _pmt_outputs[ctx.pmt_pid].reset(index);
+    }
+    ctx.id_known = false;
+    ctx.pmt_pid = PID_NULL;
+    ctx.pids.reset();
+    ctx.pzer_pat.removeAll();
+    ctx.pzer_pmt.removeAll();
+    ctx.pzer_sdt.removeAll();
+}
+
+
+//----------------------------------------------------------------------------
+// Add packets in the output buffers of services.
+//----------------------------------------------------------------------------
+
+void ts::SVSplitPlugin::ServiceContext::addPacket(const TSPacket& pkt, const TSPacketMetadata& md)
+{
+    // Flushing is done by the caller before the buffer is full. But, in the unusual
+    // case where the same PID is both the PMT PID and a component of the service,
+    // one input packet produces two output packets. Enlarge the buffer if necessary.
+    if (count >= packets.size()) {
+        packets.resize(count + BUFFER_PACKETS);
+        mdata.resize(count + BUFFER_PACKETS);
+    }
+    packets[count] = pkt;
+    mdata[count] = md;
+    count++;
+}
+
+void ts::SVSplitPlugin::addPacket(const ServiceSet& outputs, const TSPacket& pkt, const TSPacketMetadata& mdata)
+{
+    for (size_t i = 0; i < _services.size(); ++i) {
+        if (outputs.test(i)) {
+            _services[i]->addPacket(pkt, mdata);
+        }
+    }
+}
+
+void ts::SVSplitPlugin::addPacket(const ServiceSet& outputs, CyclingPacketizer ServiceContext::* pzer, const TSPacketMetadata& mdata)
+{
+    TSPacket pkt;
+    for (size_t i = 0; i < _services.size(); ++i) {
+        if (outputs.test(i) && ((*_services[i]).*pzer).getNextPacket(pkt)) {
+            _services[i]->addPacket(pkt, mdata);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send the buffered packets of all services.
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::flush()
+{
+    bool ok = true;
+    for (size_t i = 0; i < _services.size(); ++i) {
+        ServiceContext& ctx(*_services[i]);
+        if (ctx.count > 0) {
+            ok = ctx.output->send(&ctx.packets[0], &ctx.mdata[0], ctx.count) && ok;
+            ctx.count = 0;
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Output method
+//----------------------------------------------------------------------------
+
+bool ts::SVSplitPlugin::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
+{
+    // Each input packet produces at most one output packet per service.
+    // The output buffers are flushed before any of them may overflow.
+    size_t room = BUFFER_PACKETS;
+
+    for (size_t i = 0; i < packet_count; ++i) {
+
+        if (room == 0) {
+            if (!flush()) {
+                return false;
+            }
+            room = BUFFER_PACKETS;
+        }
+
+        // Analyze the signalization first, the routing of the packet may change.
+        _demux.feedPacket(buffer[i]);
+
+        const PID pid = buffer[i].getPID();
+        if (pid == PID_PAT) {
+            // Each PAT packet is replaced by a packet of the PAT of each service.
+            addPacket(_all_outputs, &ServiceContext::pzer_pat, pkt_data[i]);
+        }
+        else if (pid == PID_SDT) {
+            // Same for SDT. Other tables in the PID (BAT, SDT Other) are dropped.
+            addPacket(_all_outputs, &ServiceContext::pzer_sdt, pkt_data[i]);
+        }
+        else {
+            // A PMT PID may be shared by several services.
+            if (_pmt_outputs[pid].any()) {
+                addPacket(_pmt_outputs[pid], &ServiceContext::pzer_pmt, pkt_data[i]);
+            }
+            // Other PID's are passed unmodified to the services where they are used.
+            if (_pid_outputs[pid].any()) {
+                addPacket(_pid_outputs[pid], buffer[i], pkt_data[i]);
+            }
+        }
+        room--;
+    }
+    return flush();
+}
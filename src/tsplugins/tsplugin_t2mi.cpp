@@ -37,6 +37,8 @@
 #include "tsT2MIDescriptor.h"
 #include "tsT2MIPacket.h"
 #include "tsTSFile.h"
+#include "tsUDPSocket.h"
+#include "tsFileUtils.h"
 #include "tsNames.h"
 
 
@@ -63,6 +65,23 @@ namespace ts {
         // Set of identified T2-MI PID's with their PLP's (with --identify).
         typedef std::map<PID, PLPSet> IdentifiedSet;
 
+        // Output of one PLP in one PID (with --plp-output or --plp-udp).
+        class PLPOutput
+        {
+            TS_NOCOPY(PLPOutput);
+        public:
+            PLPOutput();
+            PacketCounter     t2mi_count;   // Number of T2-MI packets in this PLP.
+            PacketCounter     ts_count;     // Number of extracted TS packets.
+            UString           name;         // Output file name or UDP destination.
+            TSFile            file;         // Output file (with --plp-output).
+            IPv4SocketAddress destination;  // UDP destination (with --plp-udp).
+        };
+        typedef SafePtr<PLPOutput> PLPOutputPtr;
+
+        // Map of PLP outputs, indexed by PID (13 bits) and PLP (8 bits): (pid << 8) | plp.
+        typedef std::map<uint32_t, PLPOutputPtr> PLPOutputMap;
+
         // Plugin private fields.
         bool              _abort;           // Error, abort asap.
         bool              _extract;         // Extract encapsulated TS.
@@ -81,11 +100,23 @@ namespace ts {
         T2MIDemux         _demux;           // T2-MI demux.
         IdentifiedSet     _identified;      // Map of identified PID's and PLP's.
         std::deque<TSPacket> _ts_queue;     // Queue of demuxed TS packets.
+        bool              _all_plps;        // Extract all PLP's of all PID's (--plp-output, --plp-udp).
+        UString           _plp_template;    // Output file name template for all PLP's.
+        UString           _plp_udp;         // Base UDP destination for all PLP's.
+        int               _udp_ttl;         // TTL of UDP datagrams.
+        IPv4SocketAddress _udp_base;        // Base UDP destination, the port is incremented.
+        UDPSocket         _udp_sock;        // Output UDP socket.
+        std::map<PID,size_t> _pid_index;    // Index of each T2-MI PID, in order of discovery.
+        PLPOutputMap      _plp_outputs;     // All PLP outputs.
+
+        // Get or create the output of a PLP, null on error.
+        PLPOutput* getPLPOutput(PID pid, uint8_t plp);
 
         // Inherited methods.
         virtual void handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid, const T2MIDescriptor& desc) override;
         virtual void handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt) override;
         virtual void handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts) override;
+        virtual void handleTSPackets(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket* ts, size_t count) override;
     };
 }
 
@@ -115,7 +146,15 @@ ts::T2MIPlugin::T2MIPlugin(TSP* tsp_) :
     _ts_count(0),
     _demux(duck, this),
     _identified(),
-    _ts_queue()
+    _ts_queue(),
+    _all_plps(false),
+    _plp_template(),
+    _plp_udp(),
+    _udp_ttl(0),
+    _udp_base(),
+    _udp_sock(),
+    _pid_index(),
+    _plp_outputs()
 {
     option(u"append", 'a');
     help(u"append",
@@ -143,6 +182,13 @@ ts::T2MIPlugin::T2MIPlugin(TSP* tsp_) :
     option(u"log", 'l');
     help(u"log", u"Log all T2-MI packets using one single summary line per packet.");
 
+    option(u"ttl", 0, INTEGER, 0, 1, 1, 255);
+    help(u"ttl",
+         u"With --plp-udp, specify the TTL (Time-To-Live) socket option. "
+         u"The actual option is either \"Unicast TTL\" or \"Multicast TTL\", "
+         u"depending on the destination address. Remember that the default "
+         u"Multicast TTL is 1 on most systems.");
+
     option(u"output-file", 'o', FILENAME);
     help(u"output-file", u"filename",
          u"Specify that the extracted stream is saved in this file. In that case, "
@@ -153,6 +199,23 @@ ts::T2MIPlugin::T2MIPlugin(TSP* tsp_) :
          u"Specify the PID carrying the T2-MI encapsulation. By default, use the "
          u"first component with a T2MI_descriptor in a service.");
 
+    option(u"plp-output", 0, FILENAME);
+    help(u"plp-output", u"'file-name-template'",
+         u"Extract all PLP's of all T2-MI PID's in one pass, each one in a separate file. "
+         u"In the file name template, the sequences {pid} and {plp} are replaced by the PID "
+         u"and PLP values in decimal. If {plp} is not present, '-pid-plp' is added before the file "
+         u"name extension. The main transport stream is passed unchanged to the next plugin. "
+         u"With --pid, only extract the PLP's of this PID. "
+         u"The options --append and --keep apply to all files.");
+
+    option(u"plp-udp", 0, STRING);
+    help(u"plp-udp", u"address:port",
+         u"Extract all PLP's of all T2-MI PID's in one pass, each one sent in UDP datagrams to a "
+         u"separate port. The PLP 'n' of the first T2-MI PID is sent to the specified port + n. "
+         u"The PLP's of the next T2-MI PID's, if any, are sent to port + 256 + n, port + 512 + n, etc. "
+         u"The main transport stream is passed unchanged to the next plugin. "
+         u"With --pid, only extract the PLP's of this PID.");
+
     option(u"plp", 0, UINT8);
     help(u"plp",
          u"Specify the PLP (Physical Layer Pipe) to extract from the T2-MI "
@@ -175,6 +238,19 @@ bool ts::T2MIPlugin::getOptions()
     getIntValue(_original_pid, u"pid", PID_NULL);
     getIntValue(_plp, u"plp");
     getValue(_outfile_name, u"output-file");
+    getValue(_plp_template, u"plp-output");
+    getValue(_plp_udp, u"plp-udp");
+    getIntValue(_udp_ttl, u"ttl", 0);
+    _all_plps = !_plp_template.empty() || !_plp_udp.empty();
+
+    if (_all_plps && (_extract || _plp_valid || !_outfile_name.empty())) {
+        tsp->error(u"--plp-output and --plp-udp extract all PLP's, they cannot be used with --extract, --plp, --output-file");
+        return false;
+    }
+    if (!_plp_template.empty() && !_plp_udp.empty()) {
+        tsp->error(u"--plp-output and --plp-udp are mutually exclusive");
+        return false;
+    }
 
     // Output file open flags.
     _outfile_flags = TSFile::WRITE | TSFile::SHARED;
@@ -187,7 +263,7 @@ bool ts::T2MIPlugin::getOptions()
 
     // Extract is the default operation.
     // It is also implicit if an output file is specified.
-    if ((!_extract && !_log && !_identify) || !_outfile_name.empty()) {
+    if ((!_extract && !_log && !_identify && !_all_plps) || !_outfile_name.empty()) {
         _extract = true;
     }
 
@@ -216,6 +292,26 @@ bool ts::T2MIPlugin::start()
     _t2mi_count = 0;
     _ts_count = 0;
     _abort = false;
+    _pid_index.clear();
+    _plp_outputs.clear();
+
+    // Open the UDP socket for all PLP's.
+    if (!_plp_udp.empty()) {
+        if (!_udp_base.resolve(_plp_udp, *tsp)) {
+            return false;
+        }
+        if (!_udp_base.hasAddress() || !_udp_base.hasPort()) {
+            tsp->error(u"missing address or port in --plp-udp %s", {_plp_udp});
+            return false;
+        }
+        if (!_udp_sock.open(*tsp)) {
+            return false;
+        }
+        if (_udp_ttl > 0 && !_udp_sock.setTTL(_udp_ttl, _udp_base.isMulticast(), *tsp)) {
+            _udp_sock.close(*tsp);
+            return false;
+        }
+    }
 
     // Open output file if present.
     return _outfile_name.empty() || _outfile.open(_outfile_name, _outfile_flags , *tsp);
@@ -238,6 +334,23 @@ bool ts::T2MIPlugin::stop()
         tsp->verbose(u"extracted %'d TS packets from %'d T2-MI packets", {_ts_count, _t2mi_count});
     }
 
+    // With --plp-output or --plp-udp, close all outputs and display per-PLP statistics.
+    if (_all_plps) {
+        for (const auto& it : _plp_outputs) {
+            const PID pid = PID(it.first >> 8);
+            const uint8_t plp = uint8_t(it.first);
+            PLPOutput& out(*it.second);
+            if (out.file.isOpen()) {
+                out.file.close(*tsp);
+            }
+            tsp->info(u"PID 0x%X (%<d), PLP %d: extracted %'d TS packets from %'d T2-MI packets to %s", {pid, plp, out.ts_count, out.t2mi_count, out.name});
+        }
+        _plp_outputs.clear();
+        if (_udp_sock.isOpen()) {
+            _udp_sock.close(*tsp);
+        }
+    }
+
     // With --identify, display a summary.
     if (_identify) {
         tsp->info(u"summary: found %d PID's with T2-MI", {_identified.size()});
@@ -279,6 +392,11 @@ void ts::T2MIPlugin::handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid,
         _demux.addPID(_extract_pid);
     }
 
+    // Demux all T2-MI PID's to extract all PLP's.
+    if (_all_plps && _original_pid == PID_NULL) {
+        _demux.addPID(pid);
+    }
+
     // Report all new PID's with --identify.
     if (_identify) {
         tsp->info(u"found T2-MI PID 0x%X (%d)", {pid, pid});
@@ -326,6 +444,14 @@ void ts::T2MIPlugin::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
         }
     }
 
+    // Count T2-MI packets per PLP when extracting all PLP's.
+    if (_all_plps && hasPLP && (_original_pid == PID_NULL || pid == _original_pid)) {
+        PLPOutput* out = getPLPOutput(pid, plp);
+        if (out != nullptr) {
+            out->t2mi_count++;
+        }
+    }
+
     // Identify new PLP's.
     if (_identify && hasPLP) {
         PLPSet& plps(_identified[pid]);
@@ -361,6 +487,91 @@ void ts::T2MIPlugin::handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, co
 }
 
 
+//----------------------------------------------------------------------------
+// Process all TS packets which were extracted from one T2-MI packet.
+// The packets are directly written from the demux buffer, without copy.
+//----------------------------------------------------------------------------
+
+void ts::T2MIPlugin::handleTSPackets(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket* ts, size_t count)
+{
+    if (_all_plps) {
+        PLPOutput* out = getPLPOutput(t2mi.sourcePID(), t2mi.plp());
+        if (out != nullptr) {
+            out->ts_count += count;
+            if (out->file.isOpen()) {
+                _abort = _abort || !out->file.writePackets(ts, nullptr, count, *tsp);
+            }
+            else {
+                // Send UDP datagrams of up to 7 TS packets.
+                for (size_t i = 0; !_abort && i < count; i += 7) {
+                    _abort = !_udp_sock.send(ts + i, std::min<size_t>(7, count - i) * PKT_SIZE, out->destination, *tsp);
+                }
+            }
+        }
+    }
+    else if (_extract && !_replace_ts && _plp_valid && t2mi.plp() == _plp) {
+        // Write all packets to the output file at once.
+        _abort = _abort || !_outfile.writePackets(ts, nullptr, count, *tsp);
+    }
+    else {
+        // Default processing, one packet at a time.
+        T2MIHandlerInterface::handleTSPackets(demux, t2mi, ts, count);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get or create the output of a PLP, with --plp-output or --plp-udp.
+//----------------------------------------------------------------------------
+
+ts::T2MIPlugin::PLPOutput::PLPOutput() :
+    t2mi_count(0),
+    ts_count(0),
+    name(),
+    file(),
+    destination()
+{
+}
+
+ts::T2MIPlugin::PLPOutput* ts::T2MIPlugin::getPLPOutput(PID pid, uint8_t plp)
+{
+    PLPOutputPtr& out(_plp_outputs[(uint32_t(pid) << 8) | plp]);
+    if (out.isNull()) {
+        out = new PLPOutput;
+        CheckNonNull(out.pointer());
+
+        // Index of the PID, in order of discovery.
+        const size_t index = _pid_index.insert(std::make_pair(pid, _pid_index.size())).first->second;
+
+        if (!_plp_template.empty()) {
+            // Build the file name from the template.
+            if (_plp_template.contain(u"{plp}")) {
+                out->name = _plp_template;
+            }
+            else {
+                out->name = PathPrefix(_plp_template) + u"-{pid}-{plp}" + PathSuffix(_plp_template);
+            }
+            out->name.substitute(u"{pid}", UString::Decimal(pid, 0, true, UString()));
+            out->name.substitute(u"{plp}", UString::Decimal(plp, 0, true, UString()));
+            _abort = _abort || !out->file.open(out->name, _outfile_flags, *tsp);
+        }
+        else {
+            // Compute the UDP destination port.
+            const size_t port = _udp_base.port() + 256 * index + plp;
+            if (port > 0xFFFF) {
+                tsp->error(u"UDP port overflow for PID 0x%X (%<d), PLP %d", {pid, plp});
+                _abort = true;
+            }
+            out->destination = _udp_base;
+            out->destination.setPort(IPv4SocketAddress::Port(port));
+            out->name = out->destination.toString();
+        }
+        tsp->verbose(u"PID 0x%X (%<d), PLP %d: extracting to %s", {pid, plp, out->name});
+    }
+    return _abort ? nullptr : out.pointer();
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
@@ -178,6 +178,16 @@ bool ts::TimeShiftPlugin::start()
 
 bool ts::TimeShiftPlugin::stop()
 {
+    // Report the latency of the disk backup.
+    if (_buffer.isOpen() && !_buffer.memoryResident()) {
+        const TimeShiftBuffer::Statistics stats(_buffer.statistics());
+        tsp->verbose(u"time-shift file: %'d reads, %'d writes, average I/O: %'d us, max I/O: %'d us",
+                     {stats.read_count, stats.write_count,
+                      stats.io_time / NanoSecPerMicroSec / NanoSecond(std::max<PacketCounter>(1, stats.read_count + stats.write_count)),
+                      stats.io_max / NanoSecPerMicroSec});
+        tsp->verbose(u"time-shift file: packet processing waited %'d times, total: %'d us, max: %'d us",
+                     {stats.wait_count, stats.wait_time / NanoSecPerMicroSec, stats.wait_max / NanoSecPerMicroSec});
+    }
     _buffer.close(*tsp);
     return true;
 }
@@ -31,10 +31,25 @@
 //
 //----------------------------------------------------------------------------
 
+
 #include "tsMain.h"
+#include "tsMemoryMappedFile.h"
 #include "tsContinuityAnalyzer.h"
+#include "tsThread.h"
+#include "tsSysUtils.h"
+#include "tsFileUtils.h"
+#include "tsTime.h"
 TS_MAIN(MainCode);
 
+namespace {
+    // The file is processed by views of 65536 packets (about 12 MB). This is a multiple
+    // of the packet size and of the mapping granularity of all known systems.
+    constexpr size_t VIEW_PACKETS = 65536;
+
+    // Minimum interval between two progress reports.
+    constexpr ts::MilliSecond PROGRESS_INTERVAL = 2000;
+}
+
 
 //----------------------------------------------------------------------------
 //  Command line options
@@ -47,15 +62,12 @@ namespace {
     public:
         Options(int argc, char *argv[]);
 
-        bool         test;          // Test mode
-        bool         circular;      // Add empty packets to enforce circular continuity
-        bool         no_replicate;  // Option --no-replicate-duplicated
-        ts::UString  filename;      // File name
-        std::fstream file;          // File buffer
-
-        // Check if there was an I/O error on the file.
-        // Print an error message if this is the case.
-        bool fileError(const ts::UChar* message);
+        bool        test;          // Test mode
+        bool        circular;      // Add empty packets to enforce circular continuity
+        bool        no_replicate;  // Option --no-replicate-duplicated
+        bool        progress;      // Report progress and throughput
+        size_t      threads;       // Number of processing threads
+        ts::UString filename;      // File name
     };
 }
 
@@ -65,8 +77,9 @@ Options::Options(int argc, char *argv[]) :
     test(false),
     circular(false),
     no_replicate(false),
-    filename(),
-    file()
+    progress(false),
+    threads(1),
+    filename()
 {
     option(u"", 0, FILENAME, 1, 1);
     help(u"", u"MPEG capture file to be modified.");
@@ -92,120 +105,629 @@ Options::Options(int argc, char *argv[]) :
          u"When this option is specified, the input packets are not considered as duplicated and "
          u"the output packets receive individually incremented countinuity counters.");
 
+    option(u"progress", 'p');
+    help(u"progress",
+         u"Periodically report the progression of the processing and "
+         u"display the throughput at the end of the processing.");
+
+    option(u"threads", 't', POSITIVE);
+    help(u"threads", u"count",
+         u"Number of threads to use to process the file. "
+         u"With more than one thread, the file is first scanned in parallel by chunks, "
+         u"then the state of each PID is computed across chunk boundaries and, finally, "
+         u"the chunks are fixed in parallel. "
+         u"The result is identical to the sequential processing. "
+         u"The default is one thread, the file is sequentially processed in one pass.");
+
     analyze(argc, argv);
 
     filename = value(u"");
     circular = present(u"circular");
     test = present(u"no-action") || present(u"noaction");
     no_replicate = present(u"no-replicate-duplicated");
+    progress = present(u"progress");
+    getIntValue(threads, u"threads", 1);
 
     exitOnError();
 }
 
-// Check error on file
-bool Options::fileError(const ts::UChar* message)
+
+//----------------------------------------------------------------------------
+//  Continuity counters fixer.
+//  Same processing as ts::ContinuityAnalyzer in fix mode but with a flat
+//  per-PID table and the ability to save and restore the state of PID's.
+//----------------------------------------------------------------------------
+
+namespace {
+    class CCFixer
+    {
+        TS_NOBUILD_NOCOPY(CCFixer);
+    public:
+        // Constructor.
+        CCFixer(Options& opt, bool display);
+
+        // State of a PID.
+        class PIDState
+        {
+        public:
+            PIDState();
+            uint8_t      first_cc;      // Initial CC on this PID, INVALID_CC if not yet seen.
+            uint8_t      last_cc_out;   // Last output CC.
+            bool         reset;         // Output CC was reset to an input value after the first packet.
+            size_t       dup_count;     // Number of consecutive duplicate packets.
+            size_t       count;         // Number of packets since the state was cleared.
+            ts::TSPacket first_pkt_in;  // First input packet since the state was cleared.
+            ts::TSPacket last_pkt_in;   // Last input packet.
+        };
+        typedef std::map<ts::PID, PIDState> PIDStateMap;
+
+        // Forget all PID's and reset counters.
+        void clear();
+
+        // Enable or disable the display of errors.
+        void setDisplay(bool display) { _display = display; }
+
+        // Set the destination of messages. By default, messages are directly reported.
+        void setMessages(ts::UStringVector* messages) { _messages = messages; }
+
+        // Access the state of a PID.
+        PIDState& state(ts::PID pid) { return _states[pid]; }
+        const PIDState& state(ts::PID pid) const { return _states[pid]; }
+
+        // Get or set the state of all PID's which were seen since the last clear().
+        void getStates(PIDStateMap& states) const;
+        void setStates(const PIDStateMap& states);
+
+        // Process one packet. Return true if the packet was modified.
+        bool feedPacket(ts::TSPacket& pkt, ts::PacketCounter index);
+
+        // Get counters since the last clear().
+        ts::PacketCounter errorCount() const { return _error_count; }
+        ts::PacketCounter fixCount() const { return _fix_count; }
+
+    private:
+        Options&               _opt;
+        bool                   _display;
+        const int              _severity;
+        ts::UStringVector*     _messages;
+        ts::PacketCounter      _error_count;
+        ts::PacketCounter      _fix_count;
+        std::vector<PIDState>  _states;  // Indexed by PID.
+        std::vector<ts::PID>   _pids;    // PID's which were seen since the last clear().
+
+        // Report a message for a packet.
+        void message(ts::PacketCounter index, ts::PID pid, const ts::UString& text);
+    };
+}
+
+CCFixer::PIDState::PIDState() :
+    first_cc(ts::INVALID_CC),
+    last_cc_out(ts::INVALID_CC),
+    reset(false),
+    dup_count(0),
+    count(0),
+    first_pkt_in(ts::NullPacket),
+    last_pkt_in(ts::NullPacket)
 {
-    if (file) {
-        return false;
+}
+
+CCFixer::CCFixer(Options& opt, bool display) :
+    _opt(opt),
+    _display(display),
+    _severity(opt.test ? ts::Severity::Info : ts::Severity::Verbose),
+    _messages(nullptr),
+    _error_count(0),
+    _fix_count(0),
+    _states(ts::PID_MAX),
+    _pids()
+{
+}
+
+void CCFixer::clear()
+{
+    for (auto pid : _pids) {
+        _states[pid] = PIDState();
     }
-    else {
-        error(u"%s: %s", {filename, message});
-        return true;
+    _pids.clear();
+    _error_count = _fix_count = 0;
+}
+
+void CCFixer::getStates(PIDStateMap& states) const
+{
+    states.clear();
+    for (auto pid : _pids) {
+        states[pid] = _states[pid];
+    }
+}
+
+void CCFixer::setStates(const PIDStateMap& states)
+{
+    for (const auto& it : states) {
+        if (_states[it.first].first_cc == ts::INVALID_CC) {
+            _pids.push_back(it.first);
+        }
+        _states[it.first] = it.second;
+    }
+}
+
+void CCFixer::message(ts::PacketCounter index, ts::PID pid, const ts::UString& text)
+{
+    if (_display) {
+        const ts::UString line(ts::UString::Format(u"packet index: %'d, PID: 0x%04X, %s", {index, pid, text}));
+        if (_messages == nullptr) {
+            _opt.log(_severity, line);
+        }
+        else {
+            _messages->push_back(line);
+        }
+    }
+}
+
+bool CCFixer::feedPacket(ts::TSPacket& pkt, ts::PacketCounter index)
+{
+    const ts::PID pid = pkt.getPID();
+    bool modified = false;
+
+    // The null PID is never eligible for CC processing.
+    if (pid != ts::PID_NULL) {
+
+        PIDState& st(_states[pid]);
+        const bool new_pid = st.first_cc == ts::INVALID_CC;
+
+        // Remember initial characteristics of the input packet.
+        const uint8_t last_cc_in = new_pid ? ts::INVALID_CC : st.last_pkt_in.getCC();
+        const uint8_t cc = pkt.getCC();
+        const bool has_payload = pkt.hasPayload();
+        const bool has_discontinuity = pkt.getDiscontinuityIndicator();
+        const bool duplicated = !new_pid && !has_discontinuity && pkt.isDuplicate(st.last_pkt_in);
+
+        // Save input packet as originally received.
+        st.last_pkt_in = pkt;
+        st.count++;
+
+        if (new_pid) {
+            // First packet on this PID
+            st.first_cc = cc;
+            st.first_pkt_in = pkt;
+            _pids.push_back(pid);
+        }
+        else if (has_discontinuity) {
+            // Discontinuity indicator is set, ignore any discontinuity.
+            st.dup_count = 0;
+            st.reset = true;
+        }
+        else if (duplicated) {
+            // Duplicate packet.
+            if (++st.dup_count >= 2) {
+                // The standard allows at most 2 duplicate packets. There is nothing we can do to fix this.
+                message(index, pid, ts::UString::Format(u"%d duplicate packets", {st.dup_count + 1}));
+                _error_count++;
+            }
+            if (!_opt.test) {
+                // Check if we need to replicate a duplicate packet (same CC) or increment the CC.
+                const uint8_t cc_out = !_opt.no_replicate || !has_payload ? st.last_cc_out : ((st.last_cc_out + 1) & ts::CC_MASK);
+                if (cc != cc_out) {
+                    pkt.setCC(cc_out);
+                    modified = true;
+                    _fix_count++;
+                }
+            }
+        }
+        else {
+            // Compute expected CC for this packet.
+            const uint8_t good_cc_in = has_payload ? ((last_cc_in + 1) & ts::CC_MASK) : last_cc_in;
+            const uint8_t good_cc_out = has_payload ? ((st.last_cc_out + 1) & ts::CC_MASK) : st.last_cc_out;
+
+            if (cc != good_cc_in) {
+                // Display a specific message depending on the error.
+                if (!has_payload && cc == ((last_cc_in + 1) & ts::CC_MASK)) {
+                    message(index, pid, u"incorrect CC increment without payload");
+                }
+                else {
+                    message(index, pid, ts::UString::Format(u"missing %d packets", {ts::ContinuityAnalyzer::MissingPackets(last_cc_in, cc)}));
+                }
+                _error_count++;
+            }
+            if (cc != good_cc_out && !_opt.test) {
+                pkt.setCC(good_cc_out);
+                modified = true;
+                _fix_count++;
+            }
+            st.dup_count = 0;
+        }
+
+        // Save actual CC for next time.
+        st.last_cc_out = pkt.getCC();
     }
+    return modified;
 }
 
 
 //----------------------------------------------------------------------------
-//  Program entry point
+//  Progress and throughput report.
 //----------------------------------------------------------------------------
 
-int MainCode(int argc, char *argv[])
-{
-    Options opt(argc, argv);
-    ts::ContinuityAnalyzer fixer(ts::AllPIDs, &opt);
+namespace {
+    class Progress
+    {
+        TS_NOBUILD_NOCOPY(Progress);
+    public:
+        // Constructor.
+        Progress(Options& opt, uint64_t total_bytes);
+
+        // Report progress when necessary. The processing is done in several passes of the file.
+        void update(const ts::UChar* pass, uint64_t bytes);
 
-    // Configure the CC analyzer.
-    fixer.setDisplay(true);
-    fixer.setFix(!opt.test);
-    fixer.setReplicateDuplicated(!opt.no_replicate);
-    fixer.setMessageSeverity(opt.test ? ts::Severity::Info : ts::Severity::Verbose);
+        // Report final throughput.
+        void final(uint64_t bytes);
 
-    // Open file in read/write mode (CC are overwritten)
-    std::ios::openmode mode = std::ios::in | std::ios::binary;
-    if (!opt.test) {
-        mode |= std::ios::out;
+    private:
+        Options&       _opt;
+        const uint64_t _total;
+        const ts::Time _start;
+        ts::Time       _last;
+    };
+}
+
+Progress::Progress(Options& opt, uint64_t total_bytes) :
+    _opt(opt),
+    _total(total_bytes),
+    _start(ts::Time::CurrentUTC()),
+    _last(_start)
+{
+}
+
+void Progress::update(const ts::UChar* pass, uint64_t bytes)
+{
+    if (_opt.progress) {
+        const ts::Time now(ts::Time::CurrentUTC());
+        if (now - _last >= PROGRESS_INTERVAL) {
+            _last = now;
+            _opt.info(u"%s: %'d / %'d MB (%d%%)", {pass, bytes / 1000000, _total / 1000000, _total == 0 ? 100 : (100 * bytes) / _total});
+        }
     }
+}
 
-    opt.file.open(opt.filename.toUTF8().c_str(), mode);
+void Progress::final(uint64_t bytes)
+{
+    const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - _start);
+    _opt.log(_opt.progress ? ts::Severity::Info : ts::Severity::Verbose,
+             u"processed %'d MB in %'d ms, %'d MB/s", {bytes / 1000000, duration, (bytes * 1000) / (uint64_t(duration) * 1000000)});
+}
 
-    if (!opt.file) {
-        opt.error(u"cannot open file %s", {opt.filename});
-        return EXIT_FAILURE;
+
+//----------------------------------------------------------------------------
+//  Sequential processing of the file in one pass.
+//----------------------------------------------------------------------------
+
+namespace {
+    bool FixSequential(Options& opt, CCFixer& fixer, ts::PacketCounter& packets)
+    {
+        ts::MemoryMappedFile file;
+        if (!file.open(opt.filename, opt.test, opt)) {
+            return false;
+        }
+
+        const ts::PacketCounter total = file.fileSize() / ts::PKT_SIZE;
+        Progress progress(opt, file.fileSize());
+        bool ok = true;
+
+        for (packets = 0; ok && packets < total; ) {
+            const size_t count = size_t(std::min<ts::PacketCounter>(VIEW_PACKETS, total - packets));
+            ok = file.map(packets * ts::PKT_SIZE, count * ts::PKT_SIZE, opt);
+            // In test mode, the file is mapped read-only and the packets are not modified.
+            ts::TSPacket* pkt = reinterpret_cast<ts::TSPacket*>(file.data());
+            for (size_t i = 0; ok && i < count; ++i, ++packets) {
+                if (pkt[i].b[0] != ts::SYNC_BYTE) {
+                    opt.error(u"synchronization lost after %'d TS packets, got 0x%X instead of 0x%X at start of TS packet", {packets, pkt[i].b[0], ts::SYNC_BYTE});
+                    ok = false;
+                }
+                else {
+                    fixer.feedPacket(pkt[i], packets);
+                }
+            }
+            progress.update(u"fixing", packets * ts::PKT_SIZE);
+        }
+
+        ok = file.close(opt) && ok;
+        progress.final(packets * ts::PKT_SIZE);
+        return ok;
     }
+}
+
+
+//----------------------------------------------------------------------------
+//  Parallel processing of the file.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Context of the parallel processing, shared between all threads.
+    class ParallelContext
+    {
+        TS_NOBUILD_NOCOPY(ParallelContext);
+    public:
+        ParallelContext(Options& opt_, ts::PacketCounter packets_);
+
+        Options&                          opt;
+        const ts::PacketCounter           packets;     // Number of packets in the file.
+        const size_t                      view_count;  // Number of views in the file.
+        bool                              scan;        // Scan pass (read-only) or fix pass.
+        std::atomic<size_t>               next_view;   // Next view to process.
+        std::atomic<size_t>               running;     // Number of running threads.
+        std::atomic<uint64_t>             bytes;       // Number of processed bytes in current pass.
+        std::atomic<bool>                 failed;      // An error occured in a thread.
+        std::vector<CCFixer::PIDStateMap> states;      // Per view: state of PID's at end of scan, then initial state for fix.
+        std::vector<ts::PacketCounter>    sync_error;  // Per view: index of first packet with invalid sync byte.
+        std::vector<ts::PacketCounter>    errors;      // Per view: number of discontinuities.
+        std::vector<ts::PacketCounter>    fixes;       // Per view: number of fixed packets.
+        std::vector<ts::UStringVector>    messages;    // Per view: error messages.
+    };
 
-    // Process all packets in the file
-    ts::TSPacket pkt;
+    // Processing thread.
+    class Worker: public ts::Thread
+    {
+        TS_NOBUILD_NOCOPY(Worker);
+    public:
+        Worker(ParallelContext& context);
+        virtual ~Worker() override;
+    private:
+        ParallelContext& _context;
+        CCFixer          _fixer;
+        virtual void main() override;
+    };
+}
 
-    for (;;) {
+ParallelContext::ParallelContext(Options& opt_, ts::PacketCounter packets_) :
+    opt(opt_),
+    packets(packets_),
+    view_count(size_t((packets_ + VIEW_PACKETS - 1) / VIEW_PACKETS)),
+    scan(true),
+    next_view(0),
+    running(0),
+    bytes(0),
+    failed(false),
+    states(view_count),
+    sync_error(view_count, ts::INVALID_PACKET_COUNTER),
+    errors(view_count, 0),
+    fixes(view_count, 0),
+    messages(view_count)
+{
+}
 
-        // Save position of current packet
-        const std::ios::pos_type pos = opt.file.tellg();
-        if (opt.fileError(u"error getting file position")) {
+Worker::Worker(ParallelContext& context) :
+    Thread(),
+    _context(context),
+    _fixer(context.opt, !context.scan)
+{
+}
+
+Worker::~Worker()
+{
+    waitForTermination();
+}
+
+void Worker::main()
+{
+    // Each thread uses its own mapping of the file.
+    // The file is modified during the fix pass only.
+    ts::MemoryMappedFile file;
+    if (!file.open(_context.opt.filename, _context.scan || _context.opt.test, _context.opt)) {
+        _context.failed = true;
+    }
+
+    while (!_context.failed) {
+        const size_t view = _context.next_view++;
+        if (view >= _context.view_count) {
             break;
         }
-
-        // Read a TS packet
-        if (!pkt.read(opt.file, true, opt)) {
-            break; // end of file
+        const ts::PacketCounter first = ts::PacketCounter(view) * VIEW_PACKETS;
+        const size_t count = size_t(std::min<ts::PacketCounter>(VIEW_PACKETS, _context.packets - first));
+        if (!file.map(first * ts::PKT_SIZE, count * ts::PKT_SIZE, _context.opt)) {
+            _context.failed = true;
+            break;
         }
+        ts::TSPacket* pkt = reinterpret_cast<ts::TSPacket*>(file.data());
+        _fixer.clear();
+
+        if (_context.scan) {
+            // Scan pass: process copies of the packets, starting from an unknown state on all PID's.
+            ts::TSPacket copy;
+            for (size_t i = 0; i < count; ++i) {
+                if (pkt[i].b[0] != ts::SYNC_BYTE) {
+                    _context.sync_error[view] = first + i;
+                    break;
+                }
+                copy = pkt[i];
+                _fixer.feedPacket(copy, first + i);
+            }
+            _fixer.getStates(_context.states[view]);
+        }
+        else {
+            // Fix pass: starting from the actual state of PID's, fix packets in place.
+            _fixer.setStates(_context.states[view]);
+            _fixer.setMessages(&_context.messages[view]);
+            for (size_t i = 0; i < count; ++i) {
+                _fixer.feedPacket(pkt[i], first + i);
+            }
+            _context.errors[view] = _fixer.errorCount();
+            _context.fixes[view] = _fixer.fixCount();
+        }
+        _context.bytes += count * ts::PKT_SIZE;
+    }
+
+    if (!file.close(_context.opt)) {
+        _context.failed = true;
+    }
+    _context.running--;
+}
 
-        // Process packet
-        if (!fixer.feedPacket(pkt) && !opt.test) {
-            // Packet was modified, need to rewrite it.
-            // Rewind to beginning of current packet
-            opt.file.seekp(pos);
-            if (opt.fileError(u"error setting file position")) {
+namespace {
+
+    // Run one pass over the file using several threads.
+    bool RunPass(ParallelContext& context, bool scan, Progress& progress)
+    {
+        const size_t threads = std::min(context.opt.threads, context.view_count);
+        std::vector<ts::SafePtr<Worker>> workers;
+
+        context.scan = scan;
+        context.next_view = 0;
+        context.bytes = 0;
+        context.running = threads;
+
+        for (size_t i = 0; i < threads; ++i) {
+            workers.push_back(new Worker(context));
+            if (!workers.back()->start()) {
+                context.opt.error(u"error starting thread");
+                context.failed = true;
+                context.running -= threads - i;
                 break;
             }
-            // Rewrite the packet
-            pkt.write(opt.file, opt);
-            if (opt.fileError(u"error rewriting packet")) {
-                break;
+        }
+        while (context.running > 0) {
+            ts::SleepThread(100);
+            progress.update(scan ? u"scanning" : u"fixing", context.bytes);
+        }
+        // Wait for termination of all threads.
+        workers.clear();
+        return !context.failed;
+    }
+
+    // Compute the state of PID's at the beginning of each view, from the state at the end of the previous views.
+    void StitchStates(ParallelContext& context, CCFixer& fixer)
+    {
+        for (auto& view_states : context.states) {
+            CCFixer::PIDStateMap initial;
+            for (const auto& it : view_states) {
+                const ts::PID pid = it.first;
+                const CCFixer::PIDState& scan(it.second);
+                CCFixer::PIDState& state(fixer.state(pid));
+
+                // The initial state of the PID in this view is the final state from the previous views.
+                if (state.first_cc != ts::INVALID_CC) {
+                    initial[pid] = state;
+                }
+
+                // Replay the first packet of the PID in this view, from the actual state.
+                ts::TSPacket pkt(scan.first_pkt_in);
+                fixer.feedPacket(pkt, 0);
+
+                // The following packets were processed in the scan pass from the first one.
+                if (scan.count > 1) {
+                    if (!scan.reset) {
+                        // No discontinuity indicator in the view: all output CC are shifted by the same amount.
+                        state.last_cc_out = uint8_t((state.last_cc_out + scan.last_cc_out - scan.first_pkt_in.getCC()) & ts::CC_MASK);
+                    }
+                    else {
+                        state.last_cc_out = scan.last_cc_out;
+                    }
+                    if (scan.dup_count == scan.count - 1) {
+                        // All packets after the first one were duplicated.
+                        state.dup_count += scan.dup_count;
+                    }
+                    else {
+                        state.dup_count = scan.dup_count;
+                    }
+                    state.last_pkt_in = scan.last_pkt_in;
+                }
             }
-            // Make sure the get position is ok
-            opt.file.seekg(opt.file.tellp());
-            if (opt.fileError(u"error setting file position")) {
-                break;
+            view_states.swap(initial);
+        }
+    }
+
+    bool FixParallel(Options& opt, CCFixer& fixer, ts::PacketCounter& packets)
+    {
+        const int64_t size = ts::GetFileSize(opt.filename);
+        if (size < 0) {
+            opt.error(u"cannot open file %s", {opt.filename});
+            return false;
+        }
+
+        ParallelContext context(opt, uint64_t(size) / ts::PKT_SIZE);
+        Progress progress(opt, 2 * uint64_t(size));
+        bool ok = RunPass(context, true, progress);
+
+        // Stop before any modification on synchronization loss.
+        for (size_t view = 0; ok && view < context.view_count; ++view) {
+            if (context.sync_error[view] != ts::INVALID_PACKET_COUNTER) {
+                opt.error(u"synchronization lost after %'d TS packets", {context.sync_error[view]});
+                ok = false;
+            }
+        }
+
+        if (ok) {
+            // The first packet of each PID in each view is replayed without display.
+            fixer.setDisplay(false);
+            StitchStates(context, fixer);
+            ok = RunPass(context, false, progress);
+            // Messages and counters from all threads, in file order.
+            const int severity = opt.test ? ts::Severity::Info : ts::Severity::Verbose;
+            ts::PacketCounter errors = 0;
+            ts::PacketCounter fixes = 0;
+            for (size_t view = 0; view < context.view_count; ++view) {
+                for (const auto& line : context.messages[view]) {
+                    opt.log(severity, line);
+                }
+                errors += context.errors[view];
+                fixes += context.fixes[view];
             }
+            packets = context.packets;
+            progress.final(packets * ts::PKT_SIZE);
+            opt.verbose(u"%'d packets read, %'d discontinuities, %'d packets updated", {packets, errors, fixes});
         }
+        return ok;
     }
+}
 
-    opt.verbose(u"%'d packets read, %'d discontinuities, %'d packets updated", {fixer.totalPackets(), fixer.errorCount(), fixer.fixCount()});
+
+//----------------------------------------------------------------------------
+//  Program entry point
+//----------------------------------------------------------------------------
+
+int MainCode(int argc, char *argv[])
+{
+    Options opt(argc, argv);
+
+    // The final state of all PID's is in this fixer, after sequential or parallel processing.
+    CCFixer fixer(opt, true);
+    ts::PacketCounter packets = 0;
+
+    if (opt.threads > 1) {
+        FixParallel(opt, fixer, packets);
+    }
+    else {
+        FixSequential(opt, fixer, packets);
+        opt.verbose(u"%'d packets read, %'d discontinuities, %'d packets updated", {packets, fixer.errorCount(), fixer.fixCount()});
+    }
+
+    // A truncated packet at end of file is an error, as with non-mapped processing.
+    const int64_t size = ts::GetFileSize(opt.filename);
+    if (opt.valid() && size > 0 && size % ts::PKT_SIZE != 0) {
+        opt.error(u"truncated TS packet (%d bytes) after %'d TS packets", {size % ts::PKT_SIZE, size / ts::PKT_SIZE});
+    }
 
     // Append empty packet to ensure circular continuity
     if (opt.circular && opt.valid()) {
 
         // Create an empty packet (no payload, 184-byte adaptation field)
-        pkt = ts::NullPacket;
+        ts::TSPacket pkt(ts::NullPacket);
         pkt.b[3] = 0x20;    // adaptation field, no payload
         pkt.b[4] = 183;     // adaptation field length
         pkt.b[5] = 0x00;    // nothing in adaptation field
 
-        // Ensure write position is at end of file
+        // Packets are appended at end of file.
+        std::ofstream file;
         if (!opt.test) {
-            // First, need to clear the eof bit
-            opt.file.clear();
-            // Set write position at eof
-            opt.file.seekp(0, std::ios::end);
-            // Returned value ignored on purpose, just report error when needed.
-            // coverity[CHECKED_RETURN]
-            opt.fileError(u"error setting file position");
+            file.open(opt.filename.toUTF8().c_str(), std::ios::out | std::ios::binary | std::ios::app);
+            if (!file) {
+                opt.error(u"cannot open file %s", {opt.filename});
+            }
         }
 
         // Loop through all PIDs, adding packets where some are missing
         for (ts::PID pid = 0; opt.valid() && pid < ts::PID_MAX; pid++) {
-            const uint8_t first_cc = fixer.firstCC(pid);
-            uint8_t last_cc = fixer.lastCC(pid);
+            const uint8_t first_cc = fixer.state(pid).first_cc;
+            uint8_t last_cc = fixer.state(pid).last_cc_out;
             if (first_cc != ts::INVALID_CC && first_cc != ((last_cc + 1) & ts::CC_MASK)) {
                 // We must add some packets on this PID
                 opt.verbose(u"PID: 0x%04X, adding %2d empty packets", {pid, ts::ContinuityAnalyzer::MissingPackets(last_cc, first_cc)});
@@ -219,17 +741,16 @@ int MainCode(int argc, char *argv[])
                         pkt.setPID(ts::PID(pid));
                         pkt.setCC(last_cc);
                         // Write the new packet
-                        pkt.write(opt.file, opt);
-                        if (opt.fileError(u"error writing extra packet")) {
+                        if (!pkt.write(file, opt)) {
+                            opt.error(u"%s: error writing extra packet", {opt.filename});
                             break;
                         }
                     }
                 }
             }
         }
+        file.close();
     }
 
-    opt.file.close();
-
     return opt.valid() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -64,7 +64,7 @@ namespace {
 }
 
 TSPOptions::TSPOptions(int argc, char *argv[]) :
-    ts::ArgsWithPlugins(0, 1, 0, UNLIMITED_COUNT, 0, 1, u"MPEG transport stream processor using a chain of plugins", u"[tsp-options]"),
+    ts::ArgsWithPlugins(0, 1, 0, UNLIMITED_COUNT, 0, UNLIMITED_COUNT, u"MPEG transport stream processor using a chain of plugins", u"[tsp-options]"),
     monitor(false),
     monitor_config(),
     duck(this),
@@ -34,6 +34,7 @@
 #include "tsMain.h"
 #include "tsInputRedirector.h"
 #include "tsOutputRedirector.h"
+#include "tsTSPacketStream.h"
 #include "tsByteBlock.h"
 #include "tsFatal.h"
 #include "tsTS.h"
@@ -109,7 +110,8 @@ Options::Options(int argc, char *argv[]) :
     help(u"packet-size",
          u"Expected TS packet size in bytes. By default, try 188-byte (standard), "
          u"204-byte (trailing 16-byte Reed-Solomon outer FEC), 192-byte (leading "
-         u"4-byte timestamp in M2TS/Blu-ray disc files). If the input file contains "
+         u"4-byte timestamp in M2TS/Blu-ray disc files), 202-byte (leading 14-byte "
+         u"TSDuck-specific metadata). If the input file contains "
          u"any other type of packet encapsulation, use options --packet-size and "
          u"--header-size.");
 
@@ -159,11 +161,15 @@ public:
     }
 
     // Look for MPEG packets in a buffer, according to an assumed packet size.
-    // If the complete buffer matches the packet size, set input and output packet
-    // sizes and return true. Return false otherwise.
-    bool checkSync(const uint8_t* buf, size_t buf_size, size_t pkt_size, size_t header_size);
+    // The packets must be contiguous over at least search_size bytes.
+    // If the packets are found, set input and output packet sizes and return true.
+    // The start index of the packets is updated when the packets are found earlier in the buffer.
+    bool locateSync(const uint8_t* buf, size_t buf_size, size_t search_size, size_t pkt_size, size_t header_size, size_t& start);
 
-    // Get packet sizes, as determined by checkSync(). Size is zero if no valid packet size found.
+    // Same with a standard packet format.
+    bool locateSync(const uint8_t* buf, size_t buf_size, size_t search_size, ts::TSPacketFormat format, size_t& start);
+
+    // Get packet sizes, as determined by locateSync(). Size is zero if no valid packet size found.
     size_t inputPacketSize() const {return _in_pkt_size;}
     size_t inputHeaderSize() const {return _in_header_size;}
     size_t outputPacketSize() const {return _out_pkt_size;}
@@ -180,8 +186,8 @@ public:
     // Read input data, return read size (zero on end of file or error)
     size_t readData(uint8_t* buf, size_t size);
 
-    // Write one output packet from input packet.
-    bool writePacket(const uint8_t* input_packet);
+    // Write output packets from contiguous input packets.
+    bool writePackets(const uint8_t* input_packets, size_t count);
 
     // Constructor
     Resynchronizer(bool keep_packet_size) :
@@ -196,6 +202,12 @@ public:
     }
 
 private:
+    // Maximum size of the buffer to search when packets were already found at some index.
+    static size_t searchLimit(size_t buf_size, size_t search_size, size_t pkt_size, size_t min_packets, size_t start);
+
+    // Set the packet sizes if packets were found at index, before start. Update start.
+    bool setSync(size_t index, size_t pkt_size, size_t header_size, size_t& start);
+
     Status   _status;            // Processing status
     bool     _keep_packet_size;  // Same packet size on output file
     uint64_t _out_size;          // Size of output file
@@ -221,6 +233,8 @@ size_t Resynchronizer::readData(uint8_t* buf, size_t size)
             remain -= count;
         }
         else {
+            // Partial read at end of file.
+            got += std::cin.gcount();
             if (got == 0) {
                 _status = RS_EOF;
             }
@@ -232,21 +246,32 @@ size_t Resynchronizer::readData(uint8_t* buf, size_t size)
 
 
 //----------------------------------------------------------------------------
-// Write one output packet from input packet.
+// Write output packets from contiguous input packets.
 //----------------------------------------------------------------------------
 
-bool Resynchronizer::writePacket(const uint8_t* input_packet)
+bool Resynchronizer::writePackets(const uint8_t* input_packets, size_t count)
 {
-    const char* out_pkt = reinterpret_cast<const char*>(input_packet + _in_header_size - _out_header_size);
-    if (std::cout.write(out_pkt, std::streamsize(_out_pkt_size))) {
-        _out_size += _out_pkt_size;
-        return true;
+    bool success = true;
+    if (_in_pkt_size == _out_pkt_size) {
+        // Same input and output packets, write all packets at once.
+        success = bool(std::cout.write(reinterpret_cast<const char*>(input_packets), std::streamsize(count * _out_pkt_size)));
+    }
+    else {
+        // Extract the output packet from each input packet.
+        const char* out_pkt = reinterpret_cast<const char*>(input_packets + _in_header_size - _out_header_size);
+        for (size_t i = 0; success && i < count; ++i) {
+            success = bool(std::cout.write(out_pkt, std::streamsize(_out_pkt_size)));
+            out_pkt += _in_pkt_size;
+        }
+    }
+    if (success) {
+        _out_size += count * _out_pkt_size;
     }
     else {
         std::cerr << "* Error writing output file" << std::endl;
         _status = RS_ERROR;
-        return false;
     }
+    return success;
 }
 
 
@@ -254,20 +279,46 @@ bool Resynchronizer::writePacket(const uint8_t* input_packet)
 //  Look for MPEG packets in a buffer, according to an assumed packet size.
 //----------------------------------------------------------------------------
 
-bool Resynchronizer::checkSync(const uint8_t* buf, size_t buf_size, size_t pkt_size, size_t header_size)
+bool Resynchronizer::locateSync(const uint8_t* buf, size_t buf_size, size_t search_size, size_t pkt_size, size_t header_size, size_t& start)
 {
     assert(pkt_size >= header_size + ts::PKT_SIZE);
-    const uint8_t* end = buf + buf_size - pkt_size + 1;
+    assert(search_size <= buf_size);
 
-    // Check if the buffer contains packets with the appropriate size
-    while (buf < end) {
-        if (buf[header_size] != ts::SYNC_BYTE) {
-            return false; // not found
-        }
-        buf += pkt_size;
+    // All packets which start in the search size must be valid, up to the end of the search size.
+    // Search only before previously found packets, if any.
+    const size_t min_packets = std::max<size_t>(1, search_size / pkt_size);
+    const size_t limit = searchLimit(buf_size, search_size, pkt_size, min_packets, start);
+    return setSync(ts::TSPacketStream::LocatePackets(buf, limit, pkt_size, header_size, min_packets), pkt_size, header_size, start);
+}
+
+bool Resynchronizer::locateSync(const uint8_t* buf, size_t buf_size, size_t search_size, ts::TSPacketFormat format, size_t& start)
+{
+    assert(search_size <= buf_size);
+
+    const size_t header_size = ts::TSPacketStream::PacketHeaderSize(format);
+    const size_t pkt_size = header_size + ts::PKT_SIZE + ts::TSPacketStream::PacketTrailerSize(format);
+    const size_t min_packets = std::max<size_t>(1, search_size / pkt_size);
+    const size_t limit = searchLimit(buf_size, search_size, pkt_size, min_packets, start);
+    return setSync(ts::TSPacketStream::LocatePackets(buf, limit, min_packets, format), pkt_size, header_size, start);
+}
+
+size_t Resynchronizer::searchLimit(size_t buf_size, size_t search_size, size_t pkt_size, size_t min_packets, size_t start)
+{
+    // The first packet cannot start after buf_size - search_size.
+    size_t limit = buf_size - search_size % pkt_size;
+    if (start != ts::NPOS) {
+        // The first packet must start before the previously found one.
+        limit = start == 0 ? 0 : std::min(limit, start - 1 + min_packets * pkt_size);
     }
+    return limit;
+}
 
-    // Packets found all along the buffer
+bool Resynchronizer::setSync(size_t index, size_t pkt_size, size_t header_size, size_t& start)
+{
+    if (index == ts::NPOS || (start != ts::NPOS && index >= start)) {
+        return false; // not found or not earlier
+    }
+    start = index;
     _in_pkt_size = pkt_size;
     _in_header_size = header_size;
     _out_pkt_size = _keep_packet_size ? pkt_size : ts::PKT_SIZE;
@@ -313,31 +364,24 @@ int MainCode(int argc, char *argv[])
 
         // Look for a range of packets for at least --min-contiguous bytes
         size_t const search_size = std::min(opt.contig_size, sync_size);
-        uint8_t* const end_search = sync_end - search_size + 1;
 
         // Search a range of valid packets. Try all expected packet sizes.
-        const uint8_t* start;
-        for (start = sync_buf; start < end_search; start++) {
-            if (opt.packet_size > 0) {
-                if (resync.checkSync(start, search_size, opt.packet_size, opt.header_size)) {
-                    // Found user-specified encapsulation of TS packets
-                    break;
-                }
-            }
-            else {
-                if (resync.checkSync(start, search_size, ts::PKT_SIZE, 0)) {
-                    // Found standard TS packets
-                    break;
-                }
-                if (resync.checkSync(start, search_size, ts::PKT_RS_SIZE, 0)) {
-                    // Found TS packets with trailing Reed-Solomon outer FEC
-                    break;
-                }
-                if (resync.checkSync(start, search_size, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE)) {
-                    // Found TS packets with leading 4-byte timestamp (M2TS format, blu-ray discs)
-                    break;
-                }
-            }
+        // The earliest range of packets is selected. When several packet sizes
+        // match at the same position, the first one in the list is used.
+        size_t index = ts::NPOS;
+        if (opt.packet_size > 0) {
+            // User-specified encapsulation of TS packets
+            resync.locateSync(sync_buf, sync_size, search_size, opt.packet_size, opt.header_size, index);
+        }
+        else {
+            // Standard TS packets
+            resync.locateSync(sync_buf, sync_size, search_size, ts::TSPacketFormat::TS, index);
+            // TS packets with trailing Reed-Solomon outer FEC
+            resync.locateSync(sync_buf, sync_size, search_size, ts::TSPacketFormat::RS204, index);
+            // TS packets with leading 4-byte timestamp (M2TS format, blu-ray discs)
+            resync.locateSync(sync_buf, sync_size, search_size, ts::TSPacketFormat::M2TS, index);
+            // TS packets with leading 14-byte TSDuck-specific metadata
+            resync.locateSync(sync_buf, sync_size, search_size, ts::TSPacketFormat::DUCK, index);
         }
         if (resync.inputPacketSize() == 0) {
             std::cerr << "* Cannot find MPEG TS packets after " << ts::UString::Decimal(search_size) << " bytes" << std::endl;
@@ -345,7 +389,7 @@ int MainCode(int argc, char *argv[])
             break;
         }
         if (opt.verbose()) {
-            std::cerr << "* Found synchronization after " << ts::UString::Decimal(start - sync_buf) << " bytes" << std::endl
+            std::cerr << "* Found synchronization after " << ts::UString::Decimal(index) << " bytes" << std::endl
                       << "* Packet size is " << resync.inputPacketSize() << " bytes";
             if (resync.inputHeaderSize() > 0) {
                 std::cerr << " (" << resync.inputHeaderSize() << "-byte header)";
@@ -353,50 +397,56 @@ int MainCode(int argc, char *argv[])
             std::cerr << std::endl;
         }
 
-        // Output initial sync buffer, starting at first valid packet, writing all valid packets
-        while (start <= sync_end - resync.inputPacketSize() && start[resync.inputHeaderSize()] == ts::SYNC_BYTE) {
-            if (!resync.writePacket(start)) {
-                break;
-            }
-            start += resync.inputPacketSize();
-        }
-        if (resync.status() != RS_OK) {
-            break;
-        }
-
-        // Compact sync buffer
-        if (start >= sync_end) {
-            sync_pre_size = 0;
-        }
-        else {
-            sync_pre_size = sync_end - start;
-            ::memmove(sync_buf, start, sync_pre_size);
-        }
+        const size_t pkt_size = resync.inputPacketSize();
+        const size_t header_size = resync.inputHeaderSize();
 
-        // If more than one packet left, out of sync
-        if (sync_pre_size >= resync.inputPacketSize()) {
-            resync.setStatus(RS_SYNC_LOST);
-        }
+        // Read size of subsequent chunks: as many complete packets as possible in the sync buffer.
+        const size_t chunk_size = (sync_buf_size / pkt_size) * pkt_size;
 
-        // Read the rest of the input file
+        // Output the initial sync buffer, starting at first valid packet, then the rest of
+        // the input file, chunk by chunk, writing all valid packets in each chunk.
+        const uint8_t* start = sync_buf + index;
+        const uint8_t* end = sync_end;
+        bool initial = true;
+        bool eof = false;
         while (resync.status() == RS_OK) {
-            assert(sync_pre_size < resync.inputPacketSize());
-            // Read the next packet
-            const size_t remain_size = resync.inputPacketSize() - sync_pre_size;
-            if (resync.readData(sync_buf + sync_pre_size, remain_size) != remain_size) {
-                resync.setStatus(RS_EOF);
+
+            // Locate all contiguous valid packets in the chunk and write them at once.
+            const uint8_t* next = start;
+            while (next + pkt_size <= end && next[header_size] == ts::SYNC_BYTE) {
+                next += pkt_size;
+            }
+            if (next > start && !resync.writePackets(start, (next - start) / pkt_size)) {
+                break;
             }
-            else if (sync_buf[resync.inputHeaderSize()] != ts::SYNC_BYTE) {
-                std::cerr << ts::UString::Format(u"*** Synchronization lost after %'d TS packets", {resync.outputFilePackets()}) << std::endl
-                          << ts::UString::Format(u"*** Got 0x%X instead of 0x%X at start of TS packet", {sync_buf[resync.inputHeaderSize()], ts::SYNC_BYTE}) << std::endl;
+
+            // Move the rest of the chunk at the beginning of the sync buffer.
+            sync_pre_size = end - next;
+            ::memmove(sync_buf, next, sync_pre_size);
+
+            // If more than one packet left, out of sync. Will resynchronize with sync buffer pre-loaded.
+            if (sync_pre_size >= pkt_size) {
+                if (!initial) {
+                    std::cerr << ts::UString::Format(u"*** Synchronization lost after %'d TS packets", {resync.outputFilePackets()}) << std::endl
+                              << ts::UString::Format(u"*** Got 0x%X instead of 0x%X at start of TS packet", {sync_buf[header_size], ts::SYNC_BYTE}) << std::endl;
+                }
                 resync.setStatus(RS_SYNC_LOST);
-                // Will resynchronize with sync buffer pre-loaded
-                sync_pre_size = resync.inputPacketSize();
+                break;
             }
-            else {
-                resync.writePacket(sync_buf);
-                sync_pre_size = 0;
+
+            // Stop at end of file, after the last chunk.
+            if (eof) {
+                resync.setStatus(RS_EOF);
+                break;
             }
+
+            // Read the next chunk of the input file.
+            const size_t chunk_read = chunk_size - sync_pre_size;
+            const size_t got = resync.readData(sync_buf + sync_pre_size, chunk_read);
+            eof = got < chunk_read;
+            start = sync_buf;
+            end = sync_buf + sync_pre_size + got;
+            initial = false;
         }
 
     } while (resync.status() == RS_OK || (resync.status() == RS_SYNC_LOST && opt.cont_sync));
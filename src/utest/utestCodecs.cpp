@@ -32,7 +32,13 @@
 //----------------------------------------------------------------------------
 
 #include "tsAccessUnitIterator.h"
+#include "tsStartCode.h"
+#include "tsMemory.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
 #include "tsAVC.h"
+#include "tsHEVC.h"
+#include "tsVVC.h"
 #include "tsunit.h"
 
 
@@ -47,9 +53,13 @@ public:
     virtual void afterTest() override;
 
     void testIterator();
+    void testStartCode();
+    void testBenchmark();
 
     TSUNIT_TEST_BEGIN(CodecsTest);
     TSUNIT_TEST(testIterator);
+    TSUNIT_TEST(testStartCode);
+    TSUNIT_TEST(testBenchmark);
     TSUNIT_TEST_END();
 };
 
@@ -75,6 +85,62 @@ void CodecsTest::afterTest()
 // Unitary tests.
 //----------------------------------------------------------------------------
 
+namespace {
+    // Simple deterministic pseudo-random generator.
+    class Lcg
+    {
+    public:
+        Lcg() : _state(0x87654321) {}
+        uint8_t next() { _state = _state * 6364136223846793005ULL + 1442695040888963407ULL; return uint8_t(_state >> 56); }
+    private:
+        uint64_t _state;
+    };
+
+    // Reference implementation of the NALunit end, as previously used in AccessUnitIterator.
+    const uint8_t* RefNALUnitEnd(const uint8_t* data, size_t size)
+    {
+        static const uint8_t Zero3[] = {0x00, 0x00, 0x00};
+        static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
+        const uint8_t* const p2 = ts::LocatePattern(data, size, StartCodePrefix, sizeof(StartCodePrefix));
+        const uint8_t* const p3 = ts::LocatePattern(data, size, Zero3, sizeof(Zero3));
+        return p2 == nullptr ? p3 : (p3 != nullptr && p3 < p2 ? p3 : p2);
+    }
+
+    // Build a video PES payload: NALunits of random content, with start code emulation prevention.
+    void BuildPayload(ts::ByteBlock& data, size_t size, ts::CodecType format, Lcg& rnd)
+    {
+        data.clear();
+        data.reserve(size + 1024);
+        size_t nal_count = 0;
+        while (data.size() < size) {
+            // Start code prefix and NALunit header. The first NALunit is an access unit delimiter.
+            data.appendUInt32(0x00000001);
+            if (format == ts::CodecType::AVC) {
+                data.appendUInt8(nal_count == 0 ? ts::AVC_AUT_DELIMITER : (nal_count == 1 ? ts::AVC_AUT_SEI : ts::AVC_AUT_IDR));
+            }
+            else if (format == ts::CodecType::HEVC) {
+                data.appendUInt16(uint16_t((nal_count == 0 ? ts::HEVC_AUT_AUD_NUT : (nal_count == 1 ? ts::HEVC_AUT_PREFIX_SEI_NUT : ts::HEVC_AUT_IDR_N_LP)) << 9) | 0x0001);
+            }
+            else {
+                data.appendUInt16(uint16_t((nal_count == 0 ? ts::VVC_AUT_AUD_NUT : (nal_count == 1 ? ts::VVC_AUT_PREFIX_SEI_NUT : ts::VVC_AUT_IDR_N_LP)) << 3) | 0x0001);
+            }
+            // Slices are large, other NALunits are small. Compressed data contain few zeroes.
+            const size_t nal_size = nal_count < 2 ? 16 : 20000;
+            for (size_t i = 0; i < nal_size; ++i) {
+                const uint8_t b = rnd.next();
+                const size_t len = data.size();
+                if (b <= 3 && data[len - 1] == 0 && data[len - 2] == 0) {
+                    data.appendUInt8(0x03);
+                }
+                data.appendUInt8(b);
+            }
+            // Avoid trailing zeroes.
+            data.appendUInt8(0x80);
+            nal_count++;
+        }
+    }
+}
+
 void CodecsTest::testIterator()
 {
     static const uint8_t data[] = {
@@ -142,3 +208,95 @@ void CodecsTest::testIterator()
     TSUNIT_ASSERT(iter.atEnd());
     TSUNIT_EQUAL(3, iter.currentAccessUnitIndex());
 }
+
+void CodecsTest::testStartCode()
+{
+    static const uint8_t data[] = {
+        0x12, 0x00, 0x00, 0x02, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x45, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0x00,
+        0x00, 0x01,
+    };
+
+    TSUNIT_ASSERT(ts::LocateStartCodePrefix(nullptr, 10) == nullptr);
+    TSUNIT_ASSERT(ts::LocateStartCodePrefix(data, 0) == nullptr);
+    TSUNIT_ASSERT(ts::LocateStartCodePrefix(data, 2) == nullptr);
+    TSUNIT_EQUAL(10, ts::LocateStartCodePrefix(data, sizeof(data)) - data);
+    TSUNIT_EQUAL(18, ts::LocateStartCodePrefix(data + 11, sizeof(data) - 11) - data);
+    TSUNIT_EQUAL(31, ts::LocateStartCodePrefix(data + 19, sizeof(data) - 19) - data);
+    TSUNIT_ASSERT(ts::LocateStartCodePrefix(data + 19, sizeof(data) - 20) == nullptr);
+
+    TSUNIT_EQUAL(9, ts::LocateNALUnitEnd(data, sizeof(data)) - data);
+    TSUNIT_EQUAL(14, ts::LocateNALUnitEnd(data + 13, sizeof(data) - 13) - data);
+    TSUNIT_EQUAL(31, ts::LocateNALUnitEnd(data + 19, sizeof(data) - 19) - data);
+    TSUNIT_ASSERT(ts::LocateNALUnitEnd(data + 19, sizeof(data) - 20) == nullptr);
+
+    // Compare with generic pattern search on random data with many zeroes.
+    static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
+    Lcg rnd;
+    ts::ByteBlock buffer(4096);
+    for (size_t iter = 0; iter < 200; ++iter) {
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            const uint8_t b = rnd.next();
+            buffer[i] = b < 64 ? 0 : (b < 80 ? 1 : b);
+        }
+        for (size_t start = 0; start < buffer.size(); ) {
+            const uint8_t* const p = buffer.data() + start;
+            const size_t size = buffer.size() - start;
+            const uint8_t* const ref = ts::LocatePattern(p, size, StartCodePrefix, sizeof(StartCodePrefix));
+            TSUNIT_ASSERT(ts::LocateStartCodePrefix(p, size) == ref);
+            TSUNIT_ASSERT(ts::LocateNALUnitEnd(p, size) == RefNALUnitEnd(p, size));
+            start = ref == nullptr ? buffer.size() : ref - buffer.data() + 1;
+        }
+    }
+}
+
+void CodecsTest::testBenchmark()
+{
+    // Large PES payloads, typically one 4K frame.
+    constexpr size_t PAYLOAD_SIZE = 500000;
+    constexpr size_t REPEAT = 20;
+    static const ts::CodecType formats[] = {ts::CodecType::AVC, ts::CodecType::HEVC, ts::CodecType::VVC};
+    static const uint8_t stream_types[] = {ts::ST_AVC_VIDEO, ts::ST_HEVC_VIDEO, ts::ST_VVC_VIDEO};
+
+    Lcg rnd;
+    ts::ByteBlock data;
+
+    for (size_t fi = 0; fi < sizeof(formats) / sizeof(formats[0]); ++fi) {
+        BuildPayload(data, PAYLOAD_SIZE, formats[fi], rnd);
+
+        // Iterate with the access unit iterator.
+        size_t count = 0;
+        ts::Monotonic start(true);
+        for (size_t rep = 0; rep < REPEAT; ++rep) {
+            for (ts::AccessUnitIterator iter(data.data(), data.size(), stream_types[fi]); !iter.atEnd(); iter.next()) {
+                count++;
+            }
+        }
+        const ts::NanoSecond iter_ns = ts::Monotonic(true) - start;
+
+        // Same thing with the generic pattern search as previously used.
+        static const uint8_t StartCodePrefix[] = {0x00, 0x00, 0x01};
+        size_t ref_count = 0;
+        start.getSystemTime();
+        for (size_t rep = 0; rep < REPEAT; ++rep) {
+            const uint8_t* p = data.data();
+            const uint8_t* const end = p + data.size();
+            while ((p = ts::LocatePattern(p, end - p, StartCodePrefix, sizeof(StartCodePrefix))) != nullptr) {
+                p += sizeof(StartCodePrefix);
+                const uint8_t* const next = RefNALUnitEnd(p, end - p);
+                ref_count++;
+                if (next == nullptr) {
+                    break;
+                }
+                p = next;
+            }
+        }
+        const ts::NanoSecond ref_ns = ts::Monotonic(true) - start;
+
+        TSUNIT_EQUAL(ref_count, count);
+        TSUNIT_EQUAL(REPEAT * (2 + PAYLOAD_SIZE / 20000), count);
+        debug() << "CodecsTest::testBenchmark: " << ts::CodecTypeEnum.name(int(formats[fi])) << ", " << (REPEAT * data.size()) << " bytes, "
+                << count << " NALunits" << std::endl
+                << "CodecsTest::testBenchmark: AccessUnitIterator: " << (iter_ns / 1000) << " us, generic search: " << (ref_ns / 1000) << " us" << std::endl;
+    }
+}
@@ -92,6 +92,7 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testRepeatedSections();
 
     TSUNIT_TEST_BEGIN(DemuxTest);
     TSUNIT_TEST(testPAT);
@@ -105,6 +106,7 @@ public:
     TSUNIT_TEST(testTDT);
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testHEVC);
+    TSUNIT_TEST(testRepeatedSections);
     TSUNIT_TEST_END();
 
 private:
@@ -114,6 +116,9 @@ private:
     // Compare a vector of packets with the list of reference packets
     bool checkPackets(const char* test_name, const char* table_name, const ts::TSPacketVector& packets, const uint8_t* ref_packets, size_t ref_packets_size);
 
+    // Feed a demux with a table several times.
+    void feedTable(ts::DuckContext& duck, ts::OneShotPacketizer& pzer, ts::SectionDemux& demux1, ts::SectionDemux& demux2, const ts::AbstractTable& table, size_t count);
+
     // Unitary test for one table.
     void testTable(const char* name, const uint8_t* ref_packets, size_t ref_packets_size, const uint8_t* ref_sections, size_t ref_sections_size);
 };
@@ -489,3 +494,77 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+
+//----------------------------------------------------------------------------
+// Test the filtering of repeated sections.
+//----------------------------------------------------------------------------
+
+namespace {
+    class SectionCounter : public ts::SectionHandlerInterface
+    {
+    public:
+        size_t count;
+        SectionCounter() : count(0) {}
+        virtual void handleSection(ts::SectionDemux&, const ts::Section&) override { count++; }
+    };
+}
+
+void DemuxTest::feedTable(ts::DuckContext& duck, ts::OneShotPacketizer& pzer, ts::SectionDemux& demux1, ts::SectionDemux& demux2, const ts::AbstractTable& table, size_t count)
+{
+    while (count-- > 0) {
+        ts::TSPacketVector packets;
+        pzer.removeAll();
+        pzer.addTable(duck, table);
+        pzer.getPackets(packets);
+        for (size_t i = 0; i < packets.size(); ++i) {
+            demux1.feedPacket(packets[i]);
+            demux2.feedPacket(packets[i]);
+        }
+    }
+}
+
+void DemuxTest::testRepeatedSections()
+{
+    ts::DuckContext duck;
+    ts::OneShotPacketizer pzer(duck, ts::PID_PAT);
+
+    // Same packets in two demux, the second one filters repeated sections.
+    SectionCounter counter1;
+    SectionCounter counter2;
+    ts::SectionDemux demux1(duck, nullptr, &counter1, ts::PIDSet().set(ts::PID_PAT));
+    ts::SectionDemux demux2(duck, nullptr, &counter2, ts::PIDSet().set(ts::PID_PAT));
+    demux2.filterRepeatedSections(true);
+
+    ts::PAT pat1(1, true, 0x1234);
+    pat1.pmts[100] = 1000;
+
+    ts::PAT pat2(pat1);
+    pat2.pmts[101] = 1010;  // same version, different content
+
+    ts::PAT pat3(pat2);
+    pat3.version = 2;
+
+    feedTable(duck, pzer, demux1, demux2, pat1, 5);
+    TSUNIT_EQUAL(5, counter1.count);
+    TSUNIT_EQUAL(1, counter2.count);
+
+    feedTable(duck, pzer, demux1, demux2, pat2, 3);
+    TSUNIT_EQUAL(8, counter1.count);
+    TSUNIT_EQUAL(2, counter2.count);
+
+    feedTable(duck, pzer, demux1, demux2, pat3, 3);
+    TSUNIT_EQUAL(11, counter1.count);
+    TSUNIT_EQUAL(3, counter2.count);
+
+    feedTable(duck, pzer, demux1, demux2, pat1, 2);
+    TSUNIT_EQUAL(13, counter1.count);
+    TSUNIT_EQUAL(4, counter2.count);
+
+    // After a reset, the first occurrence is passed again.
+    demux2.reset();
+    demux2.addPID(ts::PID_PAT);
+    feedTable(duck, pzer, demux1, demux2, pat1, 2);
+    TSUNIT_EQUAL(15, counter1.count);
+    TSUNIT_EQUAL(5, counter2.count);
+}
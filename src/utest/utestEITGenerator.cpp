@@ -0,0 +1,206 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::EITGenerator
+//
+//----------------------------------------------------------------------------
+
+#include "tsEITGenerator.h"
+#include "tsDuckContext.h"
+#include "tsMonotonic.h"
+#include "tsMJD.h"
+#include "tsBCD.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class EITGeneratorTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testRegenerationThreads();
+    void testBenchmark();
+
+    TSUNIT_TEST_BEGIN(EITGeneratorTest);
+    TSUNIT_TEST(testRegenerationThreads);
+    TSUNIT_TEST(testBenchmark);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(EITGeneratorTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void EITGeneratorTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void EITGeneratorTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Load an EPG in an EIT generator: a number of services with contiguous events of the same duration.
+    void LoadEPG(ts::EITGenerator& gen, uint16_t first_service, size_t service_count, const ts::Time& start, ts::MilliSecond duration, size_t event_count)
+    {
+        const ts::UString text(u"Some event description text, long enough to fill EIT sections more quickly.");
+        for (size_t srv = 0; srv < service_count; ++srv) {
+            ts::ByteBlock data;
+            for (size_t ev = 0; ev < event_count; ++ev) {
+                const ts::Time ev_start(start + ts::MilliSecond(ev) * duration);
+                const ts::Second ev_duration = duration / ts::MilliSecPerSec;
+                data.appendUInt16(uint16_t(ev));
+                ts::EncodeMJD(ev_start, data.enlarge(5), 5);
+                data.appendUInt8(ts::EncodeBCD(int(ev_duration / 3600)));
+                data.appendUInt8(ts::EncodeBCD(int(ev_duration / 60 % 60)));
+                data.appendUInt8(ts::EncodeBCD(int(ev_duration % 60)));
+                // Short event descriptor.
+                const std::string name(ts::UString::Format(u"Event %d of service %d", {ev, first_service + srv}).toUTF8());
+                const std::string desc(text.toUTF8());
+                const size_t desc_size = 7 + name.size() + desc.size();
+                data.appendUInt16(0x8000 | uint16_t(desc_size));
+                data.appendUInt8(0x4D);
+                data.appendUInt8(uint8_t(desc_size - 2));
+                data.append("eng", 3);
+                data.appendUInt8(uint8_t(name.size()));
+                data.append(name.data(), name.size());
+                data.appendUInt8(uint8_t(desc.size()));
+                data.append(desc.data(), desc.size());
+            }
+            gen.loadEvents(ts::ServiceIdTriplet(uint16_t(first_service + srv), 1, 1), data.data(), data.size());
+        }
+    }
+
+    // Check that two EIT generators produce the same EIT's.
+    void CheckSameEITs(ts::EITGenerator& gen1, ts::EITGenerator& gen2)
+    {
+        ts::SectionPtrVector sections1;
+        ts::SectionPtrVector sections2;
+        gen1.saveEITs(sections1);
+        gen2.saveEITs(sections2);
+        TSUNIT_ASSERT(!sections1.empty());
+        TSUNIT_EQUAL(sections1.size(), sections2.size());
+        for (size_t i = 0; i < sections1.size() && i < sections2.size(); ++i) {
+            TSUNIT_ASSERT(*sections1[i] == *sections2[i]);
+        }
+    }
+}
+
+void EITGeneratorTest::testRegenerationThreads()
+{
+    ts::DuckContext duck;
+    ts::EITGenerator gen1(duck);
+    ts::EITGenerator gen2(duck);
+    gen2.setRegenerationThreads(3);
+
+    ts::Time now(2030, 1, 1, 10, 0, 0);
+    for (ts::EITGenerator* gen : {&gen1, &gen2}) {
+        gen->setTransportStreamId(1);
+        gen->setCurrentTime(now);
+        LoadEPG(*gen, 100, 20, now - ts::MilliSecPerHour, 45 * ts::MilliSecPerMin, 200);
+    }
+    CheckSameEITs(gen1, gen2);
+
+    // Incremental loading in some services.
+    for (ts::EITGenerator* gen : {&gen1, &gen2}) {
+        LoadEPG(*gen, 110, 5, now + 6 * ts::MilliSecPerDay, 20 * ts::MilliSecPerMin, 50);
+    }
+    CheckSameEITs(gen1, gen2);
+
+    // Cross midnight.
+    now += 16 * ts::MilliSecPerHour;
+    for (ts::EITGenerator* gen : {&gen1, &gen2}) {
+        gen->setCurrentTime(now);
+    }
+    CheckSameEITs(gen1, gen2);
+
+    // Change the number of threads in the middle of the regeneration.
+    for (ts::EITGenerator* gen : {&gen1, &gen2}) {
+        LoadEPG(*gen, 200, 10, now, 30 * ts::MilliSecPerMin, 100);
+        ts::TSPacket pkt(ts::NullPacket);
+        gen->processPacket(pkt);
+    }
+    gen2.setRegenerationThreads(1);
+    CheckSameEITs(gen1, gen2);
+}
+
+void EITGeneratorTest::testBenchmark()
+{
+    // Typical large EPG: 500 services, 8 days of one-hour events.
+    constexpr size_t SERVICES = 500;
+    const ts::Time now(2030, 1, 1, 0, 0, 0);
+
+    ts::DuckContext duck;
+    ts::EITGenerator gen1(duck);
+    ts::EITGenerator gen2(duck);
+    gen2.setRegenerationThreads(4);
+
+    ts::NanoSecond packet_ns[2] = {0, 0};
+    ts::NanoSecond total_ns[2] = {0, 0};
+    size_t sections_count[2] = {0, 0};
+    ts::EITGenerator* gens[2] = {&gen1, &gen2};
+
+    for (size_t i = 0; i < 2; ++i) {
+        gens[i]->setTransportStreamId(1);
+        gens[i]->setCurrentTime(now);
+        LoadEPG(*gens[i], 1, SERVICES, now, ts::MilliSecPerHour, 8 * 24);
+
+        // Time spent in the packet processing path.
+        ts::TSPacket pkt(ts::NullPacket);
+        const ts::Monotonic start(true);
+        gens[i]->processPacket(pkt);
+        packet_ns[i] = ts::Monotonic(true) - start;
+
+        // Wait for the completion of the regeneration.
+        ts::SectionPtrVector sections;
+        gens[i]->saveEITs(sections);
+        total_ns[i] = ts::Monotonic(true) - start;
+        sections_count[i] = sections.size();
+    }
+
+    TSUNIT_EQUAL(sections_count[0], sections_count[1]);
+    debug() << "EITGeneratorTest::testBenchmark: " << SERVICES << " services, " << sections_count[0] << " EIT sections" << std::endl
+            << "EITGeneratorTest::testBenchmark: synchronous: " << (packet_ns[0] / 1000) << " us in packet path, " << (total_ns[0] / 1000) << " us total" << std::endl
+            << "EITGeneratorTest::testBenchmark: 4 threads: " << (packet_ns[1] / 1000) << " us in packet path, " << (total_ns[1] / 1000) << " us total" << std::endl;
+}
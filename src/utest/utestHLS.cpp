@@ -52,6 +52,7 @@ public:
     void testMediaPlaylist();
     void testBuildMasterPlaylist();
     void testBuildMediaPlaylist();
+    void testBuildLowLatencyPlaylist();
 
     TSUNIT_TEST_BEGIN(HLSTest);
     TSUNIT_TEST(testMasterPlaylist);
@@ -59,6 +60,7 @@ public:
     TSUNIT_TEST(testMediaPlaylist);
     TSUNIT_TEST(testBuildMasterPlaylist);
     TSUNIT_TEST(testBuildMediaPlaylist);
+    TSUNIT_TEST(testBuildLowLatencyPlaylist);
     TSUNIT_TEST_END();
 
 private:
@@ -398,3 +400,77 @@ void HLSTest::testBuildMediaPlaylist()
 
     TSUNIT_EQUAL(refContent2, pl.textContent());
 }
+
+void HLSTest::testBuildLowLatencyPlaylist()
+{
+    ts::hls::PlayList pl;
+    pl.reset(ts::hls::PlayListType::EVENT, u"/c/test/path/master/test.m3u8", 6);
+
+    TSUNIT_ASSERT(pl.isValid());
+    TSUNIT_EQUAL(6, pl.version());
+    TSUNIT_ASSERT(pl.setTargetDuration(2));
+    TSUNIT_EQUAL(0, pl.partTarget());
+    TSUNIT_ASSERT(pl.setPartTarget(1000));
+    TSUNIT_EQUAL(1000, pl.partTarget());
+
+    // Four segments of two parts each. Then one part of a fifth segment.
+    for (int index = 1; index <= 5; ++index) {
+        const ts::UString name(ts::UString::Format(u"/c/test/path/segments/seg-%04d.ts", {index}));
+        for (int count = 0; count < 2; ++count) {
+            ts::hls::MediaPart part;
+            part.relativeURI = name;
+            part.duration = 1000;
+            part.byteRangeStart = count * 18800;
+            part.byteRangeLength = 18800;
+            part.independent = count == 0;
+            TSUNIT_ASSERT(pl.addPart(part));
+            TSUNIT_EQUAL(size_t(count + 1), pl.pendingPartCount());
+            if (index == 5) {
+                ts::hls::MediaPart hint;
+                hint.relativeURI = name;
+                hint.byteRangeStart = 18800;
+                TSUNIT_ASSERT(pl.setPreloadHint(hint));
+                break;
+            }
+        }
+        if (index < 5) {
+            ts::hls::MediaSegment seg;
+            seg.relativeURI = name;
+            seg.duration = 2000;
+            TSUNIT_ASSERT(pl.addSegment(seg));
+            TSUNIT_EQUAL(0, pl.pendingPartCount());
+        }
+    }
+
+    TSUNIT_EQUAL(4, pl.segmentCount());
+    TSUNIT_EQUAL(0, pl.segment(0).parts.size());
+    TSUNIT_EQUAL(2, pl.segment(1).parts.size());
+
+    // Parts of the first segment are too old and are no longer listed.
+    static const ts::UChar* const refContent =
+        u"#EXTM3U\n"
+        u"#EXT-X-VERSION:6\n"
+        u"#EXT-X-TARGETDURATION:2\n"
+        u"#EXT-X-MEDIA-SEQUENCE:0\n"
+        u"#EXT-X-PLAYLIST-TYPE:EVENT\n"
+        u"#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=3.000\n"
+        u"#EXT-X-PART-INF:PART-TARGET=1.000\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0001.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0002.ts\",BYTERANGE=\"18800@0\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0002.ts\",BYTERANGE=\"18800@18800\"\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0002.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0003.ts\",BYTERANGE=\"18800@0\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0003.ts\",BYTERANGE=\"18800@18800\"\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0003.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0004.ts\",BYTERANGE=\"18800@0\",INDEPENDENT=YES\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0004.ts\",BYTERANGE=\"18800@18800\"\n"
+        u"#EXTINF:2.000,\n"
+        u"../segments/seg-0004.ts\n"
+        u"#EXT-X-PART:DURATION=1.000,URI=\"../segments/seg-0005.ts\",BYTERANGE=\"18800@0\",INDEPENDENT=YES\n"
+        u"#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"../segments/seg-0005.ts\",BYTERANGE-START=18800\n";
+
+    TSUNIT_EQUAL(refContent, pl.textContent());
+}
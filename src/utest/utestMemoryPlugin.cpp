@@ -49,9 +49,11 @@ public:
     virtual void afterTest() override;
 
     void testAll();
+    void testBranches();
 
     TSUNIT_TEST_BEGIN(MemoryPluginTest);
     TSUNIT_TEST(testAll);
+    TSUNIT_TEST(testBranches);
     TSUNIT_TEST_END();
 };
 
@@ -254,3 +256,38 @@ void MemoryPluginTest::testAll()
     TSUNIT_EQUAL(0, ::memcmp(&output_packets[0], REF_PACKETS, ts::PKT_SIZE * REF_PACKETS_COUNT));
     TSUNIT_EQUAL(u"", log_buffer);
 }
+
+void MemoryPluginTest::testBranches()
+{
+    ts::UString log_buffer;
+    TestReport log(log_buffer);
+
+    ts::TSPacketVector output_packets1;
+    ts::TSPacketVector output_packets2;
+    Input input(REF_PACKETS, REF_PACKETS_COUNT);
+    Output output1(output_packets1);
+    Output output2(output_packets2);
+
+    // One main output and two output branches, all receiving the same packets.
+    ts::TSProcessorArgs opt;
+    opt.input = {u"memory", {}};
+    opt.output = {u"memory", {u"--event-code", u"1"}};
+    opt.branches = {
+        {u"drop", {}},
+        {u"memory", {u"--event-code", u"2"}},
+    };
+
+    ts::TSProcessor tsp(log);
+    tsp.registerEventHandler(&input, ts::PluginType::INPUT);
+    tsp.registerEventHandler(&output1, ts::TSProcessor::Criteria(1));
+    tsp.registerEventHandler(&output2, ts::TSProcessor::Criteria(2));
+
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+
+    TSUNIT_EQUAL(REF_PACKETS_COUNT, output_packets1.size());
+    TSUNIT_EQUAL(0, ::memcmp(&output_packets1[0], REF_PACKETS, ts::PKT_SIZE * REF_PACKETS_COUNT));
+    TSUNIT_EQUAL(REF_PACKETS_COUNT, output_packets2.size());
+    TSUNIT_EQUAL(0, ::memcmp(&output_packets2[0], REF_PACKETS, ts::PKT_SIZE * REF_PACKETS_COUNT));
+    TSUNIT_EQUAL(u"", log_buffer);
+}
@@ -35,6 +35,7 @@
 #include "tsReportFile.h"
 #include "tsFileUtils.h"
 #include "tsNullReport.h"
+#include "tsAsyncReport.h"
 #include "tsunit.h"
 
 
@@ -55,6 +56,7 @@ public:
     void testPrintf();
     void testByName();
     void testByStream();
+    void testAsync();
 
     TSUNIT_TEST_BEGIN(ReportTest);
     TSUNIT_TEST(testSeverity);
@@ -62,6 +64,7 @@ public:
     TSUNIT_TEST(testPrintf);
     TSUNIT_TEST(testByName);
     TSUNIT_TEST(testByStream);
+    TSUNIT_TEST(testAsync);
     TSUNIT_TEST_END();
 
 private:
@@ -326,3 +329,42 @@ void ReportTest::testByStream()
     ts::UString::Load(value, _fileName);
     TSUNIT_ASSERT(value == ref);
 }
+
+// Test case: asynchronous report, all messages delivered in synchronous mode.
+namespace {
+    class CollectReport : public ts::AsyncReport
+    {
+        TS_NOBUILD_NOCOPY(CollectReport);
+    public:
+        ts::UStringVector messages;
+        CollectReport(const ts::AsyncReportArgs& args) : ts::AsyncReport(ts::Severity::Info, args), messages() {}
+        virtual ~CollectReport() override { terminate(); }
+    protected:
+        virtual void asyncThreadLog(int severity, const ts::UString& message) override
+        {
+            messages.push_back(ts::Severity::Header(severity) + message);
+        }
+    };
+}
+
+void ReportTest::testAsync()
+{
+    ts::AsyncReportArgs args;
+    args.sync_log = true;
+    args.log_msg_count = 4;  // much smaller than the number of messages
+    CollectReport log(args);
+
+    for (int i = 0; i < 1000; ++i) {
+        log.log(i % 2 == 0 ? ts::Severity::Info : ts::Severity::Warning, u"message %d", {i});
+    }
+    log.debug(u"filtered out");
+    log.terminate();
+
+    TSUNIT_EQUAL(1000, log.messages.size());
+    TSUNIT_EQUAL(u"message 0", log.messages[0]);
+    TSUNIT_EQUAL(u"Warning: message 1", log.messages[1]);
+    TSUNIT_EQUAL(u"Warning: message 999", log.messages[999]);
+    for (size_t i = 0; i < log.messages.size(); ++i) {
+        TSUNIT_ASSERT(log.messages[i].endWith(ts::UString::Format(u" %d", {i})));
+    }
+}
@@ -0,0 +1,313 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for SMPTE 2022-1 FEC encoder and decoder.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSMPTE2022FECEncoder.h"
+#include "tsSMPTE2022FECDecoder.h"
+#include "tsTS.h"
+#include "tsMemory.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class SMPTE2022FECTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testMemXor();
+    void testEncoder();
+    void testColumnRecovery();
+    void testRowColumnRecovery();
+    void testLateMedia();
+    void testBenchmark();
+
+    TSUNIT_TEST_BEGIN(SMPTE2022FECTest);
+    TSUNIT_TEST(testMemXor);
+    TSUNIT_TEST(testEncoder);
+    TSUNIT_TEST(testColumnRecovery);
+    TSUNIT_TEST(testRowColumnRecovery);
+    TSUNIT_TEST(testLateMedia);
+    TSUNIT_TEST(testBenchmark);
+    TSUNIT_TEST_END();
+
+private:
+    // Build a set of RTP packets with distinct payload sizes.
+    static void BuildMedia(std::vector<ts::ByteBlock>& media, size_t count, uint16_t first_seq);
+
+    // Encode media packets, feed the decoder with all FEC packets and all media packets except the lost ones.
+    // Then check that the lost packets are recovered.
+    void checkRecovery(size_t columns, size_t rows, bool row_fec, uint16_t first_seq, const std::set<size_t>& lost, size_t expected_recovered);
+};
+
+TSUNIT_REGISTER(SMPTE2022FECTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void SMPTE2022FECTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void SMPTE2022FECTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Build a set of RTP packets.
+//----------------------------------------------------------------------------
+
+void SMPTE2022FECTest::BuildMedia(std::vector<ts::ByteBlock>& media, size_t count, uint16_t first_seq)
+{
+    media.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        // Most datagrams contain 7 TS packets, some of them are shorter.
+        const size_t pkt_count = i % 11 == 3 ? 1 + i % 6 : 7;
+        ts::ByteBlock& rtp(media[i]);
+        rtp.resize(ts::RTP_HEADER_SIZE + pkt_count * ts::PKT_SIZE);
+        rtp[0] = 0x80;
+        rtp[1] = ts::RTP_PT_MP2T;
+        ts::PutUInt16(&rtp[2], uint16_t(first_seq + i));
+        ts::PutUInt32(&rtp[4], uint32_t(1000 + 3 * i * i));
+        ts::PutUInt32(&rtp[8], 0x12345678);
+        for (size_t j = ts::RTP_HEADER_SIZE; j < rtp.size(); ++j) {
+            rtp[j] = uint8_t(i * 7 + j * 13 + (j >> 8));
+        }
+        for (size_t j = ts::RTP_HEADER_SIZE; j < rtp.size(); j += ts::PKT_SIZE) {
+            rtp[j] = ts::SYNC_BYTE;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encode, lose and recover.
+//----------------------------------------------------------------------------
+
+void SMPTE2022FECTest::checkRecovery(size_t columns, size_t rows, bool row_fec, uint16_t first_seq, const std::set<size_t>& lost, size_t expected_recovered)
+{
+    const size_t count = 2 * columns * rows;
+    std::vector<ts::ByteBlock> media;
+    BuildMedia(media, count, first_seq);
+
+    ts::SMPTE2022FECEncoder encoder;
+    ts::SMPTE2022FECDecoder decoder;
+    TSUNIT_ASSERT(encoder.setMatrix(columns, rows, row_fec));
+
+    ts::ByteBlock column_fec;
+    ts::ByteBlock row_fec_packet;
+    size_t column_count = 0;
+    size_t row_count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(encoder.addMediaPacket(media[i].data(), media[i].size(), column_fec, row_fec_packet));
+        if (lost.count(i) == 0) {
+            TSUNIT_ASSERT(decoder.addMediaPacket(media[i].data(), media[i].size()));
+        }
+        if (!column_fec.empty()) {
+            column_count++;
+            TSUNIT_EQUAL(ts::RTP_PT_FEC, column_fec[1]);
+            TSUNIT_ASSERT(decoder.addFECPacket(column_fec.data(), column_fec.size()));
+        }
+        if (!row_fec_packet.empty()) {
+            row_count++;
+            TSUNIT_ASSERT(decoder.addFECPacket(row_fec_packet.data(), row_fec_packet.size()));
+        }
+    }
+    TSUNIT_EQUAL(2 * columns, column_count);
+    TSUNIT_EQUAL(row_fec ? 2 * rows : 0, row_count);
+
+    ts::ByteBlock buffer(2000);
+    for (auto i : lost) {
+        size_t size = 0;
+        debug() << "SMPTE2022FECTest: " << columns << "x" << rows << ", recovering packet " << i << std::endl;
+        TSUNIT_ASSERT(decoder.recoverPacket(uint16_t(first_seq + i), buffer.data(), buffer.size(), size));
+        TSUNIT_EQUAL(media[i].size(), size);
+        TSUNIT_ASSERT(::memcmp(media[i].data(), buffer.data(), size) == 0);
+    }
+    TSUNIT_EQUAL(expected_recovered, decoder.recoveredCount());
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void SMPTE2022FECTest::testMemXor()
+{
+    uint8_t a[100];
+    uint8_t b[100];
+    uint8_t c[100];
+    for (size_t i = 0; i < sizeof(a); ++i) {
+        a[i] = uint8_t(i);
+        b[i] = uint8_t(3 * i + 1);
+    }
+    ts::MemXor(c, a, b, sizeof(c));
+    for (size_t i = 0; i < sizeof(c); ++i) {
+        TSUNIT_EQUAL(uint8_t(i) ^ uint8_t(3 * i + 1), c[i]);
+    }
+    // In place, applying the same xor twice.
+    ts::MemXor(c + 1, c + 1, b + 1, sizeof(c) - 2);
+    TSUNIT_EQUAL(uint8_t(0 ^ 1), c[0]);
+    TSUNIT_ASSERT(::memcmp(a + 1, c + 1, sizeof(c) - 2) == 0);
+    TSUNIT_EQUAL(uint8_t(99) ^ uint8_t(3 * 99 + 1), c[99]);
+}
+
+void SMPTE2022FECTest::testEncoder()
+{
+    ts::SMPTE2022FECEncoder encoder;
+    TSUNIT_ASSERT(!encoder.setMatrix(0, 5));
+    TSUNIT_ASSERT(!encoder.setMatrix(21, 5));
+    TSUNIT_ASSERT(!encoder.setMatrix(5, 21));
+    TSUNIT_ASSERT(encoder.setMatrix(4, 3, true));
+    TSUNIT_EQUAL(4, encoder.columns());
+    TSUNIT_EQUAL(3, encoder.rows());
+    TSUNIT_ASSERT(encoder.rowFEC());
+
+    std::vector<ts::ByteBlock> media;
+    BuildMedia(media, 12, 100);
+
+    ts::ByteBlock column_fec;
+    ts::ByteBlock row_fec;
+    for (size_t i = 0; i < 12; ++i) {
+        TSUNIT_ASSERT(encoder.addMediaPacket(media[i].data(), media[i].size(), column_fec, row_fec));
+        // Column FEC packets are produced along the last row, row FEC packets at the end of each row.
+        TSUNIT_EQUAL(i >= 8, !column_fec.empty());
+        TSUNIT_EQUAL(i % 4 == 3, !row_fec.empty());
+    }
+
+    // Check the FEC header of the last column FEC packet: SNBase=103, offset=L=4, NA=D=3.
+    TSUNIT_ASSERT(column_fec.size() > ts::RTP_HEADER_SIZE + ts::FEC_HEADER_SIZE);
+    const uint8_t* fec = column_fec.data() + ts::RTP_HEADER_SIZE;
+    TSUNIT_EQUAL(103, ts::GetUInt16(fec));
+    TSUNIT_EQUAL(0x80, fec[4] & 0x80);
+    TSUNIT_EQUAL(0x00, fec[12]);
+    TSUNIT_EQUAL(4, fec[13]);
+    TSUNIT_EQUAL(3, fec[14]);
+    TSUNIT_EQUAL((media[3].size() - ts::RTP_HEADER_SIZE) ^ (media[7].size() - ts::RTP_HEADER_SIZE) ^ (media[11].size() - ts::RTP_HEADER_SIZE), ts::GetUInt16(fec + 2));
+    TSUNIT_EQUAL(ts::GetUInt32(&media[3][4]) ^ ts::GetUInt32(&media[7][4]) ^ ts::GetUInt32(&media[11][4]), ts::GetUInt32(fec + 8));
+
+    // Check the FEC header of the last row FEC packet: SNBase=108, offset=1, NA=L=4.
+    fec = row_fec.data() + ts::RTP_HEADER_SIZE;
+    TSUNIT_EQUAL(108, ts::GetUInt16(fec));
+    TSUNIT_EQUAL(0x40, fec[12]);
+    TSUNIT_EQUAL(1, fec[13]);
+    TSUNIT_EQUAL(4, fec[14]);
+
+    // Invalid RTP packet.
+    TSUNIT_ASSERT(!encoder.addMediaPacket(media[0].data(), 4, column_fec, row_fec));
+}
+
+void SMPTE2022FECTest::testColumnRecovery()
+{
+    // One lost packet per column, sequence number wrapping in the first matrix.
+    checkRecovery(5, 4, false, 65530, {0, 6, 12, 18, 19, 25, 31}, 7);
+
+    // A burst of one full row, the typical case for column FEC.
+    checkRecovery(10, 10, false, 1000, {20, 21, 22, 23, 24, 25, 26, 27, 28, 29}, 10);
+}
+
+void SMPTE2022FECTest::testRowColumnRecovery()
+{
+    // Two lost packets in one row and one column, recovered iteratively.
+    checkRecovery(4, 4, true, 0, {0, 1, 4}, 3);
+
+    // Larger matrix, with a burst of one full row and isolated losses.
+    // Packet 399 is in the same column as the burst and is first recovered using its row.
+    checkRecovery(20, 20, true, 65000, {40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 399, 412, 505, 506, 799}, 25);
+}
+
+void SMPTE2022FECTest::testLateMedia()
+{
+    // The FEC packet is received before the last media packet it protects.
+    std::vector<ts::ByteBlock> media;
+    BuildMedia(media, 5, 200);
+
+    ts::SMPTE2022FECEncoder encoder(5, 1, true);
+    ts::SMPTE2022FECDecoder decoder;
+    ts::ByteBlock column_fec;
+    ts::ByteBlock row_fec;
+    for (size_t i = 0; i < media.size(); ++i) {
+        TSUNIT_ASSERT(encoder.addMediaPacket(media[i].data(), media[i].size(), column_fec, row_fec));
+    }
+    TSUNIT_ASSERT(!row_fec.empty());
+
+    TSUNIT_ASSERT(decoder.addMediaPacket(media[0].data(), media[0].size()));
+    TSUNIT_ASSERT(decoder.addMediaPacket(media[2].data(), media[2].size()));
+    TSUNIT_ASSERT(decoder.addMediaPacket(media[3].data(), media[3].size()));
+    TSUNIT_ASSERT(decoder.addFECPacket(row_fec.data(), row_fec.size()));
+
+    ts::ByteBlock buffer(2000);
+    size_t size = 0;
+    TSUNIT_ASSERT(!decoder.recoverPacket(201, buffer.data(), buffer.size(), size));
+    TSUNIT_ASSERT(!decoder.recoverPacket(201, buffer.data(), buffer.size(), size));
+    TSUNIT_ASSERT(decoder.addMediaPacket(media[4].data(), media[4].size()));
+    TSUNIT_ASSERT(decoder.recoverPacket(201, buffer.data(), buffer.size(), size));
+    TSUNIT_EQUAL(media[1].size(), size);
+    TSUNIT_ASSERT(::memcmp(media[1].data(), buffer.data(), size) == 0);
+}
+
+void SMPTE2022FECTest::testBenchmark()
+{
+    // Encode the equivalent of 1 Gb/s during one second, complete 20x20 matrices with row FEC.
+    const size_t count = 1000000000 / (8 * 7 * ts::PKT_SIZE) / 400 * 400;
+    std::vector<ts::ByteBlock> media;
+    BuildMedia(media, 400, 0);
+
+    ts::SMPTE2022FECEncoder encoder(20, 20, true);
+    ts::ByteBlock column_fec;
+    ts::ByteBlock row_fec;
+    size_t fec_count = 0;
+
+    ts::Monotonic start(true);
+    for (size_t i = 0; i < count; ++i) {
+        ts::ByteBlock& rtp(media[i % media.size()]);
+        ts::PutUInt16(&rtp[2], uint16_t(i));
+        encoder.addMediaPacket(rtp.data(), rtp.size(), column_fec, row_fec);
+        fec_count += !column_fec.empty() + !row_fec.empty();
+    }
+    const ts::NanoSecond ns = ts::Monotonic(true) - start;
+
+    debug() << "SMPTE2022FECTest::testBenchmark: encoded " << count << " datagrams (1 Gb/s during 1 s), "
+            << fec_count << " FEC packets in " << ns / ts::NanoSecPerMicroSec << " us" << std::endl;
+    TSUNIT_EQUAL(2 * (count / 20), fec_count);
+}
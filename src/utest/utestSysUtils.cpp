@@ -32,6 +32,8 @@
 //----------------------------------------------------------------------------
 
 #include "tsFileUtils.h"
+#include "tsMemoryMappedFile.h"
+#include "tsNullReport.h"
 #include "tsSysUtils.h"
 #include "tsSysInfo.h"
 #include "tsRegistry.h"
@@ -69,6 +71,7 @@ public:
     void testFilePaths();
     void testTempFiles();
     void testFileSize();
+    void testMemoryMappedFile();
     void testFileTime();
     void testDirectory();
     void testWildcard();
@@ -97,6 +100,7 @@ public:
     TSUNIT_TEST(testFilePaths);
     TSUNIT_TEST(testTempFiles);
     TSUNIT_TEST(testFileSize);
+    TSUNIT_TEST(testMemoryMappedFile);
     TSUNIT_TEST(testFileTime);
     TSUNIT_TEST(testDirectory);
     TSUNIT_TEST(testWildcard);
@@ -508,6 +512,50 @@ void SysUtilsTest::testFileSize()
     TSUNIT_ASSERT(!ts::FileExists(tmpName2));
 }
 
+void SysUtilsTest::testMemoryMappedFile()
+{
+    const ts::UString tmpName(ts::TempFile());
+    const size_t granularity = ts::MemoryMappedFile::Granularity();
+    TSUNIT_ASSERT(granularity > 0);
+    TSUNIT_ASSERT(_CreateFile(tmpName, granularity + 100));
+
+    ts::MemoryMappedFile file;
+    TSUNIT_ASSERT(!file.isOpen());
+    TSUNIT_ASSERT(file.open(tmpName, false));
+    TSUNIT_ASSERT(file.isOpen());
+    TSUNIT_EQUAL(granularity + 100, file.fileSize());
+
+    // The mapped size is truncated at end of file.
+    TSUNIT_ASSERT(file.map(granularity, 1000));
+    TSUNIT_ASSERT(file.data() != nullptr);
+    TSUNIT_EQUAL(100, file.mappedSize());
+    TSUNIT_EQUAL(granularity, file.mappedOffset());
+    TSUNIT_EQUAL('-', file.data()[0]);
+    TSUNIT_EQUAL('-', file.data()[99]);
+    file.data()[5] = 'X';
+
+    // Invalid offset.
+    TSUNIT_ASSERT(!file.map(1, 10, NULLREP));
+    TSUNIT_ASSERT(file.data() == nullptr);
+
+    TSUNIT_ASSERT(file.map(0, 10));
+    TSUNIT_EQUAL(10, file.mappedSize());
+    TSUNIT_EQUAL('-', file.data()[0]);
+    TSUNIT_ASSERT(file.close());
+    TSUNIT_ASSERT(!file.isOpen());
+
+    // Check that the modification was written in the file.
+    TSUNIT_ASSERT(file.open(tmpName, true));
+    TSUNIT_ASSERT(file.map(granularity, 10));
+    TSUNIT_EQUAL('-', file.data()[4]);
+    TSUNIT_EQUAL('X', file.data()[5]);
+    TSUNIT_EQUAL('-', file.data()[6]);
+    TSUNIT_ASSERT(file.close());
+
+    TSUNIT_ASSERT(ts::DeleteFile(tmpName));
+    TSUNIT_ASSERT(!file.open(tmpName, true, NULLREP));
+}
+
 void SysUtilsTest::testFileTime()
 {
     const ts::UString tmpName(ts::TempFile());
@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSFile.h"
+#include "tsTSPacketStream.h"
 #include "tsTSPacket.h"
 #include "tsTSPacketMetadata.h"
 #include "tsCerrReport.h"
@@ -57,6 +58,8 @@ public:
     void testDuck();
     void testStuffingRead();
     void testStuffingWrite();
+    void testLocatePackets();
+    void testResync();
 
     TSUNIT_TEST_BEGIN(TSFileTest);
     TSUNIT_TEST(testTS);
@@ -64,6 +67,8 @@ public:
     TSUNIT_TEST(testDuck);
     TSUNIT_TEST(testStuffingRead);
     TSUNIT_TEST(testStuffingWrite);
+    TSUNIT_TEST(testLocatePackets);
+    TSUNIT_TEST(testResync);
     TSUNIT_TEST_END();
 
 private:
@@ -395,3 +400,66 @@ void TSFileTest::testStuffingWrite()
     TSUNIT_EQUAL(184, packets[5].getPayloadSize());
     TSUNIT_EQUAL(0xFF, packets[5].getPayload()[0]);
 }
+
+void TSFileTest::testLocatePackets()
+{
+    // 10 bytes of garbage, then 5 packets of 204 bytes.
+    ts::ByteBlock data(10, 0x47);
+    for (size_t i = 0; i < 5; ++i) {
+        data.append(ts::NullPacket.b, ts::PKT_SIZE);
+        data.append(uint8_t(0), ts::RS_SIZE);
+    }
+
+    TSUNIT_EQUAL(10, ts::TSPacketStream::LocatePackets(data.data(), data.size(), ts::PKT_RS_SIZE, 0, 5));
+    TSUNIT_EQUAL(ts::NPOS, ts::TSPacketStream::LocatePackets(data.data(), data.size(), ts::PKT_RS_SIZE, 0, 6));
+    TSUNIT_EQUAL(ts::NPOS, ts::TSPacketStream::LocatePackets(data.data(), data.size(), ts::PKT_SIZE, 0, 5));
+    TSUNIT_EQUAL(ts::NPOS, ts::TSPacketStream::LocatePackets(data.data(), data.size() - 1, ts::PKT_RS_SIZE, 0, 5));
+
+    ts::TSPacketFormat format = ts::TSPacketFormat::AUTODETECT;
+    TSUNIT_EQUAL(10, ts::TSPacketStream::LocatePackets(data.data(), data.size(), 3, format));
+    TSUNIT_EQUAL(ts::TSPacketFormat::RS204, format);
+
+    format = ts::TSPacketFormat::M2TS;
+    TSUNIT_EQUAL(ts::NPOS, ts::TSPacketStream::LocatePackets(data.data(), data.size(), 3, format));
+    TSUNIT_EQUAL(ts::TSPacketFormat::M2TS, format);
+}
+
+void TSFileTest::testResync()
+{
+    // 10 packets, 50 bytes of garbage, 10 packets.
+    ts::TSPacketVector packets(20);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i] = ts::NullPacket;
+        packets[i].setPID(ts::PID(100 + i));
+    }
+    ts::ByteBlock data(packets[0].b, 10 * ts::PKT_SIZE);
+    data.append(ts::ByteBlock(50, 0xAA));
+    data.append(packets[10].b, 10 * ts::PKT_SIZE);
+    TSUNIT_ASSERT(data.saveToFile(_tempFileName));
+
+    // Without resynchronization, garbage is read as packets.
+    ts::TSFile file;
+    ts::TSPacketVector inpackets(packets.size());
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 0, NULLREP));
+    TSUNIT_EQUAL(20, file.readPackets(inpackets.data(), nullptr, inpackets.size(), NULLREP));
+    TSUNIT_ASSERT(inpackets[9].hasValidSync());
+    TSUNIT_ASSERT(!inpackets[10].hasValidSync());
+    TSUNIT_EQUAL(0, file.resyncCount());
+    TSUNIT_ASSERT(file.close(NULLREP));
+
+    // With resynchronization, skip garbage.
+    file.setResync(4);
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 0, CERR));
+    size_t count = 0;
+    size_t ret = 0;
+    while ((ret = file.readPackets(&inpackets[count], nullptr, inpackets.size() - count, NULLREP)) > 0) {
+        count += ret;
+    }
+    TSUNIT_EQUAL(20, count);
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_EQUAL(100 + i, inpackets[i].getPID());
+    }
+    TSUNIT_EQUAL(1, file.resyncCount());
+    TSUNIT_EQUAL(50, file.resyncSkippedBytes());
+    TSUNIT_ASSERT(file.close(CERR));
+}
@@ -47,6 +47,10 @@
 #include "tsEacemPreferredNameIdentifierDescriptor.h"
 #include "tsEacemLogicalChannelNumberDescriptor.h"
 #include "tsEutelsatChannelNumberDescriptor.h"
+#include "tsServiceListDescriptor.h"
+#include "tsBinaryTablePatcher.h"
+#include "tsBinaryTable.h"
+#include "tsMonotonic.h"
 #include "tsDuckContext.h"
 #include "tsTSPacket.h"
 #include "tsunit.h"
@@ -73,6 +77,8 @@ public:
     void testTOT();
     void testTSDT();
     void testCleanupPrivateDescriptors();
+    void testPatchNIT();
+    void testPatchOverflow();
 
     TSUNIT_TEST_BEGIN(TableTest);
     TSUNIT_TEST(testAssignPMT);
@@ -86,6 +92,8 @@ public:
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testTSDT);
     TSUNIT_TEST(testCleanupPrivateDescriptors);
+    TSUNIT_TEST(testPatchNIT);
+    TSUNIT_TEST(testPatchOverflow);
     TSUNIT_TEST_END();
 };
 
@@ -368,3 +376,148 @@ void TableTest::testCleanupPrivateDescriptors()
     TSUNIT_EQUAL(1, dlist.count());
     TSUNIT_EQUAL(ts::DID_SERVICE, dlist[0]->tag());
 }
+
+namespace {
+    // Build a large NIT, spanning several sections.
+    void BuildLargeNIT(ts::DuckContext& duck, ts::NIT& nit)
+    {
+        nit.network_id = 0x1234;
+        nit.descs.add(duck, ts::CADescriptor(0x0100, 0x0200));
+        for (uint16_t ts_id = 1; ts_id <= 500; ++ts_id) {
+            ts::DescriptorList& dlist(nit.transports[ts::TransportStreamId(ts_id, 0x0055)].descs);
+            ts::ServiceListDescriptor sld;
+            for (uint16_t srv = 0; srv < 10; ++srv) {
+                sld.addService(uint16_t(ts_id * 16 + srv), 0x01);
+            }
+            dlist.add(duck, sld);
+            dlist.add(duck, ts::CADescriptor(0x0100, ts::PID(0x0100 + ts_id)));
+        }
+    }
+
+    // Patch handler: remove transport streams with odd ids and all CA descriptors.
+    class RemovePatchHandler: public ts::BinaryTablePatcher::Handler
+    {
+    public:
+        virtual bool keepEntry(const ts::BinaryTablePatcher::Location& loc) override
+        {
+            return loc.entry_id % 2 == 0;
+        }
+        virtual void patchDescriptorList(ts::DescriptorList& dlist, const ts::BinaryTablePatcher::Location&) override
+        {
+            dlist.removeByTag(ts::DID_CA);
+        }
+    };
+
+    // Patch handler: add a large private descriptor in each transport stream, overflowing sections.
+    class GrowPatchHandler: public ts::BinaryTablePatcher::Handler
+    {
+    public:
+        virtual void patchDescriptorList(ts::DescriptorList& dlist, const ts::BinaryTablePatcher::Location& loc) override
+        {
+            if (!loc.global) {
+                uint8_t desc[202];
+                ::memset(desc, 0xA5, sizeof(desc));
+                desc[0] = 0xF0;
+                desc[1] = uint8_t(sizeof(desc) - 2);
+                dlist.add(desc, sizeof(desc));
+            }
+        }
+    };
+}
+
+void TableTest::testPatchNIT()
+{
+    ts::DuckContext duck;
+    ts::NIT nit;
+    BuildLargeNIT(duck, nit);
+
+    ts::BinaryTable bin;
+    nit.serialize(duck, bin);
+    TSUNIT_ASSERT(bin.isValid());
+    TSUNIT_ASSERT(bin.sectionCount() > 1);
+
+    // Reference: full deserialization, modification, serialization.
+    ts::NIT ref(duck, bin);
+    TSUNIT_ASSERT(ref.isValid());
+    for (auto it = ref.transports.begin(); it != ref.transports.end(); ) {
+        if (it->first.transport_stream_id % 2 != 0) {
+            it = ref.transports.erase(it);
+        }
+        else {
+            it->second.descs.removeByTag(ts::DID_CA);
+            ++it;
+        }
+    }
+    ref.descs.removeByTag(ts::DID_CA);
+
+    // In-place patching.
+    ts::BinaryTable patched(bin, ts::ShareMode::COPY);
+    ts::BinaryTablePatcher patcher;
+    RemovePatchHandler handler;
+    TSUNIT_ASSERT(patcher.patch(patched, handler));
+    TSUNIT_EQUAL(bin.sectionCount(), patcher.modifiedSections());
+    TSUNIT_EQUAL(bin.sectionCount(), patched.sectionCount());
+    TSUNIT_ASSERT(patched.isValid());
+    TSUNIT_ASSERT(patched.totalSize() < bin.totalSize());
+
+    ts::NIT result(duck, patched);
+    TSUNIT_ASSERT(result.isValid());
+    TSUNIT_EQUAL(0x1234, result.network_id);
+    TSUNIT_EQUAL(0, result.descs.count());
+    TSUNIT_EQUAL(ref.transports.size(), result.transports.size());
+    for (const auto& it : ref.transports) {
+        TSUNIT_EQUAL(1, result.transports.count(it.first));
+        TSUNIT_ASSERT(it.second.descs == result.transports[it.first].descs);
+    }
+
+    // A second patch with the same handler does not modify anything.
+    TSUNIT_ASSERT(patcher.patch(patched, handler));
+    TSUNIT_EQUAL(0, patcher.modifiedSections());
+
+    // Compare the speed of the two methods.
+    const int count = 50;
+    ts::Monotonic start(true);
+    for (int i = 0; i < count; ++i) {
+        ts::BinaryTable bt(bin, ts::ShareMode::COPY);
+        ts::NIT n(duck, bt);
+        for (auto& it : n.transports) {
+            it.second.descs.removeByTag(ts::DID_CA);
+        }
+        n.clearPreferredSections();
+        n.serialize(duck, bt);
+    }
+    const ts::NanoSecond full = ts::Monotonic(true) - start;
+    start.getSystemTime();
+    for (int i = 0; i < count; ++i) {
+        ts::BinaryTable bt(bin, ts::ShareMode::COPY);
+        patcher.patch(bt, handler);
+    }
+    const ts::NanoSecond inplace = ts::Monotonic(true) - start;
+    debug() << "TableTest::testPatchNIT: " << bin.sectionCount() << " sections, full reserialization: "
+            << (full / count / 1000) << " us, in-place patch: " << (inplace / count / 1000) << " us" << std::endl;
+}
+
+void TableTest::testPatchOverflow()
+{
+    ts::DuckContext duck;
+    ts::NIT nit;
+    BuildLargeNIT(duck, nit);
+
+    ts::BinaryTable bin;
+    nit.serialize(duck, bin);
+    TSUNIT_ASSERT(bin.isValid());
+
+    // The sections are full, adding descriptors overflows and the table is left unmodified.
+    ts::BinaryTable patched(bin, ts::ShareMode::COPY);
+    ts::BinaryTablePatcher patcher;
+    GrowPatchHandler handler;
+    TSUNIT_ASSERT(!patcher.patch(patched, handler));
+    TSUNIT_ASSERT(patched == bin);
+
+    // Unsupported table.
+    ts::TOT tot;
+    ts::BinaryTable bintot;
+    tot.serialize(duck, bintot);
+    TSUNIT_ASSERT(!ts::BinaryTablePatcher::IsSupported(ts::TID_TOT));
+    TSUNIT_ASSERT(!patcher.patch(bintot, handler));
+}
@@ -33,6 +33,7 @@
 
 #include "tsTimeShiftBuffer.h"
 #include "tsCerrReport.h"
+#include "tsMonotonic.h"
 #include "tsunit.h"
 
 
@@ -49,11 +50,13 @@ public:
     void testMinimum();
     void testMemory();
     void testFile();
+    void testSoak();
 
     TSUNIT_TEST_BEGIN(TimeShiftBufferTest);
     TSUNIT_TEST(testMinimum);
     TSUNIT_TEST(testMemory);
     TSUNIT_TEST(testFile);
+    TSUNIT_TEST(testSoak);
     TSUNIT_TEST_END();
 
 private:
@@ -166,3 +169,53 @@ void TimeShiftBufferTest::testFile()
 {
     testCommon(20, 4);
 }
+
+// Long run through a disk-backed buffer, wrapping many times around the file.
+void TimeShiftBufferTest::testSoak()
+{
+    constexpr size_t total = 10007;   // not a multiple of the cache size
+    constexpr size_t memory = 256;
+    constexpr uint32_t count = 200000;
+
+    ts::TimeShiftBuffer buf(total);
+    TSUNIT_ASSERT(buf.setMemoryPackets(memory));
+    TSUNIT_ASSERT(buf.open(CERR));
+    TSUNIT_ASSERT(!buf.memoryResident());
+
+    ts::TSPacket pkt;
+    ts::TSPacketMetadata mdata;
+    const ts::Monotonic start(true);
+
+    for (uint32_t i = 0; i < count; i++) {
+        pkt.init(ts::PID(i % ts::PID_NULL), uint8_t(i), uint8_t(i));
+        ts::PutUInt32(pkt.getPayload(), i);
+        mdata.reset();
+        mdata.setLabel(i % ts::TSPacketMetadata::LABEL_COUNT);
+
+        TSUNIT_ASSERT(buf.shift(pkt, mdata, CERR));
+
+        if (i < total) {
+            TSUNIT_EQUAL(ts::PID_NULL, pkt.getPID());
+            TSUNIT_ASSERT(mdata.getInputStuffing());
+        }
+        else {
+            const uint32_t j = i - uint32_t(total);
+            TSUNIT_EQUAL(j, ts::GetUInt32(pkt.getPayload()));
+            TSUNIT_EQUAL(j % ts::PID_NULL, pkt.getPID());
+            TSUNIT_ASSERT(mdata.hasLabel(j % ts::TSPacketMetadata::LABEL_COUNT));
+            TSUNIT_ASSERT(!mdata.getInputStuffing());
+        }
+    }
+
+    const ts::NanoSecond duration = ts::Monotonic(true) - start;
+    const ts::TimeShiftBuffer::Statistics stats(buf.statistics());
+    debug() << "TimeShiftBufferTest::testSoak: " << count << " packets in " << duration / ts::NanoSecPerMicroSec << " us" << std::endl
+            << "TimeShiftBufferTest::testSoak: " << stats.read_count << " reads, " << stats.write_count << " writes, "
+            << "I/O time: " << stats.io_time / ts::NanoSecPerMicroSec << " us, max: " << stats.io_max / ts::NanoSecPerMicroSec << " us" << std::endl
+            << "TimeShiftBufferTest::testSoak: " << stats.wait_count << " waits, "
+            << "wait time: " << stats.wait_time / ts::NanoSecPerMicroSec << " us, max: " << stats.wait_max / ts::NanoSecPerMicroSec << " us" << std::endl;
+
+    TSUNIT_ASSERT(stats.read_count > 0);
+    TSUNIT_ASSERT(stats.write_count > 0);
+    TSUNIT_ASSERT(buf.close(CERR));
+}
@@ -0,0 +1,262 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TimerWheel
+//
+//----------------------------------------------------------------------------
+
+#include "tsTimerWheel.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TimerWheelTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testOrder();
+    void testRandom();
+    void testRemoveIf();
+    void testBenchmark();
+
+    TSUNIT_TEST_BEGIN(TimerWheelTest);
+    TSUNIT_TEST(testOrder);
+    TSUNIT_TEST(testRandom);
+    TSUNIT_TEST(testRemoveIf);
+    TSUNIT_TEST(testBenchmark);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(TimerWheelTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TimerWheelTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TimerWheelTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Deterministic pseudo-random generator, reproducible across platforms.
+    class Lcg
+    {
+    public:
+        Lcg() : _state(0x12345678) {}
+        uint64_t next(uint64_t max) { _state = _state * 6364136223846793005ULL + 1442695040888963407ULL; return (_state >> 33) % max; }
+    private:
+        uint64_t _state;
+    };
+}
+
+void TimerWheelTest::testOrder()
+{
+    ts::TimerWheel<int> wheel(100);
+    TSUNIT_ASSERT(wheel.empty());
+    TSUNIT_EQUAL(100, wheel.currentTick());
+
+    wheel.insert(1, 1000);
+    wheel.insert(2, 150);
+    wheel.insert(3, 1000);      // same due as 1, must come after it
+    wheel.insert(4, 50);        // in the past, clamped to current tick
+    wheel.insert(5, 1 << 30);   // far in the future (overflow)
+    TSUNIT_EQUAL(5, wheel.size());
+
+    int value = 0;
+    ts::TimerWheel<int>::Tick due = 0;
+
+    TSUNIT_ASSERT(wheel.popReady(value, 100, &due));
+    TSUNIT_EQUAL(4, value);
+    TSUNIT_EQUAL(100, due);
+    TSUNIT_ASSERT(!wheel.popReady(value, 149));
+    TSUNIT_ASSERT(wheel.popReady(value, 999, &due));
+    TSUNIT_EQUAL(2, value);
+    TSUNIT_EQUAL(150, due);
+    TSUNIT_ASSERT(!wheel.popReady(value, 999));
+    TSUNIT_ASSERT(wheel.popReady(value, 1000));
+    TSUNIT_EQUAL(1, value);
+    TSUNIT_ASSERT(wheel.popReady(value, 1000));
+    TSUNIT_EQUAL(3, value);
+    TSUNIT_ASSERT(!wheel.popReady(value, (1 << 30) - 1));
+    TSUNIT_ASSERT(wheel.pop(value, &due));
+    TSUNIT_EQUAL(5, value);
+    TSUNIT_EQUAL(1 << 30, due);
+    TSUNIT_ASSERT(wheel.empty());
+    TSUNIT_ASSERT(!wheel.pop(value));
+}
+
+void TimerWheelTest::testRandom()
+{
+    // Compare with a multimap which keeps insertion order of equal keys.
+    typedef ts::TimerWheel<int>::Tick Tick;
+    ts::TimerWheel<int> wheel;
+    std::multimap<Tick, int> ref;
+    Lcg rnd;
+    Tick now = 0;
+    int counter = 0;
+
+    for (int iter = 0; iter < 20000; ++iter) {
+        // Insert a few elements, mostly near, sometimes very far.
+        const size_t count = size_t(rnd.next(4));
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t range = rnd.next(100) == 0 ? (uint64_t(1) << 34) : rnd.next(2) == 0 ? 300 : 100000;
+            const Tick due = now + rnd.next(range);
+            wheel.insert(counter, due);
+            ref.insert(std::make_pair(due, counter));
+            counter++;
+        }
+        // Advance time and extract all ready elements.
+        now += rnd.next(rnd.next(50) == 0 ? 1000000 : 500);
+        int value = 0;
+        Tick due = 0;
+        while (wheel.popReady(value, now, &due)) {
+            TSUNIT_ASSERT(!ref.empty());
+            TSUNIT_EQUAL(ref.begin()->first, due);
+            TSUNIT_EQUAL(ref.begin()->second, value);
+            TSUNIT_ASSERT(due <= now);
+            ref.erase(ref.begin());
+        }
+        TSUNIT_ASSERT(ref.empty() || ref.begin()->first > now);
+        TSUNIT_EQUAL(ref.size(), wheel.size());
+    }
+
+    // Drain the rest.
+    int value = 0;
+    Tick due = 0;
+    while (wheel.pop(value, &due)) {
+        TSUNIT_ASSERT(!ref.empty());
+        TSUNIT_EQUAL(ref.begin()->first, due);
+        TSUNIT_EQUAL(ref.begin()->second, value);
+        ref.erase(ref.begin());
+    }
+    TSUNIT_ASSERT(ref.empty());
+    debug() << "TimerWheelTest::testRandom: " << counter << " elements" << std::endl;
+}
+
+void TimerWheelTest::testRemoveIf()
+{
+    ts::TimerWheel<int> wheel;
+    for (int i = 0; i < 1000; ++i) {
+        wheel.insert(i, ts::TimerWheel<int>::Tick(i % 10 == 0 ? i << 20 : i * 7));
+    }
+    size_t calls = 0;
+    TSUNIT_EQUAL(500, wheel.removeIf([&calls](const int& value) { ++calls; return value % 2 != 0; }));
+    TSUNIT_EQUAL(1000, calls);
+    TSUNIT_EQUAL(500, wheel.size());
+
+    ts::TimerWheel<int>::Tick previous = 0;
+    bool ordered = true;
+    size_t count = 0;
+    wheel.forEach([&](const int& value, ts::TimerWheel<int>::Tick due) { ordered = ordered && value % 2 == 0 && due >= previous; previous = due; ++count; });
+    TSUNIT_ASSERT(ordered);
+    TSUNIT_EQUAL(500, count);
+
+    int value = 0;
+    ts::TimerWheel<int>::Tick due = 0;
+    previous = 0;
+    while (wheel.pop(value, &due)) {
+        TSUNIT_EQUAL(0, value % 2);
+        TSUNIT_ASSERT(due >= previous);
+        previous = due;
+    }
+}
+
+void TimerWheelTest::testBenchmark()
+{
+    // Typical EIT schedule load: 500 services, 8 days of 3-hour segments.
+    // Each section is repeatedly rescheduled as in EITGenerator, one tick is one millisecond.
+    typedef ts::TimerWheel<int>::Tick Tick;
+    constexpr int SECTIONS = 500 * 64;
+    constexpr Tick DURATION = 60000;
+    constexpr Tick REPEAT = 10000;
+
+    // Timer wheel.
+    ts::Monotonic start(true);
+    ts::TimerWheel<int> wheel;
+    for (int i = 0; i < SECTIONS; ++i) {
+        wheel.insert(i, Tick(i % 1000));
+    }
+    size_t wheel_count = 0;
+    for (Tick now = 0; now < DURATION; ++now) {
+        int value = 0;
+        Tick due = 0;
+        while (wheel.popReady(value, now, &due)) {
+            wheel.insert(value, due + REPEAT);
+            wheel_count++;
+        }
+    }
+    const ts::NanoSecond wheel_ns = ts::Monotonic(true) - start;
+
+    // Same thing with a sorted list, as previously used in EITGenerator.
+    start.getSystemTime();
+    std::list<std::pair<Tick, int>> list;
+    const auto list_insert = [&list](int value, Tick due) {
+        auto it = list.end();
+        while (it != list.begin() && std::prev(it)->first > due) {
+            --it;
+        }
+        list.insert(it, std::make_pair(due, value));
+    };
+    for (int i = 0; i < SECTIONS; ++i) {
+        list_insert(i, Tick(i % 1000));
+    }
+    size_t list_count = 0;
+    for (Tick now = 0; now < DURATION; ++now) {
+        while (!list.empty() && list.front().first <= now) {
+            const std::pair<Tick, int> p(list.front());
+            list.pop_front();
+            list_insert(p.second, p.first + REPEAT);
+            list_count++;
+        }
+    }
+    const ts::NanoSecond list_ns = ts::Monotonic(true) - start;
+
+    TSUNIT_EQUAL(list_count, wheel_count);
+    TSUNIT_EQUAL(list.size(), wheel.size());
+    debug() << "TimerWheelTest::testBenchmark: " << SECTIONS << " sections, " << wheel_count << " reschedules" << std::endl
+            << "TimerWheelTest::testBenchmark: timer wheel: " << (wheel_ns / 1000) << " us, sorted list: " << (list_ns / 1000) << " us" << std::endl;
+}
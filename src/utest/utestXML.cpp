@@ -32,13 +32,18 @@
 //----------------------------------------------------------------------------
 
 #include "tsxmlModelDocument.h"
+#include "tsxmlJSONConverter.h"
+#include "tsxmlStreamWriter.h"
 #include "tsxmlElement.h"
 #include "tsSectionFile.h"
 #include "tsTextFormatter.h"
 #include "tsCerrReport.h"
 #include "tsReportBuffer.h"
 #include "tsFileUtils.h"
+#include "tsMonotonic.h"
+#include "tsDuckContext.h"
 #include "tsunit.h"
+#include "tables/psi_pmt_scte35_xml.h"
 
 
 //----------------------------------------------------------------------------
@@ -56,23 +61,33 @@ public:
     void testDocument();
     void testInvalid();
     void testFileBOM();
+    void testFileCRLF();
     void testValidation();
     void testCreation();
     void testKeepOpen();
     void testEscape();
     void testTweaks();
     void testChannels();
+    void testStreamWriter();
+    void testStreamWriterJSON();
+    void testStreamWriterBenchmark();
+    void testParserBenchmark();
 
     TSUNIT_TEST_BEGIN(XMLTest);
     TSUNIT_TEST(testDocument);
     TSUNIT_TEST(testInvalid);
     TSUNIT_TEST(testFileBOM);
+    TSUNIT_TEST(testFileCRLF);
     TSUNIT_TEST(testValidation);
     TSUNIT_TEST(testCreation);
     TSUNIT_TEST(testKeepOpen);
     TSUNIT_TEST(testEscape);
     TSUNIT_TEST(testTweaks);
     TSUNIT_TEST(testChannels);
+    TSUNIT_TEST(testStreamWriter);
+    TSUNIT_TEST(testStreamWriterJSON);
+    TSUNIT_TEST(testStreamWriterBenchmark);
+    TSUNIT_TEST(testParserBenchmark);
     TSUNIT_TEST_END();
 
 private:
@@ -249,6 +264,57 @@ void XMLTest::testFileBOM()
     TSUNIT_ASSERT(ts::DeleteFile(_tempFileName));
 }
 
+void XMLTest::testFileCRLF()
+{
+    // Mixed CR/LF line endings, CR inside a line, no final end of line.
+    const std::string fileData(
+        "<?xml version='1.0' encoding='UTF-8'?>\r\n"
+        "<foo>\r\r\n"
+        "  <bar a=\"x\ry\">\n"
+        "    text\r\n"
+        "  </bar>\n"
+        "\n"
+        "  <baz/>\r\n"
+        "</foo>");
+
+    TSUNIT_ASSERT(ts::ByteBlock(fileData.data(), fileData.size()).saveToFile(_tempFileName, &report()));
+
+    ts::xml::Document doc(report());
+    TSUNIT_ASSERT(doc.load(_tempFileName));
+
+    const ts::xml::Element* root = doc.rootElement();
+    TSUNIT_ASSERT(root != nullptr);
+    TSUNIT_EQUAL(2, root->lineNumber());
+    TSUNIT_EQUAL(2, root->childrenCount());
+
+    const ts::xml::Element* elem = root->firstChildElement();
+    TSUNIT_ASSERT(elem != nullptr);
+    TSUNIT_EQUAL(u"bar", elem->name());
+    TSUNIT_EQUAL(3, elem->lineNumber());
+    TSUNIT_EQUAL(u"x\ry", elem->attribute(u"a").value());
+    TSUNIT_EQUAL(u"\n    text\n  ", elem->text(false));
+
+    elem = elem->nextSiblingElement();
+    TSUNIT_ASSERT(elem != nullptr);
+    TSUNIT_EQUAL(u"baz", elem->name());
+    TSUNIT_EQUAL(7, elem->lineNumber());
+
+    // Same document from an in-memory string, where all CR are removed.
+    ts::xml::Document doc2(report());
+    TSUNIT_ASSERT(doc2.parse(ts::UString::FromUTF8(fileData)));
+    TSUNIT_ASSERT(doc2.rootElement() != nullptr);
+    TSUNIT_EQUAL(u"xy", doc2.rootElement()->firstChildElement()->attribute(u"a").value());
+    TSUNIT_EQUAL(7, doc2.rootElement()->lastChild()->lineNumber());
+
+    // Line numbers in error messages.
+    ts::ReportBuffer<> rep;
+    ts::xml::Document doc3(rep);
+    TSUNIT_ASSERT(!doc3.parse(u"<foo>\r\n\r\n<bar a=\"1\"\n a=\"2\"/>\n</foo>"));
+    TSUNIT_EQUAL(u"Error: line 4: duplicate attribute 'a' in tag <bar>", rep.getMessages());
+
+    TSUNIT_ASSERT(ts::DeleteFile(_tempFileName));
+}
+
 void XMLTest::testValidation()
 {
     ts::xml::ModelDocument model(report());
@@ -488,3 +554,266 @@ void XMLTest::testChannels()
     ts::xml::Document model(report());
     TSUNIT_ASSERT(model.load(ts::SectionFile::XML_TABLES_MODEL));
 }
+
+namespace {
+    // A document with all kinds of nodes and formatting difficulties.
+    const ts::UChar* const StreamDocument =
+        u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        u"<root a1=\"val1\" Num=\"0x20\" flag=\"true\" Neg=\"-12\" big=\"-0x8000000000000000\">\n"
+        u"  <!-- a comment -->\n"
+        u"  <node1>  Text in\tnode1  </node1>\n"
+        u"  <node2 n=\"12,345\" b=\"maybe\" s=\"12\">\n"
+        u"    <node21 x=\"a&amp;&quot;b\" y='c\"d' z=\"e&lt;'f&quot;\">\n"
+        u"      <node211/>\n"
+        u"    </node21>\n"
+        u"    <data>  01 02 03\n"
+        u"      04 05  </data>\n"
+        u"  </node2>\n"
+        u"  <node3 foo=\"bar\">before<![CDATA[some <cdata>]]>after</node3>\n"
+        u"  <empty><!-- only a comment --></empty>\n"
+        u"</root>\n";
+
+    // The corresponding model, for JSON conversion.
+    const ts::UChar* const StreamModel =
+        u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        u"<root a1=\"string\" num=\"uint8\" flag=\"bool\" neg=\"int8\" big=\"uint64\">\n"
+        u"  <node1>String</node1>\n"
+        u"  <node2 n=\"uint32\" b=\"bool\" s=\"string\">\n"
+        u"    <node21 x=\"string\" y=\"string\" z=\"string\">\n"
+        u"      <node211/>\n"
+        u"    </node21>\n"
+        u"    <data>Hexadecimal content</data>\n"
+        u"  </node2>\n"
+        u"  <node3 foo=\"string\"/>\n"
+        u"  <empty/>\n"
+        u"</root>\n";
+
+    // Print a node or JSON value as a one-liner.
+    template <class T>
+    ts::UString OneLiner(const T& obj)
+    {
+        ts::TextFormatter text(NULLREP);
+        text.setString();
+        text.setEndOfLineMode(ts::TextFormatter::EndOfLineMode::SPACING);
+        obj.print(text);
+        return text.toString();
+    }
+}
+
+void XMLTest::testStreamWriter()
+{
+    ts::xml::Document doc(report());
+    TSUNIT_ASSERT(doc.parse(StreamDocument));
+
+    ts::xml::StreamWriter writer(report());
+    for (int strict = 0; strict < 2; ++strict) {
+        ts::xml::Tweaks tweaks;
+        tweaks.strictAttributeFormatting = tweaks.strictTextNodeFormatting = strict != 0;
+        doc.setTweaks(tweaks);
+        writer.setTweaks(tweaks);
+
+        // Complete document, indented.
+        writer.setOneLiner(false);
+        writer.clear();
+        writer.addDocument(doc);
+        TSUNIT_EQUAL(doc.toString(), writer.toString());
+
+        // Complete document, one-liner.
+        writer.setOneLiner(true);
+        writer.clear();
+        writer.addDocument(doc);
+        TSUNIT_EQUAL(OneLiner(doc), writer.toString());
+        debug() << "XMLTest::testStreamWriter: " << writer.toString() << std::endl;
+    }
+
+    // Same as a running document: elements with a margin.
+    const ts::xml::Element* node2 = doc.rootElement()->findFirstChild(u"node2");
+    TSUNIT_ASSERT(node2 != nullptr);
+    ts::TextFormatter text(report());
+    text.setString();
+    text << ts::indent << ts::margin;
+    node2->print(text);
+    writer.setOneLiner(false);
+    writer.setMarginSize(2);
+    writer.clear();
+    writer.margin();
+    writer.addElement(*node2);
+    TSUNIT_EQUAL(text.toString(), writer.toString());
+
+    // Build the same element using the SAX-like interface.
+    writer.clear();
+    writer.margin();
+    writer.startElement(u"node2");
+    writer.setAttribute(u"s", u"foo");
+    writer.setAttribute(u"n", u"12,345");
+    writer.setAttribute(u"b", u"maybe");
+    writer.setAttribute(u"S", u"12");    // replaced and moved last
+    writer.startElement(u"node21");
+    writer.setAttribute(u"x", u"a&\"b");
+    writer.setAttribute(u"y", u"c\"d");
+    writer.setAttribute(u"z", u"e<'f\"");
+    writer.startElement(u"node211");
+    writer.endElement();
+    writer.endElement();
+    writer.startElement(u"data");
+    writer.addText(u"  01 02 03\n      04 05  ");
+    writer.endElement();
+    writer.endElement();
+    TSUNIT_EQUAL(text.toString().toSubstituted(u" s=\"12\"", u" S=\"12\""), writer.toString());
+}
+
+void XMLTest::testStreamWriterJSON()
+{
+    ts::xml::Document doc(report());
+    TSUNIT_ASSERT(doc.parse(StreamDocument));
+
+    ts::xml::JSONConverter conv(report());
+    TSUNIT_ASSERT(conv.parse(StreamModel));
+
+    ts::xml::StreamWriter writer(report());
+    writer.setJSON(&conv);
+    TSUNIT_ASSERT(writer.isJSON());
+
+    for (int trim = 0; trim < 2; ++trim) {
+        ts::xml::Tweaks tweaks;
+        tweaks.x2jTrimText = tweaks.x2jCollapseText = tweaks.x2jEnforceInteger = tweaks.x2jEnforceBoolean = trim != 0;
+        conv.setTweaks(tweaks);
+
+        // Complete document, indented.
+        const ts::json::ValuePtr jdoc(conv.convertToJSON(doc, true));
+        writer.setOneLiner(false);
+        writer.clear();
+        writer.addElement(*doc.rootElement());
+        TSUNIT_EQUAL(jdoc->printed(2), writer.toString());
+
+        // Complete document, one-liner.
+        writer.setOneLiner(true);
+        writer.clear();
+        writer.addElement(*doc.rootElement());
+        TSUNIT_EQUAL(OneLiner(*jdoc), writer.toString());
+        debug() << "XMLTest::testStreamWriterJSON: " << writer.toString() << std::endl;
+    }
+
+    // One element inside the root, as logged by TablesLogger.
+    const ts::xml::Element* node2 = doc.rootElement()->findFirstChild(u"node2");
+    TSUNIT_ASSERT(node2 != nullptr);
+    writer.setJSON(&conv, u"root");
+    writer.setOneLiner(true);
+    writer.clear();
+    writer.addElement(*node2);
+    TSUNIT_EQUAL(OneLiner(conv.convertToJSON(doc, true)->query(u"#nodes[1]")), writer.toString());
+
+    // Same with a real table and the tables model.
+    ts::xml::Document tdoc(report());
+    TSUNIT_ASSERT(tdoc.parse(psi_pmt_scte35_xml));
+    ts::xml::JSONConverter tconv(report());
+    TSUNIT_ASSERT(ts::SectionFile::LoadModel(tconv));
+    writer.setJSON(&tconv, u"tsduck");
+    writer.clear();
+    writer.addElement(*tdoc.rootElement()->firstChildElement());
+    TSUNIT_EQUAL(OneLiner(tconv.convertToJSON(tdoc, true)->query(u"#nodes[0]")), writer.toString());
+    debug() << "XMLTest::testStreamWriterJSON: " << writer.toString() << std::endl;
+}
+
+void XMLTest::testStreamWriterBenchmark()
+{
+    // Format the same table many times as an XML and JSON one-liner, as with tstables --log-xml-line --log-json-line.
+    constexpr size_t COUNT = 2000;
+
+    ts::xml::Document doc(report());
+    TSUNIT_ASSERT(doc.parse(psi_pmt_scte35_xml));
+    ts::xml::JSONConverter conv(report());
+    TSUNIT_ASSERT(ts::SectionFile::LoadModel(conv));
+    const ts::xml::Element* table = doc.rootElement()->firstChildElement();
+    TSUNIT_ASSERT(table != nullptr);
+
+    // Using the text formatter and the JSON converter.
+    ts::Monotonic start(true);
+    size_t dom_size = 0;
+    for (size_t i = 0; i < COUNT; ++i) {
+        dom_size += OneLiner(doc).size();
+        dom_size += OneLiner(conv.convertToJSON(doc, true)->query(u"#nodes[0]")).size();
+    }
+    const ts::NanoSecond dom_ns = ts::Monotonic(true) - start;
+
+    // Using streaming writers.
+    start.getSystemTime();
+    ts::xml::StreamWriter xml_writer(report());
+    ts::xml::StreamWriter json_writer(report());
+    xml_writer.setOneLiner(true);
+    json_writer.setOneLiner(true);
+    json_writer.setJSON(&conv, u"tsduck");
+    size_t writer_size = 0;
+    for (size_t i = 0; i < COUNT; ++i) {
+        xml_writer.clear();
+        xml_writer.addDocument(doc);
+        writer_size += xml_writer.toString().size();
+        json_writer.clear();
+        json_writer.addElement(*table);
+        writer_size += json_writer.toString().size();
+    }
+    const ts::NanoSecond writer_ns = ts::Monotonic(true) - start;
+
+    TSUNIT_EQUAL(dom_size, writer_size);
+    debug() << "XMLTest::testStreamWriterBenchmark: " << COUNT << " tables, text formatter and JSON converter: "
+            << dom_ns / ts::NanoSecPerMicroSec << " us, streaming writers: " << writer_ns / ts::NanoSecPerMicroSec << " us" << std::endl;
+}
+
+void XMLTest::testParserBenchmark()
+{
+    // Build a large EPG file, as used by eitinject or tstabcomp.
+    constexpr size_t SERVICES = 50;
+    constexpr size_t TABLES = 16;
+    constexpr size_t EVENTS = 8;
+
+    ts::UStringList lines;
+    lines.push_back(u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+    lines.push_back(u"<tsduck>");
+    for (size_t srv = 1; srv <= SERVICES; ++srv) {
+        for (size_t tid = 0; tid < TABLES; ++tid) {
+            lines.push_back(ts::UString::Format(u"  <EIT type=\"%d\" version=\"3\" service_id=\"%d\" transport_stream_id=\"1\" original_network_id=\"1\">", {tid, srv}));
+            for (size_t ev = 0; ev < EVENTS; ++ev) {
+                const size_t id = (srv * TABLES + tid) * EVENTS + ev;
+                lines.push_back(ts::UString::Format(u"    <event event_id=\"%d\" start_time=\"2030-01-%02d %02d:00:00\" duration=\"03:00:00\" running_status=\"undefined\" CA_mode=\"false\">", {id, tid + 1, ev * 3}));
+                lines.push_back(u"      <short_event_descriptor language_code=\"fre\">");
+                lines.push_back(ts::UString::Format(u"        <event_name>\u00C9mission %d &amp; suite</event_name>", {id}));
+                lines.push_back(ts::UString::Format(u"        <text>Description d\u00E9taill\u00E9e de l'\u00E9mission %d.</text>", {id}));
+                lines.push_back(u"      </short_event_descriptor>");
+                lines.push_back(u"      <component_descriptor stream_content=\"1\" component_type=\"3\" component_tag=\"1\" language_code=\"fre\"/>");
+                lines.push_back(u"    </event>");
+            }
+            lines.push_back(u"  </EIT>");
+        }
+    }
+    lines.push_back(u"</tsduck>");
+    TSUNIT_ASSERT(ts::UString::Save(lines, _tempFileName));
+    const size_t file_size = size_t(ts::GetFileSize(_tempFileName));
+
+    // Load the XML document from the file.
+    ts::Monotonic start(true);
+    ts::xml::Document doc(report());
+    TSUNIT_ASSERT(doc.load(_tempFileName));
+    const ts::NanoSecond load_ns = ts::Monotonic(true) - start;
+
+    TSUNIT_ASSERT(doc.rootElement() != nullptr);
+    TSUNIT_EQUAL(SERVICES * TABLES, doc.rootElement()->childrenCount());
+    TSUNIT_EQUAL(2, doc.rootElement()->lineNumber());
+
+    // Same document from a list of lines.
+    ts::xml::Document doc2(report());
+    TSUNIT_ASSERT(doc2.parse(lines));
+    TSUNIT_EQUAL(doc.toString(), doc2.toString());
+
+    // Load and compile the tables, as tstabcomp or inject.
+    start.getSystemTime();
+    ts::DuckContext duck;
+    ts::SectionFile file(duck);
+    TSUNIT_ASSERT(file.loadXML(_tempFileName));
+    const ts::NanoSecond tables_ns = ts::Monotonic(true) - start;
+    TSUNIT_EQUAL(SERVICES * TABLES, file.tablesCount());
+
+    debug() << "XMLTest::testParserBenchmark: " << file_size << " bytes, " << lines.size() << " lines, XML load: "
+            << load_ns / ts::NanoSecPerMicroSec << " us, SectionFile load: " << tables_ns / ts::NanoSecPerMicroSec << " us" << std::endl;
+
+    TSUNIT_ASSERT(ts::DeleteFile(_tempFileName));
+}